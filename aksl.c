@@ -18,25 +18,54 @@ object::
     get_int_attr
     get_object_attr
     get_datum_attr
+    subscribe
 event::
     print
 event_heap::
     print
+    set_fel_type
+    reserve
+    defer_insert
+    flush
+    insert_many
+    remove
+    purge
+    resize_batch
+    pop_batch
+    group_batch
 globvarlist::
     set
     set
     get
+subscriber_array::
+    remove
+    resize
 systm::
     add
+    remove
+    pack_event
+    unpack_event
+    insert_event
+    subscribe
+    clear_subscriptions
     cancel_message
     newevent_abs
     newevent_abs
     newevent_abs
     newevent_abs
     newevent_abs
+    newevent_abs
     broadcast
+    broadcast_all
     simulate
+    resume
+    initialise
+    advance
+    terminate
     sgetglob
+package::
+    index_keys
+    mesgkey
 model::
     newsystem
     getsystem
@@ -50,6 +79,7 @@ model::
     missingpackages
     newobject
     print_message
+    set_priority
     print
 ------------------------------------------------------------------------------*/
 
@@ -58,6 +88,12 @@ model::
 #ifndef AKSL_NUMPRINT_H
 #include "aksl/numprint.h"
 #endif
+#ifndef AKSL_TRACE_H
+#include "aksl/trace.h"
+#endif
+#ifndef AKSL_PROF_H
+#include "aksl/prof.h"
+#endif
 
 // System header files.
 #ifndef AKSL_X_STRING_H
@@ -65,16 +101,31 @@ model::
 #include <string.h>
 #endif
 
-// Fast block memory for "event"s.
+// Fast block memory for "event"s. (See event_heap::remove() for brMADVISE.)
+#if AKSL_BMEM_SAFE
+bmem_safe event::bmem0(sizeof(event), deftnchunks, msNEW, "event", brMADVISE);
+#else
 bmem_define(event, bmem0);
+#endif
 
 //----------------------//
 //    object::object    //
 //----------------------//
 object::object() {
     index = -1;
+    oid = 0;
+    prv = 0;
     mloc2glob = 0;
     mglob2loc = 0;
+    bgroup = 0;
+    nsent = 0;
+    aindex = -1;
+    if (arena_pending) {
+        aindex = arena_pending->index;
+        arena_pending->arena->bind(arena_pending, this);
+        arena_pending = 0;
+        }
+    subscriber = false;
     sys = 0;
     pkg = 0;
     error = 0;
@@ -191,6 +242,23 @@ int object::get_datum_attr(object* p, mtype m, const value& arg, datum*& pd) {
     return 0;
     } // End of function object::get_datum_attr.
 
+/*------------------------------------------------------------------------------
+object::subscribe() subscribes the object to the broadcasts of the local
+message type "m". (See systm::subscribe().) If the object has no package
+tables, or "m" is not a message type of its package, eBAD_ARGUMENT is
+returned. If the object is not in a system, 0 is returned.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   object::subscribe  //
+//----------------------//
+int object::subscribe(mtype m) {
+    if (!sys)
+        return 0;
+    if (!pkg || !mloc2glob || m < 0 || m >= pkg->n_local_mtypes())
+        return eBAD_ARGUMENT;
+    return sys->subscribe(this, mloc2glob[m]);
+    } // End of function object::subscribe.
+
 //--------------------------//
 //       event::print       //
 //--------------------------//
@@ -205,7 +273,7 @@ void event::print(ostream& os, systm* ps) const {
     os << (orig ? (const char*)orig->name : "Cancelled event");
     os << " -> " << (dest ? (const char*)dest->name : "BROADCAST") << DOTNL;
     datum* pd;
-    if (orig && arg && (pd = *arg) != 0)
+    if (orig && (pd = arg) != 0)
         pd->print(os);
     } // End of function event::print.
 
@@ -213,7 +281,16 @@ void event::print(ostream& os, systm* ps) const {
 //   event_heap::print  //
 //----------------------//
 void event_heap::print(ostream& os, systm* ps) {
+    const char* fel_name = "unknown";
+    switch (felq) {
+    case felHEAP:       fel_name = "heap";      break;
+    case felCALENDAR:   fel_name = "calendar";  break;
+    case felLADDER:     fel_name = "ladder";    break;
+    case felDARY:       fel_name = "d-ary";     break;
+    case felORDERED:    fel_name = "ordered";   break;
+        }
     os << "Contents of event_heap 0x" << hex8((long)this) << ":\n";
+    os << "    Type of FEL = " << fel_name << DOTNL;
     os << "    Size of heap = " << length() << DOTNL;
     if (!empty()) {
         os << "    First element is:\n    ";
@@ -221,6 +298,411 @@ void event_heap::print(ostream& os, systm* ps) {
         }
     } // End of function event_heap::print.
 
+/*------------------------------------------------------------------------------
+event_heap::set_fel_type() changes the implementation of the FEL. Any events
+already in the FEL are moved to the new implementation in dequeueing order, so
+that the order of equal-time events is preserved.
+The arity is only used for the d-ary heaps.
+------------------------------------------------------------------------------*/
+//------------------------------//
+//   event_heap::set_fel_type   //
+//------------------------------//
+void event_heap::set_fel_type(fel_t f, unsigned int arity) {
+    if (f != felHEAP && f != felCALENDAR && f != felLADDER && f != felDARY
+        && f != felORDERED)
+        return;
+    if (f == felq && (f != felDARY || arity == dheap->arity())
+        && (f != felORDERED || arity == oheap->arity()))
+        return;
+
+    // Pop the old events into a temporary calendar queue, which is stable.
+    cal_queue tmp;
+    event* pe;
+    while ((pe = popfirst()) != 0)
+        tmp.insert((tim*)pe);
+    delete calq;
+    calq = 0;
+    delete ladq;
+    ladq = 0;
+    delete dheap;
+    dheap = 0;
+    delete oheap;
+    oheap = 0;
+
+    felq = f;
+    if (felq == felCALENDAR)
+        calq = new cal_queue;
+    else if (felq == felLADDER)
+        ladq = new ladder_queue;
+    else if (felq == felDARY)
+        dheap = new min_tim_dheap(arity);
+    else if (felq == felORDERED)
+        oheap = new min_ord_dheap(arity);
+    while ((pe = (event*)tmp.popfirst()) != 0)
+        insert(pe);
+    } // End of function event_heap::set_fel_type.
+
+/*------------------------------------------------------------------------------
+event_heap::reserve() makes room for "n" events in the FEL, so that the FEL
+does not need to be re-allocated while it is growing to that size. This only
+applies to the heap implementations. The queues do not need it.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   event_heap::reserve    //
+//--------------------------//
+void event_heap::reserve(unsigned int n) {
+    if (felq == felHEAP)
+        heap.reserve(n);
+    else if (felq == felDARY)
+        dheap->reserve(n);
+    else if (felq == felORDERED)
+        oheap->reserve(n);
+    } // End of function event_heap::reserve.
+
+/*------------------------------------------------------------------------------
+event_heap::defer_insert() appends an event to the pending array. The array
+grows geometrically.
+------------------------------------------------------------------------------*/
+//------------------------------//
+//   event_heap::defer_insert   //
+//------------------------------//
+void event_heap::defer_insert(event* p) {
+    if (!p)
+        return;
+    if (npending >= pending_size) {
+        unsigned int newsize = (pending_size > 0) ? 2 * pending_size
+                                                  : heap_block_size;
+        event** pp = new event*[newsize];
+        for (unsigned int i = 0; i < npending; ++i)
+            pp[i] = pending[i];
+        delete[] pending;
+        pending = pp;
+        pending_size = newsize;
+        }
+    pending[npending++] = p;
+    } // End of function event_heap::defer_insert.
+
+/*------------------------------------------------------------------------------
+event_heap::flush() inserts all pending events into the FEL, and ends the
+deferral of insertions. The pending array is released, since it is normally
+only used once, during initialisation.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//    event_heap::flush     //
+//--------------------------//
+void event_heap::flush() {
+    deferring = false;
+    if (npending > 0) {
+        // (Must set npending = 0 first, because insert_many() may call first.)
+        unsigned int k = npending;
+        npending = 0;
+        insert_many(pending, k);
+        }
+    delete[] pending;
+    pending = 0;
+    pending_size = 0;
+    } // End of function event_heap::flush.
+
+/*------------------------------------------------------------------------------
+event_heap::insert_many() inserts an array of "k" events into the FEL. The heap
+implementations can do this in linear time. Equal-time events are dequeued in
+the order of the array if AKSL_SYSTM_FEL_STRICT_ORDER is set, except in the
+ordered FEL, which orders them by their keys.
+------------------------------------------------------------------------------*/
+//------------------------------//
+//   event_heap::insert_many    //
+//------------------------------//
+void event_heap::insert_many(event** pp, unsigned int k) {
+    if (!pp)
+        return;
+    if (felq == felHEAP)
+#if AKSL_SYSTM_FEL_STRICT_ORDER
+        heap.insert_many((tim2**)pp, k);
+#else
+        heap.insert_many((tim**)pp, k);
+#endif
+    else if (felq == felDARY)
+        dheap->insert_many((tim**)pp, k);
+    else if (felq == felORDERED) {
+        ord_entry* pe = new ord_entry[k + 1];
+        for (unsigned int i = 0; i < k; ++i) {
+            if (pp[i])
+                pp[i]->get_order(pe[i]);
+            else
+                pe[i].p = 0;
+            }
+        oheap->insert_many(pe, k);
+        delete[] pe;
+        }
+    else
+        for (unsigned int i = 0; i < k; ++i)
+            insert(pp[i]);
+    } // End of function event_heap::insert_many.
+
+/*------------------------------------------------------------------------------
+event_heap::remove() removes the event "pe" from the FEL if it is in the FEL and
+its origin is "po". The origin is checked first, so that the FEL is not touched
+if it is wrong. (The event may already have been deleted, but reading it is
+safe because event memory comes from a bmem, which never gives memory back.
+With AKSL_BMEM_SAFE, it comes from a bmem_safe which releases blocks only with
+madvise(), so that a deleted event reads as zeros. So event::bmem0 must not
+be switched to any other kind of allocator.)
+The undispatched events of the current batch are searched next.
+The event is returned if it is removed. Otherwise null is returned.
+For the default binary heap with AKSL_SYSTM_FEL_STRICT_ORDER, this takes
+logarithmic time, because the heap records the position of each event.
+The other implementations must search for the event. The calendar queue only
+searches one bucket, but the ladder queue and the d-ary heap may search a large
+part of the FEL. So they are not recommended for models which cancel most of
+their events.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//    event_heap::remove    //
+//--------------------------//
+event* event_heap::remove(event* pe, object* po) {
+    if (!pe || pe->orig != po)
+        return 0;
+    for (unsigned int i = ibatch; i < nbatch; ++i) {
+        if (batch[i] != pe)
+            continue;
+        for (++i; i < nbatch; ++i)
+            batch[i-1] = batch[i];
+        nbatch -= 1;
+        return pe;
+        }
+    for (unsigned int i = 0; i < npending; ++i) {
+        if (pending[i] != pe)
+            continue;
+        for (++i; i < npending; ++i)
+            pending[i-1] = pending[i];
+        npending -= 1;
+        return pe;
+        }
+    tim* p = 0;
+    switch (felq) {
+    case felHEAP:
+#if AKSL_SYSTM_FEL_STRICT_ORDER
+        if (!heap.contains((tim2*)pe))
+            return 0;
+        return (event*)heap.remove((tim2*)pe);
+#else
+        p = heap.remove((tim*)pe);
+        break;
+#endif
+    case felCALENDAR:
+        p = calq->remove((tim*)pe);
+        break;
+    case felLADDER:
+        p = ladq->remove((tim*)pe);
+        break;
+    case felDARY:
+        p = dheap->remove((tim*)pe);
+        break;
+    case felORDERED:
+        p = oheap->remove((tim*)pe);
+        break;
+        }
+    return p ? pe : 0;
+    } // End of function event_heap::remove.
+
+/*------------------------------------------------------------------------------
+event_heap::purge() removes and deletes the events of which "po" is the origin
+or the destination, or whose argument is the object "po". The number of events
+deleted is returned. The pending events are flushed first, and the current
+batch is compacted in place. For the default binary heap with
+AKSL_SYSTM_FEL_STRICT_ORDER, each event is removed in logarithmic time.
+Otherwise, if any events must be removed, the FEL is emptied in dequeueing
+order and refilled with insert_many(), so that the order of the other events
+is kept.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//     event_heap::purge    //
+//--------------------------//
+unsigned int event_heap::purge(const object* po) {
+    if (!po)
+        return 0;
+    if (npending > 0)
+        flush();
+
+    // The undispatched events of the current batch.
+    unsigned int k = 0;
+    unsigned int j = ibatch;
+    for (unsigned int i = ibatch; i < nbatch; ++i) {
+        if (batch[i]->refers_to(po)) {
+            delete batch[i];
+            k += 1;
+            }
+        else
+            batch[j++] = batch[i];
+        }
+    nbatch = j;
+
+    // Count the other events to be removed.
+    unsigned int n = 0;
+    event* pe = 0;
+    event_heap_traversal ht(*this);
+    while ((pe = ht.next()) != 0)
+        if (pe->refers_to(po))
+            n += 1;
+    if (n == 0)
+        return k;
+
+#if AKSL_SYSTM_FEL_STRICT_ORDER
+    if (felq == felHEAP) {
+        event** pp = new event*[n];
+        unsigned int i = 0;
+        ht.init();
+        while ((pe = ht.next()) != 0)
+            if (pe->refers_to(po))
+                pp[i++] = pe;
+        for (i = 0; i < n; ++i) {
+            heap.remove((tim2*)pp[i]);
+            delete pp[i];
+            }
+        delete[] pp;
+        return k + n;
+        }
+#endif
+
+    // Empty the FEL, except for the batch, and refill it.
+    unsigned int ib = ibatch;
+    unsigned int m = length() - (nbatch - ibatch);
+    event** pp = new event*[m + 1];
+    unsigned int i = 0;
+    ibatch = nbatch;
+    while ((pe = popfirst()) != 0) {
+        if (pe->refers_to(po))
+            delete pe;
+        else
+            pp[i++] = pe;
+        }
+    ibatch = ib;
+    insert_many(pp, i);
+    delete[] pp;
+    return k + n;
+    } // End of function event_heap::purge.
+
+/*------------------------------------------------------------------------------
+event_heap::resize_batch() doubles the size of the batch arrays. The events of
+the batch are kept. (The grouping arrays are only used within group_batch().)
+------------------------------------------------------------------------------*/
+//------------------------------//
+//   event_heap::resize_batch   //
+//------------------------------//
+void event_heap::resize_batch() {
+    unsigned int newsize = (batch_size > 0) ? 2 * batch_size : heap_block_size;
+    event** pp = new event*[newsize];
+    for (unsigned int i = 0; i < nbatch; ++i)
+        pp[i] = batch[i];
+    delete[] batch;
+    batch = pp;
+    batch_size = newsize;
+    delete[] gtmp;
+    delete[] gcount;
+    gtmp = 0;
+    gcount = 0;
+    } // End of function event_heap::resize_batch.
+
+/*------------------------------------------------------------------------------
+event_heap::pop_batch() moves all of the events which have the same time as the
+first event from the FEL to the batch array, and returns the number of them.
+If some events of the previous batch are undispatched, because advance()
+stopped in the middle of it, no events are moved. The number of undispatched
+events is returned, and they are dispatched first.
+Each event after the first costs one call to first() and one to popfirst() of
+the FEL implementation, which avoids the checks in event_heap::popfirst().
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   event_heap::pop_batch  //
+//--------------------------//
+unsigned int event_heap::pop_batch() {
+    if (ibatch < nbatch)
+        return nbatch - ibatch;
+    ibatch = nbatch = 0;
+    event* pe = popfirst();
+    if (!pe)
+        return 0;
+    double t = pe->t;
+    batch_append(pe);
+    const tim* p;
+    switch (felq) {
+    case felCALENDAR:
+        while ((p = calq->first()) != 0 && p->t == t)
+            batch_append((event*)calq->popfirst());
+        break;
+    case felLADDER:
+        while ((p = ladq->first()) != 0 && p->t == t)
+            batch_append((event*)ladq->popfirst());
+        break;
+    case felDARY:
+        while ((p = dheap->first()) != 0 && p->t == t)
+            batch_append((event*)dheap->popfirst());
+        break;
+    case felORDERED:
+        while ((p = oheap->first()) != 0 && p->t == t)
+            batch_append((event*)oheap->popfirst());
+        break;
+    default:
+        while ((p = heap.first()) != 0 && p->t == t)
+            batch_append((event*)heap.popfirst());
+        break;
+        }
+    if (grouping && nbatch > 2)
+        group_batch();
+    return nbatch;
+    } // End of function event_heap::pop_batch.
+
+/*------------------------------------------------------------------------------
+event_heap::group_batch() sorts the batch stably by destination, with the
+destinations in order of their first appearance in the batch. This is a
+counting sort, using the "bgroup" field of each destination object to hold its
+group number. Broadcast events (with null destination) form one group.
+------------------------------------------------------------------------------*/
+//------------------------------//
+//   event_heap::group_batch    //
+//------------------------------//
+void event_heap::group_batch() {
+    if (!gtmp) {
+        gtmp = new event*[batch_size];
+        gcount = new unsigned int[batch_size + 1];
+        }
+
+    // Mark the destinations, and then number them in order of appearance.
+    unsigned int i;
+    for (i = 0; i < nbatch; ++i)
+        if (batch[i]->dest)
+            batch[i]->dest->bgroup = (unsigned int)-1;
+    unsigned int bgroup = (unsigned int)-1;    // The broadcast group.
+    unsigned int ngroups = 0;
+    for (i = 0; i < nbatch; ++i) {
+        object* po = batch[i]->dest;
+        unsigned int& g = po ? po->bgroup : bgroup;
+        if (g == (unsigned int)-1) {
+            g = ngroups++;
+            gcount[g] = 1;
+            }
+        else
+            gcount[g] += 1;
+        }
+    if (ngroups == nbatch)
+        return;                 // All destinations are different.
+
+    // Convert the counts to starting positions, and then scatter.
+    unsigned int pos = 0;
+    for (unsigned int g = 0; g < ngroups; ++g) {
+        unsigned int c = gcount[g];
+        gcount[g] = pos;
+        pos += c;
+        }
+    for (i = 0; i < nbatch; ++i) {
+        event* pe = batch[i];
+        gtmp[gcount[pe->dest ? pe->dest->bgroup : bgroup]++] = pe;
+        }
+    event** pp = batch;
+    batch = gtmp;
+    gtmp = pp;
+    } // End of function event_heap::group_batch.
+
 /*------------------------------------------------------------------------------
 globvarlist::set(c_string&, value*) sets a global variable in the list.
 Note that copies are NOT made of values given as parameters. The given value
@@ -232,10 +714,8 @@ must therefore be allocated on the heap and never used again!
 int globvarlist::set(const c_string& name, value* pv) {
     if (name.null())
         return 0;
-    globvar* pg = 0;
-    forall(pg, *this)
-        if (pg->name == name)
-            break;
+    void* p = 0;
+    globvar* pg = index.find(p, name.read()) ? (globvar*)p : 0;
     if (pg) { // If the globvar name exists, re-set it.
         delete pg->val;
         pg->val = pv;
@@ -279,24 +759,257 @@ A new copy of the value is not created. The user may only read the value!
 value* globvarlist::get(const c_string& name) {
     if (name.null())
         return 0;
-    globvar* pg = 0;
-    forall(pg, *this)
-        if (pg->name == name)
-            break;
-    return pg ? pg->val : 0;
+    void* p = 0;
+    return index.find(p, name.read()) ? ((globvar*)p)->val : 0;
     } // End of function globvarlist::get.
 
+//------------------------------//
+//   subscriber_array::remove   //
+//------------------------------//
+void subscriber_array::remove(object* p) {
+    unsigned int j = 0;
+    for (unsigned int i = 0; i < n; ++i)
+        if (v[i] != p)
+            v[j++] = v[i];
+    n = j;
+    } // End of function subscriber_array::remove.
+
+//------------------------------//
+//   subscriber_array::resize   //
+//------------------------------//
+void subscriber_array::resize() {
+    unsigned int newsize = (size > 0) ? 2 * size : 8;
+    object** pp = new object*[newsize];
+    for (unsigned int i = 0; i < n; ++i)
+        pp[i] = v[i];
+    delete[] v;
+    v = pp;
+    size = newsize;
+    } // End of function subscriber_array::resize.
+
+/*------------------------------------------------------------------------------
+systm::add() appends an object to the system, and gives it the next id. The ids
+of the objects of a system are 0, 1, 2, ... in the order in which they were
+added. The id of a removed object is not re-used, so that the ids also identify
+the objects in the order of events in the ordered FEL. The object is also named
+in the event trace, if any.
+------------------------------------------------------------------------------*/
 //----------------------//
 //      systm::add      //
 //----------------------//
 int systm::add(object* po) {
-    if (!po)
+    if (!po || next_oid == no_object_id)
         return eBAD_ARGUMENT;
+    if (next_oid >= objtab_size) {
+        unsigned int newsize = (objtab_size > 0) ? 2 * objtab_size : 64;
+        object** pp = new object*[newsize];
+        for (unsigned int i = 0; i < next_oid; ++i)
+            pp[i] = objtab[i];
+        delete[] objtab;
+        objtab = pp;
+        objtab_size = newsize;
+        }
     objects.append(po);
     po->sys = this;
+    po->oid = next_oid++;
+    objtab[po->oid] = po;
+    others_ok = false;
+    if (etrace)
+        etrace->add_object(po);
     return 0;
     } // End of function systm::add.
 
+/*------------------------------------------------------------------------------
+systm::remove() takes an object out of the system, so that the caller may delete
+it. The object is removed from the object list and the id table in constant
+time. Its broadcast subscriptions are removed, and the events in the FEL of
+which it is the origin or the destination, or whose argument is the object, are
+deleted with event_heap::purge(), which takes one pass over the FEL if it is
+not empty. Pointers to these events become invalid, as if they had been
+delivered. An object must not remove itself, and objects cannot be removed from
+a partitioned system. (See psim.h.)
+------------------------------------------------------------------------------*/
+//----------------------//
+//     systm::remove    //
+//----------------------//
+int systm::remove(object* po) {
+    if (!po)
+        return eBAD_ARGUMENT;
+    if (par || parent)
+        return eBAD_ARGUMENT;
+    if (po->sys != this || po->oid >= next_oid || objtab[po->oid] != po)
+        return eNOT_FOUND;
+    objects.remove(po);
+    objtab[po->oid] = 0;
+    if (po->subscriber) {
+        for (unsigned int m = 0; m < nsubs; ++m)
+            subs[m].remove(po);
+        po->subscriber = false;
+        nsubscribers -= 1;
+        }
+    others_ok = false;
+    if (events.length() > 0)
+        events.purge(po);
+    return 0;
+    } // End of function systm::remove.
+
+/*------------------------------------------------------------------------------
+systm::pack_event() converts an event to an event_rec. If the argument of the
+event is a datum or a value, eNOT_SERIALISABLE is returned.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   systm::pack_event  //
+//----------------------//
+int systm::pack_event(const event* pe, event_rec& r) const {
+    if (!pe || !pe->orig)
+        return eBAD_ARGUMENT;
+    r.t = pe->time();
+    r.orig = pe->orig->oid;
+    r.dest = pe->dest ? pe->dest->oid : no_object_id;
+    r.mty = pe->mty;
+    r.prio = pe->prio;
+    r.depth = pe->depth;
+    r.seq = pe->seq;
+    r.ptype = pe->arg.type();
+    r.argid = no_object_id;
+    r.arg = 0;
+    switch (pe->arg.type()) {
+    case pNONE:
+        break;
+    case pINTEGER:
+        r.arg = (long)pe->arg;
+        break;
+    case pREAL: {
+        double x = pe->arg;
+        memcpy(&r.arg, &x, sizeof(x));
+        }
+        break;
+    case pOBJECT: {
+        object* po = pe->arg;
+        if (po)
+            r.argid = po->oid;
+        }
+        break;
+    default:
+        return eNOT_SERIALISABLE;
+        }
+    return 0;
+    } // End of function systm::pack_event.
+
+/*------------------------------------------------------------------------------
+systm::unpack_event() makes a new event from an event_rec. Null is returned if
+an object id is not in the system. The event is not inserted into the FEL.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  systm::unpack_event //
+//----------------------//
+event* systm::unpack_event(const event_rec& r) const {
+    object* orig = object_by_id(r.orig);
+    object* dest = (r.dest != no_object_id) ? object_by_id(r.dest) : 0;
+    if (!orig || (!dest && r.dest != no_object_id))
+        return 0;
+    payload x;
+    switch (r.ptype) {
+    case pNONE:
+        break;
+    case pINTEGER:
+        x = (long)r.arg;
+        break;
+    case pREAL: {
+        double d = 0;
+        memcpy(&d, &r.arg, sizeof(d));
+        x = d;
+        }
+        break;
+    case pOBJECT: {
+        object* po = (r.argid != no_object_id) ? object_by_id(r.argid) : 0;
+        if (!po && r.argid != no_object_id)
+            return 0;
+        x = po;
+        }
+        break;
+    default:
+        return 0;
+        }
+    event* pe = new event(r.t, orig, dest, r.mty);
+    pe->prio = r.prio;
+    pe->depth = r.depth;
+    pe->seq = r.seq;
+    pe->arg = x;
+    return pe;
+    } // End of function systm::unpack_event.
+
+/*------------------------------------------------------------------------------
+systm::insert_event() inserts the event of an event_rec into the FEL of the
+system. The time of the event must not be earlier than the system clock. This
+is not available for a partitioned system.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  systm::insert_event //
+//----------------------//
+int systm::insert_event(const event_rec& r) {
+    if (par || parent || r.t < clck)
+        return eBAD_ARGUMENT;
+    event* pe = unpack_event(r);
+    if (!pe)
+        return eNOT_FOUND;
+    events.insert(pe);
+    return 0;
+    } // End of function systm::insert_event.
+
+/*------------------------------------------------------------------------------
+systm::subscribe() adds the object "po" to the subscribers of broadcast events
+of the global message type "m". (See object::subscribe().)
+------------------------------------------------------------------------------*/
+//----------------------//
+//   systm::subscribe   //
+//----------------------//
+int systm::subscribe(object* po, mtype m) {
+    if (!po || m < 0)
+        return eBAD_ARGUMENT;
+    if ((unsigned int)m >= nsubs) {
+        unsigned int newsize = nsubs > 0 ? nsubs : 16;
+        while (newsize <= (unsigned int)m)
+            newsize *= 2;
+        subscriber_array* p = new subscriber_array[newsize];
+        for (unsigned int i = 0; i < nsubs; ++i) {
+            p[i] = subs[i];
+            subs[i].v = 0;      // So that the array is not deleted.
+            }
+        delete[] subs;
+        subs = p;
+        nsubs = newsize;
+        }
+    subscriber_array& sa = subs[m];
+    for (unsigned int i = 0; i < sa.n; ++i)
+        if (sa.v[i] == po)
+            return 0;
+    sa.append(po);
+    if (!po->subscriber) {
+        po->subscriber = true;
+        nsubscribers += 1;
+        others_ok = false;
+        }
+    return 0;
+    } // End of function systm::subscribe.
+
+/*------------------------------------------------------------------------------
+systm::clear_subscriptions() deletes all subscriptions of the objects of the
+system to broadcast events.
+------------------------------------------------------------------------------*/
+//----------------------------------//
+//    systm::clear_subscriptions    //
+//----------------------------------//
+void systm::clear_subscriptions() {
+    for (unsigned int i = 0; i < nsubs; ++i)
+        subs[i].clear();
+    object* po = 0;
+    forall(po, objects)
+        po->subscriber = false;
+    nsubscribers = 0;
+    others_ok = false;
+    } // End of function systm::clear_subscriptions.
+
 /*------------------------------------------------------------------------------
 Safe version of cancel_message(), which checks to make sure that the event is
 still in the FEL. The given event is not even read until it is established that
@@ -306,6 +1019,12 @@ really take note of when events arrive, so as not to clobber re-used space.
 One way to prevent this sort of problem would be to put a sequence number in all
 events, but this would give a nasty space and time overhead. However, if there
 is demand for this sort of thing, it could be an option some day.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+The cancelled event is removed from the FEL and deleted immediately, rather than
+being left in the FEL as a "tombstone" until its time comes. So the FEL does not
+fill up with cancelled timers. The argument of the event is not deleted, just
+as for delivered events. In a partition of an optimistic parallel simulation,
+the cancelled event is kept until the cancellation can no longer be undone.
 ------------------------------------------------------------------------------*/
 //--------------------------//
 //  systm::cancel_message   //
@@ -313,13 +1032,12 @@ is demand for this sort of thing, it could be an option some day.
 void systm::cancel_message(event* pe, object* po) {
     if (!pe || !po)
         return;
-    event_heap_traversal eh(events);
-    for (event* pe1 = eh.next(); pe1; pe1 = eh.next()) {
-        if (pe1 == pe) {
-            if (pe->origin() == po)
-                pe->cancel();
-            break;
-            }
+    if (events.remove(pe, po)) {
+        if (par)
+            par_cancelled(pe);
+        else
+            delete pe;
+        tombstones_avoided += 1;
         }
     } // End of function systm::cancel_message.
 
@@ -340,7 +1058,7 @@ event* systm::newevent_abs(
         return 0;
     event* pe = new event(t, orig, dest, msg);
     pe->arg = arg;
-    events.insert(pe);
+    enqueue(pe);
     return pe;
     } // End of function systm::newevent_abs.
 
@@ -359,7 +1077,7 @@ event* systm::newevent_abs(double t, object* orig, object* dest, mtype msg) {
     if (!orig)
         return 0;
     event* pe = new event(t, orig, dest, msg);
-    events.insert(pe);
+    enqueue(pe);
     return pe;
     } // End of function systm::newevent_abs.
 
@@ -380,7 +1098,7 @@ event* systm::newevent_abs(
         return 0;
     event* pevt = new event(t, orig, dest, message);
     pevt->setarg(x);
-    events.insert(pevt);
+    enqueue(pevt);
 
     return pevt;
     } // End of function systm::newevent_abs.
@@ -402,7 +1120,7 @@ event* systm::newevent_abs(
         return 0;
     event* pevt = new event(t, orig, dest, message);
     pevt->setarg(x);
-    events.insert(pevt);
+    enqueue(pevt);
 
     return pevt;
     } // End of function systm::newevent_abs.
@@ -424,7 +1142,29 @@ event* systm::newevent_abs(
         return 0;
     event* pevt = new event(t, orig, dest, message);
     pevt->setarg(x);
-    events.insert(pevt);
+    enqueue(pevt);
+
+    return pevt;
+    } // End of function systm::newevent_abs.
+
+//----------------------//
+//  systm::newevent_abs //
+//----------------------//
+event* systm::newevent_abs(
+        double t, object* orig, object* dest, mtype message, const payload& x) {
+    if (t < clck) {
+        if (!orig)
+            cout << "Warning: negative delay event attempted by null object.\n";
+        else
+            cout << "Warning: negative delay event attempted by "
+                  << orig->name << DOTNL;
+        return 0;
+        }
+    if (!orig)
+        return 0;
+    event* pevt = new event(t, orig, dest, message);
+    pevt->setarg(x);
+    enqueue(pevt);
 
     return pevt;
     } // End of function systm::newevent_abs.
@@ -437,44 +1177,130 @@ The null object pointer is returned if no objects complain. Otherwise a
 pointer to the complainant is returned.
 The order of sending messages is the order of creation of the
 objects at system-creation time.
-Note: If any object tampers with "arg", then all later recipients of the
-argument are affected.
+Note: If any object tampers with a value argument, then all later recipients of
+the argument are affected. This includes the value which is made for the
+recipients whose recv_message() takes a "value*". (See object::arg_value().)
+That value is deleted after the broadcast. (A handler may call broadcast()
+itself, so the state of an outer broadcast is saved.)
 ------------------------------------------------------------------------------*/
 //----------------------//
 //   systm::broadcast   //
 //----------------------//
-object* systm::broadcast(object* orig, mtype mty, value* arg) {
+object* systm::broadcast(object* orig, mtype mty, const payload& arg) {
+    bool_enum b0 = in_bcast;
+    value* v0 = bcast_value;
+    in_bcast = true;
+    bcast_value = 0;
+    object* po = broadcast_all(orig, mty, arg);
+    delete bcast_value;
+    in_bcast = b0;
+    bcast_value = v0;
+    return po;
+    } // End of function systm::broadcast.
+
+//--------------------------//
+//   systm::broadcast_all   //
+//--------------------------//
+object* systm::broadcast_all(object* orig, mtype mty, const payload& arg) {
     object* dest = 0;
-    forall(dest, objects)
+    if (nsubscribers == 0) {
+        forall(dest, objects)
+            if (dest != orig && dest->sim(orig, mty, arg) < 0)
+                break;
+        return dest;
+        }
+
+    // The arrays are re-read for each object, since the callee may subscribe.
+    if (mty >= 0 && (unsigned int)mty < nsubs) {
+        for (unsigned int i = 0; i < subs[mty].n; ++i) {
+            dest = subs[mty].v[i];
+            if (dest != orig && dest->sim(orig, mty, arg) < 0)
+                return dest;
+            }
+        }
+    if (!others_ok) {
+        others.clear();
+        forall(dest, objects)
+            if (!dest->subscriber)
+                others.append(dest);
+        others_ok = true;
+        }
+    for (unsigned int i = 0; i < others.n; ++i) {
+        dest = others.v[i];
         if (dest != orig && dest->sim(orig, mty, arg) < 0)
-            break;
-    return dest;
-    } // End of function systm::broadcast.
+            return dest;
+        }
+    return 0;
+    } // End of function systm::broadcast_all.
 
 /*------------------------------------------------------------------------------
-This is the core of the AKSL simulation scheduler.
-The efficiency of simulations depends primarily on this function.
+systm::simulate() initialises the packages and objects, simulates the events
+until the finish time "start + duration", and then terminates the objects and
+packages. The three parts of the simulation are also available separately, so
+that a simulation may be stopped and checkpointed, and later resumed. (See
+ckpt.h.)
 ------------------------------------------------------------------------------*/
 //----------------------//
 //    systm::simulate   //
 //----------------------//
 int systm::simulate(double duration, double start) {
-    int err = 0;
+    if (duration <= 0) {
+        cout << "Terminating simulation due to non-positive duration.\n";
+        return eNEGATIVE_DURATION;
+        }
+    int err = initialise(start);
+    if (err < 0)
+        return err;
+    if ((err = advance(start + duration)) < 0)
+        return err;
+    terminate();
+    return 0;
+    } // End of function systm::simulate.
 
+/*------------------------------------------------------------------------------
+systm::resume() continues a simulation which was stopped by advance(), or which
+was restored from a checkpoint, for the given duration. Then the objects and
+packages are terminated.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     systm::resume    //
+//----------------------//
+int systm::resume(double duration) {
     if (duration <= 0) {
         cout << "Terminating simulation due to non-positive duration.\n";
         return eNEGATIVE_DURATION;
         }
+    int err = advance(clck + duration);
+    if (err < 0)
+        return err;
+    terminate();
+    return 0;
+    } // End of function systm::resume.
+
+/*------------------------------------------------------------------------------
+systm::initialise() clears the FEL, sets the clock to "start", and initialises
+all packages and objects.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   systm::initialise  //
+//----------------------//
+int systm::initialise(double start) {
+    int err = 0;
+
     if (objects.empty()) {
         cout << "Terminating simulation due to lack of objects.\n";
         return eNO_OBJECTS;
         }
     events.clear();
+    if (fel_hint > 0)
+        events.reserve(fel_hint);
     clck = start;
     if (trace >= 4 && mdl)
         mdl->print(cout);
 
-    // Initialise all packages.
+    // Initialise all packages and objects. Initial events are inserted in bulk.
+    clear_subscriptions();
+    events.defer();
     package* pp = 0;
     forall(pp, mdl->packages)
         if (pp->init)
@@ -492,17 +1318,90 @@ int systm::simulate(double duration, double start) {
             cout << "  Type is: "
                  << (po->type() ? po->type() : "NONE") << DOTNL;
             }
-        if ((err = po->init()) < 0)
+        if ((err = po->init()) < 0) {
+            events.flush();
 //            return eINIT_FAILED;
             return err;
+            }
         }
-    double finish = start + duration;
+    events.flush();
     if (trace >= 3)
         events.print(cout, this);
+    return 0;
+    } // End of function systm::initialise.
 
+/*------------------------------------------------------------------------------
+This is the core of the AKSL simulation scheduler.
+The efficiency of simulations depends primarily on this function.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+systm::advance() simulates events until the clock reaches "finish". The
+simulation stops after the first event at or after the finish time. So it may
+be continued by calling advance() again with a later finish time.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Without tracing, the events are dequeued in batches of equal-time events. The
+event trace and the profile are tested once for each batch, to choose either a
+plain dispatch loop or an instrumented one. So if a handler opens or closes the
+trace or the profile, this takes effect at the next batch. If a handler returns
+an error, its event is deleted, and the rest of the batch is left in the FEL,
+as when the finish time is reached.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    systm::advance    //
+//----------------------//
+int systm::advance(double finish) {
     // This is the "main loop" of AKSL simulations.
     // Note: Signals could be used to set finish to 0 or clck, so as to
     // terminate a simulation upon instruction from the user.
+    if (trace < 1) {
+        while (clck < finish) {
+            if (events.pop_batch() == 0) {
+                cout << "Simulation ending with exhaustion of events.\n";
+                return eNO_EVENTS;
+                }
+            event* evt;
+            object* err = 0;
+            if (!etrace && !prof) {
+                // The plain dispatch loop.
+                while ((evt = events.pop_batched()) != 0) {
+                    if (evt->origin()) { // Ignore cancelled events.
+                        clck = evt->time();
+                        depth = evt->depth;
+                        err = evt->simulate();
+                        if (err || clck >= finish) {
+                            delete(evt);
+                            break;
+                            }
+                        }
+                    delete(evt);
+                    }
+                }
+            else {
+                // The instrumented dispatch loop.
+                while ((evt = events.pop_batched()) != 0) {
+                    if (evt->origin()) { // Ignore cancelled events.
+                        clck = evt->time();
+                        depth = evt->depth;
+                        if (etrace)
+                            etrace->record(evt);
+                        err = prof
+                            ? prof->simulate(evt, clck, events.length())
+                            : evt->simulate();
+                        if (err || clck >= finish) {
+                            delete(evt);
+                            break;
+                            }
+                        }
+                    delete(evt);
+                    }
+                }
+            if (err) {
+                cout << "Termination condition received from the "
+                     << err->type();
+                cout << " called " << err->name << DOTNL;
+                return (err->error < 0) ? err->error : eEVENT_ERROR;
+                }
+            }
+        }
     while (clck < finish) {
         // Check to see if any signals occurred since the last event?
         // ....
@@ -518,8 +1417,13 @@ int systm::simulate(double duration, double start) {
             }
         if (evt->origin()) { // Ignore cancelled events.
             clck = evt->time();
-            object* err = evt->simulate();
+            depth = evt->depth;
+            if (etrace)
+                etrace->record(evt);
+            object* err = prof ? prof->simulate(evt, clck, events.length())
+                               : evt->simulate();
             if (err) {
+                delete(evt);
                 cout << "Termination condition received from the "
                      << err->type();
                 cout << " called " << err->name << DOTNL;
@@ -528,6 +1432,15 @@ int systm::simulate(double duration, double start) {
             }
         delete(evt);
         }
+    return 0;
+    } // End of function systm::advance.
+
+//----------------------//
+//   systm::terminate   //
+//----------------------//
+void systm::terminate() {
+    object* po = 0;
+    package* pp = 0;
 
     // Terminate all objects and packages.
     forall(po, objects)
@@ -543,8 +1456,9 @@ int systm::simulate(double duration, double start) {
         if (pp->del)
             (*pp->del)(pp);
 
-    return 0;
-    } // End of function systm::simulate.
+    // Print the profile, if any.
+    print_profile(cout);
+    } // End of function systm::terminate.
 
 /*------------------------------------------------------------------------------
 systm::sgetglob() gets the string value of an global variable, or
@@ -554,12 +1468,42 @@ the null pointer, if it is not a string. The return value is read-only.
 //    systm::sgetglob   //
 //----------------------//
 const char* systm::sgetglob(const c_string& n) {
-    value* pv = globvars.get(n);
+    value* pv = gvars().get(n);
     if (!pv || pv->type() != vSTRING)
         return 0;
     return *pv;
     } // End of function systm::sgetglob.
 
+/*------------------------------------------------------------------------------
+package::index_keys() builds the index of the message names of the package.
+If a name is repeated, the first occurrence is indexed, as in skilist::key().
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   package::index_keys    //
+//--------------------------//
+void package::index_keys() {
+    keyindex.clear();
+    void* p = 0;
+    Forall(ski, pski, cs_mesgkeys)
+        if (!keyindex.find(p, pski->s.read()))
+            keyindex.insert((void*)pski->i, pski->s.read());
+    } // End of function package::index_keys.
+
+/*------------------------------------------------------------------------------
+package::mesgkey() returns the local message key of a message name, or -1 if
+the name is not found. Before the package is loaded, the table cs_mesgkeys is
+searched directly.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   package::mesgkey   //
+//----------------------//
+long package::mesgkey(const c_string& cs) {
+    if (!mdl)
+        return cs_mesgkeys.key(cs);
+    void* p = 0;
+    return keyindex.find(p, cs.read()) ? long(p) : -1;
+    } // End of function package::mesgkey.
+
 /*------------------------------------------------------------------------------
 model::newsystem() creates a new system, with a given name.
 ------------------------------------------------------------------------------*/
@@ -651,7 +1595,7 @@ model at run time, and sorts out relations between the packages.
 int model::load(package* pkg) {
     mtype i, count;
     package* pkg2;
-    object *p0, *p1;
+    object* p0;
 
     if (!pkg)
         return eNULL_ARGUMENT;
@@ -661,28 +1605,32 @@ int model::load(package* pkg) {
         return eNO_OBJECT_FUNCTION;
 
     // Make one representative of each class from the new_object() function.
+    void* pv = 0;
     for (i = 0; (p0 = pkg->new_object(i)) != 0; ++i) {
         if (nullstr(p0->type()))
             return eBAD_OBJECT_TYPE_NAME;
-
-        const char* pc = p0->type();
-        forall(p1, reps)
-            if (strcmp(pc, p1->type()) == 0)
-                break;
-        if (p1)
+        if (repindex.find(pv, p0->type()))
             return eNEW_OBJECT_NAME_CLASH;
 
         p0->index = i;
         p0->pkg = pkg;
         reps.append(p0);
+        repindex.insert(p0, p0->type());
         }
 
     // Check the message keys of the package for repeats.
     if (pkg->cs_mesgkeys.repeats())
         return eMESSAGE_KEY_CLASH;
 
-    // Merge in the set of message types.
+    // Merge in the set of message types, and re-index them.
     merge(cs_mtypenames, pkg->cs_mesgkeys);
+    mtypeindex.clear();
+    i = 0;
+    Forall(c_stringlink, pcsl, cs_mtypenames) {
+        mtypeindex.insert((void*)long(i), pcsl->read());
+        ++i;
+        }
+    pkg->index_keys();
 
     // Construct the local-to-global message type conversion tables.
     if (pkg->cs_mesgkeys.min_i() < 0)
@@ -691,13 +1639,15 @@ int model::load(package* pkg) {
     // Need entries for all integers from 0 to max.
     count = (mtype)pkg->cs_mesgkeys.max_i() + 1;
     pkg->mloc2glob = new mtype[count];
+    pkg->nlocal = count;
 
     // Put in catches in case of non-existent messages.
     for (i = 0; i < count; ++i)
         pkg->mloc2glob[i] = (mtype)-1;
 
     Forall(ski, pski, pkg->cs_mesgkeys)
-        pkg->mloc2glob[pski->i] = (mtype)cs_mtypenames.index(pski->s);
+        pkg->mloc2glob[pski->i] =
+            (mtype)(mtypeindex.find(pv, pski->s.read()) ? long(pv) : -1);
 
     // Construct the global-to-local message type conversion tables.
     count = (mtype)cs_mtypenames.length();
@@ -706,7 +1656,8 @@ int model::load(package* pkg) {
     mtypenames = new const char*[count];
     i = 0;
     Forall(c_stringlink, pcsl, cs_mtypenames) {
-        pkg->mglob2loc[i] = (mtype)pkg->cs_mesgkeys.key(*pcsl);
+        pkg->mglob2loc[i] = (mtype)(pkg->keyindex.find(pv, pcsl->read())
+                                    ? long(pv) : -1);
         // Stick a convenience copy of the type-name list in array mtypenames.
         mtypenames[i] = pcsl->read();   // NOTE: only cross-reference!!!!!!!!!
         ++i;
@@ -718,7 +1669,7 @@ int model::load(package* pkg) {
         pkg2->mglob2loc = new mtype[count];
         i = 0;
         Forall(c_stringlink, pcsl, cs_mtypenames) {
-            pkg2->mglob2loc[i] = (mtype)pkg2->cs_mesgkeys.key(*pcsl);
+            pkg2->mglob2loc[i] = (mtype)pkg2->mesgkey(*pcsl);
             ++i;
             }
         }
@@ -834,10 +1785,8 @@ object* model::newobject(systm& sys, c_string& type, c_string& name) {
         return 0;
 
     // Locate a representative of the given class.
-    object* x0 = 0;
-    forall(x0, reps)
-        if (type == x0->type())
-            break;
+    void* pv = 0;
+    object* x0 = repindex.find(pv, type.read()) ? (object*)pv : 0;
 
     if (!x0) {
         cout << "No object of type " << type << " is currently registered.\n";
@@ -846,10 +1795,12 @@ object* model::newobject(systm& sys, c_string& type, c_string& name) {
         return 0;
         }
 
-    // Make a new member of the requested class.
+    // Make a new member of the requested class, in its arena if it has one.
     package* p0 = x0->pkg;
     int i0 = x0->index;
+    arena_next = p0->arena(i0);
     object* x1 = (*p0->new_object)(i0);
+    arena_next = 0;
     if (!x1) {
         cout << "Failed to make duplicate object of type " << type << DOTNL;
         return 0;
@@ -889,6 +1840,40 @@ bool_enum model::print_message(int index, ostream& os) {
     return true;
     } // End of function model::print_message.
 
+/*------------------------------------------------------------------------------
+model::set_priority() sets the priority of the global message type with the
+given name, for the ordered FEL (felORDERED). Equal-time events with a lower
+priority are dequeued first. The default priority is 0. The priority must be
+in the range of a "short". The priority of an event is fixed when it is sent.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  model::set_priority //
+//----------------------//
+int model::set_priority(const c_string& name, int p) {
+    void* pv = 0;
+    if (!mtypeindex.find(pv, name.read()))
+        return eNOT_FOUND;
+    if (p < -32768 || p > 32767)
+        return eBAD_ARGUMENT;
+    unsigned int m = (unsigned int)long(pv);
+    if (m >= nmprio) {
+        unsigned int newsize = (nmprio > 0) ? nmprio : 16;
+        while (newsize <= m)
+            newsize *= 2;
+        short* pp = new short[newsize];
+        unsigned int i = 0;
+        for ( ; i < nmprio; ++i)
+            pp[i] = mprio[i];
+        for ( ; i < newsize; ++i)
+            pp[i] = 0;
+        delete[] mprio;
+        mprio = pp;
+        nmprio = newsize;
+        }
+    mprio[m] = (short)p;
+    return 0;
+    } // End of function model::set_priority.
+
 //----------------------//
 //     model::print     //
 //----------------------//
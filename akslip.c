@@ -1251,8 +1251,8 @@ int nbytes_from::recvfrom(int fd, int bufsize) {
 
     // Copy the bytes to the (pc, n) pair:
     if (rval > 0) {
-        delete pc;
-        pc = new char[rval];
+        szbuf_delete(pc);
+        pc = szbuf_new(rval);
         memcpy(pc, buf, rval);
         n = rval;
         }
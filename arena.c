@@ -0,0 +1,245 @@
+// src/aksl/arena.c   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+/*------------------------------------------------------------------------------
+Functions in this file:
+
+obj_arena::
+    newslab
+    alloc
+    release
+    discard
+    ~obj_arena
+object::
+    operator new
+    operator delete
+package::
+    set_arena
+model::
+    arena
+------------------------------------------------------------------------------*/
+
+// AKSL header files:
+#include "aksl/arena.h"
+#ifndef AKSL_AKSL_H
+#include "aksl/aksl.h"
+#endif
+#ifndef AKSL_ERROR_H
+#include "aksl/error.h"
+#endif
+
+AKSL_TLS obj_arena* arena_next = 0;
+AKSL_TLS arena_slot* arena_pending = 0;
+
+// Slots are a multiple of this size, so that objects keep the alignment of
+// "operator new".
+const long arena_align = 16;
+
+/*------------------------------------------------------------------------------
+obj_arena::newslab() adds a slab of "nper" slots.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  obj_arena::newslab  //
+//----------------------//
+void obj_arena::newslab() {
+    if (nslabs >= slabs_size) {
+        long k = slabs_size ? 2 * slabs_size : 8;
+        char** s2 = new char*[k];
+        object** o2 = new object*[k * nper];
+        for (long i = 0; i < nslabs; ++i)
+            s2[i] = slabs[i];
+        for (long i = 0; i < n; ++i)
+            o2[i] = objs[i];
+        delete[] slabs;
+        delete[] objs;
+        slabs = s2;
+        objs = o2;
+        slabs_size = k;
+        }
+    slabs[nslabs++] = (char*)::operator new(nper * slotsize);
+    } // End of function obj_arena::newslab.
+
+/*------------------------------------------------------------------------------
+obj_arena::alloc() returns the memory for an object of size "s", after its
+arena_slot header, and sets arena_pending. The first call fixes the size of
+the slots. If "s" is larger than that, 0 is returned.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   obj_arena::alloc   //
+//----------------------//
+void* obj_arena::alloc(size_t s) {
+    if (bmem_threaded)
+        while (__sync_lock_test_and_set(&lock, 1))
+            while (lock)
+                ;
+    void* p = 0;
+    if (objsize == 0) {
+        objsize = s;
+        slotsize = sizeof(arena_slot) + s;
+        slotsize = (slotsize + arena_align - 1) / arena_align * arena_align;
+        }
+    if ((long)s <= objsize) {
+        arena_slot* ps = free;
+        if (ps)
+            free = *(arena_slot**)(ps + 1);
+        else {
+            if (n >= nslabs * nper)
+                newslab();
+            ps = (arena_slot*)(slabs[n / nper] + (n % nper) * slotsize);
+            ps->arena = this;
+            ps->index = n++;
+            }
+        objs[ps->index] = 0;
+        nlive += 1;
+        arena_pending = ps;
+        p = ps + 1;
+        }
+    if (bmem_threaded)
+        __sync_lock_release(&lock);
+    return p;
+    } // End of function obj_arena::alloc.
+
+/*------------------------------------------------------------------------------
+obj_arena::release() puts the slot of a deleted object on the free list. The
+arena deletes itself if it has been discarded and this was its last object.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  obj_arena::release  //
+//----------------------//
+void obj_arena::release(arena_slot* ps) {
+    if (bmem_threaded)
+        while (__sync_lock_test_and_set(&lock, 1))
+            while (lock)
+                ;
+    objs[ps->index] = 0;
+    *(arena_slot**)(ps + 1) = free;
+    free = ps;
+    nlive -= 1;
+    bool_enum last = (orphan && nlive == 0) ? true : false;
+    if (bmem_threaded)
+        __sync_lock_release(&lock);
+    if (last)
+        delete this;
+    } // End of function obj_arena::release.
+
+/*------------------------------------------------------------------------------
+obj_arena::discard() deletes the arena, or if it still holds objects, marks it
+to be deleted with its last object.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  obj_arena::discard  //
+//----------------------//
+void obj_arena::discard() {
+    if (nlive == 0)
+        delete this;
+    else
+        orphan = true;
+    } // End of function obj_arena::discard.
+
+//------------------------------//
+//    obj_arena::~obj_arena     //
+//------------------------------//
+obj_arena::~obj_arena() {
+    for (long i = 0; i < nslabs; ++i)
+        ::operator delete(slabs[i]);
+    delete[] slabs;
+    delete[] objs;
+    } // End of function obj_arena::~obj_arena.
+
+/*------------------------------------------------------------------------------
+object::operator new(size_t) makes the object in arena_next if it is set, and
+otherwise on the heap. The object is preceded by an arena_slot header in either
+case. The placement form makes the object in the given arena.
+------------------------------------------------------------------------------*/
+//------------------------------//
+//     object::operator new     //
+//------------------------------//
+void* object::operator new(size_t s) {
+    obj_arena* pa = arena_next;
+    arena_next = 0;
+    return object::operator new(s, pa);
+    } // End of function object::operator new.
+
+//------------------------------//
+//     object::operator new     //
+//------------------------------//
+void* object::operator new(size_t s, obj_arena* pa) {
+    void* p = pa ? pa->alloc(s) : 0;
+    if (p)
+        return p;
+    arena_slot* ps = (arena_slot*)::operator new(sizeof(arena_slot) + s);
+    ps->arena = 0;
+    ps->index = -1;
+    arena_pending = 0;
+    return ps + 1;
+    } // End of function object::operator new.
+
+/*------------------------------------------------------------------------------
+object::operator delete() gives the memory of an object back to its arena or to
+the heap. The placement form is called only if a constructor throws.
+------------------------------------------------------------------------------*/
+//------------------------------//
+//    object::operator delete   //
+//------------------------------//
+void object::operator delete(void* p) {
+    if (!p)
+        return;
+    arena_slot* ps = (arena_slot*)p - 1;
+    if (ps->arena)
+        ps->arena->release(ps);
+    else
+        ::operator delete(ps);
+    } // End of function object::operator delete.
+
+//------------------------------//
+//    object::operator delete   //
+//------------------------------//
+void object::operator delete(void* p, obj_arena*) {
+    object::operator delete(p);
+    } // End of function object::operator delete.
+
+/*------------------------------------------------------------------------------
+package::set_arena() makes an arena for the objects of class "i" of the package,
+with "nslab" objects in each slab. Objects which have already been made are
+not moved. If the class already has an arena, it is kept.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  package::set_arena  //
+//----------------------//
+int package::set_arena(int i, long nslab) {
+    if (i < 0 || nslab <= 0)
+        return eBAD_ARGUMENT;
+    if (i >= narenas) {
+        int k = (2 * narenas > i) ? 2 * narenas : i + 1;
+        obj_arena** a2 = new obj_arena*[k];
+        int j = 0;
+        for (j = 0; j < narenas; ++j)
+            a2[j] = arenas[j];
+        for ( ; j < k; ++j)
+            a2[j] = 0;
+        delete[] arenas;
+        arenas = a2;
+        narenas = k;
+        }
+    if (!arenas[i])
+        arenas[i] = new obj_arena(nslab);
+    return 0;
+    } // End of function package::set_arena.
+
+/*------------------------------------------------------------------------------
+model::arena() returns the arena of the class with the given name, or 0 if the
+class is not known or has no arena.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     model::arena     //
+//----------------------//
+obj_arena* model::arena(const c_string& type) {
+    if (type.null())
+        return 0;
+    void* pv = 0;
+    object* x0 = repindex.find(pv, type.read()) ? (object*)pv : 0;
+    return (x0 && x0->pkg) ? x0->pkg->arena(x0->index) : 0;
+    } // End of function model::arena.
@@ -0,0 +1,221 @@
+// src/aksl/bench/dsimbench.c   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+/*------------------------------------------------------------------------------
+Classes in this file:
+
+dphold_obj::
+
+Functions in this file:
+
+new_dsim_object
+new_dsim_package
+main
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Benchmark of distributed simulation (see dsim.h) with the PHOLD model.
+
+Each process runs one rank. Each object starts with "e" events. Each event
+sends one new event, after the lookahead plus an exponential delay with mean 1,
+to a random object with probability "r", and otherwise to itself. Each object
+has its own random number generator, seeded by its id, so that the events do
+not depend on the number of ranks. The sums of the event counts and checksums
+printed by the ranks are therefore equal to those printed by a single rank.
+
+Usage: dsimbench [options] rank nranks
+    -n N    Number of objects. (Default 1000.)
+    -e E    Initial events per object. (Default 1.)
+    -r R    Remote fraction. (Default 0.9.)
+    -l L    Lookahead. (Default 1.)
+    -t T    Simulated duration. (Default 200.)
+    -p P    TCP port of rank 0. (Default 47000.)
+    -s S    Random number seed. (Default 1.)
+    -v      Send a list value with each event, instead of an integer.
+
+Example, with 4 ranks on one host:
+    for r in 0 1 2 3 ; do bench/dsimbench $r 4 & done ; wait
+------------------------------------------------------------------------------*/
+
+#include "aksl/aksl.h"
+#include "aksl/dsim.h"
+#include "aksl/newstr.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/time.h>
+
+// Local message types.
+enum {
+    mPHOLD
+    };
+
+static stringkey dsim_keys[] = {
+    "phold",    mPHOLD,
+    (char*)0
+    };
+
+// Parameters.
+static long n_objs = 1000;
+static long n_init = 1;
+static double remote = 0.9;
+static double lookahead = 1;
+static double duration = 200;
+static unsigned long long seed = 1;
+static bool_enum send_values = false;
+
+// Results.
+static object** objs = 0;
+static unsigned long long n_events = 0;
+static double csum = 0;
+
+//----------------------//
+//     dphold_obj::     //
+//----------------------//
+struct dphold_obj: public object {
+    unsigned long long rs;      // State of the random number generator.
+
+    double rand01() {           // Uniform on (0, 1].
+        rs = rs * 6364136223846793005ULL + 1442695040888963407ULL;
+        return ((rs >> 11) + 1) * (1.0 / 9007199254740992.0);
+        }
+    void send(object* dest, long hops) {
+        double dt = lookahead - log(rand01());
+        if (!send_values) {
+            send_message(dt, dest, mPHOLD, hops);
+            return;
+            }
+        valuelist* pl = new valuelist;
+        value* pv = new value;
+        *pv = hops;
+        pl->append(pv);
+        pv = new value;
+        *pv = new_strcpy(name.read());
+        pl->append(pv);
+        pv = new value;
+        *pv = pl;
+        send_message(dt, dest, mPHOLD, pv);
+        }
+    int init() {
+        rs = seed * 0x9e3779b97f4a7c15ULL + id();
+        for (long i = 0; i < n_init; ++i)
+            send(this, 0);
+        return 0;
+        }
+    int recv_message(object*, mtype, payload x) {
+        long hops = 0;
+        value* pv = x.value_ptr();
+        if (pv) {
+            valuelist* pl = *pv;
+            hops = (pl && pl->first()) ? (long)*pl->first() : 0;
+            delete pv;
+            }
+        else
+            hops = x;
+        n_events += 1;
+        csum += sys->sysclock() * (id() + 1) + hops;
+        object* dest = this;
+        if (rand01() <= remote)
+            dest = objs[(long)(rand01() * n_objs) % n_objs];
+        send(dest, hops + 1);
+        return 0;
+        }
+    const char* type() { return "dphold"; }
+    dphold_obj() { rs = 0; }
+    }; // End of struct dphold_obj.
+
+//----------------------//
+//    new_dsim_object   //
+//----------------------//
+static object* new_dsim_object(int i) {
+    return (i == 0) ? new dphold_obj : 0;
+    } // End of function new_dsim_object.
+
+//----------------------//
+//   new_dsim_package   //
+//----------------------//
+static package* new_dsim_package() {
+    package* pp = new package;
+    pp->name = "dsimbench";
+    pp->cs_mesgkeys.merge(*new skilist(dsim_keys));
+    pp->new_object = new_dsim_object;
+    return pp;
+    } // End of function new_dsim_package.
+
+//----------------------//
+//         main         //
+//----------------------//
+int main(int argc, char** argv) {
+    int i = 1;
+    unsigned int port = dsim_deft_port;
+    for ( ; i < argc && argv[i][0] == '-'; ++i) {
+        char c = argv[i][1];
+        if (c == 'v') {
+            send_values = true;
+            continue;
+            }
+        if (i + 1 >= argc || argv[i][2] != 0) {
+            fprintf(stderr, "dsimbench: bad option %s\n", argv[i]);
+            return 1;
+            }
+        const char* a = argv[++i];
+        switch (c) {
+        case 'n':   n_objs = atol(a);                   break;
+        case 'e':   n_init = atol(a);                   break;
+        case 'r':   remote = atof(a);                   break;
+        case 'l':   lookahead = atof(a);                break;
+        case 't':   duration = atof(a);                 break;
+        case 'p':   port = (unsigned int)atoi(a);       break;
+        case 's':   seed = strtoull(a, 0, 10);          break;
+        default:
+            fprintf(stderr, "dsimbench: bad option %s\n", argv[i - 1]);
+            return 1;
+            }
+        }
+    if (i + 2 != argc) {
+        fprintf(stderr, "Usage: dsimbench [options] rank nranks\n");
+        return 1;
+        }
+    int rank = atoi(argv[i]);
+    int nranks = atoi(argv[i + 1]);
+    if (nranks < 1 || rank < 0 || rank >= nranks || n_objs < nranks
+        || lookahead <= 0 || duration <= 0) {
+        fprintf(stderr, "dsimbench: bad arguments\n");
+        return 1;
+        }
+
+    model m;
+    int err = m.load(new_dsim_package());
+    if (err < 0)
+        return 1;
+    systm* s = m.newsystem("dsimbench");
+    s->set_fel(felORDERED);
+    objs = new object*[n_objs];
+    c_string type("dphold");
+    for (long k = 0; k < n_objs; ++k) {
+        char buf[32];
+        sprintf(buf, "dphold%ld", k);
+        c_string name(buf);
+        objs[k] = m.newobject(*s, type, name);
+        if (!objs[k])
+            return 1;
+        }
+
+    dsim ds(*s, rank, nranks, (uint16)port);
+    ds.set_lookahead(lookahead);
+    timeval t0, t1;
+    gettimeofday(&t0, 0);
+    int ret = ds.simulate(duration);
+    gettimeofday(&t1, 0);
+    double secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_usec - t0.tv_usec)*1e-6;
+    printf("rank=%d nranks=%d ret=%d events=%llu csum=%.6f rounds=%lu "
+        "sent=%lu received=%lu seconds=%.3f\n",
+        rank, nranks, ret, n_events, csum, ds.n_rounds(), ds.n_sent(),
+        ds.n_received(), secs);
+    fflush(stdout);
+    delete[] objs;
+    return (ret < 0) ? 1 : 0;
+    } // End of function main.
@@ -0,0 +1,123 @@
+// src/aksl/bench/heapbench.c   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+/*------------------------------------------------------------------------------
+Functions in this file:
+
+hold_bench
+main
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Hold-model benchmark of the FEL implementations in event_heap.
+The FEL is filled with n events. Then each "hold" operation pops the first
+event, and inserts a new event at the same time plus an exponentially
+distributed increment with mean 1. This is the classic FEL benchmark. The
+events are real "event" objects from event::bmem0, as in a simulation.
+
+Usage: heapbench [n_max [holds]]
+The FEL sizes are 1000, 10000, ... up to n_max. The default n_max is 1000000.
+The default number of hold operations per test is 2000000.
+A second table shows the time per hold relative to the binary heap, which is
+the cost of the FEL implementation compared with min_tim_heap. For the ordered
+heaps (felORDERED), this is the cost of the deterministic tie-breaking keys.
+------------------------------------------------------------------------------*/
+
+#include "aksl/aksl.h"
+#include "aksl/rndm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <sys/time.h>
+
+struct bench_fel {
+    const char* name;
+    fel_t fel;
+    unsigned int arity;
+    };
+
+static const bench_fel bench_fels[] = {
+    { "binary heap",    felHEAP,        2 },
+    { "2-ary dheap",    felDARY,        2 },
+    { "4-ary dheap",    felDARY,        4 },
+    { "8-ary dheap",    felDARY,        8 },
+    { "4-ary ordered",  felORDERED,     4 },
+    { "8-ary ordered",  felORDERED,     8 },
+    { "calendar queue", felCALENDAR,    0 },
+    { "ladder queue",   felLADDER,      0 },
+    };
+static const int n_bench_fels = sizeof(bench_fels)/sizeof(bench_fels[0]);
+
+//----------------------//
+//      hold_bench      //
+//----------------------//
+static double hold_bench(const bench_fel& bf, unsigned long n,
+        unsigned long holds, double& tsum) {
+    event_heap fel;
+    fel.set_fel_type(bf.fel, bf.arity);
+    srandom(1);
+    for (unsigned long i = 0; i < n; ++i)
+        fel.insert(new event(-log(random01()), 0, 0, 0));
+
+    timeval t0, t1;
+    gettimeofday(&t0, 0);
+    tsum = 0;
+    for (unsigned long i = 0; i < holds; ++i) {
+        event* pe = fel.popfirst();
+        double t = pe->time();
+        tsum += t;
+        delete pe;
+        fel.insert(new event(t - log(random01()), 0, 0, 0));
+        }
+    gettimeofday(&t1, 0);
+    fel.clear();
+    double secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_usec - t0.tv_usec)*1e-6;
+    return (secs > 0) ? holds/secs : 0;
+    } // End of function hold_bench.
+
+//----------------------//
+//         main         //
+//----------------------//
+int main(int argc, char** argv) {
+    unsigned long n_max = (argc > 1) ? strtoul(argv[1], 0, 10) : 1000000;
+    unsigned long holds = (argc > 2) ? strtoul(argv[2], 0, 10) : 2000000;
+
+    int nsizes = 0;
+    for (unsigned long n = 1000; n <= n_max; n *= 10)
+        nsizes += 1;
+    double* rates = new double[n_bench_fels * nsizes + 1];
+
+    printf("Hold-model throughput (million holds per second), %lu holds.\n",
+        holds);
+    printf("%-16s", "FEL size");
+    for (unsigned long n = 1000; n <= n_max; n *= 10)
+        printf(" %10lu", n);
+    printf("\n");
+    for (int k = 0; k < n_bench_fels; ++k) {
+        printf("%-16s", bench_fels[k].name);
+        fflush(stdout);
+        int j = 0;
+        for (unsigned long n = 1000; n <= n_max; n *= 10) {
+            double tsum = 0;
+            double rate = hold_bench(bench_fels[k], n, holds, tsum);
+            rates[k * nsizes + j++] = rate;
+            printf(" %10.3f", rate * 1e-6);
+            fflush(stdout);
+            }
+        printf("\n");
+        }
+
+    printf("\nTime per hold relative to the binary heap.\n");
+    for (int k = 1; k < n_bench_fels; ++k) {
+        printf("%-16s", bench_fels[k].name);
+        for (int j = 0; j < nsizes; ++j) {
+            double r = rates[k * nsizes + j];
+            printf(" %10.3f", (r > 0) ? rates[j] / r : 0.0);
+            }
+        printf("\n");
+        }
+    delete[] rates;
+    return 0;
+    } // End of function main.
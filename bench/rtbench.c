@@ -0,0 +1,228 @@
+// src/aksl/bench/rtbench.c   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+/*------------------------------------------------------------------------------
+Classes in this file:
+
+rt_obj::
+rt_source::
+rt_reader::
+
+Functions in this file:
+
+new_rt_object
+new_rt_package
+main
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Benchmark of real-time simulation (see rtsim.h).
+
+Each of "n" objects sends itself an event at exponential intervals with mean
+"m" simulated seconds. An external source, which is a timer of the selector,
+writes a byte to one end of a socket pair every "i" wall seconds. A handler of
+the other end injects an event into a random object for each byte. The
+lateness statistics of the events are printed at the end.
+
+Usage: rtbench [options]
+    -n N    Number of objects. (Default 100.)
+    -m M    Mean interval between events of an object. (Default 0.1.)
+    -i I    Interval of the external input, in wall seconds. (Default 0.01.)
+    -t T    Simulated duration. (Default 5.)
+    -x X    Wall seconds per simulated second. (Default 1.)
+    -j J    Jitter bound, in wall seconds. (Default 0.001.)
+    -s      Let the simulation slip behind the wall clock when it is late.
+------------------------------------------------------------------------------*/
+
+#include "aksl/aksl.h"
+#include "aksl/rtsim.h"
+#include "aksl/rndm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+// Local message types.
+enum {
+    mTICK,
+    mINPUT
+    };
+
+static stringkey rt_keys[] = {
+    "tick",     mTICK,
+    "input",    mINPUT,
+    (char*)0
+    };
+
+// Parameters.
+static long n_objs = 100;
+static double mean = 0.1;
+static double interval = 0.01;
+static double duration = 5;
+static double scale = 1;
+static double jitter = rtsim_deft_jitter;
+static bool_enum slip = false;
+
+// Results.
+static object** objs = 0;
+static unsigned long n_ticks = 0;
+static unsigned long n_inputs = 0;
+
+//----------------------//
+//       rt_obj::       //
+//----------------------//
+struct rt_obj: public object {
+    int init() {
+        send_message(-mean * log(random01()), this, mTICK);
+        return 0;
+        }
+    int recv_message(object*, mtype m, payload) {
+        if (m == mINPUT) {
+            n_inputs += 1;
+            return 0;
+            }
+        n_ticks += 1;
+        send_message(-mean * log(random01()), this, mTICK);
+        return 0;
+        }
+    const char* type() { return "rtobj"; }
+    }; // End of struct rt_obj.
+
+/*------------------------------------------------------------------------------
+The external source writes one byte to its socket at each timer event.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      rt_source::     //
+//----------------------//
+struct rt_source: public select_handler {
+    int sock;
+    int handler() {
+        char c = 'x';
+        if (write(sock, &c, 1) != 1)
+            return -1;
+        set_timer(t() + interval, this);
+        return 0;
+        }
+    rt_source(int s) { sock = s; }
+    }; // End of struct rt_source.
+
+/*------------------------------------------------------------------------------
+The reader injects an event into a random object for each byte received.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      rt_reader::     //
+//----------------------//
+struct rt_reader: public select_handler {
+    rtsim* rt;
+    int handler() {
+        char buf[256];
+        int k = (int)read(fd, buf, sizeof(buf));
+        if (k <= 0) {
+            rt->stop(eEND_OF_STREAM);
+            return -1;
+            }
+        for (int i = 0; i < k; ++i) {
+            object* po = objs[random0n(n_objs)];
+            rt->inject(po, po, mINPUT);
+            }
+        return 0;
+        }
+    rt_reader(rtsim* r) { rt = r; }
+    }; // End of struct rt_reader.
+
+//----------------------//
+//     new_rt_object    //
+//----------------------//
+static object* new_rt_object(int i) {
+    return (i == 0) ? new rt_obj : 0;
+    } // End of function new_rt_object.
+
+//----------------------//
+//    new_rt_package    //
+//----------------------//
+static package* new_rt_package() {
+    package* pp = new package;
+    pp->name = "rtbench";
+    pp->cs_mesgkeys.merge(*new skilist(rt_keys));
+    pp->new_object = new_rt_object;
+    return pp;
+    } // End of function new_rt_package.
+
+//----------------------//
+//         main         //
+//----------------------//
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (argv[i][0] != '-' || argv[i][1] == 0 || argv[i][2] != 0) {
+            fprintf(stderr, "rtbench: bad option %s\n", argv[i]);
+            return 1;
+            }
+        char c = argv[i][1];
+        if (c == 's') {
+            slip = true;
+            continue;
+            }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "rtbench: bad option %s\n", argv[i]);
+            return 1;
+            }
+        const char* a = argv[++i];
+        switch (c) {
+        case 'n':   n_objs = atol(a);       break;
+        case 'm':   mean = atof(a);         break;
+        case 'i':   interval = atof(a);     break;
+        case 't':   duration = atof(a);     break;
+        case 'x':   scale = atof(a);        break;
+        case 'j':   jitter = atof(a);       break;
+        default:
+            fprintf(stderr, "rtbench: bad option %s\n", argv[i - 1]);
+            return 1;
+            }
+        }
+    if (n_objs < 1 || mean <= 0 || interval <= 0 || duration <= 0
+        || scale <= 0) {
+        fprintf(stderr, "rtbench: bad arguments\n");
+        return 1;
+        }
+
+    rndm_stream rs(1, 0);
+    rndm_current = &rs;
+    model m;
+    if (m.load(new_rt_package()) < 0)
+        return 1;
+    systm* s = m.newsystem("rtbench");
+    objs = new object*[n_objs];
+    c_string type("rtobj");
+    for (long k = 0; k < n_objs; ++k) {
+        char buf[32];
+        sprintf(buf, "rtobj%ld", k);
+        c_string name(buf);
+        objs[k] = m.newobject(*s, type, name);
+        if (!objs[k])
+            return 1;
+        }
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0)
+        return 1;
+    selector sel;
+    rtsim rt(*s, sel, scale, jitter);
+    rt.set_slip(slip);
+    rt_source src(sv[0]);
+    rt_reader rdr(&rt);
+    sel.set_fd_mask(sv[1], sREAD, &rdr);
+    sel.set_timer_rel(interval, &src);
+
+    int ret = rt.simulate(duration);
+    printf("ret=%d ticks=%lu inputs=%lu\n", ret, n_ticks, n_inputs);
+    rt.print_stats(cout);
+    cout << flush;
+    close(sv[0]);
+    close(sv[1]);
+    delete[] objs;
+    rndm_current = 0;
+    return (ret < 0) ? 1 : 0;
+    } // End of function main.
@@ -0,0 +1,451 @@
+// src/aksl/bench/simbench.c   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+/*------------------------------------------------------------------------------
+Classes in this file:
+
+bench_obj::
+phold_obj::
+hold_obj::
+bcast_obj::
+timer_obj::
+monitor_obj::
+
+Functions in this file:
+
+expo
+hold_increment
+new_bench_object
+new_bench_package
+run_bench
+print_result
+main
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Benchmarks of the AKSL simulation kernel with synthetic models.
+Unlike heapbench, which exercises the FEL alone, these run complete simulations
+through systm::simulate(), so that they measure the scheduler, the event
+allocator and the dispatch of messages together.
+
+phold   The PHOLD model. Each object starts with "e" events. Each event sends
+        one new event, after the lookahead plus an exponential delay with
+        mean 1, to a random object with probability "r" (the remote
+        fraction), and otherwise to itself.
+hold    The classic hold model. Each event sends one new event to its own
+        object, after an increment with mean 1 from the distribution "d"
+        (exp, unif or bimodal).
+bcast   A broadcast storm. All objects subscribe to a broadcast message type.
+        Each of "b" source objects broadcasts to all others at exponential
+        intervals with mean 1.
+timer   A cancel-heavy timer model. Each event restarts a time-out of its
+        object, which usually cancels the previous time-out, and sends a new
+        event to a random object after an exponential delay with mean 1.
+
+Usage: simbench [options] [model ...]
+The default is to run all four models.
+    -n N    Number of objects. (Default 1000.)
+    -e E    Initial events per object. (Default 1.)
+    -r R    Remote fraction of phold. (Default 0.9.)
+    -l L    Lookahead of phold. (Default 0.1.)
+    -d D    Increment distribution of hold: exp, unif or bimodal.
+    -b B    Number of broadcast sources. (Default 1.)
+    -t T    Simulated duration. (Default 2000.)
+    -f F    FEL type: heap, dary, ordered, calendar or ladder. (Default heap.)
+    -a A    Arity of the d-ary heap. (Default 4.)
+    -s S    Random number seed. (Default 1.)
+    -m M    Make the objects in an arena with M objects per slab. (Default 0,
+            which means that the objects are made on the heap.)
+    -k      Machine-readable output: one line of key=value pairs per model.
+
+The results are the number of handler calls ("events"; for bcast, one for each
+delivery of a broadcast), the real time, the events per second, the time per
+event, the mean and maximum FEL length sampled at 1000 times during the run,
+the highest number of events in existence during the model, and the peak
+resident memory of the process. The last is cumulative over the models run by
+one process.
+------------------------------------------------------------------------------*/
+
+#include "aksl/aksl.h"
+#include "aksl/rndm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+// Local message types.
+enum {
+    mPHOLD,
+    mHOLD,
+    mBCAST,
+    mTICK,
+    mTIMEOUT,
+    mSAMPLE
+    };
+
+static stringkey bench_keys[] = {
+    "phold",    mPHOLD,
+    "hold",     mHOLD,
+    "bcast",    mBCAST,
+    "tick",     mTICK,
+    "timeout",  mTIMEOUT,
+    "sample",   mSAMPLE,
+    (char*)0
+    };
+
+// Object classes, in the order of new_bench_object().
+static const char* bench_models[] = { "phold", "hold", "bcast", "timer" };
+static const int n_bench_models = 4;
+
+enum hold_dist_t { hdEXP, hdUNIF, hdBIMODAL };
+
+// Parameters.
+static long n_objs = 1000;
+static long n_init = 1;
+static double remote = 0.9;
+static double lookahead = 0.1;
+static hold_dist_t hold_dist = hdEXP;
+static long n_sources = 1;
+static double duration = 2000;
+static fel_t fel_type = felHEAP;
+static const char* fel_name = "heap";
+static unsigned int fel_arity = 4;
+static unsigned long long seed = 1;
+static long arena_slab = 0;
+static bool_enum keyval = false;
+
+// Results.
+static object** objs = 0;
+static unsigned long long n_events = 0;
+static unsigned long long n_timeouts = 0;
+static double fel_sum = 0;
+static unsigned long fel_max = 0;
+static unsigned long n_samples = 0;
+static unsigned long n_events0 = 0;     // Events in existence at the start.
+
+//----------------------//
+//         expo         //
+//----------------------//
+inline double expo() {
+    return -log(random01());
+    } // End of function expo.
+
+//----------------------//
+//    hold_increment    //
+//----------------------//
+static double hold_increment() {
+    switch (hold_dist) {
+    case hdUNIF:
+        return 2 * random01();
+    case hdBIMODAL:     // 0.9 * 0.1 + 0.1 * 9.1 = 1.
+        return (random01() <= 0.9) ? 0.2 * random01() : 18.2 * random01();
+    default:
+        return expo();
+        }
+    } // End of function hold_increment.
+
+//----------------------//
+//      bench_obj::     //
+//----------------------//
+struct bench_obj: public object {
+    long id;
+
+    bench_obj() { id = 0; }
+    }; // End of struct bench_obj.
+
+//----------------------//
+//      phold_obj::     //
+//----------------------//
+struct phold_obj: public bench_obj {
+    int init() {
+        for (long i = 0; i < n_init; ++i)
+            send_message(lookahead + expo(), this, mPHOLD);
+        return 0;
+        }
+    int recv_message(object*, mtype, payload) {
+        n_events += 1;
+        object* dest = (random01() <= remote) ? objs[random0n(n_objs)] : this;
+        send_message(lookahead + expo(), dest, mPHOLD);
+        return 0;
+        }
+    const char* type() { return "phold"; }
+    }; // End of struct phold_obj.
+
+//----------------------//
+//      hold_obj::      //
+//----------------------//
+struct hold_obj: public bench_obj {
+    int init() {
+        for (long i = 0; i < n_init; ++i)
+            send_message(hold_increment(), this, mHOLD);
+        return 0;
+        }
+    int recv_message(object*, mtype, payload) {
+        n_events += 1;
+        send_message(hold_increment(), this, mHOLD);
+        return 0;
+        }
+    const char* type() { return "hold"; }
+    }; // End of struct hold_obj.
+
+//----------------------//
+//      bcast_obj::     //
+//----------------------//
+struct bcast_obj: public bench_obj {
+    int init() {
+        subscribe(mBCAST);
+        if (id < n_sources)
+            send_message(expo(), this, mTICK);
+        return 0;
+        }
+    int recv_message(object*, mtype m, payload) {
+        if (m == mTICK) {
+            send_message(0.0, 0, mBCAST, (long)id);
+            send_message(expo(), this, mTICK);
+            }
+        else
+            n_events += 1;
+        return 0;
+        }
+    const char* type() { return "bcast"; }
+    }; // End of struct bcast_obj.
+
+//----------------------//
+//      timer_obj::     //
+//----------------------//
+struct timer_obj: public bench_obj {
+    event* timer;
+
+    int init() {
+        timer = 0;
+        for (long i = 0; i < n_init; ++i)
+            send_message(expo(), this, mTICK);
+        return 0;
+        }
+    int recv_message(object*, mtype m, payload) {
+        n_events += 1;
+        if (m == mTIMEOUT) {
+            n_timeouts += 1;
+            timer = 0;
+            return 0;
+            }
+        if (timer)
+            cancel_message(timer);
+        timer = send_message(0.5 + 3 * random01(), this, mTIMEOUT);
+        send_message(expo(), objs[random0n(n_objs)], mTICK);
+        return 0;
+        }
+    const char* type() { return "timer"; }
+    timer_obj() { timer = 0; }
+    }; // End of struct timer_obj.
+
+/*------------------------------------------------------------------------------
+The monitor samples the length of the FEL 1000 times during the run.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     monitor_obj::    //
+//----------------------//
+struct monitor_obj: public bench_obj {
+    int init() {
+        send_message(duration / 1000, this, mSAMPLE);
+        return 0;
+        }
+    int recv_message(object*, mtype m, payload) {
+        if (m != mSAMPLE)       // E.g. a broadcast.
+            return 0;
+        unsigned long n = sys->event_count();
+        fel_sum += n;
+        if (n > fel_max)
+            fel_max = n;
+        n_samples += 1;
+        send_message(duration / 1000, this, mSAMPLE);
+        return 0;
+        }
+    const char* type() { return "monitor"; }
+    }; // End of struct monitor_obj.
+
+//----------------------//
+//   new_bench_object   //
+//----------------------//
+static object* new_bench_object(int i) {
+    switch (i) {
+    case 0:     return new phold_obj;
+    case 1:     return new hold_obj;
+    case 2:     return new bcast_obj;
+    case 3:     return new timer_obj;
+    case 4:     return new monitor_obj;
+    default:    return 0;
+        }
+    } // End of function new_bench_object.
+
+//----------------------//
+//   new_bench_package  //
+//----------------------//
+static package* new_bench_package() {
+    package* pp = new package;
+    pp->name = "bench";
+    pp->cs_mesgkeys.merge(*new skilist(bench_keys));
+    pp->new_object = new_bench_object;
+    if (arena_slab > 0)
+        for (int i = 0; i < n_bench_models; ++i)
+            pp->set_arena(i, arena_slab);
+    return pp;
+    } // End of function new_bench_package.
+
+//----------------------//
+//     print_result     //
+//----------------------//
+static void print_result(const char* name, double secs, int ret) {
+    rusage ru;
+    memset(&ru, 0, sizeof(ru));
+    getrusage(RUSAGE_SELF, &ru);
+    double rate = (secs > 0) ? n_events / secs : 0;
+    double ns = (n_events > 0) ? 1e9 * secs / n_events : 0;
+    double fel_mean = (n_samples > 0) ? fel_sum / n_samples : 0;
+    if (keyval) {
+        printf("model=%s objects=%ld init=%ld duration=%g fel=%s arity=%u "
+            "events=%llu seconds=%.6f events_per_sec=%.1f ns_per_event=%.2f "
+            "fel_mean=%.1f fel_max=%lu event_high_water=%lu "
+            "peak_rss_kb=%ld timeouts=%llu arena=%ld ret=%d\n",
+            name, n_objs, n_init, duration, fel_name, fel_arity,
+            n_events, secs, rate, ns, fel_mean, fel_max,
+            event::bmem0.high_water() - n_events0, (long)ru.ru_maxrss,
+            n_timeouts, arena_slab, ret);
+        }
+    else {
+        printf("%-8s %12llu %9.3f %10.3f %9.1f %10.1f %9lu %9lu %9ld\n",
+            name, n_events, secs, rate * 1e-6, ns, fel_mean, fel_max,
+            event::bmem0.high_water() - n_events0, (long)ru.ru_maxrss);
+        }
+    fflush(stdout);
+    } // End of function print_result.
+
+/*------------------------------------------------------------------------------
+run_bench() runs model number "k" (see bench_models) and prints the results.
+------------------------------------------------------------------------------*/
+//----------------------//
+//       run_bench      //
+//----------------------//
+static int run_bench(int k) {
+    rndm_stream rs(seed, 0);
+    rndm_current = &rs;
+    n_events = 0;
+    n_timeouts = 0;
+    fel_sum = 0;
+    fel_max = 0;
+    n_samples = 0;
+    event::bmem0.reset_high_water();
+    n_events0 = event::bmem0.length();
+
+    model m;
+    int err = m.load(new_bench_package());
+    if (err < 0)
+        return err;
+    systm* s = m.newsystem("bench");
+    s->set_fel(fel_type, fel_arity);
+    objs = new object*[n_objs + 1];
+    c_string type(bench_models[k]);
+    for (long i = 0; i < n_objs; ++i) {
+        char buf[32];
+        sprintf(buf, "%s%ld", bench_models[k], i);
+        c_string name(buf);
+        objs[i] = m.newobject(*s, type, name);
+        if (!objs[i])
+            return eNULL_ARGUMENT;
+        ((bench_obj*)objs[i])->id = i;
+        }
+    c_string mtype_name("monitor"), mname("monitor");
+    m.newobject(*s, mtype_name, mname);
+
+    timeval t0, t1;
+    gettimeofday(&t0, 0);
+    int ret = s->simulate(duration);
+    gettimeofday(&t1, 0);
+    double secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_usec - t0.tv_usec)*1e-6;
+    print_result(bench_models[k], secs, ret);
+
+    delete[] objs;
+    objs = 0;
+    rndm_current = 0;
+    return ret;
+    } // End of function run_bench.
+
+//----------------------//
+//         main         //
+//----------------------//
+int main(int argc, char** argv) {
+    int i = 1;
+    for ( ; i < argc && argv[i][0] == '-'; ++i) {
+        char c = argv[i][1];
+        if (c == 'k') {
+            keyval = true;
+            continue;
+            }
+        if (i + 1 >= argc || argv[i][2] != 0) {
+            fprintf(stderr, "simbench: bad option %s\n", argv[i]);
+            return 1;
+            }
+        const char* a = argv[++i];
+        switch (c) {
+        case 'n':   n_objs = atol(a);                   break;
+        case 'e':   n_init = atol(a);                   break;
+        case 'r':   remote = atof(a);                   break;
+        case 'l':   lookahead = atof(a);                break;
+        case 'b':   n_sources = atol(a);                break;
+        case 't':   duration = atof(a);                 break;
+        case 'a':   fel_arity = (unsigned int)atoi(a);  break;
+        case 's':   seed = strtoull(a, 0, 10);          break;
+        case 'm':   arena_slab = atol(a);               break;
+        case 'd':
+            hold_dist = (strcmp(a, "unif") == 0) ? hdUNIF
+                      : (strcmp(a, "bimodal") == 0) ? hdBIMODAL : hdEXP;
+            break;
+        case 'f':
+            fel_type = (strcmp(a, "dary") == 0) ? felDARY
+                     : (strcmp(a, "ordered") == 0) ? felORDERED
+                     : (strcmp(a, "calendar") == 0) ? felCALENDAR
+                     : (strcmp(a, "ladder") == 0) ? felLADDER : felHEAP;
+            fel_name = (fel_type == felDARY) ? "dary"
+                     : (fel_type == felORDERED) ? "ordered"
+                     : (fel_type == felCALENDAR) ? "calendar"
+                     : (fel_type == felLADDER) ? "ladder" : "heap";
+            break;
+        default:
+            fprintf(stderr, "simbench: bad option %s\n", argv[i - 1]);
+            return 1;
+            }
+        }
+    if (n_objs < 1 || duration <= 0) {
+        fprintf(stderr, "simbench: bad number of objects or duration\n");
+        return 1;
+        }
+
+    if (!keyval) {
+        printf("%-8s %12s %9s %10s %9s %10s %9s %9s %9s\n", "model",
+            "events", "seconds", "Mevents/s", "ns/event", "fel_mean",
+            "fel_max", "evt_hw", "rss_kb");
+        }
+    int err = 0;
+    if (i >= argc) {
+        for (int k = 0; k < n_bench_models; ++k)
+            if (run_bench(k) < 0)
+                err = 1;
+        return err;
+        }
+    for ( ; i < argc; ++i) {
+        int k = 0;
+        while (k < n_bench_models && strcmp(argv[i], bench_models[k]) != 0)
+            ++k;
+        if (k >= n_bench_models) {
+            fprintf(stderr, "simbench: unknown model %s\n", argv[i]);
+            return 1;
+            }
+        if (run_bench(k) < 0)
+            err = 1;
+        }
+    return err;
+    } // End of function main.
@@ -0,0 +1,1288 @@
+// src/aksl/bench/simcheck.c   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+/*------------------------------------------------------------------------------
+Classes in this file:
+
+tie_obj::
+prof_obj::
+phold_state::
+phold_obj::
+rep_obj::
+ckpt_state::
+ckpt_obj::
+trace_obj::
+big_obj::
+
+Functions in this file:
+
+new_check_object
+new_check_package
+check_resume_tie
+check_profile
+make_phold
+run_phold
+check_psim
+link_check_package
+collect_rep
+run_replic
+check_replic
+make_ckpt
+run_ckpt
+check_ckpt
+read_trace_header
+check_trace_file
+check_trace
+check_arena
+check_memsrc
+bmem_thread
+ptr_cmp
+check_bmem_threads
+check_bmem_safe
+check_bmem_registry
+main
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Checks of the AKSL simulation kernel and its allocators, run by "make check".
+The simulation checks are run with every FEL type, and the resume check with
+and without profiling (which selects the instrumented dispatch loop of
+systm::advance()). A line is printed for each failure. The exit status is 1 if
+any check fails.
+
+resume  One object has five events at time 1, one at time 2 and one at time 4.
+        The simulation is advanced to time 1, which stops after the first
+        event of the batch at time 1, and then to time 3. All seven events
+        must be delivered, with six left in the FEL at the pause.
+profile One object has events at times 1 to 5. The handlers at times 1, 3 and
+        4 restart, stop and start profiling. Only the events at times 2 and 5
+        must be recorded, in the profile which is current when they occur.
+psim    A small PHOLD model, in which each object draws its delays and
+        destinations from its own random stream, is run as one system and
+        with psim on 1 and 4 LPs, conservatively and with Time Warp. The
+        sequential run executes one more event, at or after the finish
+        time, than the parallel runs. So one object must have one more
+        event, and every other object must have the same events.
+replic  A data file with four hold objects is run in 12 replications with a
+        replicator, on 1, 2 and 4 threads. The number of events and the sum
+        of their times in each replication must not depend on the number of
+        threads.
+ckpt    Eight objects send ticks to each other with whole delays, so that
+        many events have the same time, and each tick restarts a time-out
+        of its object, which usually cancels the previous one. A run is
+        paused in the middle of a batch of equal-time events and written to
+        a checkpoint. Then the checkpoint is restored into a new model and
+        resumed. The final states must be the same as those of a run which
+        was not interrupted, including the pointers to the time-outs.
+trace   One object sends itself an event with the argument i at time i + 1,
+        for i = 0 to 19, with a binary event trace. Its handler syncs the
+        trace at time 12, when the header of a buffered file must count 12
+        records. The file is then decoded. A buffered trace of 5 records
+        must hold all 20 events, and a ring of 8 records must hold the last
+        8 of them, oldest first.
+arena   Ten tie objects are made by model::newobject() in an arena of four
+        objects in each slab. They must have the indices 0 to 9, and be
+        spaced evenly in each slab. A deleted object must free its index for
+        the next object. An object which is larger than the slots, or of a
+        class without an arena, must be made on the heap.
+memsrc  A bmem with the msMMAP source is constructed in storage filled with
+        ones and in zeroed storage. Both must allocate the same block.
+threads Four threads allocate chunks from one bmem with thread caches, and
+        then each frees the chunks of another thread. The chunks must be
+        distinct, and after bmem_thread_flush() none may be in use. Then the
+        same number of chunks must be allocated without a new block.
+safe    1024 chunks are allocated from a bmem_safe with blocks of 64 chunks
+        and a watermark of 200 free chunks, keeping 50, and freed in order.
+        Blocks must be released, and at most 264 chunks may be left free,
+        until reclaim(0) releases them all. With brMADVISE, the released
+        blocks must be kept idle, and re-used by the next allocations.
+registry The counts of chunks in use must be kept. A bmem must be found by
+        its owner until it is deleted. After 2048 bmems have been
+        constructed and deleted, the registry must not have grown, and a new
+        bmem must still be found. A bmem which takes the place of a deleted
+        bmem must not be given a chunk which a thread cached for the old one.
+------------------------------------------------------------------------------*/
+
+#include "aksl/aksl.h"
+#include "aksl/prof.h"
+#include "aksl/psim.h"
+#include "aksl/replic.h"
+#include "aksl/rndm.h"
+#include "aksl/ckpt.h"
+#include "aksl/trace.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <new>
+
+// Local message types.
+enum {
+    mTIE,
+    mPROF,
+    mPHOLD,
+    mREP,
+    mTICK,
+    mTIMEOUT,
+    mTRACE
+    };
+
+static stringkey check_keys[] = {
+    "tie",      mTIE,
+    "prof",     mPROF,
+    "phold",    mPHOLD,
+    "rep",      mREP,
+    "tick",     mTICK,
+    "timeout",  mTIMEOUT,
+    "trace",    mTRACE,
+    (char*)0
+    };
+
+static const fel_t fel_types[] =
+    { felHEAP, felCALENDAR, felLADDER, felDARY, felORDERED };
+static const char* fel_names[] =
+    { "heap", "calendar", "ladder", "dary", "ordered" };
+static const int n_fel_types = 5;
+
+// Results.
+static long n_recv = 0;
+
+// The PHOLD model.
+static const long phold_nobjs = 16;
+static const double phold_lookahead = 0.25;
+static const double phold_duration = 40;
+static object* phold_objs[phold_nobjs];
+
+// The checkpoint model.
+static const long ckpt_nobjs = 8;
+static const double ckpt_pause = 10;
+static const double ckpt_finish = 30;
+static object* ckpt_objs[ckpt_nobjs];
+static long ckpt_at_pause = 0;          // Events received at the pause time.
+static long ckpt_before = 0;            // The same, before the checkpoint.
+
+// The trace model.
+static const long trace_nevents = 20;
+static const double trace_sync_time = 12;
+static const char* trace_path = 0;
+static long trace_synced = -1;          // Header count after the sync.
+
+//----------------------//
+//       tie_obj::      //
+//----------------------//
+struct tie_obj: public object {
+    int init() {
+        for (int i = 0; i < 5; ++i)
+            send_message(1.0, this, mTIE);
+        send_message(2.0, this, mTIE);
+        send_message(4.0, this, mTIE);
+        return 0;
+        }
+    int recv_message(object*, mtype, payload) {
+        n_recv += 1;
+        return 0;
+        }
+    const char* type() { return "tie"; }
+    }; // End of struct tie_obj.
+
+//----------------------//
+//      prof_obj::      //
+//----------------------//
+struct prof_obj: public object {
+    int init() {
+        for (int i = 1; i <= 5; ++i)
+            send_message(double(i), this, mPROF);
+        return 0;
+        }
+    int recv_message(object*, mtype, payload) {
+        n_recv += 1;
+        double t = sysclock();
+        if (t == 1 || t == 4)
+            sys->set_profiling(true);
+        else if (t == 3)
+            sys->set_profiling(false);
+        return 0;
+        }
+    const char* type() { return "prof"; }
+    }; // End of struct prof_obj.
+
+//----------------------//
+//     phold_state::    //
+//----------------------//
+struct phold_state {
+    unsigned long long rng;     // State of the random stream of the object.
+    long count;                 // Number of events received.
+    unsigned long long hash;    // Hash of the times of the events.
+    }; // End of struct phold_state.
+
+/*------------------------------------------------------------------------------
+A phold_obj sends one event for each event which it receives. The random
+stream is part of the state, so that the events of the object do not depend on
+the order in which the objects are run.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      phold_obj::     //
+//----------------------//
+struct phold_obj: public object {
+    phold_state st;
+
+    double uniform() {
+        st.rng = st.rng * 6364136223846793005ULL + 1442695040888963407ULL;
+        return ((st.rng >> 11) + 1.0) / 9007199254740993.0;
+        }
+    void send() {
+        double d = phold_lookahead - log(uniform());
+        long j = long(uniform() * phold_nobjs) % phold_nobjs;
+        send_message(d, phold_objs[j], mPHOLD);
+        }
+    int init() {
+        send();
+        send();
+        return 0;
+        }
+    int recv_message(object*, mtype, payload) {
+        st.count += 1;
+        st.hash = st.hash * 1000003ULL
+            + (unsigned long long)(sysclock() * 1e6);
+        send();
+        return 0;
+        }
+    void* save_state() { return new phold_state(st); }
+    void restore_state(void* p) {
+        st = *(phold_state*)p;
+        delete (phold_state*)p;
+        }
+    void discard_state(void* p) { delete (phold_state*)p; }
+    const char* type() { return "phold"; }
+    phold_obj() { st.rng = 0; st.count = 0; st.hash = 0; }
+    }; // End of struct phold_obj.
+
+/*------------------------------------------------------------------------------
+A rep_obj sends events to itself, with delays from the random number stream of
+the replication.
+------------------------------------------------------------------------------*/
+//----------------------//
+//       rep_obj::      //
+//----------------------//
+struct rep_obj: public object {
+    long count;                 // Number of events received.
+    double tsum;                // Sum of the times of the events.
+
+    int init() {
+        send_message(-log(1 - random01()), this, mREP);
+        return 0;
+        }
+    int recv_message(object*, mtype, payload) {
+        count += 1;
+        tsum += sysclock();
+        send_message(-log(1 - random01()), this, mREP);
+        return 0;
+        }
+    const char* type() { return "rep"; }
+    rep_obj() { count = 0; tsum = 0; }
+    }; // End of struct rep_obj.
+
+//----------------------//
+//     ckpt_state::     //
+//----------------------//
+struct ckpt_state {
+    unsigned long long rng;     // State of the random stream of the object.
+    long count;                 // Number of ticks received.
+    long ntimeouts;             // Number of time-outs received.
+    unsigned long long hash;    // Hash of the times and origins of the ticks.
+    double ttimer;              // Time of the pending time-out, or -1.
+    }; // End of struct ckpt_state.
+
+/*------------------------------------------------------------------------------
+A ckpt_obj sends a tick to a random object for each tick which it receives,
+and restarts its time-out. Its state is written to checkpoints.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      ckpt_obj::      //
+//----------------------//
+struct ckpt_obj: public object {
+    ckpt_state st;
+    event* timer;               // The pending time-out, or 0.
+
+    long draw(long n) {
+        st.rng = st.rng * 6364136223846793005ULL + 1442695040888963407ULL;
+        return long((st.rng >> 33) % (unsigned long long)n);
+        }
+    void tick() {
+        send_message(double(1 + draw(3)), ckpt_objs[draw(ckpt_nobjs)], mTICK);
+        }
+    int init() {
+        tick();
+        tick();
+        return 0;
+        }
+    int recv_message(object* from, mtype m, payload) {
+        if (sysclock() == ckpt_pause)
+            ckpt_at_pause += 1;
+        if (m == mTIMEOUT) {
+            st.ntimeouts += 1;
+            timer = 0;
+            return 0;
+            }
+        st.count += 1;
+        st.hash = st.hash * 1000003ULL + (unsigned long long)sysclock() * 16
+            + (unsigned long long)from->id();
+        if (timer)
+            cancel_message(timer);
+        timer = send_message(0.5 + draw(2), this, mTIMEOUT);
+        tick();
+        return 0;
+        }
+    int write_state(ckpt_writer& w) {
+        w.put_uint(st.rng);
+        w.put_int(st.count);
+        w.put_int(st.ntimeouts);
+        w.put_uint(st.hash);
+        w.put_event(timer);
+        return 0;
+        }
+    int read_state(ckpt_reader& r) {
+        st.rng = r.get_uint();
+        st.count = (long)r.get_int();
+        st.ntimeouts = (long)r.get_int();
+        st.hash = r.get_uint();
+        timer = r.get_event();
+        return 0;
+        }
+    const char* type() { return "ckpt"; }
+    ckpt_obj() {
+        st.rng = 0; st.count = 0; st.ntimeouts = 0; st.hash = 0;
+        st.ttimer = -1;
+        timer = 0;
+        }
+    }; // End of struct ckpt_obj.
+
+//----------------------//
+//      trace_obj::     //
+//----------------------//
+struct trace_obj: public object {
+    long n;                     // Number of events sent.
+
+    int init() {
+        send_message(1.0, this, mTRACE, n++);
+        return 0;
+        }
+    int recv_message(object*, mtype, payload) {
+        if (sysclock() == trace_sync_time) {
+            sys->sync_event_trace();
+            trace_synced = read_trace_header(0);
+            }
+        if (n < trace_nevents)
+            send_message(1.0, this, mTRACE, n++);
+        return 0;
+        }
+    const char* type() { return "trace"; }
+    trace_obj() { n = 0; }
+
+    static long read_trace_header(trace_header*);
+    }; // End of struct trace_obj.
+
+//----------------------//
+//       big_obj::      //
+//----------------------//
+struct big_obj: public tie_obj {
+    double pad[8];
+    }; // End of struct big_obj.
+
+//----------------------//
+//   new_check_object   //
+//----------------------//
+static object* new_check_object(int i) {
+    switch (i) {
+    case 0:     return new tie_obj;
+    case 1:     return new prof_obj;
+    case 2:     return new phold_obj;
+    case 3:     return new rep_obj;
+    case 4:     return new ckpt_obj;
+    case 5:     return new trace_obj;
+    default:    return 0;
+        }
+    } // End of function new_check_object.
+
+//----------------------//
+//   new_check_package  //
+//----------------------//
+static package* new_check_package() {
+    package* pp = new package;
+    pp->name = "check";
+    pp->cs_mesgkeys.merge(*new skilist(check_keys));
+    pp->new_object = new_check_object;
+    return pp;
+    } // End of function new_check_package.
+
+/*------------------------------------------------------------------------------
+check_resume_tie() returns the number of failures of the "resume" check for
+FEL type number "k" (see fel_types).
+------------------------------------------------------------------------------*/
+//----------------------//
+//   check_resume_tie   //
+//----------------------//
+static int check_resume_tie(int k, bool_enum profiled) {
+    const char* how = profiled ? "profiled" : "plain";
+    n_recv = 0;
+    model m;
+    if (m.load(new_check_package()) < 0) {
+        printf("resume %s %s: cannot load package\n", fel_names[k], how);
+        return 1;
+        }
+    systm* s = m.newsystem("check");
+    s->set_fel(fel_types[k]);
+    c_string type("tie"), name("tie0");
+    if (!m.newobject(*s, type, name)) {
+        printf("resume %s %s: cannot make object\n", fel_names[k], how);
+        return 1;
+        }
+    if (s->initialise() < 0) {
+        printf("resume %s %s: cannot initialise\n", fel_names[k], how);
+        return 1;
+        }
+    if (profiled)
+        s->set_profiling(true);
+
+    int nfail = 0;
+    int ret = s->advance(1.0);
+    if (ret != 0 || n_recv != 1 || s->event_count() != 6) {
+        printf("resume %s %s: advance(1) returned %d with %ld delivered "
+            "and %lu in the FEL\n", fel_names[k], how, ret, n_recv,
+            s->event_count());
+        nfail += 1;
+        }
+    ret = s->advance(3.0);
+    if (ret != 0 || n_recv != 7 || s->event_count() != 0) {
+        printf("resume %s %s: advance(3) returned %d with %ld delivered "
+            "and %lu in the FEL\n", fel_names[k], how, ret, n_recv,
+            s->event_count());
+        nfail += 1;
+        }
+    s->set_profiling(false);
+    s->terminate();
+    return nfail;
+    } // End of function check_resume_tie.
+
+/*------------------------------------------------------------------------------
+check_profile() returns the number of failures of the "profile" check for FEL
+type number "k" (see fel_types).
+------------------------------------------------------------------------------*/
+//----------------------//
+//     check_profile    //
+//----------------------//
+static int check_profile(int k) {
+    n_recv = 0;
+    model m;
+    if (m.load(new_check_package()) < 0) {
+        printf("profile %s: cannot load package\n", fel_names[k]);
+        return 1;
+        }
+    systm* s = m.newsystem("check");
+    s->set_fel(fel_types[k]);
+    c_string type("prof"), name("prof0");
+    if (!m.newobject(*s, type, name)) {
+        printf("profile %s: cannot make object\n", fel_names[k]);
+        return 1;
+        }
+    if (s->initialise() < 0) {
+        printf("profile %s: cannot initialise\n", fel_names[k]);
+        return 1;
+        }
+    s->set_profiling(true);
+
+    int nfail = 0;
+    int ret = s->advance(5.0);
+    unsigned long long n = s->profile() ? s->profile()->n_events() : 0;
+    if (ret != 0 || n_recv != 5 || n != 1) {
+        printf("profile %s: advance(5) returned %d with %ld delivered "
+            "and %llu profiled\n", fel_names[k], ret, n_recv, n);
+        nfail += 1;
+        }
+    s->set_profiling(false);
+    s->terminate();
+    return nfail;
+    } // End of function check_profile.
+
+/*------------------------------------------------------------------------------
+make_phold() makes the objects of the PHOLD model in a new system of "m", with
+FEL type number "k", and returns the system, or 0.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      make_phold      //
+//----------------------//
+static systm* make_phold(model& m, int k) {
+    if (m.load(new_check_package()) < 0)
+        return 0;
+    systm* s = m.newsystem("check");
+    s->set_fel(fel_types[k]);
+    c_string type("phold");
+    for (long i = 0; i < phold_nobjs; ++i) {
+        char buf[32];
+        sprintf(buf, "phold%ld", i);
+        c_string name(buf);
+        phold_obj* po = (phold_obj*)m.newobject(*s, type, name);
+        if (!po)
+            return 0;
+        po->st.rng = 12345 + 1000 * i;
+        phold_objs[i] = po;
+        }
+    return s;
+    } // End of function make_phold.
+
+/*------------------------------------------------------------------------------
+run_phold() runs the PHOLD model with FEL type number "k", and copies the final
+states of the objects to "st". If nlp is 0, the model is run by
+systm::simulate(), and otherwise by psim with nlp LPs. Returns the error of the
+simulation, or 1 if the model cannot be made.
+------------------------------------------------------------------------------*/
+//----------------------//
+//       run_phold      //
+//----------------------//
+static int run_phold(int k, int nlp, bool_enum optimistic, phold_state* st) {
+    model m;
+    systm* s = make_phold(m, k);
+    if (!s)
+        return 1;
+    int ret = 0;
+    if (nlp == 0)
+        ret = s->simulate(phold_duration);
+    else {
+        psim ps(*s, nlp);
+        if (optimistic)
+            ps.set_optimistic();
+        else
+            ps.set_lookahead(phold_lookahead);
+        ret = ps.simulate(phold_duration);
+        }
+    for (long i = 0; i < phold_nobjs; ++i)
+        st[i] = ((phold_obj*)phold_objs[i])->st;
+    return ret;
+    } // End of function run_phold.
+
+/*------------------------------------------------------------------------------
+check_psim() returns the number of failures of the "psim" check for FEL type
+number "k" (see fel_types), conservatively or with Time Warp.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      check_psim      //
+//----------------------//
+static int check_psim(int k, bool_enum optimistic) {
+    phold_state seq[phold_nobjs];
+    phold_state par[phold_nobjs];
+    int ret = run_phold(k, 0, false, seq);
+    if (ret != 0) {
+        printf("psim %s: sequential run returned %d\n", fel_names[k], ret);
+        return 1;
+        }
+    int nfail = 0;
+    const char* how = optimistic ? "optimistic" : "conservative";
+    static const int nlps[] = { 1, 4 };
+    for (int j = 0; j < 2; ++j) {
+        ret = run_phold(k, nlps[j], optimistic, par);
+        if (ret != 0) {
+            printf("psim %s %s %d: returned %d\n", fel_names[k], how,
+                nlps[j], ret);
+            nfail += 1;
+            continue;
+            }
+        int nextra = 0;
+        int ndiff = 0;
+        for (long i = 0; i < phold_nobjs; ++i) {
+            if (seq[i].count == par[i].count + 1)
+                nextra += 1;
+            else if (seq[i].count != par[i].count
+                     || seq[i].hash != par[i].hash
+                     || seq[i].rng != par[i].rng)
+                ndiff += 1;
+            }
+        if (nextra != 1 || ndiff != 0) {
+            printf("psim %s %s %d: %d objects with one more event, %d "
+                "different\n", fel_names[k], how, nlps[j], nextra, ndiff);
+            nfail += 1;
+            }
+        }
+    return nfail;
+    } // End of function check_psim.
+
+//--------------------------//
+//    link_check_package    //
+//--------------------------//
+static int link_check_package(model& m, void*) {
+    return m.link1(new_check_package);
+    } // End of function link_check_package.
+
+/*------------------------------------------------------------------------------
+collect_rep() records the number of events and the sum of their times for the
+objects of a replication.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      collect_rep     //
+//----------------------//
+static void collect_rep(model& m, long, double* row, void*) {
+    row[0] = 0;
+    row[1] = 0;
+    for (systm* s = m.firstsystem(); s; s = s->next()) {
+        object* po = 0;
+        forall(po, s->objects) {
+            row[0] += ((rep_obj*)po)->count;
+            row[1] += ((rep_obj*)po)->tsum;
+            }
+        }
+    } // End of function collect_rep.
+
+/*------------------------------------------------------------------------------
+run_replic() runs the replications of the data file "path" with "nthreads"
+threads, and copies the statistics of replication r to x[2*r] and x[2*r + 1].
+Returns the number of failed replications, or a negative error code.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      run_replic      //
+//----------------------//
+static int run_replic(c_string& path, int nthreads, long nreps, double* x) {
+    replicator rp;
+    rp.setup = link_check_package;
+    rp.collect = collect_rep;
+    int err = rp.read(path);
+    if (err < 0)
+        return err;
+    rp.add_stat("events");
+    rp.add_stat("tsum");
+    err = rp.run(nreps, nthreads, 50, 7);
+    for (long r = 0; r < nreps; ++r) {
+        x[2*r] = rp.rep_value(r, 0);
+        x[2*r + 1] = rp.rep_value(r, 1);
+        }
+    return err;
+    } // End of function run_replic.
+
+/*------------------------------------------------------------------------------
+check_replic() returns the number of failures of the "replic" check.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     check_replic     //
+//----------------------//
+static int check_replic() {
+    char buf[] = "/tmp/simcheckXXXXXX";
+    int fd = mkstemp(buf);
+    if (fd < 0) {
+        printf("replic: cannot make a data file\n");
+        return 1;
+        }
+    static const char data[] =
+        "package check;\n"
+        "system check {\n"
+        "    rep r0 {}\n"
+        "    rep r1 {}\n"
+        "    rep r2 {}\n"
+        "    rep r3 {}\n"
+        "    }\n";
+    int nw = write(fd, data, sizeof(data) - 1);
+    close(fd);
+    c_string path(buf);
+
+    const long nreps = 12;
+    static const int nthreads[] = { 1, 2, 4 };
+    double x[3][2 * nreps];
+    int nfail = 0;
+    for (int j = 0; j < 3 && nw > 0; ++j) {
+        int err = run_replic(path, nthreads[j], nreps, x[j]);
+        if (err != 0) {
+            printf("replic %d: run returned %d\n", nthreads[j], err);
+            nfail += 1;
+            continue;
+            }
+        for (long r = 0; r < nreps; ++r)
+            if (x[j][2*r] <= 0 || x[j][2*r] != x[0][2*r]
+                || x[j][2*r + 1] != x[0][2*r + 1]) {
+                printf("replic %d: replication %ld has %g events, "
+                    "not %g\n", nthreads[j], r, x[j][2*r], x[0][2*r]);
+                nfail += 1;
+                break;
+                }
+        }
+    if (nw <= 0) {
+        printf("replic: cannot write the data file\n");
+        nfail += 1;
+        }
+    unlink(buf);
+    return nfail;
+    } // End of function check_replic.
+
+/*------------------------------------------------------------------------------
+make_ckpt() makes the objects of the checkpoint model in a new system of "m",
+with FEL type number "k", and returns the system, or 0.
+------------------------------------------------------------------------------*/
+//----------------------//
+//       make_ckpt      //
+//----------------------//
+static systm* make_ckpt(model& m, int k) {
+    if (m.load(new_check_package()) < 0)
+        return 0;
+    systm* s = m.newsystem("check");
+    s->set_fel(fel_types[k]);
+    c_string type("ckpt");
+    for (long i = 0; i < ckpt_nobjs; ++i) {
+        char buf[32];
+        sprintf(buf, "ckpt%ld", i);
+        c_string name(buf);
+        ckpt_obj* po = (ckpt_obj*)m.newobject(*s, type, name);
+        if (!po)
+            return 0;
+        po->st.rng = 777 + 31 * i;
+        ckpt_objs[i] = po;
+        }
+    return s;
+    } // End of function make_ckpt.
+
+/*------------------------------------------------------------------------------
+run_ckpt() runs the checkpoint model with FEL type number "k" until the finish
+time, and copies the final states of the objects to "st". If "path" is not 0,
+the run is paused at ckpt_pause and written to the checkpoint file "path".
+Then a new model is restored from the file, and resumed. Returns the first
+error, or 1 if the model cannot be made.
+------------------------------------------------------------------------------*/
+//----------------------//
+//       run_ckpt       //
+//----------------------//
+static int run_ckpt(int k, const char* path, ckpt_state* st) {
+    ckpt_at_pause = 0;
+    model m1;
+    systm* s = make_ckpt(m1, k);
+    if (!s)
+        return 1;
+    int ret = s->initialise();
+    if (ret >= 0 && path) {
+        ret = s->advance(ckpt_pause);
+        ckpt_before = ckpt_at_pause;
+        if (ret >= 0)
+            ret = s->checkpoint(path);
+        }
+    model m2;
+    if (ret >= 0 && path) {
+        s = make_ckpt(m2, k);
+        if (!s)
+            return 1;
+        ret = s->restore(path);
+        }
+    if (ret >= 0)
+        ret = s->advance(ckpt_finish);
+    for (long i = 0; i < ckpt_nobjs; ++i) {
+        ckpt_obj* po = (ckpt_obj*)ckpt_objs[i];
+        st[i] = po->st;
+        st[i].ttimer = po->timer ? po->timer->time() : -1;
+        }
+    return ret;
+    } // End of function run_ckpt.
+
+/*------------------------------------------------------------------------------
+check_ckpt() returns the number of failures of the "ckpt" check for FEL type
+number "k" (see fel_types).
+------------------------------------------------------------------------------*/
+//----------------------//
+//      check_ckpt      //
+//----------------------//
+static int check_ckpt(int k) {
+    ckpt_state ref[ckpt_nobjs];
+    ckpt_state st[ckpt_nobjs];
+    int ret = run_ckpt(k, 0, ref);
+    long nref = ckpt_at_pause;
+    if (ret != 0) {
+        printf("ckpt %s: uninterrupted run returned %d\n", fel_names[k], ret);
+        return 1;
+        }
+    char buf[] = "/tmp/simcheckXXXXXX";
+    int fd = mkstemp(buf);
+    if (fd < 0) {
+        printf("ckpt %s: cannot make a checkpoint file\n", fel_names[k]);
+        return 1;
+        }
+    close(fd);
+    ret = run_ckpt(k, buf, st);
+    unlink(buf);
+    if (ret != 0) {
+        printf("ckpt %s: restored run returned %d\n", fel_names[k], ret);
+        return 1;
+        }
+
+    // The pause must be in the middle of a batch.
+    int nfail = 0;
+    if (ckpt_at_pause != nref || ckpt_before < 1 || ckpt_before >= nref) {
+        printf("ckpt %s: %ld of %ld events at the pause time before the "
+            "checkpoint, %ld in all\n", fel_names[k], ckpt_before, nref,
+            ckpt_at_pause);
+        nfail += 1;
+        }
+    for (long i = 0; i < ckpt_nobjs; ++i)
+        if (st[i].rng != ref[i].rng || st[i].count != ref[i].count
+            || st[i].ntimeouts != ref[i].ntimeouts
+            || st[i].hash != ref[i].hash || st[i].ttimer != ref[i].ttimer) {
+            printf("ckpt %s: object %ld has %ld ticks and %ld time-outs, "
+                "not %ld and %ld\n", fel_names[k], i, st[i].count,
+                st[i].ntimeouts, ref[i].count, ref[i].ntimeouts);
+            nfail += 1;
+            break;
+            }
+    return nfail;
+    } // End of function check_ckpt.
+
+/*------------------------------------------------------------------------------
+trace_obj::read_trace_header() reads the header of the trace file into "ph" if
+it is not 0, and returns its record count, or -1 if it is not a trace file.
+------------------------------------------------------------------------------*/
+//----------------------------------//
+//   trace_obj::read_trace_header   //
+//----------------------------------//
+long trace_obj::read_trace_header(trace_header* ph) {
+    trace_header h;
+    FILE* fp = fopen(trace_path, "rb");
+    if (!fp)
+        return -1;
+    size_t nr = fread(&h, sizeof(h), 1, fp);
+    fclose(fp);
+    if (nr != 1 || memcmp(h.magic, TRACE_MAGIC, sizeof(h.magic)) != 0
+        || h.byte_order != trace_byte_order
+        || h.record_size != sizeof(trace_record))
+        return -1;
+    if (ph)
+        *ph = h;
+    return (long)h.count;
+    } // End of function trace_obj::read_trace_header.
+
+/*------------------------------------------------------------------------------
+check_trace_file() decodes the closed trace file, as tools/tracedump does, and
+returns the number of failures. The object of the trace has the id "id", and
+"cap" is the capacity of the ring, or 0 for a buffered trace.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   check_trace_file   //
+//----------------------//
+static int check_trace_file(const char* how, unsigned int id,
+        unsigned long long cap) {
+    trace_header h;
+    if (trace_obj::read_trace_header(&h) < 0) {
+        printf("trace %s: not a trace file\n", how);
+        return 1;
+        }
+    if (h.count != (unsigned long long)trace_nevents || h.capacity != cap
+        || h.tables == 0) {
+        printf("trace %s: header has count %llu, capacity %llu\n", how,
+            h.count, h.capacity);
+        return 1;
+        }
+    unsigned long long n = h.count;
+    unsigned long long first = 0;
+    if (cap > 0 && n > cap) {
+        first = n % cap;
+        n = cap;
+        }
+    FILE* fp = fopen(trace_path, "rb");
+    if (!fp)
+        return 1;
+    int nfail = 0;
+    trace_record r;
+    for (unsigned long long k = 0; k < n; ++k) {
+        unsigned long long slot = cap > 0 ? (first + k) % cap : k;
+        long i = long(h.count - n + k);     // The number of the event.
+        if (fseek(fp, (long)(sizeof(h) + slot * sizeof(r)), SEEK_SET) != 0
+            || fread(&r, sizeof(r), 1, fp) != 1) {
+            printf("trace %s: record %ld is missing\n", how, i);
+            nfail += 1;
+            break;
+            }
+        if (r.t != i + 1 || r.orig != id || r.dest != id || r.mty != mTRACE
+            || r.arg != i) {
+            printf("trace %s: record %ld has time %g and argument %lld\n",
+                how, i, r.t, r.arg);
+            nfail += 1;
+            break;
+            }
+        }
+    fclose(fp);
+    return nfail;
+    } // End of function check_trace_file.
+
+/*------------------------------------------------------------------------------
+check_trace() returns the number of failures of the "trace" check, for a
+buffered trace or a ring.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      check_trace     //
+//----------------------//
+static int check_trace(bool_enum ring) {
+    const char* how = ring ? "ring" : "buffered";
+    char buf[] = "/tmp/simcheckXXXXXX";
+    int fd = mkstemp(buf);
+    if (fd < 0) {
+        printf("trace %s: cannot make a trace file\n", how);
+        return 1;
+        }
+    close(fd);
+    trace_path = buf;
+    trace_synced = -1;
+
+    int nfail = 0;
+    model m;
+    systm* s = 0;
+    object* po = 0;
+    if (m.load(new_check_package()) >= 0) {
+        s = m.newsystem("check");
+        c_string type("trace"), name("trace0");
+        po = m.newobject(*s, type, name);
+        }
+    unsigned long cap = ring ? 8 : 5;
+    int ret = po ? s->initialise() : 1;
+    if (ret >= 0)
+        ret = s->open_event_trace(buf, cap, ring);
+    if (ret >= 0)
+        ret = s->advance(trace_nevents);
+    if (ret >= 0)
+        ret = s->close_event_trace();
+    if (ret != 0) {
+        printf("trace %s: run returned %d\n", how, ret);
+        nfail += 1;
+        }
+    else {
+        if (trace_synced != long(trace_sync_time)) {
+            printf("trace %s: header has count %ld after the sync at %g\n",
+                how, trace_synced, trace_sync_time);
+            nfail += 1;
+            }
+        nfail += check_trace_file(how, po->id(), ring ? cap : 0);
+        }
+    if (s)
+        s->terminate();
+    unlink(buf);
+    trace_path = 0;
+    return nfail;
+    } // End of function check_trace.
+
+/*------------------------------------------------------------------------------
+check_arena() returns the number of failures of the "arena" check.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      check_arena     //
+//----------------------//
+static int check_arena() {
+    const long n = 10;
+    model m;
+    package* pp = new_check_package();
+    if (m.load(pp) < 0 || pp->set_arena(0, 4) < 0) {
+        printf("arena: cannot load package\n");
+        return 1;
+        }
+    systm* s = m.newsystem("check");
+    c_string tie("tie"), prof("prof"), name("a");
+    object* v[n];
+    for (long i = 0; i < n; ++i)
+        v[i] = m.newobject(*s, tie, name);
+    obj_arena* pa = m.arena(tie);
+    int nfail = 0;
+    long nbad = 0;
+    for (long i = 0; i < n; ++i)
+        if (!v[i] || v[i]->arena_index() != i || !pa || pa->at(i) != v[i]
+            || (i % 4 > 0 && (char*)v[i] - (char*)v[i - 1]
+                             != (char*)v[1] - (char*)v[0]))
+            nbad += 1;
+    if (nbad > 0 || !pa || pa != pp->arena(0) || pa->length() != n
+        || pa->n_live() != n) {
+        printf("arena: %ld objects misplaced\n", nbad);
+        return 1;
+        }
+
+    // Delete an object, and re-use its slot.
+    s->remove(v[3]);
+    delete v[3];
+    if (pa->n_live() != n - 1 || pa->at(3) != 0) {
+        printf("arena: %ld objects after a delete\n", pa->n_live());
+        nfail += 1;
+        }
+    v[3] = m.newobject(*s, tie, name);
+    if (!v[3] || v[3]->arena_index() != 3 || pa->at(3) != v[3]
+        || pa->length() != n || pa->n_live() != n) {
+        printf("arena: deleted slot not re-used\n");
+        nfail += 1;
+        }
+
+    // Objects on the heap.
+    object* pb = new(pa) big_obj;
+    object* pc = m.newobject(*s, prof, name);
+    if (pb->arena_index() != -1 || !pc || pc->arena_index() != -1
+        || pa->n_live() != n) {
+        printf("arena: heap objects put in the arena\n");
+        nfail += 1;
+        }
+    delete pb;
+    return nfail;
+    } // End of function check_arena.
+
+/*------------------------------------------------------------------------------
+check_memsrc() returns the number of failures of the "memsrc" check.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     check_memsrc     //
+//----------------------//
+static int check_memsrc() {
+    static double store[2][sizeof(bmem) / sizeof(double) + 1];
+    unsigned long sz[2];
+    for (int i = 0; i < 2; ++i) {
+        memset(store[i], i ? 0 : 1, sizeof(store[i]));
+        bmem* pb = new(store[i]) bmem(40, 4, msMMAP, "simcheck");
+        void* p = pb->newchunk();
+        sz[i] = p ? pb->size() : 0;
+        if (p)
+            pb->freechunk(p);
+        pb->~bmem();
+        }
+    if (sz[0] == 0 || sz[0] != sz[1]) {
+        printf("memsrc: block of %lu bytes in dirty storage, %lu in zeroed\n",
+            sz[0], sz[1]);
+        return 1;
+        }
+    return 0;
+    } // End of function check_memsrc.
+
+// The bmem threads check.
+static const int bmem_nthreads = 4;
+static const long bmem_nper = 1000;     // Chunks per thread.
+static bmem* bmem_test = 0;
+static void* bmem_chunks[bmem_nthreads][bmem_nper];
+static pbarrier bmem_barrier(bmem_nthreads);
+
+/*------------------------------------------------------------------------------
+bmem_thread() is the thread function of the "threads" check. Its argument is
+the number of the thread.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      bmem_thread     //
+//----------------------//
+static void* bmem_thread(void* arg) {
+    long t = (long)arg;
+    int sense = 0;
+    for (long i = 0; i < bmem_nper; ++i)
+        bmem_chunks[t][i] = bmem_test->newchunk();
+    bmem_barrier.wait(sense);
+    void** v = bmem_chunks[(t + 1) % bmem_nthreads];
+    for (long i = 0; i < bmem_nper; ++i)
+        if (v[i])
+            bmem_test->freechunk(v[i]);
+    bmem_thread_flush();
+    return 0;
+    } // End of function bmem_thread.
+
+//----------------------//
+//        ptr_cmp       //
+//----------------------//
+static int ptr_cmp(const void* a, const void* b) {
+    const char* p = *(const char* const*)a;
+    const char* q = *(const char* const*)b;
+    return (p < q) ? -1 : (p > q) ? 1 : 0;
+    } // End of function ptr_cmp.
+
+/*------------------------------------------------------------------------------
+check_bmem_threads() returns the number of failures of the "threads" check.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//    check_bmem_threads    //
+//--------------------------//
+static int check_bmem_threads() {
+    bmem_test = new bmem(48, 16, msNEW, "simcheck");
+    bmem_threaded = 1;
+    pthread_t tids[bmem_nthreads];
+    for (long t = 1; t < bmem_nthreads; ++t)
+        if (pthread_create(&tids[t], 0, bmem_thread, (void*)t) != 0) {
+            printf("threads: cannot create a thread\n");
+            exit(1);    // The other threads would wait at the barrier.
+            }
+    bmem_thread((void*)0);
+    for (int t = 1; t < bmem_nthreads; ++t)
+        pthread_join(tids[t], 0);
+    bmem_threaded = 0;
+
+    // The chunks which were in use at once must be distinct.
+    int nfail = 0;
+    const long n = bmem_nthreads * bmem_nper;
+    void** v = &bmem_chunks[0][0];
+    qsort(v, n, sizeof(void*), ptr_cmp);
+    long nbad = 0;
+    for (long i = 0; i < n; ++i)
+        if (!v[i] || (i > 0 && v[i] == v[i - 1]))
+            nbad += 1;
+    if (nbad > 0 || bmem_test->length() != 0) {
+        printf("threads: %ld bad chunks, %lu in use after the flush\n",
+            nbad, bmem_test->length());
+        nfail += 1;
+        }
+
+    // The freed chunks must be re-used.
+    unsigned long nb = bmem_test->n_blocks();
+    for (long i = 0; i < n; ++i)
+        v[i] = bmem_test->newchunk();
+    if (bmem_test->n_blocks() != nb || bmem_test->length() != (unsigned long)n) {
+        printf("threads: %lu blocks and %lu chunks in use after "
+            "re-allocation\n", bmem_test->n_blocks(), bmem_test->length());
+        nfail += 1;
+        }
+    for (long i = 0; i < n; ++i)
+        bmem_test->freechunk(v[i]);
+    delete bmem_test;
+    bmem_test = 0;
+    return nfail;
+    } // End of function check_bmem_threads.
+
+/*------------------------------------------------------------------------------
+check_bmem_safe() returns the number of failures of the "safe" check.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    check_bmem_safe   //
+//----------------------//
+static int check_bmem_safe() {
+    const long n = 1024;
+    const long nblk = 64;
+    static void* v[n];
+    int nfail = 0;
+    bmem_safe* ps = new bmem_safe(48, nblk, msNEW, "simcheck");
+    ps->set_growth(0);
+    ps->set_watermark(200, 50);
+    for (long i = 0; i < n; ++i)
+        v[i] = ps->newchunk();
+    unsigned long nb = ps->n_blocks();
+    for (long i = 0; i < n; ++i)
+        ps->freechunk(v[i]);
+    if (nb != n / nblk || ps->n_released() == 0 || ps->n_free() > 200 + nblk
+        || ps->length() != 0 || ps->n_chunks() != ps->n_free()
+        || ps->n_blocks() * nblk != ps->n_chunks()) {
+        printf("safe: %lu blocks, %lu released, %lu free, %lu chunks\n",
+            nb, ps->n_released(), ps->n_free(), ps->n_chunks());
+        nfail += 1;
+        }
+    ps->reclaim(0);
+    if (ps->n_blocks() != 0 || ps->n_free() != 0 || ps->n_released() != nb) {
+        printf("safe: %lu blocks, %lu free after reclaim(0)\n",
+            ps->n_blocks(), ps->n_free());
+        nfail += 1;
+        }
+    delete ps;
+
+    // Idle blocks.
+    ps = new bmem_safe(48, nblk, msNEW, "simcheck");
+    ps->set_growth(0);
+    ps->set_release(brMADVISE);
+    for (int pass = 0; pass < 2; ++pass) {
+        for (long i = 0; i < n; ++i) {
+            v[i] = ps->newchunk();
+            if (v[i])
+                memset(v[i], 0xff, 48);
+            }
+        if (pass == 1 && (ps->n_idle() != 0 || ps->n_blocks() != nb)) {
+            printf("safe: %lu idle and %lu blocks after re-allocation\n",
+                ps->n_idle(), ps->n_blocks());
+            nfail += 1;
+            }
+        for (long i = 0; i < n; ++i)
+            if (v[i])
+                ps->freechunk(v[i]);
+        ps->reclaim(0);
+        }
+#if defined(linux) || defined(sun)      // As for BMEM_MMAP in bmem.c.
+    if (ps->n_idle() != nb || ps->n_released() != 2 * nb) {
+        printf("safe: %lu idle blocks, %lu released\n",
+            ps->n_idle(), ps->n_released());
+        nfail += 1;
+        }
+#endif
+    delete ps;
+    return nfail;
+    } // End of function check_bmem_safe.
+
+/*------------------------------------------------------------------------------
+check_bmem_registry() returns the number of failures of the "registry" check.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//    check_bmem_registry   //
+//--------------------------//
+static int check_bmem_registry() {
+    int nfail = 0;
+    void* v[10];
+    bmem* pb = new bmem(48, 4, msNEW, "simcheck-registry");
+    for (int i = 0; i < 10; ++i)
+        v[i] = pb->newchunk();
+    for (int i = 0; i < 3; ++i)
+        pb->freechunk(v[i]);
+    unsigned long hw = pb->high_water();
+    pb->reset_high_water();
+    if (pb->length() != 7 || hw != 10 || pb->high_water() != 7) {
+        printf("registry: %lu in use, high water %lu\n", pb->length(), hw);
+        nfail += 1;
+        }
+    for (int i = 3; i < 10; ++i)
+        pb->freechunk(v[i]);
+    if (bmem_find("simcheck-registry") != pb) {
+        printf("registry: bmem not found\n");
+        nfail += 1;
+        }
+    delete pb;
+    if (bmem_find("simcheck-registry")) {
+        printf("registry: deleted bmem found\n");
+        nfail += 1;
+        }
+
+    // The places of deleted bmems must be re-used.
+    int n = bmem_count();
+    for (int i = 0; i < 2 * bmem_max_slots; ++i)
+        delete new bmem(48, 4, msNEW, "simcheck-registry");
+    pb = new bmem(48, 4, msNEW, "simcheck-registry");
+    if (bmem_count() > n + 1 || bmem_find("simcheck-registry") != pb) {
+        printf("registry: %d places, new bmem %sfound\n", bmem_count(),
+            bmem_find("simcheck-registry") ? "" : "not ");
+        nfail += 1;
+        }
+    delete pb;
+
+    // A cached chunk of a deleted bmem must not be used by the next one.
+    bmem_threaded = 1;
+    pb = new bmem(48, 4, msNEW, "simcheck-registry");
+    void* p = pb->newchunk();
+    pb->freechunk(p);
+    delete pb;
+    pb = new bmem(200, 4, msNEW, "simcheck-registry");
+    void* q = pb->newchunk();
+    pb->freechunk(q);
+    bmem_thread_flush();
+    bmem_threaded = 0;
+    if (q == p || pb->length() != 0) {
+        printf("registry: chunk of a deleted bmem re-used\n");
+        nfail += 1;
+        }
+    delete pb;
+    return nfail;
+    } // End of function check_bmem_registry.
+
+//----------------------//
+//         main         //
+//----------------------//
+int main() {
+    int nfail = 0;
+    for (int k = 0; k < n_fel_types; ++k) {
+        nfail += check_resume_tie(k, false);
+        nfail += check_resume_tie(k, true);
+        nfail += check_profile(k);
+        nfail += check_psim(k, false);
+        nfail += check_psim(k, true);
+        nfail += check_ckpt(k);
+        }
+    nfail += check_trace(false);
+    nfail += check_trace(true);
+    nfail += check_replic();
+    nfail += check_arena();
+    nfail += check_memsrc();
+    nfail += check_bmem_threads();
+    nfail += check_bmem_safe();
+    nfail += check_bmem_registry();
+    printf("simcheck: %d failure%s\n", nfail, (nfail == 1) ? "" : "s");
+    return (nfail > 0) ? 1 : 0;
+    } // End of function main.
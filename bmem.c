@@ -7,19 +7,59 @@ modified Artistic Licence, as specified in the accompanying LICENCE file.
 /*------------------------------------------------------------------------------
 Functions in this file:
 
+bmem_page_size
 bmem::
     ctor
+    ~bmem
     getnewblock
+    blockbytes
+    allocblock
+    freeblock
+    newblock
+    linkblock
+    set_memsrc
+    set_growth
+    prefill
+    refill
+    newchunk_locked
+    freechunk_locked
+    mag
+    depot_push
+    depot_pop
+    take_batch
+    put_list
+    flush_mag
+    newchunk_threaded
+    freechunk_threaded
+    count_used
     print
-    length
+    print_stats
+bmem_thread_flush
+bmem_count
+bmem_registered
+bmem_find
+bmem_dump
 bmem_safe::
+    bmem_safe
     ~bmem_safe
     getnewblock
+    prefill
+    newchunk_threaded
+    freechunk_unlocked
     freechunk
+    set_watermark
+    release_block
+    reclaim_locked
+    reclaim
+bmem_block_cmp
+bmem_block_find
 ------------------------------------------------------------------------------*/
 
 // AKSL header files:
 #include "aksl/bmem.h"
+#ifndef AKSL_NEWSTR_H
+#include "aksl/newstr.h"
+#endif
 #ifndef AKSL_NUMPRINT_H
 #include "aksl/numprint.h"
 #endif
@@ -41,13 +81,62 @@ bmem_safe::
 #endif
 #endif
 
+// For mmap() and madvise().
+#if defined(linux) || defined(sun)
+#define BMEM_MMAP 1
+#ifndef AKSL_X_SYS_MMAN_H
+#define AKSL_X_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#ifndef AKSL_X_UNISTD_H
+#define AKSL_X_UNISTD_H
+#include <unistd.h>
+#endif
+#else
+#define BMEM_MMAP 0
+#endif
+
+volatile int bmem_threaded = 0;
+
+// The bmems which have thread caches, indexed by bmem::slot. This is also
+// the registry of bmems.
+static bmem* volatile bmem_slots[bmem_max_slots];
+static volatile int bmem_nslots = 0;
+static unsigned int bmem_gens[bmem_max_slots];  // Generation of each slot.
+static volatile int bmem_slots_lock = 0;        // For the constructor.
+
+// The thread caches of the calling thread, indexed by bmem::slot.
+static AKSL_TLS bmem_mag* bmem_mags = 0;
+static AKSL_TLS int bmem_nmags = 0;
+
+/*------------------------------------------------------------------------------
+bmem_page_size() returns the size of a page, for the msMMAP memory source and
+for madvise().
+------------------------------------------------------------------------------*/
+//----------------------//
+//    bmem_page_size    //
+//----------------------//
+static long bmem_page_size() {
+    static long pg = 0;
+    if (pg <= 0) {
+#if BMEM_MMAP
+        pg = sysconf(_SC_PAGESIZE);
+#endif
+        if (pg <= 0)
+            pg = 4096;
+        }
+    return pg;
+    } // End of function bmem_page_size.
+
 /*------------------------------------------------------------------------------
-bmem::ctor(long s, long n, memsrc_t ms)
+bmem::ctor(long s, long n, memsrc_t ms, const char* o)
 s   = number of bytes for the user in each memory chunk.
 n   = number of chunks in each block of chunks.
-ms  = memory source (new or malloc).
+ms  = memory source (new, malloc or mmap).
+o   = name of the owner, for the registry, or 0. (This is not copied.)
 
-Each bmem block contains ((BMEM_ALIGN + s) * n) bytes.
+The first bmem block contains ((BMEM_ALIGN + s) * n) bytes, rounded up to whole
+pages for msMMAP and msHUGEPAGE. It is not allocated until it is needed.
 Each bmem chunk contains (BMEM_ALIGN + s) bytes.
 
 Structure of chunk:
@@ -81,14 +170,42 @@ struct block {
 //----------------------//
 //      bmem::ctor      //
 //----------------------//
-void bmem::ctor(long s, long n, memsrc_t ms) {
+void bmem::ctor(long s, long n, memsrc_t ms, const char* o) {
+    // The counts must be zero before set_memsrc() is called.
+    nblocks = 0;
+    totchunks = 0;
+    totbytes = 0;
+    nused = 0;
+    nhigh = 0;
+    own = o;
+    free = 0;
+
     // Take note of the memory source.
-    if (ms == msNEW)
-        memsrc = msNEW;
-    else if (ms == msMALLOC)
-        memsrc = msMALLOC;
-    else
-        memsrc = msNEW;             // Default for errored arg is "new".
+    memsrc = msNEW;
+    set_memsrc(ms);
+    lock = 0;
+    for (int i = 0; i < bmem_depot_size; ++i)
+        depot[i] = 0;
+    ndepot = 0;
+
+    // Take the first empty place in the registry.
+    while (__sync_lock_test_and_set(&bmem_slots_lock, 1))
+        while (bmem_slots_lock)
+            ;
+    slot = 0;
+    while (slot < bmem_nslots && bmem_slots[slot])
+        slot += 1;
+    if (slot == bmem_nslots && slot < bmem_max_slots)
+        bmem_nslots = slot + 1;
+    if (slot < bmem_max_slots) {
+        gen = ++bmem_gens[slot];
+        bmem_slots[slot] = this;
+        }
+    else {
+        slot = -1;
+        gen = 0;
+        }
+    __sync_lock_release(&bmem_slots_lock);
 
     // Round the value of "s" up to the nearest multiple of BMEM_ALIGN.
 #if BMEM_ALIGN == 4
@@ -98,57 +215,516 @@ void bmem::ctor(long s, long n, memsrc_t ms) {
     usersize = (s + BMEM_ALIGN - 1) & ~0x07;
 #endif
     chunksize = BMEM_ALIGN + usersize;
-    nchunks = n;
-    blocksize = nchunks * chunksize;
-    if (memsrc == msNEW)
-        free = new char[blocksize];
-    else
-        free = (char*)malloc((int)blocksize);
-    nblocks = 1;
-
-    // Initialise the first (nchunks - 1) chunks in the initial block.
-    register char* p = free;            // Trailing pointer.
-    register char* q = p;               // Advancing pointer.
-    for (register long i = nchunks; --i > 0; ) {
-        q += chunksize;
-        *(char**)p = q;
-        p = q;
-        }
-    // Make the last chunk point to nowhere.
-    *(char**)p = 0;
-#if BMEM_TRACE
-    // The owner of this bmem object.
-    owner = 0;
-#endif
+    nchunks = (n > 0) ? n : 1;
+    maxchunks = nchunks;
+    set_growth(bmem_deft_max_block);
     } // End of function bmem::ctor.
 
+/*------------------------------------------------------------------------------
+The blocks are not freed. The thread caches of the bmem are forgotten, and its
+place in the registry may be re-used.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      bmem::~bmem     //
+//----------------------//
+bmem::~bmem() {
+    if (slot < 0)
+        return;
+    while (__sync_lock_test_and_set(&bmem_slots_lock, 1))
+        while (bmem_slots_lock)
+            ;
+    bmem_slots[slot] = 0;
+    __sync_lock_release(&bmem_slots_lock);
+    } // End of function bmem::~bmem.
+
 /*------------------------------------------------------------------------------
 This function is to be called by class bmem:: only when all allocated memory is
 in use.
-A new block of "nchunks" chunks is allocated and initialised.
+A new block of "nchunks" chunks is allocated and initialised, and then nchunks
+is doubled, up to maxchunks.
 All knoweldge of the previous chunk is forgotten, so that it is not possible to
 ge back and free old chunks. This is intentional, so as to prevent bugs which
 arise from calling the free() function, and block allocation "thrashing".
+(But see bmem_safe.)
 ------------------------------------------------------------------------------*/
 //----------------------//
 //   bmem::getnewblock  //
 //----------------------//
 void bmem::getnewblock() {
     // Assume that the call is made only when free == 0.
-    if (memsrc == msNEW)
-        free = new char[blocksize];
+    long n = nchunks;
+    if (!newblock(n))
+        return;
+    if (nchunks < maxchunks) {
+        nchunks *= 2;
+        if (nchunks > maxchunks)
+            nchunks = maxchunks;
+        }
+    } // End of function bmem::getnewblock.
+
+/*------------------------------------------------------------------------------
+bmem::blockbytes() returns the number of bytes allocated for a block of n
+chunks. For the mmap() sources, this is rounded up to whole pages.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   bmem::blockbytes   //
+//----------------------//
+long bmem::blockbytes(long n) const {
+    long b = n * chunksize;
+    long u = 1;
+    if (memsrc == msMMAP)
+        u = bmem_page_size();
+    else if (memsrc == msHUGEPAGE)
+        u = bmem_huge_page;
+    return (b + u - 1) / u * u;
+    } // End of function bmem::blockbytes.
+
+/*------------------------------------------------------------------------------
+bmem::allocblock() allocates "bytes" bytes from the memory source. For
+msHUGEPAGE, huge pages are tried first. If there are none, the mapping is
+made one huge page longer, and trimmed so that it is aligned to a huge page,
+and transparent huge pages are requested with madvise().
+------------------------------------------------------------------------------*/
+//----------------------//
+//    bmem::allocblock  //
+//----------------------//
+char* bmem::allocblock(long bytes) {
+    if (memsrc == msMALLOC)
+        return (char*)malloc(bytes);
+#if BMEM_MMAP
+    if (memsrc == msMMAP || memsrc == msHUGEPAGE) {
+        const int prot = PROT_READ | PROT_WRITE;
+        const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+        void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        if (memsrc == msHUGEPAGE)
+            p = mmap(0, bytes, prot, flags | MAP_HUGETLB, -1, 0);
+#endif
+        if (p != MAP_FAILED)
+            return (char*)p;
+        if (memsrc == msMMAP) {
+            p = mmap(0, bytes, prot, flags, -1, 0);
+            return (p != MAP_FAILED) ? (char*)p : 0;
+            }
+
+        // Align the block to a huge page.
+        p = mmap(0, bytes + bmem_huge_page, prot, flags, -1, 0);
+        if (p == MAP_FAILED)
+            return 0;
+        unsigned long a = (unsigned long)p;
+        unsigned long b = (a + bmem_huge_page - 1) & ~(bmem_huge_page - 1);
+        if (b > a)
+            munmap(p, b - a);
+        if (bmem_huge_page - (b - a) > 0)
+            munmap((char*)b + bytes, bmem_huge_page - (b - a));
+#ifdef MADV_HUGEPAGE
+        madvise((char*)b, bytes, MADV_HUGEPAGE);
+#endif
+        return (char*)b;
+        }
+#endif
+    return new char[bytes];
+    } // End of function bmem::allocblock.
+
+//----------------------//
+//    bmem::freeblock   //
+//----------------------//
+void bmem::freeblock(char* b, long bytes) {
+    if (memsrc == msMALLOC)
+        ::free(b);
+#if BMEM_MMAP
+    else if (memsrc == msMMAP || memsrc == msHUGEPAGE)
+        munmap(b, bytes);
+#endif
     else
-        free = (char*)malloc((int)blocksize);
+        delete[] b;
+    } // End of function bmem::freeblock.
+
+/*------------------------------------------------------------------------------
+bmem::newblock() allocates a block of at least n chunks, and puts its chunks on
+the free list. On return, n is the number of chunks in the block, which may be
+more because of rounding to whole pages. If "touch" is non-zero, every page of
+the block is written, so that it is faulted in now. If the memory source fails,
+an error is printed, 0 is returned, and n and the counts are not changed.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    bmem::newblock    //
+//----------------------//
+char* bmem::newblock(long& n, int touch) {
+    long bytes = blockbytes(n);
+    char* b = allocblock(bytes);
+    if (!b) {
+        cout << flush;
+        cerr << "<<error: bmem::newblock out of memory>>\n";
+        return 0;
+        }
+    n = bytes / chunksize;
+    if (touch) {
+        long pg = bmem_page_size();
+        for (long i = 0; i < bytes; i += pg)
+            b[i] = 0;
+        }
     nblocks += 1;
-    register char* p = free;            // Trailing pointer.
+    totchunks += n;
+    totbytes += bytes;
+    linkblock(b, n);
+    return b;
+    } // End of function bmem::newblock.
+
+/*------------------------------------------------------------------------------
+bmem::linkblock() puts all of the n chunks of block b at the front of the free
+list, in address order.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    bmem::linkblock   //
+//----------------------//
+void bmem::linkblock(char* b, long n) {
+    register char* p = b;               // Trailing pointer.
     register char* q = p;               // Advancing pointer.
-    for (register long i = nchunks; --i > 0; ) {
+    for (register long i = n; --i > 0; ) {
         q += chunksize;
         *(char**)p = q;
         p = q;
         }
+    *(char**)p = free;
+    free = b;
+    } // End of function bmem::linkblock.
+
+/*------------------------------------------------------------------------------
+bmem::set_memsrc() sets the memory source of the blocks. It cannot be changed
+after the first block has been allocated, because the blocks of bmem_safe are
+given back to the source from which they came.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   bmem::set_memsrc   //
+//----------------------//
+int bmem::set_memsrc(memsrc_t ms) {
+    if (memsrc != ms && nblocks > 0)
+        return -1;
+    switch(ms) {
+    case msMALLOC:
+        memsrc = msMALLOC;
+        break;
+#if BMEM_MMAP
+    case msMMAP:
+        memsrc = msMMAP;
+        break;
+    case msHUGEPAGE:
+        memsrc = msHUGEPAGE;
+        break;
+#endif
+    default:
+        memsrc = msNEW;             // Default for errored arg is "new".
+        break;
+        }
+    return 0;
+    } // End of function bmem::set_memsrc.
+
+/*------------------------------------------------------------------------------
+bmem::set_growth() sets the maximum number of bytes in a block, which limits
+the doubling of the number of chunks in a block. The blocks do not grow if
+max_bytes is not more than the size of the next block.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   bmem::set_growth   //
+//----------------------//
+void bmem::set_growth(long max_bytes) {
+    long m = max_bytes / chunksize;
+    maxchunks = (m > nchunks) ? m : nchunks;
+    } // End of function bmem::set_growth.
+
+//----------------------//
+//     bmem::prefill    //
+//----------------------//
+void bmem::prefill(long n) {
+    if (bmem_threaded)
+        while (__sync_lock_test_and_set(&lock, 1))
+            while (lock)
+                ;
+    if (n > totchunks) {
+        long k = n - totchunks;
+        newblock(k, 1);
+        }
+    if (bmem_threaded)
+        __sync_lock_release(&lock);
+    } // End of function bmem::prefill.
+
+/*------------------------------------------------------------------------------
+bmem::refill() is called by newchunk() when the free list is empty. Batches
+which were left in the depot by other threads are used before a new block.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     bmem::refill     //
+//----------------------//
+void bmem::refill() {
+    char* b = depot_pop();
+    if (b)
+        free = b;
+    else
+        getnewblock();
+    } // End of function bmem::refill.
+
+/*------------------------------------------------------------------------------
+bmem::newchunk_locked() is the same as bmem::newchunk(), except that it holds
+the spin lock of the bmem while the free list is modified.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//  bmem::newchunk_locked   //
+//--------------------------//
+void* bmem::newchunk_locked() {
+    while (__sync_lock_test_and_set(&lock, 1))
+        while (lock)
+            ;
+    if (!free)
+        getnewblock();
+    char* p = free;
+    if (!p) {
+        __sync_lock_release(&lock);
+        return 0;
+        }
+    free = *(char**)p;
+    __sync_lock_release(&lock);
+    count_used(1);
+    return p + BMEM_ALIGN;
+    } // End of function bmem::newchunk_locked.
+
+//--------------------------//
+//  bmem::freechunk_locked  //
+//--------------------------//
+void bmem::freechunk_locked(void* p) {
+    char* q = (char*)p - BMEM_ALIGN;
+    while (__sync_lock_test_and_set(&lock, 1))
+        while (lock)
+            ;
+    *(char**)q = free;
+    free = q;
+    __sync_lock_release(&lock);
+    count_used(-1);
+    } // End of function bmem::freechunk_locked.
+
+/*------------------------------------------------------------------------------
+bmem::mag() returns the cache of the calling thread for this bmem. The array of
+caches of the thread is extended if necessary. A cache of an earlier bmem in
+the same slot is emptied. (Its chunks are lost, as for bmem::~bmem().)
+------------------------------------------------------------------------------*/
+//----------------------//
+//       bmem::mag      //
+//----------------------//
+bmem_mag* bmem::mag() {
+    if (slot >= bmem_nmags) {
+        int n = bmem_nslots;
+        if (n > bmem_max_slots)
+            n = bmem_max_slots;
+        if (n <= slot)
+            n = slot + 1;
+        bmem_mag* m2 = new bmem_mag[n];
+        int i = 0;
+        for ( ; i < bmem_nmags; ++i)
+            m2[i] = bmem_mags[i];
+        for ( ; i < n; ++i) {
+            m2[i].cur = 0;
+            m2[i].ncur = 0;
+            m2[i].prev = 0;
+            m2[i].gen = 0;
+            }
+        delete[] bmem_mags;
+        bmem_mags = m2;
+        bmem_nmags = n;
+        }
+    bmem_mag* m = &bmem_mags[slot];
+    if (m->gen != gen) {
+        m->cur = 0;
+        m->ncur = 0;
+        m->prev = 0;
+        m->gen = gen;
+        }
+    return m;
+    } // End of function bmem::mag.
+
+/*------------------------------------------------------------------------------
+bmem::depot_push() puts a full batch into an empty place in the depot. If there
+is none, the chunks of the batch are put on the free list.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   bmem::depot_push   //
+//----------------------//
+void bmem::depot_push(char* b) {
+    if (ndepot < bmem_depot_size)
+        for (int i = 0; i < bmem_depot_size; ++i)
+            if (!depot[i] && __sync_bool_compare_and_swap(&depot[i], 0, b)) {
+                __sync_fetch_and_add(&ndepot, 1);
+                return;
+                }
+    put_list(b);
+    } // End of function bmem::depot_push.
+
+/*------------------------------------------------------------------------------
+bmem::depot_pop() takes a full batch from the depot, or returns 0 if there is
+none. Since a place in the depot is only ever swapped between 0 and a batch,
+and nothing is read from a batch until it has been taken, there is no "ABA"
+problem.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    bmem::depot_pop   //
+//----------------------//
+char* bmem::depot_pop() {
+    if (ndepot <= 0)
+        return 0;
+    for (int i = 0; i < bmem_depot_size; ++i) {
+        char* b = depot[i];
+        if (b && __sync_bool_compare_and_swap(&depot[i], b, (char*)0)) {
+            __sync_fetch_and_sub(&ndepot, 1);
+            return b;
+            }
+        }
+    return 0;
+    } // End of function bmem::depot_pop.
+
+/*------------------------------------------------------------------------------
+bmem::take_batch() takes up to bmem_batch chunks from the free list, under the
+spin lock, and returns them as a list. A new block is made if the free list is
+empty. The number of chunks is returned in "n", which is 0 (with a null list)
+if a new block could not be allocated.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   bmem::take_batch   //
+//----------------------//
+char* bmem::take_batch(long& n) {
+    while (__sync_lock_test_and_set(&lock, 1))
+        while (lock)
+            ;
+    if (!free)
+        getnewblock();
+    char* b = free;
+    char* p = b;
+    n = 0;
+    if (!b) {
+        __sync_lock_release(&lock);
+        return 0;
+        }
+    n = 1;
+    while (n < bmem_batch && *(char**)p) {
+        p = *(char**)p;
+        n += 1;
+        }
+    free = *(char**)p;
     *(char**)p = 0;
-    } // End of function bmem::getnewblock.
+    __sync_lock_release(&lock);
+    return b;
+    } // End of function bmem::take_batch.
+
+/*------------------------------------------------------------------------------
+bmem::put_list() puts a list of chunks back on the free list, under the spin
+lock.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    bmem::put_list    //
+//----------------------//
+void bmem::put_list(char* b) {
+    if (!b)
+        return;
+    char* p = b;
+    while (*(char**)p)
+        p = *(char**)p;
+    while (__sync_lock_test_and_set(&lock, 1))
+        while (lock)
+            ;
+    *(char**)p = free;
+    free = b;
+    __sync_lock_release(&lock);
+    } // End of function bmem::put_list.
+
+//----------------------//
+//    bmem::flush_mag   //
+//----------------------//
+void bmem::flush_mag(bmem_mag* m) {
+    if (m->prev) {
+        depot_push(m->prev);
+        count_used(-bmem_batch);
+        }
+    put_list(m->cur);
+    count_used(-m->ncur);
+    m->cur = 0;
+    m->ncur = 0;
+    m->prev = 0;
+    } // End of function bmem::flush_mag.
+
+/*------------------------------------------------------------------------------
+bmem::newchunk_threaded() is the version of newchunk() which is used while
+bmem_threaded is set. A bmem without thread caches uses the spin lock instead.
+------------------------------------------------------------------------------*/
+//------------------------------//
+//    bmem::newchunk_threaded   //
+//------------------------------//
+void* bmem::newchunk_threaded() {
+    if (slot < 0)
+        return newchunk_locked();
+    bmem_mag* m = mag();
+    if (m->ncur == 0) {
+        if (m->prev) {
+            m->cur = m->prev;
+            m->ncur = bmem_batch;
+            m->prev = 0;
+            }
+        else {
+            if ((m->cur = depot_pop()) != 0)
+                m->ncur = bmem_batch;
+            else
+                m->cur = take_batch(m->ncur);
+            if (m->ncur == 0)
+                return 0;
+            count_used(m->ncur);
+            }
+        }
+    char* p = m->cur;
+    m->cur = *(char**)p;
+    m->ncur -= 1;
+    return p + BMEM_ALIGN;
+    } // End of function bmem::newchunk_threaded.
+
+/*------------------------------------------------------------------------------
+bmem::freechunk_threaded() is the version of freechunk() which is used while
+bmem_threaded is set. When the current list is full, it becomes the previous
+list, and the old previous list, if any, goes to the depot.
+------------------------------------------------------------------------------*/
+//------------------------------//
+//   bmem::freechunk_threaded   //
+//------------------------------//
+void bmem::freechunk_threaded(void* p) {
+    if (slot < 0) {
+        freechunk_locked(p);
+        return;
+        }
+    char* q = (char*)p - BMEM_ALIGN;
+    bmem_mag* m = mag();
+    if (m->ncur >= bmem_batch) {
+        if (m->prev) {
+            depot_push(m->prev);
+            count_used(-bmem_batch);
+            }
+        m->prev = m->cur;
+        m->cur = 0;
+        m->ncur = 0;
+        }
+    *(char**)q = m->cur;
+    m->cur = q;
+    m->ncur += 1;
+    } // End of function bmem::freechunk_threaded.
+
+/*------------------------------------------------------------------------------
+bmem::count_used() adds n to the number of chunks in use, which may be
+negative, and updates the high-water mark. It is called only while
+bmem_threaded is set, when chunks move between a thread and the bmem. The
+high-water mark may miss a value if two threads update it at once.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   bmem::count_used   //
+//----------------------//
+void bmem::count_used(long n) {
+    long u = __sync_add_and_fetch(&nused, n);
+    if (u > nhigh)
+        nhigh = u;
+    } // End of function bmem::count_used.
 
 //----------------------//
 //      bmem::print     //
@@ -159,57 +735,236 @@ void bmem::print() {
         cout << "0x" << hex8((long)p) << endl;
     } // End of function bmem::print.
 
+/*------------------------------------------------------------------------------
+bmem::print_stats() prints the owner, the chunk size, the chunks in use, the
+high-water mark, the chunks and blocks allocated, and the bytes allocated, on
+one line. The columns are as in bmem_dump().
+------------------------------------------------------------------------------*/
 //----------------------//
-//     bmem::length     //
+//   bmem::print_stats  //
 //----------------------//
-unsigned long bmem::length() {
-    // Calculate the number of free chunks:
-    unsigned long n = 0;
-    for (char** p = (char**)free; p; p = (char**)*p)
-        n += 1;
+void bmem::print_stats(ostream& os) const {
+    os.width(16);
+    os << (own ? own : "-") << " ";
+    os.width(7);
+    os << chunk_size() << " ";
+    os.width(10);
+    os << length() << " ";
+    os.width(10);
+    os << high_water() << " ";
+    os.width(10);
+    os << n_chunks() << " ";
+    os.width(6);
+    os << n_blocks() << " ";
+    os.width(11);
+    os << totbytes << NL;
+    } // End of function bmem::print_stats.
+
+/*------------------------------------------------------------------------------
+bmem_thread_flush() gives all chunks in the caches of the calling thread back
+to their bmems, and deletes the caches.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//     bmem_thread_flush    //
+//--------------------------//
+void bmem_thread_flush() {
+    for (int i = 0; i < bmem_nmags; ++i) {
+        bmem* pb = bmem_slots[i];
+        if (pb && bmem_mags[i].gen == pb->gen
+            && (bmem_mags[i].cur || bmem_mags[i].prev))
+            pb->flush_mag(&bmem_mags[i]);
+        }
+    delete[] bmem_mags;
+    bmem_mags = 0;
+    bmem_nmags = 0;
+    } // End of function bmem_thread_flush.
+
+/*------------------------------------------------------------------------------
+bmem_count() returns the number of places in the registry of bmems. Some of
+them may be empty, because their bmems have been deleted. (They are filled
+again by the next bmems to be constructed.)
+------------------------------------------------------------------------------*/
+//----------------------//
+//      bmem_count      //
+//----------------------//
+int bmem_count() {
+    int n = bmem_nslots;
+    return (n < bmem_max_slots) ? n : bmem_max_slots;
+    } // End of function bmem_count.
 
-    // Subtract the free chunks from the total chunks:
-    return nblocks * nchunks - n;
-    } // End of function bmem::length.
+//----------------------//
+//    bmem_registered   //
+//----------------------//
+bmem* bmem_registered(int i) {
+    if (i < 0 || i >= bmem_count())
+        return 0;
+    return bmem_slots[i];
+    } // End of function bmem_registered.
+
+//----------------------//
+//       bmem_find      //
+//----------------------//
+bmem* bmem_find(const char* owner) {
+    if (!owner)
+        return 0;
+    int n = bmem_count();
+    for (int i = 0; i < n; ++i) {
+        bmem* pb = bmem_slots[i];
+        if (pb && strcmpz(pb->owner(), owner) == 0)
+            return pb;
+        }
+    return 0;
+    } // End of function bmem_find.
+
+/*------------------------------------------------------------------------------
+bmem_dump() prints one line for each bmem in the registry which has allocated
+any blocks.
+------------------------------------------------------------------------------*/
+//----------------------//
+//       bmem_dump      //
+//----------------------//
+void bmem_dump(ostream& os) {
+    os << "           owner    size     in use high water     chunks"
+          " blocks       bytes\n";
+    int n = bmem_count();
+    for (int i = 0; i < n; ++i) {
+        bmem* pb = bmem_slots[i];
+        if (pb && pb->n_blocks() > 0)
+            pb->print_stats(os);
+        }
+    } // End of function bmem_dump.
+
+//----------------------//
+// bmem_safe::bmem_safe //
+//----------------------//
+bmem_safe::bmem_safe(long s, long n, memsrc_t ms, const char* o,
+        bmem_release_t r) : bmem(s, n, ms, o) {
+    blocks = 0;
+    idle = 0;
+    nfree = 0;
+    nidle = 0;
+    hiwater = 0;
+    keep = 0;
+    trigger = 0;
+    release = r;
+    nreleased = 0;
+    } // End of function bmem_safe::bmem_safe.
 
 /*------------------------------------------------------------------------------
-Same algorithm as s1list::~s1list().
+Same algorithm as s1list::~s1list(). The blocks are not freed.
 ------------------------------------------------------------------------------*/
 //----------------------//
 // bmem_safe::~bmem_safe//
 //----------------------//
 bmem_safe::~bmem_safe() {
-    // Delete the linked list of block-pointers.
+    // Delete the linked lists of block-pointers.
     for (register bmem_ptr* q = blocks; q; ) {
         register bmem_ptr* p = q->next;
         delete q;
         q = p;
         }
+    for (register bmem_ptr* q = idle; q; ) {
+        register bmem_ptr* p = q->next;
+        delete q;
+        q = p;
+        }
     } // End of function bmem_safe::~bmem_safe.
 
 /*------------------------------------------------------------------------------
-The parent class bmem::getnewblock() function is invoked when free == 0 to
-allocate and initialise a new block of free chunks, pointed to by "free".
-The bmem_safe::getnewblock() just records the new free block in the "blocks"
-list. The new item is prepended to the "blocks" list, not appended.
+bmem_safe::getnewblock() is invoked when free == 0. An idle block is used if
+there is one. Otherwise the parent class bmem::getnewblock() function is
+invoked to allocate and initialise a new block of free chunks, pointed to by
+"free", and the new block is recorded in the "blocks" list. The new item is
+prepended to the "blocks" list, not appended.
 ------------------------------------------------------------------------------*/
 //--------------------------//
 //  bmem_safe::getnewblock  //
 //--------------------------//
 void bmem_safe::getnewblock() {
-    // First do the standard getnewblock() function.
-    bmem::getnewblock();
+    bmem_ptr* p = idle;
+    if (p) {
+        // Re-use an idle block. Its pages are faulted in again.
+        idle = p->next;
+        nidle -= 1;
+        linkblock(p->block, p->nchunks);
+        nblocks += 1;
+        totchunks += p->nchunks;
+        totbytes += blockbytes(p->nchunks);
+        }
+    else {
+        // First do the standard getnewblock() function.
+        long n = totchunks;
+        bmem::getnewblock();
+        if (!free)
+            return;
+        p = new bmem_ptr(free, totchunks - n);
+        }
 
     // Then update the list of blocks.
-    bmem_ptr* p = new bmem_ptr(free);
     p->next = blocks;
     blocks = p;
+    nfree += p->nchunks;
+    trigger = hiwater;
     } // End of function bmem_safe::getnewblock.
 
 //----------------------//
-// bmem_safe::freechunk //
+//  bmem_safe::prefill  //
 //----------------------//
-void bmem_safe::freechunk(void* p) {
+void bmem_safe::prefill(long n) {
+    if (bmem_threaded)
+        while (__sync_lock_test_and_set(&lock, 1))
+            while (lock)
+                ;
+    if (n > totchunks) {
+        long k = n - totchunks;
+        char* b = newblock(k, 1);
+        if (b) {
+            bmem_ptr* p = new bmem_ptr(b, k);
+            p->next = blocks;
+            blocks = p;
+            nfree += k;
+            }
+        }
+    if (bmem_threaded)
+        __sync_lock_release(&lock);
+    } // End of function bmem_safe::prefill.
+
+/*------------------------------------------------------------------------------
+bmem_safe::newchunk_threaded() is the same as bmem_safe::newchunk(), except
+that it holds the spin lock of the bmem while the free list is modified.
+------------------------------------------------------------------------------*/
+//------------------------------//
+// bmem_safe::newchunk_threaded //
+//------------------------------//
+void* bmem_safe::newchunk_threaded() {
+    while (__sync_lock_test_and_set(&lock, 1))
+        while (lock)
+            ;
+    if (!free)
+        getnewblock();
+    char* p = free;
+    if (!p) {
+        __sync_lock_release(&lock);
+        return 0;
+        }
+    free = *(char**)p;
+    nfree -= 1;
+    if (++nused > nhigh)
+        nhigh = nused;
+    *(char**)p = (char*)1;
+    __sync_lock_release(&lock);
+    return p + BMEM_ALIGN;
+    } // End of function bmem_safe::newchunk_threaded.
+
+/*------------------------------------------------------------------------------
+bmem_safe::freechunk_unlocked() checks the chunk, puts it on the free list, and
+calls reclaim_locked() if the watermark is exceeded. The caller holds the lock
+if bmem_threaded is set.
+------------------------------------------------------------------------------*/
+//------------------------------//
+//bmem_safe::freechunk_unlocked //
+//------------------------------//
+void bmem_safe::freechunk_unlocked(void* p) {
     p = (char*)p - BMEM_ALIGN;
 
     // Check that the chunk is really in the allocated memory list.
@@ -218,11 +973,203 @@ void bmem_safe::freechunk(void* p) {
         cerr << "<<error: bmem_safe::freechunk non-allocated chunk>>\n";
         return;
         }
-
-    // Here should also check that the chunk is within one of the
-    // allocated blocks of chunks. Use "blocks" to do this.
-    // ....
-
     *(char**)p = free;
     free = (char*)p;
+    nfree += 1;
+    nused -= 1;
+
+    // Reclaim the free blocks if there are too many free chunks.
+    if (hiwater > 0 && nfree > trigger) {
+        reclaim_locked(keep);
+        long t = nfree + (hiwater - keep);
+        trigger = (t > hiwater) ? t : hiwater;
+        }
+    } // End of function bmem_safe::freechunk_unlocked.
+
+//----------------------//
+// bmem_safe::freechunk //
+//----------------------//
+void bmem_safe::freechunk(void* p) {
+    if (!bmem_threaded) {
+        freechunk_unlocked(p);
+        return;
+        }
+    while (__sync_lock_test_and_set(&lock, 1))
+        while (lock)
+            ;
+    freechunk_unlocked(p);
+    __sync_lock_release(&lock);
     } // End of function bmem_safe::freechunk.
+
+/*------------------------------------------------------------------------------
+bmem_safe::set_watermark() sets the number of free chunks above which
+freechunk() calls reclaim(keep0). If hi is not positive, reclaim() is only
+called by the user. The value of keep0 is reduced to hi / 2 if it is not less
+than hi.
+------------------------------------------------------------------------------*/
+//--------------------------//
+// bmem_safe::set_watermark //
+//--------------------------//
+void bmem_safe::set_watermark(long hi, long keep0) {
+    if (hi < 0)
+        hi = 0;
+    if (keep0 < 0)
+        keep0 = 0;
+    if (keep0 >= hi)
+        keep0 = hi / 2;
+    hiwater = hi;
+    keep = keep0;
+    trigger = hi;
+    } // End of function bmem_safe::set_watermark.
+
+/*------------------------------------------------------------------------------
+bmem_safe::release_block() gives the memory of a block back to the system. For
+brMADVISE, only the whole pages inside the block are released, and the block
+is put on the idle list. (If madvise() is not available, the block is freed.)
+------------------------------------------------------------------------------*/
+//--------------------------//
+// bmem_safe::release_block //
+//--------------------------//
+void bmem_safe::release_block(bmem_ptr* p) {
+#if BMEM_MMAP
+    if (release == brMADVISE) {
+        unsigned long pg = (unsigned long)bmem_page_size();
+        unsigned long a = ((unsigned long)p->block + pg - 1) & ~(pg - 1);
+        unsigned long b = ((unsigned long)p->block + blockbytes(p->nchunks))
+                          & ~(pg - 1);
+        if (a < b)
+            madvise((char*)a, b - a, MADV_DONTNEED);
+        p->next = idle;
+        idle = p;
+        nidle += 1;
+        return;
+        }
+#endif
+    freeblock(p->block, blockbytes(p->nchunks));
+    delete p;
+    } // End of function bmem_safe::release_block.
+
+/*------------------------------------------------------------------------------
+bmem_block_cmp() compares two bmem_ptrs by block address, for qsort().
+------------------------------------------------------------------------------*/
+//----------------------//
+//    bmem_block_cmp    //
+//----------------------//
+static int bmem_block_cmp(const void* x, const void* y) {
+    const char* a = (*(const bmem_ptr* const*)x)->block;
+    const char* b = (*(const bmem_ptr* const*)y)->block;
+    return (a < b) ? -1 : (a > b) ? 1 : 0;
+    } // End of function bmem_block_cmp.
+
+//----------------------//
+//    bmem_block_find   //
+//----------------------//
+static long bmem_block_find(bmem_ptr** v, long n, const char* p) {
+    // Find the last block which starts at or before p.
+    long lo = 0;
+    long hi = n;
+    while (hi - lo > 1) {
+        long mid = (lo + hi) / 2;
+        if (v[mid]->block <= p)
+            lo = mid;
+        else
+            hi = mid;
+        }
+    return lo;
+    } // End of function bmem_block_find.
+
+/*------------------------------------------------------------------------------
+bmem_safe::reclaim_locked() is the same as bmem_safe::reclaim(), except that
+the caller holds the lock if bmem_threaded is set.
+The free chunks are counted in each block. Then the chunks of the fully free
+blocks are removed from the free list, keeping the order of the other chunks,
+and the blocks are released, while at least keep0 free chunks remain.
+------------------------------------------------------------------------------*/
+//------------------------------//
+//   bmem_safe::reclaim_locked  //
+//------------------------------//
+long bmem_safe::reclaim_locked(long keep0) {
+    if (nfree <= keep0)
+        return 0;
+
+    // Sort the blocks by address, and count the free chunks in each block.
+    long nb = 0;
+    bmem_ptr* p = 0;
+    for (p = blocks; p; p = p->next)
+        nb += 1;
+    if (nb == 0)
+        return 0;
+    bmem_ptr** v = new bmem_ptr*[nb];
+    long i = 0;
+    for (p = blocks; p; p = p->next) {
+        p->count = 0;
+        v[i++] = p;
+        }
+    qsort(v, nb, sizeof(bmem_ptr*), bmem_block_cmp);
+    char* q = 0;
+    for (q = free; q; q = *(char**)q)
+        v[bmem_block_find(v, nb, q)]->count += 1;
+
+    // Mark the blocks to be released with a count of -1.
+    long nrel = 0;
+    long n = nfree;
+    long nc = 0;
+    for (i = 0; i < nb; ++i)
+        if (v[i]->count == v[i]->nchunks && n - v[i]->nchunks >= keep0) {
+            v[i]->count = -1;
+            n -= v[i]->nchunks;
+            nc += v[i]->nchunks;
+            nrel += 1;
+            }
+    if (nrel == 0) {
+        delete[] v;
+        return 0;
+        }
+
+    // Remove the chunks of the marked blocks from the free list.
+    char* head = 0;
+    char** tail = &head;
+    for (q = free; q; ) {
+        char* q2 = *(char**)q;
+        if (v[bmem_block_find(v, nb, q)]->count >= 0) {
+            *tail = q;
+            tail = (char**)q;
+            }
+        q = q2;
+        }
+    *tail = 0;
+    free = head;
+    nfree = n;
+    nblocks -= nrel;
+    totchunks -= nc;
+    nreleased += nrel;
+
+    // Remove the marked blocks from the list of blocks, and release them.
+    blocks = 0;
+    for (i = nb; --i >= 0; ) {
+        if (v[i]->count < 0) {
+            totbytes -= blockbytes(v[i]->nchunks);
+            release_block(v[i]);
+            }
+        else {
+            v[i]->next = blocks;
+            blocks = v[i];
+            }
+        }
+    delete[] v;
+    return nrel;
+    } // End of function bmem_safe::reclaim_locked.
+
+//----------------------//
+//  bmem_safe::reclaim  //
+//----------------------//
+long bmem_safe::reclaim(long keep0) {
+    if (!bmem_threaded)
+        return reclaim_locked(keep0);
+    while (__sync_lock_test_and_set(&lock, 1))
+        while (lock)
+            ;
+    long nrel = reclaim_locked(keep0);
+    __sync_lock_release(&lock);
+    return nrel;
+    } // End of function bmem_safe::reclaim.
@@ -80,7 +80,7 @@ negative. Any previous array found in "coded" is always deleted.
 //----------------------//
 int frame8::encode(uint8 sync_byte) {
     n_coded = 0;
-    delete[] coded;
+    szbuf_delete(coded);
     coded = 0;
     if (LI > frame8_max_LI || (LI > 0 && !payload))
         return -1;
@@ -88,7 +88,7 @@ int frame8::encode(uint8 sync_byte) {
     // frame8 length: sync(1) + opcode(1) + arg/LI(2) + HCS(2)
     //                        + payload + DCS(4):
     n_coded = frame8_hdr_size + LI + frame8_dcs_size;
-    char* pc2 = coded = new char[n_coded];
+    char* pc2 = coded = szbuf_new(n_coded);
 
     // Encode the PDU:
     *pc2++ = sync_byte;
@@ -197,7 +197,7 @@ frame8* f8stream::decode(const char* bytes, int n_bytes) {
                     pm1->opcode = buf[1];
                     pm1->arg = (buf[2] >> 4) & 0x0f;
                     pm1->LI = LI;
-                    pm1->payload = new char[LI];
+                    pm1->payload = szbuf_new(LI);
                     memcpy(pm1->payload, buf + 5, LI);
                     // Note: The coded version could be copied into the frame8
                     // structure at this point, if this would be useful.
@@ -278,14 +278,14 @@ negative. Any previous array found in "coded" is always deleted.
 //----------------------//
 int frame32::encode(uint8 sync_byte) {
     n_coded = 0;
-    delete[] coded;
+    szbuf_delete(coded);
     coded = 0;
     if (LI > frame32_max_LI || (LI > 0 && !payload))
         return -1;
 
     // frame32 length: sync(1), opcode(1), arg/LI(2), HCS(2), payload, DCS(4):
     n_coded = frame32_hdr_size + LI + frame32_dcs_size;
-    char* pc2 = coded = new char[n_coded];
+    char* pc2 = coded = szbuf_new(n_coded);
 
     // Encode the PDU:
     *pc2++ = sync_byte;
@@ -407,7 +407,7 @@ frame32* f32stream::decode(const char* bytes, int n_bytes) {
                     pm1->opcode = buf[1];
                     pm1->arg = (buf[2] >> 6) & 0x03;
                     pm1->LI = LI;
-                    pm1->payload = new char[LI];
+                    pm1->payload = szbuf_new(LI);
                     memcpy(pm1->payload, buf + frame32_hdr_size, LI);
                     // Note: The coded version could be copied into the frame32
                     // structure at this point, if this would be useful.
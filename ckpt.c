@@ -0,0 +1,843 @@
+// src/aksl/ckpt.c   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+/*------------------------------------------------------------------------------
+Functions in this file:
+
+ckpt_ptrmap::
+    append
+    sort
+    find
+ckpt_writer::
+    reserve
+    put_bytes
+    put_uint
+    put_string
+    put_object
+    put_event
+    put_value
+    put_payload
+    write
+ckpt_reader::
+    open
+    close
+    get_bytes
+    get_uint
+    get_string
+    get_object
+    get_event
+    get_value
+    get_payload
+systm::
+    checkpoint
+    restore
+------------------------------------------------------------------------------*/
+
+#include "aksl/ckpt.h"
+#ifndef AKSL_ERROR_H
+#include "aksl/error.h"
+#endif
+#ifndef AKSL_NEWSTR_H
+#include "aksl/newstr.h"
+#endif
+#ifndef AKSL_RNDM_H
+#include "aksl/rndm.h"
+#endif
+
+// System header files.
+#ifndef AKSL_X_STRING_H
+#define AKSL_X_STRING_H
+#include <string.h>
+#endif
+#ifndef AKSL_X_STDLIB_H
+#define AKSL_X_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifndef WIN32
+#ifndef AKSL_X_SYS_MMAN_H
+#define AKSL_X_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#ifndef AKSL_X_SYS_STAT_H
+#define AKSL_X_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifndef AKSL_X_FCNTL_H
+#define AKSL_X_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifndef AKSL_X_UNISTD_H
+#define AKSL_X_UNISTD_H
+#include <unistd.h>
+#endif
+#endif
+
+// The first bytes of a checkpoint file.
+static const char ckpt_magic[8] = { 'A', 'K', 'S', 'L', 'C', 'K', 'P', 'T' };
+
+// A native-order integer, for checking the byte order of the file.
+static const unsigned int ckpt_byte_order = 0x01020304;
+
+//----------------------//
+//  ckpt_ptrmap::append //
+//----------------------//
+void ckpt_ptrmap::append(const void* ptr) {
+    if (n >= size) {
+        long newsize = size ? 2 * size : 64;
+        entry* v2 = new entry[newsize];
+        for (long i = 0; i < n; ++i)
+            v2[i] = v[i];
+        delete[] v;
+        v = v2;
+        size = newsize;
+        }
+    v[n].p = ptr;
+    v[n].i = n;
+    n += 1;
+    } // End of function ckpt_ptrmap::append.
+
+//----------------------//
+//   ckpt_ptrmap_cmp    //
+//----------------------//
+static int ckpt_ptrmap_cmp(const void* a, const void* b) {
+    const void* pa = ((const ckpt_ptrmap::entry*)a)->p;
+    const void* pb = ((const ckpt_ptrmap::entry*)b)->p;
+    return (pa < pb) ? -1 : (pa > pb) ? 1 : 0;
+    } // End of function ckpt_ptrmap_cmp.
+
+//----------------------//
+//   ckpt_ptrmap::sort  //
+//----------------------//
+void ckpt_ptrmap::sort() {
+    if (n > 1)
+        qsort(v, n, sizeof(entry), ckpt_ptrmap_cmp);
+    } // End of function ckpt_ptrmap::sort.
+
+/*------------------------------------------------------------------------------
+ckpt_ptrmap::find() returns the index of a pointer by binary search, or -1 if
+the pointer is not in the map.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   ckpt_ptrmap::find  //
+//----------------------//
+long ckpt_ptrmap::find(const void* ptr) const {
+    long lo = 0;
+    long hi = n;
+    while (lo < hi) {
+        long mid = (lo + hi) / 2;
+        if (v[mid].p < ptr)
+            lo = mid + 1;
+        else
+            hi = mid;
+        }
+    return (lo < n && v[lo].p == ptr) ? v[lo].i : -1;
+    } // End of function ckpt_ptrmap::find.
+
+//----------------------//
+// ckpt_writer::reserve //
+//----------------------//
+void ckpt_writer::reserve(unsigned long k) {
+    if (n + k <= size)
+        return;
+    unsigned long newsize = size ? 2 * size : 4096;
+    while (newsize < n + k)
+        newsize *= 2;
+    unsigned char* buf2 = new unsigned char[newsize];
+    if (n > 0)
+        memcpy(buf2, buf, n);
+    delete[] buf;
+    buf = buf2;
+    size = newsize;
+    } // End of function ckpt_writer::reserve.
+
+//--------------------------//
+//  ckpt_writer::put_bytes  //
+//--------------------------//
+void ckpt_writer::put_bytes(const void* x, unsigned long k) {
+    reserve(k);
+    memcpy(buf + n, x, k);
+    n += k;
+    } // End of function ckpt_writer::put_bytes.
+
+/*------------------------------------------------------------------------------
+ckpt_writer::put_uint() writes an integer as a varint. That is, 7 bits per byte,
+least significant first, with the top bit set in all bytes except the last.
+------------------------------------------------------------------------------*/
+//----------------------//
+// ckpt_writer::put_uint //
+//----------------------//
+void ckpt_writer::put_uint(unsigned long long x) {
+    reserve(10);
+    while (x >= 0x80) {
+        buf[n++] = (unsigned char)(x | 0x80);
+        x >>= 7;
+        }
+    buf[n++] = (unsigned char)x;
+    } // End of function ckpt_writer::put_uint.
+
+/*------------------------------------------------------------------------------
+A string is written as its length plus 1, followed by the characters and a
+terminating null character. The null pointer is written as length 0.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//  ckpt_writer::put_string //
+//--------------------------//
+void ckpt_writer::put_string(const char* s) {
+    if (!s) {
+        put_uint(0);
+        return;
+        }
+    unsigned long k = strlen(s);
+    put_uint(k + 1);
+    put_bytes(s, k + 1);
+    } // End of function ckpt_writer::put_string.
+
+/*------------------------------------------------------------------------------
+An object pointer is written as the index of the object plus 1, or 0 for the
+null pointer.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//  ckpt_writer::put_object //
+//--------------------------//
+void ckpt_writer::put_object(object* po) {
+    if (!po) {
+        put_uint(0);
+        return;
+        }
+    long i = objs.find(po);
+    if (i < 0) {
+        fail(eCHECKPOINT_ERROR);
+        i = 0;
+        }
+    put_uint(i + 1);
+    } // End of function ckpt_writer::put_object.
+
+/*------------------------------------------------------------------------------
+An event pointer is written as the index of the event plus 1. The null pointer,
+and pointers to events which are not in the FEL, are written as 0.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//  ckpt_writer::put_event  //
+//--------------------------//
+void ckpt_writer::put_event(event* pe) {
+    long i = pe ? evts.find(pe) : -1;
+    put_uint(i + 1);
+    } // End of function ckpt_writer::put_event.
+
+/*------------------------------------------------------------------------------
+A value is written as its type plus 1, followed by its contents. The null
+pointer is written as 0. A datum is written by owner->write_datum().
+------------------------------------------------------------------------------*/
+//--------------------------//
+//  ckpt_writer::put_value  //
+//--------------------------//
+void ckpt_writer::put_value(value* pv, object* owner) {
+    if (!pv) {
+        put_uint(0);
+        return;
+        }
+    Vtype ty = pv->type();
+    put_uint(ty + 1);
+    switch (ty) {
+    case vINTEGER:
+        put_int((long)*pv);
+        break;
+    case vREAL:
+        put_real((double)*pv);
+        break;
+    case vSTRING:
+        put_string((const char*)*pv);
+        break;
+    case vOBJECT:
+        put_object((object*)*pv);
+        break;
+    case vDATUM: {
+        int e = owner ? owner->write_datum(*this, (datum*)*pv)
+                      : eNOT_SERIALISABLE;
+        if (e < 0)
+            fail(e);
+        }
+        break;
+    case vLIST: {
+        valuelist* pl = *pv;
+        put_uint(pl ? pl->length() : 0);
+        if (pl)
+            for (value* p = pl->first(); p; p = p->next())
+                put_value(p, owner);
+        }
+        break;
+    case vTVLIST: {
+        tagvaluelist* pl = *pv;
+        put_uint(pl ? pl->length() : 0);
+        if (pl)
+            for (tagvalue* p = pl->first(); p; p = p->next()) {
+                put_int(p->tag);
+                put_value(p, owner);
+                }
+        }
+        break;
+    case vCOLONLIST: {
+        colonlist* pl = *pv;
+        put_uint(pl ? pl->length() : 0);
+        if (pl)
+            for (value* p = pl->first(); p; p = p->next())
+                put_value(p, owner);
+        }
+        break;
+    case vNONE:
+    default:
+        break;
+        }
+    } // End of function ckpt_writer::put_value.
+
+//--------------------------//
+// ckpt_writer::put_payload //
+//--------------------------//
+void ckpt_writer::put_payload(const payload& x, object* owner) {
+    Ptype ty = x.type();
+    put_uint(ty);
+    switch (ty) {
+    case pINTEGER:
+        put_int((long)x);
+        break;
+    case pREAL:
+        put_real((double)x);
+        break;
+    case pOBJECT:
+        put_object((object*)x);
+        break;
+    case pDATUM: {
+        int e = owner ? owner->write_datum(*this, (datum*)x)
+                      : eNOT_SERIALISABLE;
+        if (e < 0)
+            fail(e);
+        }
+        break;
+    case pVALUE:
+        put_value(x.value_ptr(), owner);
+        break;
+    case pNONE:
+    default:
+        break;
+        }
+    } // End of function ckpt_writer::put_payload.
+
+/*------------------------------------------------------------------------------
+ckpt_writer::write() writes the checkpoint to a temporary file, which is then
+renamed to the given path.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  ckpt_writer::write  //
+//----------------------//
+int ckpt_writer::write(const char* path) {
+    if (err)
+        return err;
+    if (!path || !*path)
+        return eNULL_FILE_NAME;
+    char* tmp = new char[strlen(path) + 5];
+    strcpy(tmp, path);
+    strcat(tmp, ".tmp");
+    FILE* fp = fopen(tmp, "wb");
+    if (!fp) {
+        delete[] tmp;
+        return eFILE_OPEN_FAILED;
+        }
+    bool_enum ok = (bool_enum)(fwrite(buf, 1, n, fp) == n);
+    if (fclose(fp) != 0)
+        ok = false;
+    if (!ok || rename(tmp, path) != 0) {
+        remove(tmp);
+        delete[] tmp;
+        return eCHECKPOINT_ERROR;
+        }
+    delete[] tmp;
+    return 0;
+    } // End of function ckpt_writer::write.
+
+/*------------------------------------------------------------------------------
+ckpt_reader::open() maps the file into memory. If the file cannot be mapped, it
+is read into a buffer instead.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   ckpt_reader::open  //
+//----------------------//
+int ckpt_reader::open(const char* path) {
+    close();
+    if (!path || !*path)
+        return eNULL_FILE_NAME;
+#ifndef WIN32
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return eFILE_OPEN_FAILED;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* m = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m != MAP_FAILED) {
+            ::close(fd);
+            base = (const unsigned char*)m;
+            len = st.st_size;
+            mapped = true;
+            p = base;
+            end = base + len;
+            return 0;
+            }
+        }
+    ::close(fd);
+#endif
+
+    // Read the file into a buffer.
+    FILE* fp = fopen(path, "rb");
+    if (!fp)
+        return eFILE_OPEN_FAILED;
+    unsigned long bufsize = 65536;
+    unsigned char* b = new unsigned char[bufsize];
+    unsigned long k;
+    while ((k = fread(b + len, 1, bufsize - len, fp)) > 0) {
+        len += k;
+        if (len == bufsize) {
+            unsigned char* b2 = new unsigned char[2 * bufsize];
+            memcpy(b2, b, len);
+            delete[] b;
+            b = b2;
+            bufsize *= 2;
+            }
+        }
+    fclose(fp);
+    base = b;
+    p = base;
+    end = base + len;
+    return 0;
+    } // End of function ckpt_reader::open.
+
+//----------------------//
+//  ckpt_reader::close  //
+//----------------------//
+void ckpt_reader::close() {
+    if (base) {
+#ifndef WIN32
+        if (mapped)
+            munmap((void*)base, len);
+        else
+#endif
+            delete[] (unsigned char*)base;
+        }
+    base = p = end = 0;
+    len = 0;
+    mapped = false;
+    delete[] evts;
+    evts = 0;
+    nevts = 0;
+    } // End of function ckpt_reader::close.
+
+//--------------------------//
+//  ckpt_reader::get_bytes  //
+//--------------------------//
+void ckpt_reader::get_bytes(void* x, unsigned long k) {
+    if ((unsigned long)(end - p) < k) {
+        fail(eCHECKPOINT_ERROR);
+        memset(x, 0, k);
+        p = end;
+        return;
+        }
+    memcpy(x, p, k);
+    p += k;
+    } // End of function ckpt_reader::get_bytes.
+
+//----------------------//
+// ckpt_reader::get_uint //
+//----------------------//
+unsigned long long ckpt_reader::get_uint() {
+    unsigned long long x = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p >= end) {
+            fail(eCHECKPOINT_ERROR);
+            return 0;
+            }
+        unsigned char c = *p++;
+        x |= (unsigned long long)(c & 0x7f) << shift;
+        if (!(c & 0x80))
+            return x;
+        }
+    fail(eCHECKPOINT_ERROR);
+    return 0;
+    } // End of function ckpt_reader::get_uint.
+
+/*------------------------------------------------------------------------------
+ckpt_reader::get_string() returns a pointer to the string in the file, which is
+valid until the reader is closed. The caller must copy the string if it is to
+be kept.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//  ckpt_reader::get_string //
+//--------------------------//
+const char* ckpt_reader::get_string() {
+    unsigned long long k = get_uint();
+    if (k == 0)
+        return 0;
+    if ((unsigned long long)(end - p) < k || p[k - 1] != 0) {
+        fail(eCHECKPOINT_ERROR);
+        p = end;
+        return 0;
+        }
+    const char* s = (const char*)p;
+    p += k;
+    return s;
+    } // End of function ckpt_reader::get_string.
+
+//--------------------------//
+//  ckpt_reader::get_object //
+//--------------------------//
+object* ckpt_reader::get_object() {
+    unsigned long long i = get_uint();
+    if (i == 0)
+        return 0;
+    if (i > (unsigned long long)nobjs) {
+        fail(eCHECKPOINT_ERROR);
+        return 0;
+        }
+    return objs[i - 1];
+    } // End of function ckpt_reader::get_object.
+
+//--------------------------//
+//  ckpt_reader::get_event  //
+//--------------------------//
+event* ckpt_reader::get_event() {
+    unsigned long long i = get_uint();
+    if (i == 0)
+        return 0;
+    if (i > (unsigned long long)nevts) {
+        fail(eCHECKPOINT_ERROR);
+        return 0;
+        }
+    return evts[i - 1];
+    } // End of function ckpt_reader::get_event.
+
+/*------------------------------------------------------------------------------
+ckpt_reader::get_value() reads a value written by ckpt_writer::put_value().
+Strings and lists are newly allocated.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//  ckpt_reader::get_value  //
+//--------------------------//
+value* ckpt_reader::get_value(object* owner) {
+    unsigned long long ty = get_uint();
+    if (ty == 0)
+        return 0;
+    value* pv = (ty == vTVLIST + 1) ? 0 : new value;
+    switch (ty - 1) {
+    case vINTEGER:
+        *pv = (long)get_int();
+        break;
+    case vREAL:
+        *pv = get_real();
+        break;
+    case vSTRING:
+        *pv = new_strcpy(get_string());
+        break;
+    case vOBJECT:
+        *pv = get_object();
+        break;
+    case vDATUM:
+        *pv = owner ? owner->read_datum(*this) : (datum*)0;
+        if (!owner)
+            fail(eNOT_SERIALISABLE);
+        break;
+    case vLIST: {
+        valuelist* pl = new valuelist;
+        for (unsigned long long k = get_uint(); k > 0 && !err; --k) {
+            value* p = get_value(owner);
+            pl->append(p ? p : new value);
+            }
+        *pv = pl;
+        }
+        break;
+    case vTVLIST: {
+        pv = new value;
+        tagvaluelist* pl = new tagvaluelist;
+        for (unsigned long long k = get_uint(); k > 0 && !err; --k) {
+            tagvalue* ptv = new tagvalue;
+            ptv->tag = (mtype)get_int();
+            value* p = get_value(owner);
+            if (p) {
+                p->copyto(*ptv);
+                delete p;
+                }
+            pl->append(ptv);
+            }
+        *pv = pl;
+        }
+        break;
+    case vCOLONLIST: {
+        colonlist* pl = new colonlist;
+        for (unsigned long long k = get_uint(); k > 0 && !err; --k) {
+            value* p = get_value(owner);
+            pl->append(p ? p : new value);
+            }
+        *pv = pl;
+        }
+        break;
+    case vNONE:
+        break;
+    default:
+        fail(eCHECKPOINT_ERROR);
+        break;
+        }
+    return pv;
+    } // End of function ckpt_reader::get_value.
+
+//--------------------------//
+// ckpt_reader::get_payload //
+//--------------------------//
+payload ckpt_reader::get_payload(object* owner) {
+    payload x;
+    switch (get_uint()) {
+    case pINTEGER:
+        x = (long)get_int();
+        break;
+    case pREAL:
+        x = get_real();
+        break;
+    case pOBJECT:
+        x = get_object();
+        break;
+    case pDATUM:
+        x = owner ? owner->read_datum(*this) : (datum*)0;
+        if (!owner)
+            fail(eNOT_SERIALISABLE);
+        break;
+    case pVALUE:
+        x = get_value(owner);
+        break;
+    case pNONE:
+        break;
+    default:
+        fail(eCHECKPOINT_ERROR);
+        break;
+        }
+    return x;
+    } // End of function ckpt_reader::get_payload.
+
+/*------------------------------------------------------------------------------
+systm::checkpoint() writes the state of the system to a file. It must not be
+called while an event is being simulated, nor for a partition of a parallel
+simulation. The events of the FEL are written in dequeueing order. To find this
+order, they are extracted and then re-inserted in the same order. Cancelled
+events are deleted, as they would be when dequeued.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+The file contains, in this order: the header, the model and object checks, the
+clock, the random number stream, the global variables, the events, the broadcast
+subscriptions, and the states of the objects.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   systm::checkpoint  //
+//----------------------//
+int systm::checkpoint(const char* path) {
+    if (par || parent)
+        return eBAD_ARGUMENT;
+    ckpt_writer w;
+
+    // Header.
+    w.put_bytes(ckpt_magic, sizeof(ckpt_magic));
+    w.put_bytes(&ckpt_byte_order, sizeof(ckpt_byte_order));
+    w.put_uint(ckpt_version);
+
+    // Model and objects, to be checked by restore().
+    w.put_uint(mdl ? mdl->cs_mtypenames.length() : 0);
+    w.put_uint(objects.length());
+    object* po = 0;
+    forall(po, objects) {
+        w.objs.append(po);
+        w.put_string(po->type());
+        w.put_string(po->name.read());
+        w.put_uint(po->nsent);
+        }
+    w.objs.sort();
+
+    w.put_real(clck);
+    w.put_uint(depth);
+    if (rndm_current) {
+        unsigned long long s, i;
+        rndm_current->get_state(s, i);
+        w.put_uint(1);
+        w.put_uint(s);
+        w.put_uint(i);
+        }
+    else
+        w.put_uint(0);
+
+    // Global variables.
+    globvarlist& gv = gvars();
+    w.put_uint(gv.length());
+    for (globvar* pg = gv.first(); pg; pg = pg->next()) {
+        w.put_string(pg->name.read());
+        w.put_value(pg->val);
+        }
+
+    // The events, in dequeueing order.
+    unsigned long nev = events.length();
+    event** ev = new event*[nev + 1];
+    unsigned long k = 0;
+    event* pe;
+    while ((pe = events.popfirst()) != 0) {
+        if (pe->origin())
+            ev[k++] = pe;
+        else
+            delete pe;
+        }
+    for (unsigned long j = 0; j < k; ++j) {
+        events.insert(ev[j]);
+        w.evts.append(ev[j]);
+        }
+    w.evts.sort();
+    w.put_uint(k);
+    for (unsigned long j = 0; j < k; ++j) {
+        pe = ev[j];
+        w.put_real(pe->time());
+        w.put_object(pe->orig);
+        w.put_object(pe->dest);
+        w.put_uint(pe->mty);
+        w.put_uint((unsigned short)pe->prio);
+        w.put_uint(pe->depth);
+        w.put_uint(pe->seq);
+        w.put_payload(pe->arg, pe->dest ? pe->dest : pe->orig);
+        }
+    delete[] ev;
+
+    // Broadcast subscriptions.
+    w.put_uint(nsubscribers > 0 ? nsubs : 0);
+    for (unsigned int m = 0; nsubscribers > 0 && m < nsubs; ++m) {
+        w.put_uint(subs[m].n);
+        for (unsigned int j = 0; j < subs[m].n; ++j)
+            w.put_object(subs[m].v[j]);
+        }
+
+    // The states of the objects. Each is followed by its index, as a check.
+    long i = 0;
+    forall(po, objects) {
+        int err = po->write_state(w);
+        if (err < 0)
+            w.fail(err);
+        w.put_uint(i++);
+        }
+    return w.write(path);
+    } // End of function systm::checkpoint.
+
+/*------------------------------------------------------------------------------
+systm::restore() reads a checkpoint written by systm::checkpoint(). The system
+must have the same model and the same objects (types and names) in the same
+order. Any events in the FEL are deleted. The objects are not initialised. If
+an error is returned, the state of the system is undefined.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    systm::restore    //
+//----------------------//
+int systm::restore(const char* path) {
+    if (par || parent)
+        return eBAD_ARGUMENT;
+    ckpt_reader r;
+    int err = r.open(path);
+    if (err < 0)
+        return err;
+
+    // Header.
+    char magic[sizeof(ckpt_magic)];
+    unsigned int order = 0;
+    r.get_bytes(magic, sizeof(magic));
+    r.get_bytes(&order, sizeof(order));
+    if (r.err || memcmp(magic, ckpt_magic, sizeof(magic)) != 0
+        || order != ckpt_byte_order || r.get_uint() != ckpt_version)
+        return eCHECKPOINT_ERROR;
+
+    // Model and objects.
+    if (r.get_uint()
+            != (unsigned long long)(mdl ? mdl->cs_mtypenames.length() : 0)
+        || r.get_uint() != (unsigned long long)objects.length())
+        return r.err ? r.err : eCHECKPOINT_MISMATCH;
+    r.nobjs = objects.length();
+    r.objs = new object*[r.nobjs];
+    long i = 0;
+    object* po = 0;
+    forall(po, objects) {
+        r.objs[i++] = po;
+        const char* t = r.get_string();
+        const char* nm = r.get_string();
+        if (strcmpz(t, po->type()) != 0 || strcmpz(nm, po->name.read()) != 0) {
+            delete[] r.objs;
+            return r.err ? r.err : eCHECKPOINT_MISMATCH;
+            }
+        po->nsent = r.get_uint();
+        }
+
+    clck = r.get_real();
+    depth = (unsigned short)r.get_uint();
+    if (r.get_uint()) {
+        unsigned long long s = r.get_uint();
+        unsigned long long inc = r.get_uint();
+        if (rndm_current)
+            rndm_current->set_state(s, inc);
+        }
+
+    // Global variables.
+    globvarlist& gv = gvars();
+    gv.clear();
+    for (unsigned long long k = r.get_uint(); k > 0 && !r.err; --k) {
+        c_string name(r.get_string());
+        gv.set(name, r.get_value());
+        }
+
+    // The events.
+    events.clear();
+    if (fel_hint > 0)
+        events.reserve(fel_hint);
+    r.nevts = (long)r.get_uint();
+    if (r.err || r.nevts < 0 || (unsigned long)r.nevts > r.len) {
+        delete[] r.objs;
+        return eCHECKPOINT_ERROR;
+        }
+    r.evts = new event*[r.nevts + 1];
+    for (long j = 0; j < r.nevts; ++j) {
+        double t = r.get_real();
+        object* orig = r.get_object();
+        object* dest = r.get_object();
+        mtype m = (mtype)r.get_uint();
+        event* pe = new event(t, orig, dest, m);
+        pe->prio = (short)(unsigned short)r.get_uint();
+        pe->depth = (unsigned short)r.get_uint();
+        pe->seq = r.get_uint();
+        pe->arg = r.get_payload(dest ? dest : orig);
+        r.evts[j] = pe;
+        if (!orig)
+            r.fail(eCHECKPOINT_ERROR);
+        }
+    for (long j = 0; j < r.nevts; ++j)
+        events.insert(r.evts[j]);
+
+    // Broadcast subscriptions.
+    clear_subscriptions();
+    unsigned long long ns = r.get_uint();
+    for (unsigned long long m = 0; m < ns && !r.err; ++m)
+        for (unsigned long long k = r.get_uint(); k > 0 && !r.err; --k) {
+            po = r.get_object();
+            if (po)
+                subscribe(po, (mtype)m);
+            }
+
+    // The states of the objects.
+    i = 0;
+    forall(po, objects) {
+        if (r.err)
+            break;
+        if ((err = po->read_state(r)) < 0)
+            r.fail(err);
+        if (r.get_uint() != (unsigned long long)i++)
+            r.fail(eCHECKPOINT_MISMATCH);
+        }
+    if (!r.err && r.p != r.end)
+        r.fail(eCHECKPOINT_ERROR);
+    delete[] r.objs;
+    r.objs = 0;
+    return r.err;
+    } // End of function systm::restore.
@@ -66,9 +66,14 @@ const double deft_lb_cap = 9000 * 8;        // Default 9000 byte LB capacity.
 
 // Block memory class for packets, because of (alleged) solaris bug in malloc.
 #if USE_CP_PKT_BMEM
+#if AKSL_BMEM_SAFE
+bmem_safe_define(cp_pkt, bmem0);
+bmem_safe_define(udp_cp_pkt, bmem0);
+#else
 bmem_define(cp_pkt, bmem0);
 bmem_define(udp_cp_pkt, bmem0);
 #endif
+#endif
 
 //----------------------//
 //    cp_pkt::copy_in   //
@@ -79,11 +84,11 @@ void cp_pkt::copy_in(const char* p0, int len0) {
         return;
 
     // Delete old memory, if any, and make a copy of the byte-array.
-    delete[] buf0;
+    szbuf_delete(buf0);
     if (len0 == 0)
         buf0 = 0;
     else {
-        buf0 = new char[len0];
+        buf0 = szbuf_new(len0);
         memcpy(buf0, p0, len0);     // Copy from p0 to buf0.
         }
     len = len0;
@@ -0,0 +1,1409 @@
+// src/aksl/dsim.c   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+/*------------------------------------------------------------------------------
+Functions in this file:
+
+dsim_now
+dsim_listen
+dsim_connect
+dsim_accept
+dsim_read_all
+dsim_write_all
+dsim_buf::
+    reserve
+    put_u64
+    put_real
+    put_string
+    put_value
+    put_payload
+dsim_reader::
+    get_u64
+    get_real
+    get_string
+    get_object
+    get_value
+    get_payload
+dsim_peer::
+    handler
+    flush
+    ~dsim_peer
+dsim::
+    dsim
+    ~dsim
+    is_local
+    assign
+    set_lookahead
+    set_lookahead
+    set_address
+    open_peer
+    connect
+    close
+    post
+    send
+    done
+    receive
+    recv_event
+    recv_end
+    send_end
+    partition
+    unpartition
+    simulate
+systm::
+    dist_enqueue
+------------------------------------------------------------------------------*/
+
+#include "aksl/dsim.h"
+#ifndef AKSL_ERROR_H
+#include "aksl/error.h"
+#endif
+#ifndef AKSL_NEWSTR_H
+#include "aksl/newstr.h"
+#endif
+#ifndef AKSL_AKSLTIME_H
+#include "aksl/aksltime.h"
+#endif
+
+// System header files.
+#ifndef AKSL_X_STRING_H
+#define AKSL_X_STRING_H
+#include <string.h>
+#endif
+#ifndef AKSL_X_STDLIB_H
+#define AKSL_X_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifndef AKSL_X_MATH_H
+#define AKSL_X_MATH_H
+#include <math.h>
+#endif
+#ifndef AKSL_X_ERRNO_H
+#define AKSL_X_ERRNO_H
+#include <errno.h>
+#endif
+#ifndef AKSL_X_FCNTL_H
+#define AKSL_X_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifndef AKSL_X_UNISTD_H
+#define AKSL_X_UNISTD_H
+#include <unistd.h>
+#endif
+#ifndef AKSL_X_SYS_SOCKET_H
+#define AKSL_X_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#ifndef AKSL_X_NETINET_TCP_H
+#define AKSL_X_NETINET_TCP_H
+#include <netinet/tcp.h>
+#endif
+
+// Writes to a closed connection return an error instead of raising SIGPIPE.
+#ifdef MSG_NOSIGNAL
+const int dsim_send_flags = MSG_NOSIGNAL;
+#else
+const int dsim_send_flags = 0;
+#endif
+
+// The length of a dmHELLO message, after its length word.
+const uint32 dsim_hello_length = 13;
+
+//----------------------//
+//       dsim_now       //
+//----------------------//
+static double dsim_now() {
+    timeval tv;
+    gettime(tv);
+    return timeval_get(tv);
+    } // End of function dsim_now.
+
+/*------------------------------------------------------------------------------
+dsim_listen() opens a listening TCP socket. The address may be re-used at once,
+so that a simulation can be run again without waiting for old connections to
+time out.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      dsim_listen     //
+//----------------------//
+static int dsim_listen(uint32 ip, uint16 port, int backlog) {
+    int fd0 = socket(PF_INET, SOCK_STREAM, 0);
+    if (fd0 < 0)
+        return eSOCKET_FAILED;
+    int on = 1;
+    setsockopt(fd0, SOL_SOCKET, SO_REUSEADDR, (char*)&on, sizeof(on));
+    sockaddr_in bname;
+    set_in(bname, ip, port);
+    if (bind_in(fd0, bname) < 0) {
+        cout << "dsim: could not bind TCP port " << port << endl;
+        ::close(fd0);
+        return eBIND_FAILED;
+        }
+    if (listen(fd0, backlog) < 0) {
+        ::close(fd0);
+        return eLISTEN_FAILED;
+        }
+    return fd0;
+    } // End of function dsim_listen.
+
+/*------------------------------------------------------------------------------
+dsim_connect() connects to a listening rank. If the rank is not listening yet,
+it tries again every 20 ms until the deadline.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     dsim_connect     //
+//----------------------//
+static int dsim_connect(uint32 ip, uint16 port, double deadline) {
+    for (;;) {
+        int fd0 = socket(PF_INET, SOCK_STREAM, 0);
+        if (fd0 < 0)
+            return eSOCKET_FAILED;
+        sockaddr_in cname;
+        set_in(cname, ip, port);
+        if (connect_in(fd0, cname) == 0)
+            return fd0;
+        int e = errno;
+        ::close(fd0);
+        if (e != ECONNREFUSED && e != EINTR && e != ETIMEDOUT)
+            return eCONNECT_FAILED;
+        if (dsim_now() >= deadline)
+            return eCONNECT_FAILED;
+        timeval tv;
+        timeval_set(tv, 0.02);
+        select(0, 0, 0, 0, &tv);
+        }
+    } // End of function dsim_connect.
+
+//----------------------//
+//      dsim_accept     //
+//----------------------//
+static int dsim_accept(int fd1, double deadline) {
+    for (;;) {
+        double dt = deadline - dsim_now();
+        if (dt <= 0)
+            return eACCEPT_FAILED;
+        fd_set rfds;
+        FD_ZERO(&rfds);
+        FD_SET(fd1, &rfds);
+        timeval tv;
+        timeval_set(tv, dt);
+        int k = select(fd1 + 1, &rfds, 0, 0, &tv);
+        if (k < 0 && errno != EINTR)
+            return eACCEPT_FAILED;
+        if (k > 0) {
+            sockaddr_in from;
+            return accept_in(fd1, from);
+            }
+        }
+    } // End of function dsim_accept.
+
+/*------------------------------------------------------------------------------
+dsim_read_all() reads exactly "n" bytes from a blocking socket, unless the
+deadline passes first.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     dsim_read_all    //
+//----------------------//
+static int dsim_read_all(int fd0, char* buf, int n, double deadline) {
+    while (n > 0) {
+        double dt = deadline - dsim_now();
+        if (dt <= 0)
+            return eEND_OF_STREAM;
+        fd_set rfds;
+        FD_ZERO(&rfds);
+        FD_SET(fd0, &rfds);
+        timeval tv;
+        timeval_set(tv, dt);
+        int k = select(fd0 + 1, &rfds, 0, 0, &tv);
+        if (k <= 0)
+            continue;
+        k = ::read(fd0, buf, n);
+        if (k == 0)
+            return eEND_OF_STREAM;
+        if (k < 0) {
+            if (errno == EINTR)
+                continue;
+            return eSOCKET_FAILED;
+            }
+        buf += k;
+        n -= k;
+        }
+    return 0;
+    } // End of function dsim_read_all.
+
+//----------------------//
+//    dsim_write_all    //
+//----------------------//
+static int dsim_write_all(int fd0, const char* buf, int n) {
+    while (n > 0) {
+        int k = ::send(fd0, buf, n, dsim_send_flags);
+        if (k < 0) {
+            if (errno == EINTR)
+                continue;
+            return eWRITE_FAILED;
+            }
+        buf += k;
+        n -= k;
+        }
+    return 0;
+    } // End of function dsim_write_all.
+
+/*------------------------------------------------------------------------------
+dsim_buf::reserve() makes room for "k" more bytes at the end of the queue, and
+returns a pointer to them. The bytes which have been consumed are discarded.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   dsim_buf::reserve  //
+//----------------------//
+char* dsim_buf::reserve(unsigned long k) {
+    if (n + k <= size)
+        return buf + n;
+    if (head > 0) {
+        memmove(buf, buf + head, n - head);
+        n -= head;
+        head = 0;
+        if (n + k <= size)
+            return buf + n;
+        }
+    unsigned long newsize = (size > 0) ? 2 * size : 4096;
+    while (newsize < n + k)
+        newsize *= 2;
+    char* b2 = new char[newsize];
+    if (n > 0)
+        memcpy(b2, buf, n);
+    delete[] buf;
+    buf = b2;
+    size = newsize;
+    return buf + n;
+    } // End of function dsim_buf::reserve.
+
+//----------------------//
+//   dsim_buf::put_u64  //
+//----------------------//
+void dsim_buf::put_u64(unsigned long long x) {
+    put_u32((uint32)(x >> 32));
+    put_u32((uint32)(x & 0xffffffffu));
+    } // End of function dsim_buf::put_u64.
+
+/*------------------------------------------------------------------------------
+dsim_buf::put_real() writes the bits of an IEEE double as a 64-bit integer.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  dsim_buf::put_real  //
+//----------------------//
+void dsim_buf::put_real(double x) {
+    unsigned long long b = 0;
+    memcpy(&b, &x, sizeof(b));
+    put_u64(b);
+    } // End of function dsim_buf::put_real.
+
+/*------------------------------------------------------------------------------
+dsim_buf::put_string() writes the length plus one, and then the characters. The
+null pointer is written as length 0.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   dsim_buf::put_string   //
+//--------------------------//
+void dsim_buf::put_string(const char* s) {
+    if (!s) {
+        put_u32(0);
+        return;
+        }
+    unsigned long k = strlen(s);
+    put_u32(k + 1);
+    memcpy(reserve(k), s, k);
+    n += k;
+    } // End of function dsim_buf::put_string.
+
+/*------------------------------------------------------------------------------
+dsim_buf::put_value() writes a value in the same layout as
+ckpt_writer::put_value(), with fixed-length numbers. Objects are written as
+their ids.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//    dsim_buf::put_value   //
+//--------------------------//
+int dsim_buf::put_value(const value* pv0) {
+    value* pv = (value*)pv0;
+    if (!pv) {
+        put_u8(0);
+        return 0;
+        }
+    Vtype ty = pv->type();
+    put_u8(ty + 1);
+    int err = 0;
+    switch (ty) {
+    case vINTEGER:
+        put_u64((unsigned long long)(long long)(long)*pv);
+        break;
+    case vREAL:
+        put_real((double)*pv);
+        break;
+    case vSTRING:
+        put_string((const char*)*pv);
+        break;
+    case vOBJECT: {
+        object* po = *pv;
+        put_u32(po ? po->id() : no_object_id);
+        }
+        break;
+    case vDATUM:
+        return eNOT_SERIALISABLE;
+    case vLIST: {
+        valuelist* pl = *pv;
+        put_u32(pl ? pl->length() : 0);
+        if (pl)
+            for (value* p = pl->first(); p && err == 0; p = p->next())
+                err = put_value(p);
+        }
+        break;
+    case vTVLIST: {
+        tagvaluelist* pl = *pv;
+        put_u32(pl ? pl->length() : 0);
+        if (pl)
+            for (tagvalue* p = pl->first(); p && err == 0; p = p->next()) {
+                put_u32((uint32)(long)p->tag);
+                err = put_value(p);
+                }
+        }
+        break;
+    case vCOLONLIST: {
+        colonlist* pl = *pv;
+        put_u32(pl ? pl->length() : 0);
+        if (pl)
+            for (value* p = pl->first(); p && err == 0; p = p->next())
+                err = put_value(p);
+        }
+        break;
+    case vNONE:
+    default:
+        break;
+        }
+    return err;
+    } // End of function dsim_buf::put_value.
+
+//--------------------------//
+//   dsim_buf::put_payload  //
+//--------------------------//
+int dsim_buf::put_payload(const payload& x) {
+    Ptype ty = x.type();
+    put_u8(ty);
+    switch (ty) {
+    case pINTEGER:
+        put_u64((unsigned long long)(long long)(long)x);
+        break;
+    case pREAL:
+        put_real((double)x);
+        break;
+    case pOBJECT: {
+        object* po = x;
+        put_u32(po ? po->id() : no_object_id);
+        }
+        break;
+    case pDATUM:
+        return eNOT_SERIALISABLE;
+    case pVALUE:
+        return put_value(x.value_ptr());
+    case pNONE:
+    default:
+        break;
+        }
+    return 0;
+    } // End of function dsim_buf::put_payload.
+
+//--------------------------//
+//   dsim_reader::get_u64   //
+//--------------------------//
+unsigned long long dsim_reader::get_u64() {
+    unsigned long long x = get_u32();
+    return (x << 32) | get_u32();
+    } // End of function dsim_reader::get_u64.
+
+//--------------------------//
+//   dsim_reader::get_real  //
+//--------------------------//
+double dsim_reader::get_real() {
+    unsigned long long b = get_u64();
+    double x = 0;
+    memcpy(&x, &b, sizeof(x));
+    return x;
+    } // End of function dsim_reader::get_real.
+
+//--------------------------//
+//  dsim_reader::get_string //
+//--------------------------//
+char* dsim_reader::get_string() {
+    uint32 k = get_u32();
+    if (k == 0 || !check(k - 1))
+        return 0;
+    char* s = new char[k];
+    memcpy(s, p, k - 1);
+    s[k - 1] = 0;
+    p += k - 1;
+    return s;
+    } // End of function dsim_reader::get_string.
+
+//--------------------------//
+//  dsim_reader::get_object //
+//--------------------------//
+object* dsim_reader::get_object() {
+    uint32 id = get_u32();
+    if (id == no_object_id)
+        return 0;
+    object* po = sys->object_by_id((unsigned int)id);
+    if (!po)
+        err = ePROTOCOL_ERROR;
+    return po;
+    } // End of function dsim_reader::get_object.
+
+/*------------------------------------------------------------------------------
+dsim_reader::get_value() reads a value written by dsim_buf::put_value(). Strings
+and lists are newly allocated.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//  dsim_reader::get_value  //
+//--------------------------//
+value* dsim_reader::get_value() {
+    unsigned int ty = get_u8();
+    if (ty == 0)
+        return 0;
+    value* pv = new value;
+    switch (ty - 1) {
+    case vINTEGER:
+        *pv = (long)(long long)get_u64();
+        break;
+    case vREAL:
+        *pv = get_real();
+        break;
+    case vSTRING: {
+        char* s = get_string();
+        if (s)
+            *pv = s;
+        }
+        break;
+    case vOBJECT:
+        *pv = get_object();
+        break;
+    case vLIST: {
+        valuelist* pl = new valuelist;
+        for (uint32 k = get_u32(); k > 0 && !err; --k) {
+            value* p = get_value();
+            pl->append(p ? p : new value);
+            }
+        *pv = pl;
+        }
+        break;
+    case vTVLIST: {
+        tagvaluelist* pl = new tagvaluelist;
+        for (uint32 k = get_u32(); k > 0 && !err; --k) {
+            tagvalue* ptv = new tagvalue;
+            ptv->tag = (mtype)(int32)get_u32();
+            value* p = get_value();
+            if (p) {
+                p->copyto(*ptv);
+                delete p;
+                }
+            pl->append(ptv);
+            }
+        *pv = pl;
+        }
+        break;
+    case vCOLONLIST: {
+        colonlist* pl = new colonlist;
+        for (uint32 k = get_u32(); k > 0 && !err; --k) {
+            value* p = get_value();
+            pl->append(p ? p : new value);
+            }
+        *pv = pl;
+        }
+        break;
+    case vNONE:
+        break;
+    default:
+        err = ePROTOCOL_ERROR;
+        break;
+        }
+    return pv;
+    } // End of function dsim_reader::get_value.
+
+//------------------------------//
+//   dsim_reader::get_payload   //
+//------------------------------//
+payload dsim_reader::get_payload() {
+    payload x;
+    switch (get_u8()) {
+    case pINTEGER:
+        x = (long)(long long)get_u64();
+        break;
+    case pREAL:
+        x = get_real();
+        break;
+    case pOBJECT:
+        x = get_object();
+        break;
+    case pVALUE:
+        x = get_value();
+        break;
+    case pNONE:
+        break;
+    default:
+        err = ePROTOCOL_ERROR;
+        break;
+        }
+    return x;
+    } // End of function dsim_reader::get_payload.
+
+/*------------------------------------------------------------------------------
+dsim_peer::handler() reads the bytes which have arrived and passes the complete
+messages to the dsim, or sends buffered bytes when the socket is writable.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  dsim_peer::handler  //
+//----------------------//
+int dsim_peer::handler() {
+    if (type == sWRITE) {
+        int err = flush();
+        if (err < 0)
+            ds->fail(err);
+        }
+    else if (type == sREAD) {
+        char* pc = in.reserve(dsim_flush_size);
+        int k = ::read(sock, pc, dsim_flush_size);
+        if (k > 0) {
+            in.n += k;
+            ds->receive(this);
+            }
+        else if (k == 0 && ends > ds->round) {
+            eof = true;
+            out.clear();
+            ds->sel.clear_fd_mask(sock, sREAD | sWRITE);
+            wwait = false;
+            }
+        else if (k == 0)
+            ds->fail(eEND_OF_STREAM);
+        else if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK)
+            ds->fail(eSOCKET_FAILED);
+        }
+
+    // Return a negative value to force return to the selector caller.
+    return ds->done() ? -1 : 0;
+    } // End of function dsim_peer::handler.
+
+/*------------------------------------------------------------------------------
+dsim_peer::flush() sends as many of the buffered bytes as the socket accepts.
+If some are left, the selector is asked to call handler() when the socket is
+writable.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   dsim_peer::flush   //
+//----------------------//
+int dsim_peer::flush() {
+    if (eof) {
+        out.clear();
+        return 0;
+        }
+    while (out.length() > 0) {
+        int k = ::send(sock, out.front(), out.length(), dsim_send_flags);
+        if (k < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            return eWRITE_FAILED;
+            }
+        out.consume(k);
+        }
+    bool_enum w = bool_enum(out.length() > 0);
+    if (w && !wwait)
+        ds->sel.set_fd_mask(sock, sWRITE, this);
+    else if (!w && wwait)
+        ds->sel.clear_fd_mask(sock, sWRITE);
+    wwait = w;
+    return 0;
+    } // End of function dsim_peer::flush.
+
+//----------------------//
+// dsim_peer::~dsim_peer//
+//----------------------//
+dsim_peer::~dsim_peer() {
+    if (sock >= 0)
+        ::close(sock);
+    } // End of function dsim_peer::~dsim_peer.
+
+//----------------------//
+//      dsim::dsim      //
+//----------------------//
+dsim::dsim(systm& s, int r, int n, uint16 port, uint32 ip) {
+    sys = &s;
+    nranks = (n > 0) ? n : 1;
+    rank = (r >= 0 && r < nranks) ? r : 0;
+    addrs = new uint32[nranks];
+    ports = new uint16[nranks];
+    peers = new dsim_peer*[nranks];
+    for (int i = 0; i < nranks; ++i) {
+        addrs[i] = ip;
+        ports[i] = (uint16)(port + i);
+        peers[i] = 0;
+        }
+    connected = false;
+    owner = 0;
+    nowner = 0;
+    away = 0;
+    la = new double[nranks * nranks];
+    lac = new double[nranks * nranks];
+    tsent = new double[nranks];
+    finish = 0;
+    running = false;
+    lerr = 0;
+    cerr = 0;
+    round = 0;
+    etnext = new double[2 * nranks];
+    estatus = new int[2 * nranks];
+    etsent = new double[2 * nranks * nranks];
+    nend[0] = nend[1] = 0;
+    links = 0;
+    nlinks = 0;
+    links_size = 0;
+    assignments = 0;
+    nassignments = 0;
+    assignments_size = 0;
+    default_la = 0;
+    nrounds = 0;
+    nsent = 0;
+    nrecv = 0;
+    } // End of function dsim::dsim.
+
+//----------------------//
+//      dsim::~dsim     //
+//----------------------//
+dsim::~dsim() {
+    close();
+    delete[] addrs;
+    delete[] ports;
+    delete[] peers;
+    delete[] owner;
+    delete[] la;
+    delete[] lac;
+    delete[] tsent;
+    delete[] etnext;
+    delete[] estatus;
+    delete[] etsent;
+    delete[] links;
+    delete[] assignments;
+    } // End of function dsim::~dsim.
+
+/*------------------------------------------------------------------------------
+dsim::is_local() returns true if the object belongs to this rank in the current
+or the last simulation. Before the first simulation, all objects are local.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    dsim::is_local    //
+//----------------------//
+bool_enum dsim::is_local(object* po) const {
+    if (!po)
+        return false;
+    return bool_enum(po->oid >= nowner || owner[po->oid] == rank);
+    } // End of function dsim::is_local.
+
+/*------------------------------------------------------------------------------
+dsim::assign() assigns an object to a given rank. Every rank must make the same
+assignments.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     dsim::assign     //
+//----------------------//
+int dsim::assign(object* po, int k) {
+    if (!po)
+        return eNULL_ARGUMENT;
+    if (k < 0 || k >= nranks)
+        return eBAD_ARGUMENT;
+    if (nassignments >= assignments_size) {
+        int newsize = (assignments_size > 0) ? 2 * assignments_size : 64;
+        psim_assignment* pa = new psim_assignment[newsize];
+        for (int i = 0; i < nassignments; ++i)
+            pa[i] = assignments[i];
+        delete[] assignments;
+        assignments = pa;
+        assignments_size = newsize;
+        }
+    assignments[nassignments].po = po;
+    assignments[nassignments].lp = k;
+    nassignments += 1;
+    return 0;
+    } // End of function dsim::assign.
+
+/*------------------------------------------------------------------------------
+dsim::set_lookahead() declares that all messages from "from" to "to" have a
+delay of at least "d", which must be positive.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//    dsim::set_lookahead   //
+//--------------------------//
+int dsim::set_lookahead(object* from, object* to, double d) {
+    if (!from || !to)
+        return eNULL_ARGUMENT;
+    if (!(d > 0))
+        return eBAD_ARGUMENT;
+    if (nlinks >= links_size) {
+        int newsize = (links_size > 0) ? 2 * links_size : 64;
+        psim_link* pl = new psim_link[newsize];
+        for (int i = 0; i < nlinks; ++i)
+            pl[i] = links[i];
+        delete[] links;
+        links = pl;
+        links_size = newsize;
+        }
+    links[nlinks].from = from;
+    links[nlinks].to = to;
+    links[nlinks].lookahead = d;
+    nlinks += 1;
+    return 0;
+    } // End of function dsim::set_lookahead.
+
+/*------------------------------------------------------------------------------
+This version of dsim::set_lookahead() declares that all messages between
+objects in different ranks have a delay of at least "d", which must be positive.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//    dsim::set_lookahead   //
+//--------------------------//
+int dsim::set_lookahead(double d) {
+    if (!(d > 0))
+        return eBAD_ARGUMENT;
+    default_la = d;
+    return 0;
+    } // End of function dsim::set_lookahead.
+
+/*------------------------------------------------------------------------------
+dsim::set_address() sets the IP address and TCP port at which rank k listens.
+It must be called before connect().
+------------------------------------------------------------------------------*/
+//----------------------//
+//   dsim::set_address  //
+//----------------------//
+int dsim::set_address(int k, uint32 ip, uint16 port) {
+    if (k < 0 || k >= nranks || connected)
+        return eBAD_ARGUMENT;
+    addrs[k] = ip;
+    ports[k] = port;
+    return 0;
+    } // End of function dsim::set_address.
+
+/*------------------------------------------------------------------------------
+dsim::open_peer() makes the connection to rank i from the socket "fd0", which
+is made non-blocking, and registers it with the selector.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    dsim::open_peer   //
+//----------------------//
+int dsim::open_peer(int i, int fd0) {
+    if (fcntl(fd0, F_SETFL, (fcntl(fd0, F_GETFL, 0) | O_NONBLOCK)) < 0) {
+        ::close(fd0);
+        return eNONBLOCKING_FAILED;
+        }
+    int on = 1;
+    setsockopt(fd0, IPPROTO_TCP, TCP_NODELAY, (char*)&on, sizeof(on));
+    peers[i] = new dsim_peer(this, i, fd0);
+    sel.set_fd_mask(fd0, sREAD, peers[i]);
+    return 0;
+    } // End of function dsim::open_peer.
+
+/*------------------------------------------------------------------------------
+dsim::connect() opens the TCP connections to all other ranks. Rank k listens
+for the higher ranks, and connects to the lower ranks. Each connecting rank
+sends a dmHELLO message with its rank, the number of ranks and the number of
+object ids in its system, which must agree. The objects must therefore be made
+before connect() is called. If the connections are not all made within
+"timeout" seconds, the error eCONNECT_FAILED or eACCEPT_FAILED is returned.
+simulate() calls connect() if the ranks are not connected.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     dsim::connect    //
+//----------------------//
+int dsim::connect(double timeout) {
+    if (connected)
+        return 0;
+    double deadline = dsim_now() + timeout;
+    int lsock = -1;
+    if (rank < nranks - 1) {
+        lsock = dsim_listen(addrs[rank], ports[rank], nranks);
+        if (lsock < 0)
+            return lsock;
+        }
+    int err = 0;
+
+    // Connect to the lower ranks.
+    for (int i = 0; i < rank && err == 0; ++i) {
+        int fd0 = dsim_connect(addrs[i], ports[i], deadline);
+        if (fd0 < 0) {
+            cout << "dsim: rank " << rank << " could not connect to rank "
+                 << i << DOTNL;
+            err = fd0;
+            break;
+            }
+        dsim_buf b;
+        b.put_u32(dsim_hello_length);
+        b.put_u8(dmHELLO);
+        b.put_u32(rank);
+        b.put_u32(nranks);
+        b.put_u32(sys->n_object_ids());
+        err = dsim_write_all(fd0, b.front(), (int)b.length());
+        if (err < 0)
+            ::close(fd0);
+        else
+            err = open_peer(i, fd0);
+        }
+
+    // Accept the higher ranks, in any order.
+    for (int k = rank + 1; k < nranks && err == 0; ++k) {
+        int fd0 = dsim_accept(lsock, deadline);
+        if (fd0 < 0) {
+            cout << "dsim: rank " << rank
+                 << " timed out waiting for higher ranks.\n";
+            err = fd0;
+            break;
+            }
+        char hb[4 + dsim_hello_length];
+        err = dsim_read_all(fd0, hb, sizeof(hb), deadline);
+        dsim_reader r(hb, sizeof(hb), sys);
+        uint32 len = r.get_u32();
+        unsigned int kind = r.get_u8();
+        uint32 i = r.get_u32();
+        uint32 n = r.get_u32();
+        uint32 nid = r.get_u32();
+        if (err == 0 && (len != dsim_hello_length || kind != dmHELLO
+                || n != (uint32)nranks || i <= (uint32)rank
+                || i >= (uint32)nranks || peers[i])) {
+            cout << "dsim: bad connection request to rank " << rank << DOTNL;
+            err = ePROTOCOL_ERROR;
+            }
+        else if (err == 0 && nid != sys->n_object_ids()) {
+            cout << "dsim: rank " << i << " has " << nid
+                 << " object ids, but rank " << rank << " has "
+                 << sys->n_object_ids() << DOTNL;
+            err = ePROTOCOL_ERROR;
+            }
+        if (err < 0)
+            ::close(fd0);
+        else
+            err = open_peer((int)i, fd0);
+        }
+    if (lsock >= 0)
+        ::close(lsock);
+    if (err < 0) {
+        close();
+        return err;
+        }
+    connected = true;
+    return 0;
+    } // End of function dsim::connect.
+
+//----------------------//
+//      dsim::close     //
+//----------------------//
+void dsim::close() {
+    for (int i = 0; i < nranks; ++i) {
+        if (!peers[i])
+            continue;
+        sel.clear_fd_mask(peers[i]->sock, sREAD | sWRITE);
+        delete peers[i];
+        peers[i] = 0;
+        }
+    connected = false;
+    } // End of function dsim::close.
+
+/*------------------------------------------------------------------------------
+dsim::post() is called by systm::enqueue() (via dist_enqueue()) for each new
+event. Events for objects of this rank are inserted in the FEL. Events for
+other ranks are checked against the lookahead and sent. A broadcast event is
+inserted locally, and also sent to every other rank. During initialisation,
+there is no lookahead check.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      dsim::post      //
+//----------------------//
+void dsim::post(event* pe) {
+    object* po = pe->dest;
+    int j = (po && po->oid < nowner) ? owner[po->oid] : rank;
+    if (po && j == rank) {
+        sys->events.insert(pe);
+        return;
+        }
+    if (po) {
+        if (running && pe->t < sys->clck + la[rank*nranks + j]) {
+            if (lerr == 0)
+                cout << "Warning: lookahead violation by "
+                     << pe->orig->name << DOTNL;
+            lerr = eLOOKAHEAD_VIOLATION;
+            }
+        send(j, pe);
+        sent.append(pe);
+        return;
+        }
+
+    // Broadcast event.
+    sys->events.insert(pe);
+    for (int k = 0; k < nranks; ++k) {
+        if (k == rank)
+            continue;
+        if (running && pe->t < sys->clck + la[rank*nranks + k]) {
+            if (lerr == 0)
+                cout << "Warning: lookahead violation by broadcast from "
+                     << pe->orig->name << DOTNL;
+            lerr = eLOOKAHEAD_VIOLATION;
+            }
+        send(k, pe);
+        }
+    } // End of function dsim::post.
+
+/*------------------------------------------------------------------------------
+dsim::send() writes a dmEVENT message for rank j. The message is the event time,
+the origin and destination ids (no_object_id for a broadcast), the message
+type, the ordering fields and the argument.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      dsim::send      //
+//----------------------//
+void dsim::send(int j, event* pe) {
+    dsim_peer* pp = peers[j];
+    if (!pp || pp->eof)
+        return;
+    dsim_buf& b = pp->out;
+    unsigned long n0 = b.n;
+    b.put_u32(0);                   // The length, which is set below.
+    b.put_u8(dmEVENT);
+    b.put_real(pe->t);
+    b.put_u32(pe->orig->oid);
+    b.put_u32(pe->dest ? pe->dest->oid : no_object_id);
+    b.put_u32((uint32)(long)pe->mty);
+    b.put_u32((uint32)(long)pe->prio);
+    b.put_u32(pe->depth);
+    b.put_u64(pe->seq);
+    int err = b.put_payload(pe->arg);
+    if (err < 0) {
+        b.n = n0;
+        if (lerr == 0)
+            cout << "Warning: event argument from " << pe->orig->name
+                 << " cannot be sent to rank " << j << DOTNL;
+        lerr = err;
+        return;
+        }
+    u32encode(b.buf + n0, b.n - n0 - 4);
+    if (pe->t < tsent[j])
+        tsent[j] = pe->t;
+    nsent += 1;
+    if (b.length() >= dsim_flush_size && (err = pp->flush()) < 0)
+        fail(err);
+    } // End of function dsim::send.
+
+/*------------------------------------------------------------------------------
+dsim::done() returns true when the "end of round" messages of all other ranks
+have arrived and all output has been written, or when there is an error. The
+output must be written, or a rank which stops could leave a peer waiting.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      dsim::done      //
+//----------------------//
+bool_enum dsim::done() const {
+    if (cerr != 0)
+        return true;
+    if (nend[round % 2] < nranks - 1)
+        return false;
+    for (int i = 0; i < nranks; ++i)
+        if (peers[i] && peers[i]->out.length() > 0)
+            return false;
+    return true;
+    } // End of function dsim::done.
+
+/*------------------------------------------------------------------------------
+dsim::receive() processes the complete messages in the input of a peer.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     dsim::receive    //
+//----------------------//
+int dsim::receive(dsim_peer* pp) {
+    dsim_buf& b = pp->in;
+    while (cerr == 0 && b.length() >= 4) {
+        uint32 k = u32decode(b.front());
+        if (b.length() < 4 + k)
+            break;
+        dsim_reader r(b.front() + 4, k, sys);
+        int err = 0;
+        switch (r.get_u8()) {
+        case dmEVENT:
+            err = recv_event(r);
+            break;
+        case dmEND:
+            err = recv_end(pp->rank, r);
+            break;
+        default:
+            err = ePROTOCOL_ERROR;
+            break;
+            }
+        if (err == 0)
+            err = r.err;
+        if (err < 0) {
+            cout << "dsim: bad message from rank " << pp->rank << DOTNL;
+            fail(err);
+            }
+        b.consume(4 + k);
+        }
+    return cerr;
+    } // End of function dsim::receive.
+
+/*------------------------------------------------------------------------------
+dsim::recv_event() makes an event from a dmEVENT message, and inserts it into
+the FEL. Its destination must be an object of this rank. An event which is
+earlier than the clock of this rank is a causality error, which is reported to
+the other ranks at the end of the round.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   dsim::recv_event   //
+//----------------------//
+int dsim::recv_event(dsim_reader& r) {
+    double t = r.get_real();
+    object* orig = r.get_object();
+    object* dest = r.get_object();
+    mtype mty = (mtype)(int32)r.get_u32();
+    short prio = (short)(int32)r.get_u32();
+    unsigned short depth = (unsigned short)r.get_u32();
+    unsigned long long seq = r.get_u64();
+    if (r.err || !orig)
+        return ePROTOCOL_ERROR;
+    if (dest && !is_local(dest))
+        return ePROTOCOL_ERROR;
+    payload x = r.get_payload();
+    if (r.err) {
+        delete x.value_ptr();
+        return r.err;
+        }
+    event* pe = new event(t, orig, dest, mty);
+    pe->prio = prio;
+    pe->depth = depth;
+    pe->seq = seq;
+    pe->arg = x;
+    if (t < sys->clck && lerr == 0) {
+        cout << "Causality error: event at time " << t
+             << " received after time " << sys->clck << DOTNL;
+        lerr = eCAUSALITY_ERROR;
+        }
+    sys->events.insert(pe);
+    nrecv += 1;
+    return 0;
+    } // End of function dsim::recv_event.
+
+/*------------------------------------------------------------------------------
+dsim::recv_end() records the dmEND message of rank i. It may be for the current
+round or for the next round.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    dsim::recv_end    //
+//----------------------//
+int dsim::recv_end(int i, dsim_reader& r) {
+    uint32 rnd = r.get_u32();
+    if (rnd != (uint32)round && rnd != (uint32)(round + 1))
+        return ePROTOCOL_ERROR;
+    int p = rnd % 2;
+    estatus[p*nranks + i] = (int)(int32)r.get_u32();
+    etnext[p*nranks + i] = r.get_real();
+    for (int j = 0; j < nranks; ++j)
+        etsent[(p*nranks + i)*nranks + j] = r.get_real();
+    nend[p] += 1;
+    peers[i]->ends += 1;
+    return r.err;
+    } // End of function dsim::recv_end.
+
+/*------------------------------------------------------------------------------
+dsim::send_end() records this rank's dmEND message for the current round, and
+sends it to every other rank. The message is the round number, the error
+status, the time of the first event in the FEL, and the least time of the
+events sent to each rank since the last dmEND message.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    dsim::send_end    //
+//----------------------//
+void dsim::send_end() {
+    int p = round % 2;
+    const event* pf = sys->events.first();
+    estatus[p*nranks + rank] = lerr;
+    etnext[p*nranks + rank] = pf ? pf->time() : HUGE_VAL;
+    for (int j = 0; j < nranks; ++j) {
+        etsent[(p*nranks + rank)*nranks + j] = tsent[j];
+        tsent[j] = HUGE_VAL;
+        }
+    for (int i = 0; i < nranks; ++i) {
+        dsim_peer* pp = peers[i];
+        if (!pp)
+            continue;
+        dsim_buf& b = pp->out;
+        b.put_u32(1 + 4 + 4 + 8 + 8 * nranks);
+        b.put_u8(dmEND);
+        b.put_u32(round);
+        b.put_u32((uint32)(long)lerr);
+        b.put_real(etnext[p*nranks + rank]);
+        for (int j = 0; j < nranks; ++j)
+            b.put_real(etsent[(p*nranks + rank)*nranks + j]);
+        int err = pp->flush();
+        if (err < 0)
+            fail(err);
+        }
+    } // End of function dsim::send_end.
+
+//------------------------------//
+//     dsim_assignment_cmp      //
+//------------------------------//
+static int dsim_assignment_cmp(const void* a, const void* b) {
+    object* pa = ((const psim_assignment*)a)->po;
+    object* pb = ((const psim_assignment*)b)->po;
+    return (pa < pb) ? -1 : (pa > pb) ? 1 : 0;
+    } // End of function dsim_assignment_cmp.
+
+/*------------------------------------------------------------------------------
+dsim::partition() finds the rank of each object, takes the objects of the other
+ranks out of the object list, and computes the lookahead matrix and its
+shortest-path closure. (See psim::partition().)
+------------------------------------------------------------------------------*/
+//----------------------//
+//    dsim::partition   //
+//----------------------//
+void dsim::partition() {
+    unsigned int nid = sys->n_object_ids();
+    if (nid > nowner) {
+        delete[] owner;
+        owner = new int[nid];
+        nowner = nid;
+        }
+    for (unsigned int i = 0; i < nowner; ++i)
+        owner[i] = rank;
+
+    // Sort the explicit assignments so that they can be looked up.
+    if (nassignments > 1)
+        qsort(assignments, nassignments, sizeof(psim_assignment),
+              dsim_assignment_cmp);
+
+    // Divide the objects among the ranks.
+    away = new objectlist(*sys->mdl);
+    objectlist here(*sys->mdl);
+    long nobj = sys->objects.length();
+    long idx = 0;
+    object* po = 0;
+    while ((po = sys->objects.popfirst()) != 0) {
+        int k = int((idx * nranks) / nobj);
+        psim_assignment key;
+        key.po = po;
+        psim_assignment* pa = (nassignments > 0) ?
+            (psim_assignment*)bsearch(&key, assignments, nassignments,
+                sizeof(psim_assignment), dsim_assignment_cmp) : 0;
+        if (pa)
+            k = pa->lp;
+        owner[po->oid] = k;
+        if (k == rank)
+            here.append(po);
+        else
+            away->append(po);
+        idx += 1;
+        }
+    while ((po = here.popfirst()) != 0)
+        sys->objects.append(po);
+    sys->others_ok = false;
+
+    // Compute the lookahead matrix.
+    for (int i = 0; i < nranks; ++i)
+        for (int j = 0; j < nranks; ++j)
+            la[i*nranks + j] = (i != j && default_la > 0) ? default_la
+                                                          : HUGE_VAL;
+    for (int l = 0; l < nlinks; ++l) {
+        unsigned int f = links[l].from->oid;
+        unsigned int t = links[l].to->oid;
+        if (f >= nowner || t >= nowner
+            || sys->object_by_id(f) != links[l].from
+            || sys->object_by_id(t) != links[l].to)
+            continue;
+        int i = owner[f];
+        int j = owner[t];
+        if (i != j && links[l].lookahead < la[i*nranks + j])
+            la[i*nranks + j] = links[l].lookahead;
+        }
+    for (int i = 0; i < nranks * nranks; ++i)
+        lac[i] = la[i];
+    for (int m = 0; m < nranks; ++m)
+        for (int i = 0; i < nranks; ++i)
+            for (int j = 0; j < nranks; ++j)
+                if (lac[i*nranks + m] + lac[m*nranks + j] < lac[i*nranks + j])
+                    lac[i*nranks + j] = lac[i*nranks + m] + lac[m*nranks + j];
+    } // End of function dsim::partition.
+
+/*------------------------------------------------------------------------------
+dsim::unpartition() deletes any remaining events, and puts all objects back
+into the object list, in the order of their ids.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   dsim::unpartition  //
+//----------------------//
+void dsim::unpartition() {
+    sys->events.clear();
+    while (sys->objects.popfirst())
+        ;
+    while (away->popfirst())
+        ;
+    delete away;
+    away = 0;
+    for (unsigned int i = 0; i < sys->n_object_ids(); ++i) {
+        object* po = sys->object_by_id(i);
+        if (po)
+            sys->objects.append(po);
+        }
+    sys->others_ok = false;
+    } // End of function dsim::unpartition.
+
+/*------------------------------------------------------------------------------
+dsim::simulate() is the distributed version of systm::simulate(). It must be
+called by every rank with the same arguments. The objects of this rank are
+initialised, and then the rounds are run until every rank has reached the
+finish time, or any rank has an error. Events at or after the finish time are
+not executed. Then the objects of this rank are terminated. On return, all
+objects are back in the object list.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    dsim::simulate    //
+//----------------------//
+int dsim::simulate(double duration, double start) {
+    if (duration <= 0) {
+        cout << "Terminating simulation due to non-positive duration.\n";
+        return eNEGATIVE_DURATION;
+        }
+    if (sys->objects.empty()) {
+        cout << "Terminating simulation due to lack of objects.\n";
+        return eNO_OBJECTS;
+        }
+    int err = connect();
+    if (err < 0)
+        return err;
+    for (int i = 0; i < nranks; ++i) {
+        if (peers[i] && peers[i]->eof) {
+            close();
+            return eEND_OF_STREAM;
+            }
+        if (peers[i])
+            peers[i]->ends = 0;
+        }
+    finish = start + duration;
+    nrounds = 0;
+    nsent = 0;
+    nrecv = 0;
+    lerr = 0;
+    cerr = 0;
+    round = 0;
+    nend[0] = nend[1] = 0;
+    for (int j = 0; j < nranks; ++j)
+        tsent[j] = HUGE_VAL;
+    partition();
+
+    // Initialise the packages and the objects of this rank. An error is
+    // reported to the other ranks at the end of the first round.
+    running = false;
+    sys->dist = this;
+    lerr = sys->initialise(start);
+    running = true;
+
+    double tmin = HUGE_VAL;
+    for (;;) {
+        // Exchange the "end of round" messages.
+        send_end();
+        while (!done()) {
+            sel.get_event();
+            if (sel.select_return < 0)
+                fail(eSOCKET_FAILED);
+            }
+        if (cerr != 0)
+            break;
+
+        // All ranks take the same decision here.
+        int p = round % 2;
+        double* tn = new double[nranks];
+        tmin = HUGE_VAL;
+        err = 0;
+        for (int i = 0; i < nranks; ++i) {
+            tn[i] = etnext[p*nranks + i];
+            for (int k = 0; k < nranks; ++k)
+                if (etsent[(p*nranks + k)*nranks + i] < tn[i])
+                    tn[i] = etsent[(p*nranks + k)*nranks + i];
+            if (tn[i] < tmin)
+                tmin = tn[i];
+            if (estatus[p*nranks + i] != 0 && err == 0)
+                err = estatus[p*nranks + i];
+            }
+        double bound = finish;
+        for (int i = 0; i < nranks; ++i)
+            if (tn[i] + lac[i*nranks + rank] < bound)
+                bound = tn[i] + lac[i*nranks + rank];
+        delete[] tn;
+        nend[p] = 0;
+        round += 1;
+        if (err != 0 || tmin >= finish)
+            break;
+        nrounds += 1;
+
+        // Execute the events before the bound.
+        while (lerr == 0) {
+            const event* pf = sys->events.first();
+            if (!pf || pf->time() >= bound)
+                break;
+            event* evt = sys->events.popfirst();
+            if (evt->orig) {
+                sys->clck = evt->t;
+                sys->depth = evt->depth;
+                object* perr = evt->simulate();
+                if (perr) {
+                    cout << "Termination condition received from the "
+                         << perr->type();
+                    cout << " called " << perr->name << DOTNL;
+                    lerr = (perr->error < 0) ? perr->error : eEVENT_ERROR;
+                    }
+                }
+            delete evt;
+            }
+
+        // The events sent to other ranks have been written.
+        for (unsigned int m = 0; m < sent.n; ++m) {
+            delete sent.v[m]->arg.value_ptr();
+            delete sent.v[m];
+            }
+        sent.clear();
+        }
+    running = false;
+    sys->dist = 0;
+    for (unsigned int m = 0; m < sent.n; ++m) {
+        delete sent.v[m]->arg.value_ptr();
+        delete sent.v[m];
+        }
+    sent.clear();
+
+    if (lerr < 0)
+        err = lerr;
+    else if (cerr < 0)
+        err = cerr;
+    if (err == 0 && tmin == HUGE_VAL) {
+        cout << "Simulation ending with exhaustion of events.\n";
+        err = eNO_EVENTS;
+        }
+    if (err == 0)
+        sys->terminate();
+    unpartition();
+    if (cerr < 0)
+        close();
+    return err;
+    } // End of function dsim::simulate.
+
+/*------------------------------------------------------------------------------
+systm::dist_enqueue() is called instead of event_heap::insert() for a system
+while it is part of a distributed simulation.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  systm::dist_enqueue //
+//----------------------//
+void systm::dist_enqueue(event* pe) {
+    dist->post(pe);
+    } // End of function systm::dist_enqueue.
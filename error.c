@@ -33,6 +33,9 @@ static stringkey error_strings[] = {
     "bad system character",             -eBAD_SYSTEM_CHARACTER,
     "bad value",                        -eBAD_VALUE,
     "bind failed",                      -eBIND_FAILED,
+    "causality error",                  -eCAUSALITY_ERROR,
+    "checkpoint error",                 -eCHECKPOINT_ERROR,
+    "checkpoint mismatch",              -eCHECKPOINT_MISMATCH,
     "command name error",               -eCOMMAND_NAME_ERROR,
     "connect failed",                   -eCONNECT_FAILED,
     "end of file",                      -eEND_OF_FILE,
@@ -52,6 +55,7 @@ static stringkey error_strings[] = {
     "initialisation failed",            -eINIT_FAILED,
     "list error",                       -eLIST_ERROR,
     "listen failed",                    -eLISTEN_FAILED,
+    "lookahead violation",              -eLOOKAHEAD_VIOLATION,
     "message key clash",                -eMESSAGE_KEY_CLASH,
     "missing bracket",                  -eMISSING_BRACKET,
     "missing equals",                   -eMISSING_EQUALS,
@@ -73,12 +77,16 @@ static stringkey error_strings[] = {
     "no name",                          -eNO_NAME,
     "normal termination",               -eNORMAL_TERMINATION,
     "not found",                        -eNOT_FOUND,
+    "not serialisable",                 -eNOT_SERIALISABLE,
     "null argument",                    -eNULL_ARGUMENT,
     "null file name",                   -eNULL_FILE_NAME,
     "open failed",                      -eOPEN_FAILED,
+    "protocol error",                   -ePROTOCOL_ERROR,
     "simulation interrupted",           -eSIMULATION_INTERRUPTED,
     "socket failed",                    -eSOCKET_FAILED,
+    "thread creation failed",           -eTHREAD_FAILED,
     "unrecognised command",             -eUNRECOGNISED_COMMAND,
+    "write failed",                     -eWRITE_FAILED,
     (char*)0
     };
 
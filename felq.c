@@ -0,0 +1,767 @@
+// src/aksl/felq.c   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+/*------------------------------------------------------------------------------
+Functions in this file:
+
+tim_bucket::
+    resize
+    insert
+    remove
+    sort
+    swap
+cal_queue::
+    cal_queue
+    find_first
+    new_width
+    resize
+    insert
+    popfirst
+    remove
+    clear
+cal_queue_traversal::
+    next
+ladder_rung::
+    init
+ladder_queue::
+    ladder_queue
+    spread
+    top_to_ladder
+    bottom_to_ladder
+    refill_bottom
+    first
+    insert
+    popfirst
+    remove
+    clear
+ladder_queue_traversal::
+    next
+------------------------------------------------------------------------------*/
+
+#include "aksl/felq.h"
+
+/*------------------------------------------------------------------------------
+tim_bucket::resize() is called when the array is full.
+If at least half of the array has been consumed from the front, the occupants
+are just moved down to the start of the array. Otherwise the array is doubled.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  tim_bucket::resize  //
+//----------------------//
+void tim_bucket::resize() {
+    unsigned int len = n - head;
+    if (head > 0 && len <= size/2) {
+        for (unsigned int i = 0; i < len; ++i)
+            v[i] = v[head + i];
+        head = 0;
+        n = len;
+        return;
+        }
+    unsigned int newsize = (size > 0) ? 2 * size : 8;
+    tim** p = new tim*[newsize];
+    for (unsigned int i = 0; i < len; ++i)
+        p[i] = v[head + i];
+    delete[] v;
+    v = p;
+    size = newsize;
+    head = 0;
+    n = len;
+    } // End of function tim_bucket::resize.
+
+/*------------------------------------------------------------------------------
+tim_bucket::insert() inserts a "tim" after all occupants with the same or lesser
+value of "t". The search is from the back, because new events are usually later
+than the events which are already queued.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  tim_bucket::insert  //
+//----------------------//
+void tim_bucket::insert(tim* p) {
+    if (n >= size)
+        resize();
+    double t = p->t;
+    unsigned int j = n;
+    while (j > head && v[j-1]->t > t) {  // > for FIFO justice.
+        v[j] = v[j-1];
+        --j;
+        }
+    v[j] = p;
+    n += 1;
+    } // End of function tim_bucket::insert.
+
+/*------------------------------------------------------------------------------
+tim_bucket::remove() removes the given pointer from the bucket, preserving the
+order of the other occupants. The pointer is returned if it was found.
+Otherwise the null pointer is returned.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  tim_bucket::remove  //
+//----------------------//
+tim* tim_bucket::remove(tim* p) {
+    for (unsigned int i = head; i < n; ++i) {
+        if (v[i] != p)
+            continue;
+        for (unsigned int j = i + 1; j < n; ++j)
+            v[j-1] = v[j];
+        n -= 1;
+        if (head == n)
+            head = n = 0;
+        return p;
+        }
+    return 0;
+    } // End of function tim_bucket::remove.
+
+/*------------------------------------------------------------------------------
+tim_bucket::sort() sorts the occupants into non-decreasing order of "t".
+The sort is stable, so that equal-time occupants stay in their current order.
+Small buckets are insertion-sorted. Large buckets are merge-sorted.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   tim_bucket::sort   //
+//----------------------//
+void tim_bucket::sort() {
+    unsigned int len = n - head;
+    if (len < 2)
+        return;
+    tim** a = v + head;
+    if (len <= 16) {
+        for (unsigned int i = 1; i < len; ++i) {
+            tim* p = a[i];
+            unsigned int j = i;
+            while (j > 0 && a[j-1]->t > p->t) {
+                a[j] = a[j-1];
+                --j;
+                }
+            a[j] = p;
+            }
+        return;
+        }
+
+    // Bottom-up merge sort, alternating between "a" and a temporary array.
+    tim** tmp = new tim*[len];
+    tim** src = a;
+    tim** dst = tmp;
+    for (unsigned int w = 1; w < len; w *= 2) {
+        for (unsigned int lo = 0; lo < len; lo += 2*w) {
+            unsigned int mid = (lo + w < len) ? lo + w : len;
+            unsigned int hi = (lo + 2*w < len) ? lo + 2*w : len;
+            unsigned int i = lo;
+            unsigned int j = mid;
+            unsigned int k = lo;
+            while (i < mid && j < hi)   // <= on the left for stability.
+                dst[k++] = (src[i]->t <= src[j]->t) ? src[i++] : src[j++];
+            while (i < mid)
+                dst[k++] = src[i++];
+            while (j < hi)
+                dst[k++] = src[j++];
+            }
+        tim** p = src;
+        src = dst;
+        dst = p;
+        }
+    if (src != a)
+        for (unsigned int i = 0; i < len; ++i)
+            a[i] = src[i];
+    delete[] tmp;
+    } // End of function tim_bucket::sort.
+
+/*------------------------------------------------------------------------------
+tim_bucket::swap() exchanges the contents of two buckets in constant time.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   tim_bucket::swap   //
+//----------------------//
+void tim_bucket::swap(tim_bucket& b) {
+    tim** v0 = v;
+    unsigned int head0 = head;
+    unsigned int n0 = n;
+    unsigned int size0 = size;
+    v = b.v;
+    head = b.head;
+    n = b.n;
+    size = b.size;
+    b.v = v0;
+    b.head = head0;
+    b.n = n0;
+    b.size = size0;
+    } // End of function tim_bucket::swap.
+
+//--------------------------//
+//   cal_queue::cal_queue   //
+//--------------------------//
+cal_queue::cal_queue() {
+    nbuckets = calq_min_buckets;
+    buckets = new tim_bucket[nbuckets];
+    n = 0;
+    width = 1;
+    day = 0;
+    cur = 0;
+    resize_enabled = true;
+    } // End of function cal_queue::cal_queue.
+
+/*------------------------------------------------------------------------------
+cal_queue::find_first() moves the cursor to the day of the first event, and
+returns the bucket number for that day. It must not be called if the queue is
+empty.
+The buckets are searched one day at a time, starting at the cursor. If there is
+no event within one "year" of the cursor, the least event is found by a direct
+search of the heads of all buckets.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//  cal_queue::find_first   //
+//--------------------------//
+unsigned int cal_queue::find_first() {
+    unsigned int i = cur;
+    double d = day;
+    for (unsigned int k = 0; k < nbuckets; ++k) {
+        tim* p = buckets[i].first();
+        if (p && dayof(p->t) <= d) {
+            cur = i;
+            day = d;
+            return i;
+            }
+        i = (i + 1) & (nbuckets - 1);
+        d += 1;
+        }
+
+    // Direct search. (Equal-time events are always in the same bucket.)
+    tim* pmin = 0;
+    for (i = 0; i < nbuckets; ++i) {
+        tim* p = buckets[i].first();
+        if (p && (!pmin || p->t < pmin->t)) {
+            pmin = p;
+            cur = i;
+            }
+        }
+    day = dayof(pmin->t);
+    return cur;
+    } // End of function cal_queue::find_first.
+
+/*------------------------------------------------------------------------------
+cal_queue::new_width() estimates a good day width from a sample of up to
+calq_n_sample events from the front of the queue. Following Brown, the width is
+3 times the mean separation of the sampled events, after discarding separations
+which are more than twice the mean.
+The sample is read without dequeueing the events, so that the dequeueing order
+of equal-time events is not disturbed.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   cal_queue::new_width   //
+//--------------------------//
+double cal_queue::new_width() {
+    if (n < 2)
+        return width;
+    double ts[calq_n_sample];
+    unsigned int ns = 0;
+
+    // Sample the events of the current year, starting at the cursor.
+    find_first();
+    unsigned int i = cur;
+    double d = day;
+    for (unsigned int k = 0; k < nbuckets && ns < calq_n_sample; ++k) {
+        tim_bucket& b = buckets[i];
+        for (unsigned int j = 0; j < b.length() && ns < calq_n_sample; ++j) {
+            if (dayof(b.element(j)->t) > d)
+                break;
+            ts[ns++] = b.element(j)->t;
+            }
+        i = (i + 1) & (nbuckets - 1);
+        d += 1;
+        }
+    // If the events are sparse, sample the heads of the buckets instead.
+    if (ns < 2) {
+        ns = 0;
+        for (i = 0; i < nbuckets && ns < calq_n_sample; ++i)
+            if (!buckets[i].empty())
+                ts[ns++] = buckets[i].first()->t;
+        }
+    if (ns < 2)
+        return width;
+
+    // Sort the sample.
+    for (i = 1; i < ns; ++i) {
+        double t = ts[i];
+        unsigned int j = i;
+        while (j > 0 && ts[j-1] > t) {
+            ts[j] = ts[j-1];
+            --j;
+            }
+        ts[j] = t;
+        }
+    double avg = (ts[ns-1] - ts[0])/(ns - 1);
+    if (avg <= 0)
+        return width;
+
+    // Re-average, ignoring the large separations.
+    double sum = 0;
+    unsigned int count = 0;
+    for (i = 1; i < ns; ++i) {
+        double sep = ts[i] - ts[i-1];
+        if (sep < 2 * avg) {
+            sum += sep;
+            count += 1;
+            }
+        }
+    if (count > 0 && sum > 0)
+        avg = sum/count;
+    return 3 * avg;
+    } // End of function cal_queue::new_width.
+
+/*------------------------------------------------------------------------------
+cal_queue::resize() copies the queue into a new array of "nb" buckets, with a
+new day width. The contents of each old bucket are re-inserted in order, which
+preserves the order of equal-time events.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   cal_queue::resize  //
+//----------------------//
+void cal_queue::resize(unsigned int nb) {
+    double w = new_width();
+    tim_bucket* old = buckets;
+    unsigned int oldn = nbuckets;
+
+    buckets = new tim_bucket[nb];
+    nbuckets = nb;
+    width = w;
+    n = 0;
+    resize_enabled = false;
+    for (unsigned int i = 0; i < oldn; ++i)
+        for (unsigned int j = 0; j < old[i].length(); ++j)
+            insert(old[i].element(j));
+    resize_enabled = true;
+    delete[] old;
+    } // End of function cal_queue::resize.
+
+/*------------------------------------------------------------------------------
+cal_queue::insert() inserts a pointer to a "tim" or derived structure into the
+queue. The cursor is moved back if the new event is earlier than the cursor.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   cal_queue::insert  //
+//----------------------//
+void cal_queue::insert(tim* p) {
+    if (!p)
+        return;
+    double d = dayof(p->t);
+    unsigned int i = bucketof(d);
+    buckets[i].insert(p);
+    n += 1;
+    if (n == 1 || d < day) {
+        day = d;
+        cur = i;
+        }
+    if (resize_enabled && n > 2 * nbuckets)
+        resize(2 * nbuckets);
+    } // End of function cal_queue::insert.
+
+/*------------------------------------------------------------------------------
+cal_queue::popfirst() removes a pointer in the queue with the least value
+of the member "t". The pointer is returned to the caller.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   cal_queue::popfirst    //
+//--------------------------//
+tim* cal_queue::popfirst() {
+    if (n < 1)
+        return 0;
+    tim* p = buckets[find_first()].popfirst();
+    n -= 1;
+    if (resize_enabled && nbuckets > calq_min_buckets && n < nbuckets/2)
+        resize(nbuckets/2);
+    return p;
+    } // End of function cal_queue::popfirst.
+
+/*------------------------------------------------------------------------------
+cal_queue::remove() removes an arbitrary pointer from the queue.
+Only the bucket for the day of the given "tim" needs to be searched.
+The pointer is returned if it was found. Otherwise null is returned.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   cal_queue::remove  //
+//----------------------//
+tim* cal_queue::remove(tim* p) {
+    if (!p || n < 1)
+        return 0;
+    if (!buckets[bucketof(dayof(p->t))].remove(p))
+        return 0;
+    n -= 1;
+    if (resize_enabled && nbuckets > calq_min_buckets && n < nbuckets/2)
+        resize(nbuckets/2);
+    return p;
+    } // End of function cal_queue::remove.
+
+//----------------------//
+//   cal_queue::clear   //
+//----------------------//
+void cal_queue::clear() {
+    for (unsigned int i = 0; i < nbuckets; ++i)
+        buckets[i].clear();
+    n = 0;
+    day = 0;
+    cur = 0;
+    } // End of function cal_queue::clear.
+
+//------------------------------//
+//   cal_queue_traversal::next  //
+//------------------------------//
+tim* cal_queue_traversal::next() {
+    if (!cq)
+        return 0;
+    while (b < cq->nbuckets) {
+        if (i < cq->buckets[b].length())
+            return cq->buckets[b].element(i++);
+        b += 1;
+        i = 0;
+        }
+    return 0;
+    } // End of function cal_queue_traversal::next.
+
+/*------------------------------------------------------------------------------
+ladder_rung::init() prepares a rung for "nb" buckets of width "w", starting at
+time "s". The bucket array is only re-allocated if it is too small, so that the
+arrays in the buckets can be re-used.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   ladder_rung::init  //
+//----------------------//
+void ladder_rung::init(double s, double w, unsigned int nb) {
+    if (nb > size) {
+        delete[] buckets;
+        buckets = new tim_bucket[nb];
+        size = nb;
+        }
+    for (unsigned int i = 0; i < nb; ++i)
+        buckets[i].clear();
+    nbuckets = nb;
+    cur = 0;
+    n = 0;
+    start = s;
+    width = w;
+    } // End of function ladder_rung::init.
+
+/*------------------------------------------------------------------------------
+ladq_bucket() returns the bucket of the rung "r" for the time "t", which must
+not be less than r.cur_start(). The result is clamped to the range of buckets
+which have not been passed down yet, to protect against rounding errors.
+The same calculation must be used for inserting and removing events.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      ladq_bucket     //
+//----------------------//
+static inline unsigned int ladq_bucket(const ladder_rung& r, double t) {
+    double x = (t - r.start)/r.width;
+    if (x >= r.nbuckets)
+        return r.nbuckets - 1;
+    unsigned int k = (x > 0) ? (unsigned int)x : 0;
+    return (k < r.cur) ? r.cur : k;
+    } // End of function ladq_bucket.
+
+//------------------------------//
+//  ladder_queue::ladder_queue  //
+//------------------------------//
+ladder_queue::ladder_queue() {
+    top_start = -HUGE_VAL;
+    top_min = 0;
+    top_max = 0;
+    nrungs = 0;
+    n = 0;
+    } // End of function ladder_queue::ladder_queue.
+
+/*------------------------------------------------------------------------------
+ladder_queue::spread() moves the events in the bucket "b" into the rung "r",
+which is initialised to have (b.length() + 1) buckets of width "w", starting at
+time "s". The order of events in "b" is preserved within each new bucket.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   ladder_queue::spread   //
+//--------------------------//
+void ladder_queue::spread(ladder_rung& r, tim_bucket& b, double s, double w) {
+    unsigned int len = b.length();
+    r.init(s, w, len + 1);
+    for (unsigned int j = 0; j < len; ++j) {
+        tim* p = b.element(j);
+        r.buckets[ladq_bucket(r, p->t)].append(p);
+        }
+    r.n = len;
+    b.clear();
+    } // End of function ladder_queue::spread.
+
+/*------------------------------------------------------------------------------
+ladder_queue::top_to_ladder() is called when the ladder and bottom are empty.
+The events in "top" are spread out over a new first rung, and the start of top
+is moved to the end of the new rung. If all events in top have the same time,
+they are already sorted. So they are moved straight to bottom.
+------------------------------------------------------------------------------*/
+//----------------------------------//
+//   ladder_queue::top_to_ladder    //
+//----------------------------------//
+void ladder_queue::top_to_ladder() {
+    if (top_max <= top_min) {
+        bottom.swap(top);
+        top_start = top_max;
+        return;
+        }
+    unsigned int len = top.length();
+    double w = (top_max - top_min)/len;
+    spread(rungs[0], top, top_min, w);
+    nrungs = 1;
+
+    // This must be the same as rungs[0].start + rungs[0].nbuckets * w.
+    top_start = top_min + (len + 1) * w;
+    } // End of function ladder_queue::top_to_ladder.
+
+/*------------------------------------------------------------------------------
+ladder_queue::bottom_to_ladder() is called when bottom has grown too big for
+sorted insertion. The events in bottom are spread out over a new lowest rung,
+which covers the time from the first event in bottom up to the current bucket
+of the rung above, or up to the start of top if there are no rungs.
+------------------------------------------------------------------------------*/
+//----------------------------------//
+//  ladder_queue::bottom_to_ladder  //
+//----------------------------------//
+void ladder_queue::bottom_to_ladder() {
+    unsigned int len = bottom.length();
+    double t0 = bottom.first()->t;
+    double t1 = (nrungs > 0) ? rungs[nrungs-1].cur_start() : top_start;
+    if (t1 <= t0 || bottom.element(len - 1)->t <= t0)
+        return;
+    spread(rungs[nrungs], bottom, t0, (t1 - t0)/len);
+    nrungs += 1;
+    } // End of function ladder_queue::bottom_to_ladder.
+
+/*------------------------------------------------------------------------------
+ladder_queue::refill_bottom() is called when bottom is empty, but the queue is
+not. The first non-empty bucket of the lowest rung is either sorted into bottom,
+or else spread out over a new lower rung if it is too big to be sorted. Rungs
+are removed from the ladder as they are used up. When the ladder is empty, the
+events in top are moved to the ladder.
+------------------------------------------------------------------------------*/
+//----------------------------------//
+//   ladder_queue::refill_bottom    //
+//----------------------------------//
+void ladder_queue::refill_bottom() {
+    for (;;) {
+        if (nrungs == 0) {
+            if (top.empty())
+                return;
+            top_to_ladder();
+            if (!bottom.empty())
+                return;
+            continue;
+            }
+        ladder_rung& r = rungs[nrungs-1];
+        while (r.cur < r.nbuckets && r.buckets[r.cur].empty())
+            r.cur += 1;
+        if (r.cur >= r.nbuckets) {
+            nrungs -= 1;
+            continue;
+            }
+        tim_bucket& b = r.buckets[r.cur];
+        unsigned int len = b.length();
+        double s = r.cur_start();
+        r.n -= len;
+        r.cur += 1;
+
+        // Spread a big bucket over a new rung, if there is room for one.
+        if (len > ladq_threshold && nrungs < ladq_max_rungs) {
+            double t0 = b.first()->t;
+            bool_enum same = true;
+            for (unsigned int j = 1; j < len; ++j)
+                if (b.element(j)->t != t0) {
+                    same = false;
+                    break;
+                    }
+            if (!same) {
+                spread(rungs[nrungs], b, s, r.width/len);
+                nrungs += 1;
+                continue;
+                }
+            }
+
+        // Otherwise sort the bucket into bottom.
+        b.sort();
+        bottom.swap(b);
+        if (r.cur >= r.nbuckets)
+            nrungs -= 1;
+        return;
+        }
+    } // End of function ladder_queue::refill_bottom.
+
+/*------------------------------------------------------------------------------
+ladder_queue::first() returns the first event without removing it. This may
+require events to be moved down the ladder. So it is not a "const" function.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   ladder_queue::first    //
+//--------------------------//
+const tim* ladder_queue::first() {
+    if (n < 1)
+        return 0;
+    if (bottom.empty())
+        refill_bottom();
+    return bottom.first();
+    } // End of function ladder_queue::first.
+
+/*------------------------------------------------------------------------------
+ladder_queue::insert() inserts a pointer to a "tim" or derived structure into
+the queue.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   ladder_queue::insert   //
+//--------------------------//
+void ladder_queue::insert(tim* p) {
+    if (!p)
+        return;
+    n += 1;
+    double t = p->t;
+    if (t >= top_start) {
+        if (top.empty())
+            top_min = top_max = t;
+        else if (t < top_min)
+            top_min = t;
+        else if (t > top_max)
+            top_max = t;
+        top.append(p);
+        return;
+        }
+    for (unsigned int i = 0; i < nrungs; ++i) {
+        ladder_rung& r = rungs[i];
+        if (r.cur < r.nbuckets && t >= r.cur_start()) {
+            r.buckets[ladq_bucket(r, t)].append(p);
+            r.n += 1;
+            return;
+            }
+        }
+    bottom.insert(p);
+    if (bottom.length() > ladq_threshold && nrungs < ladq_max_rungs)
+        bottom_to_ladder();
+    } // End of function ladder_queue::insert.
+
+/*------------------------------------------------------------------------------
+ladder_queue::popfirst() removes a pointer in the queue with the least value
+of the member "t". The pointer is returned to the caller.
+When the queue becomes empty, the start of top is reset so that the next event
+goes into top.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//  ladder_queue::popfirst  //
+//--------------------------//
+tim* ladder_queue::popfirst() {
+    if (n < 1)
+        return 0;
+    if (bottom.empty())
+        refill_bottom();
+    tim* p = bottom.popfirst();
+    n -= 1;
+    if (n == 0) {
+        nrungs = 0;
+        top_start = -HUGE_VAL;
+        }
+    return p;
+    } // End of function ladder_queue::popfirst.
+
+/*------------------------------------------------------------------------------
+ladder_queue::remove() removes an arbitrary pointer from the queue.
+The section of the ladder which holds the event is found in the same way as for
+insertion. If the event is not found there, all sections are searched.
+The pointer is returned if it was found. Otherwise null is returned.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   ladder_queue::remove   //
+//--------------------------//
+tim* ladder_queue::remove(tim* p) {
+    if (!p || n < 1)
+        return 0;
+    double t = p->t;
+    tim* q = 0;
+    unsigned int i;
+    if (t >= top_start)
+        q = top.remove(p);
+    else {
+        for (i = 0; i < nrungs; ++i) {
+            ladder_rung& r = rungs[i];
+            if (r.cur < r.nbuckets && t >= r.cur_start()) {
+                if ((q = r.buckets[ladq_bucket(r, t)].remove(p)) != 0)
+                    r.n -= 1;
+                break;
+                }
+            }
+        if (i >= nrungs)
+            q = bottom.remove(p);
+        }
+
+    // Fall back to a search of the whole ladder.
+    if (!q && (q = bottom.remove(p)) == 0 && (q = top.remove(p)) == 0) {
+        for (i = 0; i < nrungs && !q; ++i) {
+            ladder_rung& r = rungs[i];
+            for (unsigned int k = r.cur; k < r.nbuckets; ++k)
+                if ((q = r.buckets[k].remove(p)) != 0) {
+                    r.n -= 1;
+                    break;
+                    }
+            }
+        }
+    if (!q)
+        return 0;
+    n -= 1;
+    if (n == 0) {
+        nrungs = 0;
+        top_start = -HUGE_VAL;
+        }
+    return q;
+    } // End of function ladder_queue::remove.
+
+//--------------------------//
+//   ladder_queue::clear    //
+//--------------------------//
+void ladder_queue::clear() {
+    top.clear();
+    bottom.clear();
+    for (unsigned int i = 0; i < nrungs; ++i) {
+        ladder_rung& r = rungs[i];
+        for (unsigned int k = 0; k < r.nbuckets; ++k)
+            r.buckets[k].clear();
+        r.n = 0;
+        }
+    nrungs = 0;
+    top_start = -HUGE_VAL;
+    n = 0;
+    } // End of function ladder_queue::clear.
+
+/*------------------------------------------------------------------------------
+The traversal visits bottom first, then the rungs from the lowest to the
+highest, then top. This is not the dequeueing order.
+------------------------------------------------------------------------------*/
+//----------------------------------//
+//   ladder_queue_traversal::next   //
+//----------------------------------//
+tim* ladder_queue_traversal::next() {
+    if (!lq)
+        return 0;
+    for (;;) {
+        const tim_bucket* pb = 0;
+        if (r == 0)
+            pb = (b == 0) ? &lq->bottom : 0;
+        else if (r <= lq->nrungs) {
+            ladder_rung& rr = lq->rungs[lq->nrungs - r];
+            pb = (b < rr.nbuckets) ? &rr.buckets[b] : 0;
+            }
+        else if (r == lq->nrungs + 1)
+            pb = (b == 0) ? &lq->top : 0;
+        else
+            return 0;
+        if (!pb) {
+            r += 1;
+            b = 0;
+            i = 0;
+            continue;
+            }
+        if (i < pb->length())
+            return pb->element(i++);
+        b += 1;
+        i = 0;
+        }
+    } // End of function ladder_queue_traversal::next.
@@ -30,10 +30,23 @@ hashtab_str_8::
     find
     first
     next
+hashtab_str::
+    hash
+    resize
+    insert
+    find
+    del
+    clear
 ------------------------------------------------------------------------------*/
 
 #include "aksl/hashfn.h"
 
+// System header files:
+#ifndef AKSL_X_STRING_H
+#define AKSL_X_STRING_H
+#include <string.h>
+#endif
+
 static const int mask8     = 0xff;
 static const int mask16    = 0xffff;
 
@@ -390,3 +403,138 @@ voidptrstr* hashtab_str_8::next(int* pi) {
         *pi = trav_i;
     return trav_ptr;
     } // End of function hashtab_str_8::next.
+
+/*------------------------------------------------------------------------------
+The FNV-1a hash function. This is much faster than crc32calc() for short keys.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   hashtab_str::hash  //
+//----------------------//
+uint32 hashtab_str::hash(const char* key) {
+    uint32 h = 2166136261U;
+    for ( ; *key; ++key) {
+        h ^= (unsigned char)*key;
+        h *= 16777619U;
+        }
+    return h;
+    } // End of function hashtab_str::hash.
+
+/*------------------------------------------------------------------------------
+This function doubles the size of the array, and re-inserts all entries.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  hashtab_str::resize //
+//----------------------//
+void hashtab_str::resize() {
+    hashtab_str_pair* old = table;
+    uint32 oldsize = size;
+    size = size ? 2 * size : 16;
+    table = new hashtab_str_pair[size];
+    for (uint32 i = 0; i < size; ++i) {
+        table[i].data = 0;
+        table[i].key = 0;
+        }
+    uint32 mask = size - 1;
+    for (uint32 j = 0; j < oldsize; ++j) {
+        if (!old[j].key)
+            continue;
+        uint32 i = hash(old[j].key) & mask;
+        while (table[i].key)
+            i = (i + 1) & mask;
+        table[i] = old[j];
+        }
+    delete[] old;
+    } // End of function hashtab_str::resize.
+
+/*------------------------------------------------------------------------------
+This function will always over-write an existing entry for the given key.
+The key string is not copied.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  hashtab_str::insert //
+//----------------------//
+void hashtab_str::insert(const void* data, const char* key) {
+    if (!key)
+        return;
+    if (2 * (n + 1) > size)
+        resize();
+    uint32 mask = size - 1;
+    uint32 i = hash(key) & mask;
+    for ( ; table[i].key; i = (i + 1) & mask) {
+        if (strcmp(table[i].key, key) == 0) {
+            table[i].data = data;
+            table[i].key = key;
+            return;
+            }
+        }
+    table[i].data = data;
+    table[i].key = key;
+    n += 1;
+    } // End of function hashtab_str::insert.
+
+//----------------------//
+//   hashtab_str::find  //
+//----------------------//
+bool_enum hashtab_str::find(void*& data, const char* key) const {
+    if (!key || n == 0)
+        return false;
+    uint32 mask = size - 1;
+    for (uint32 i = hash(key) & mask; table[i].key; i = (i + 1) & mask) {
+        if (strcmp(table[i].key, key) == 0) {
+            data = (void*)table[i].data;
+            return true;
+            }
+        }
+    return false;
+    } // End of function hashtab_str::find.
+
+/*------------------------------------------------------------------------------
+Deletion with linear probing must move later entries of the same cluster back
+into the gap, so that find() does not stop early at the empty slot.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   hashtab_str::del   //
+//----------------------//
+bool_enum hashtab_str::del(const char* key) {
+    if (!key || n == 0)
+        return false;
+    uint32 mask = size - 1;
+    uint32 i = hash(key) & mask;
+    for ( ; table[i].key; i = (i + 1) & mask)
+        if (strcmp(table[i].key, key) == 0)
+            break;
+    if (!table[i].key)
+        return false;
+
+    // Close the gap at i:
+    uint32 j = i;
+    for (;;) {
+        table[i].key = 0;
+        table[i].data = 0;
+        for (;;) {
+            j = (j + 1) & mask;
+            if (!table[j].key) {
+                n -= 1;
+                return true;
+                }
+            // Entry j may fill the gap if its home slot is not in (i, j]:
+            uint32 h = hash(table[j].key) & mask;
+            if (i <= j ? (i < h && h <= j) : (i < h || h <= j))
+                continue;
+            break;
+            }
+        table[i] = table[j];
+        i = j;
+        }
+    } // End of function hashtab_str::del.
+
+//----------------------//
+//  hashtab_str::clear  //
+//----------------------//
+void hashtab_str::clear() {
+    for (uint32 i = 0; i < size; ++i) {
+        table[i].data = 0;
+        table[i].key = 0;
+        }
+    n = 0;
+    } // End of function hashtab_str::clear.
@@ -8,35 +8,61 @@ modified Artistic Licence, as specified in the accompanying LICENCE file.
 Functions in this file:
 
 min_tim_heap::
-    resize
+    reserve
     insert
+    heapify
+    insert_many
     popfirst
+    remove
 min_tim2_heap::
-    resize
     insert
+    heapify
+    insert_many
     popfirst
+    remove
+min_tim_dheap::
+    min_tim_dheap
+    reserve
+    insert
+    heapify
+    insert_many
+    popfirst
+    remove
+min_ord_dheap::
+    min_ord_dheap
+    reserve
+    insert
+    sift_down
+    heapify
+    insert_many
+    popfirst
+    remove
 ------------------------------------------------------------------------------*/
 
 #include "aksl/heap.h"
 
 /*------------------------------------------------------------------------------
-min_tim_heap::resize() dynamically resizes the heap.
-Argument checks not necessary because only used internally.
-The size is increased by the constant value "heap_block_size".
+min_tim_heap::reserve() makes the heap array big enough for "m" elements.
+Since heap[0] is not used, the array size must be at least m + 1.
+The resize() function calls this with double the current size, so that the
+cost of copying is amortised constant time per insertion.
 ------------------------------------------------------------------------------*/
-//----------------------//
-// min_tim_heap::resize //
-//----------------------//
-void min_tim_heap::resize() {
-    tim** p = new tim*[size + heap_block_size];
+//--------------------------//
+//  min_tim_heap::reserve   //
+//--------------------------//
+void min_tim_heap::reserve(unsigned int m) {
+    if (m < size)
+        return;
+    unsigned int newsize = m + 1;
+    tim** p = new tim*[newsize];
     tim** q = p;
     tim** r = heap;
-    for (unsigned long i = 0; i < size; ++i)
+    for (unsigned long i = 0; i < size; ++i)  // (n may be equal to size.)
         *q++ = *r++;
     delete[] heap;
     heap = p;
-    size += heap_block_size;
-    } // End of function min_tim_heap::resize.
+    size = newsize;
+    } // End of function min_tim_heap::reserve.
 
 /*------------------------------------------------------------------------------
 min_tim_heap::insert() inserts a pointer to a "tim" or derived structure into
@@ -62,6 +88,60 @@ void min_tim_heap::insert(tim* p) {
     heap[j] = p;
     } // End of function min_tim_heap::insert.
 
+/*------------------------------------------------------------------------------
+min_tim_heap::heapify() restores the heap condition for elements 1 to n,
+assuming that elements 1 to m already satisfy it. Elements m + 1 to n are in
+arbitrary order. This is the bottom-up heap construction of Floyd, which sifts
+down each parent node from the last parent back to the root.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//  min_tim_heap::heapify   //
+//--------------------------//
+void min_tim_heap::heapify(unsigned int m) {
+    if (m >= n)
+        return;
+    for (unsigned long k = n >> 1; k >= 1; --k) {
+        tim* q = heap[k];
+        double t = q->t;
+        unsigned long i = k;
+        unsigned long j;
+        while ((j = i << 1) <= n) {
+            if (j < n && heap[j+1]->t < heap[j]->t)
+                j += 1;
+            if (heap[j]->t >= t)
+                break;
+            heap[i] = heap[j];
+            i = j;
+            }
+        heap[i] = q;
+        }
+    } // End of function min_tim_heap::heapify.
+
+/*------------------------------------------------------------------------------
+min_tim_heap::insert_many() inserts the "k" pointers in the array "pp" into the
+heap. Null pointers are ignored. If there are fewer new elements than old ones,
+they are inserted one by one. Otherwise they are appended to the heap, and the
+heap is rebuilt in linear time.
+------------------------------------------------------------------------------*/
+//------------------------------//
+//  min_tim_heap::insert_many   //
+//------------------------------//
+void min_tim_heap::insert_many(tim** pp, unsigned int k) {
+    if (!pp || k == 0)
+        return;
+    reserve(n + k);
+    if (k < n) {
+        for (unsigned int i = 0; i < k; ++i)
+            insert(pp[i]);
+        return;
+        }
+    unsigned int m = n;
+    for (unsigned int i = 0; i < k; ++i)
+        if (pp[i])
+            heap[++n] = pp[i];
+    heapify(m);
+    } // End of function min_tim_heap::insert_many.
+
 /*------------------------------------------------------------------------------
 min_tim_heap::popfirst() removes a pointer in the heap with the least value
 of the member "t". The pointer is returned to the caller.
@@ -91,29 +171,53 @@ tim* min_tim_heap::popfirst() {
     } // End of function min_tim_heap::popfirst.
 
 /*------------------------------------------------------------------------------
-min_tim2_heap::resize() dynamically resizes the heap.
-Argument checks not necessary because only used internally.
-The size is increased by the constant value "heap_block_size".
+min_tim_heap::remove() removes an arbitrary element from the heap. The element
+is found by a linear search, because the heap does not record the positions of
+its elements. The hole is then filled with the end-of-heap element, which is
+percolated up or down as required. The pointer is returned if it was found.
+Otherwise the null pointer is returned. (Only the first copy of a multiple
+member of the heap is removed.)
 ------------------------------------------------------------------------------*/
 //--------------------------//
-//   min_tim2_heap::resize  //
+//   min_tim_heap::remove   //
 //--------------------------//
-void min_tim2_heap::resize() {
-    // Create a new array of pointers.
-    tim2** p = new tim2*[size + heap_block_size];
+tim* min_tim_heap::remove(tim* p) {
+    if (!p)
+        return 0;
+    unsigned long i;
+    for (i = 1; i <= n; ++i)
+        if (heap[i] == p)
+            break;
+    if (i > n)
+        return 0;
+    tim* q = heap[n];
+    n -= 1;
+    if (i > n)
+        return p;
+    double t = q->t;
 
-    // Copy the old pointers to the new array.
-    tim2** q = p;
-    tim2** r = (tim2**)heap;
-    // (Only need to copy up to i <= n here. But play safe.)
-    for (unsigned long i = 0; i < size; ++i)
-        *q++ = *r++;
+    // Percolate upwards.
+    while (i > 1) {
+        unsigned long k = i >> 1;   // k is the parent of i.
+        if (heap[k]->t <= t)
+            break;
+        heap[i] = heap[k];
+        i = k;
+        }
 
-    // Delete the old array, and update pointer and size.
-    delete[] heap;
-    heap = (tim**)p;
-    size += heap_block_size;
-    } // End of function min_tim2_heap::resize.
+    // Percolate downwards.
+    unsigned long j;
+    while ((j = i << 1) <= n) {
+        if (j < n && heap[j+1]->t < heap[j]->t)
+            j += 1;
+        if (heap[j]->t >= t)
+            break;
+        heap[i] = heap[j];
+        i = j;
+        }
+    heap[i] = q;
+    return p;
+    } // End of function min_tim_heap::remove.
 
 #include <iostream>
 
@@ -152,24 +256,91 @@ void min_tim2_heap::insert(tim2* p) {
 
         // Move the parent to the child position.
         heap[j] = heap[i];
+        ((tim2*)heap[j])->hpos = j;
         j = i;
         }
     // Leave the new event in the child position.
     heap[j] = p;
+    p->hpos = j;
     } // End of function min_tim2_heap::insert.
 
+/*------------------------------------------------------------------------------
+min_tim2_heap::heapify() is the same as min_tim_heap::heapify(), except for the
+sorting criterion.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//  min_tim2_heap::heapify  //
+//--------------------------//
+void min_tim2_heap::heapify(unsigned int m) {
+    if (m >= n)
+        return;
+    for (unsigned long k = n >> 1; k >= 1; --k) {
+        tim2* q = (tim2*)heap[k];
+        double t = q->t;
+        unsigned long long index = q->index;
+        unsigned long i = k;
+        unsigned long j;
+        while ((j = i << 1) <= n) {
+            tim2* c0 = (tim2*)heap[j];
+            if (j < n) {
+                tim2* c1 = (tim2*)heap[j+1];
+                if (c1->t < c0->t
+                        || ((c1->t == c0->t) && c1->index < c0->index)) {
+                    c0 = c1;
+                    j += 1;
+                    }
+                }
+            if (t < c0->t || (t == c0->t && index < c0->index))
+                break;
+            heap[i] = c0;
+            c0->hpos = i;
+            i = j;
+            }
+        heap[i] = q;
+        q->hpos = i;
+        }
+    } // End of function min_tim2_heap::heapify.
+
+/*------------------------------------------------------------------------------
+min_tim2_heap::insert_many() is the same as min_tim_heap::insert_many(), except
+that the new elements are given sequence numbers in the order of the array.
+So equal-time elements are dequeued in the same order as if they had been
+inserted one by one.
+------------------------------------------------------------------------------*/
+//------------------------------//
+//  min_tim2_heap::insert_many  //
+//------------------------------//
+void min_tim2_heap::insert_many(tim2** pp, unsigned int k) {
+    if (!pp || k == 0)
+        return;
+    reserve(n + k);
+    if (k < n) {
+        for (unsigned int i = 0; i < k; ++i)
+            insert(pp[i]);
+        return;
+        }
+    unsigned int m = n;
+    for (unsigned int i = 0; i < k; ++i) {
+        if (!pp[i])
+            continue;
+        pp[i]->index = next_index;
+        next_index += 1;
+        heap[++n] = pp[i];
+        pp[i]->hpos = n;
+        }
+    heapify(m);
+    } // End of function min_tim2_heap::insert_many.
+
 /*------------------------------------------------------------------------------
 min_tim2_heap::popfirst() removes a pointer in the heap with the least value
 of the member "t". The pointer is returned to the caller.
 This differs from the min_tim_heap class in the sorting criterion.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-It is very important to compare indices by comparing the difference with 0
-rather than comparing the indices with each other.
-This copes optimally with the integer wrap-around problem.
-Thus (i1 < i2) will give the wrong answer if i2 has wrapped around to -infinity.
-But ((i1 - i2) < 0) will give the right answer if there are less than
-2 billion events enqueued between the two events.
-This should be satisfactory for all except the most extreme situations.
+The indices are unsigned 64-bit integers, which cannot wrap around in any
+realistic simulation. (At 10^9 insertions per second, it would take over 500
+years.) So they are compared directly. The old 32-bit signed indices had to be
+compared by their difference, which failed if more than 2 billion events were
+enqueued between two equal-time events.
 ------------------------------------------------------------------------------*/
 //--------------------------//
 //  min_tim2_heap::popfirst //
@@ -185,7 +356,7 @@ tim2* min_tim2_heap::popfirst() {
     tim2* q = (tim2*)heap[n];
     n -= 1;
     double t = q->t;
-    long index = q->index;
+    unsigned long long index = q->index;
 
     // Percolate the end-of-heap event into the heap from the top.
     unsigned long i = 1;
@@ -201,22 +372,479 @@ tim2* min_tim2_heap::popfirst() {
 
             // If right child < left child, focus on the right child.
             if (c1->t < c0->t
-                    || ((c1->t == c0->t) && (c1->index - c0->index) < 0)) {
+                    || ((c1->t == c0->t) && c1->index < c0->index)) {
                 c0 = c1;
                 j += 1;
                 }
             }
 
         // If parent < least child, exit the loop.
-        if (t < c0->t || (t == c0->t && (index - c0->index) < 0))
+        if (t < c0->t || (t == c0->t && index < c0->index))
             break;
 
         // If parent >= least child, move the child into the parent position.
         heap[i] = c0;
+        c0->hpos = i;
         i = j;
         }
     // Put the parent event in the hole created in the heap.
     heap[i] = q;
+    q->hpos = i;
 
+    p->hpos = 0;
     return p;
     } // End of function min_tim2_heap::popfirst.
+
+/*------------------------------------------------------------------------------
+min_tim2_heap::remove() removes an arbitrary element from the heap in
+logarithmic time. The position of the element is known from its "hpos" field.
+The element is only removed if the heap really has a pointer to it in that
+position. So it is safe to call this for an element which is not in the heap,
+provided that its memory is still readable. (This is true for elements which
+are allocated by a "bmem", because bmem memory is never given back.)
+The pointer is returned if it was found. Otherwise the null pointer is returned.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   min_tim2_heap::remove  //
+//--------------------------//
+tim2* min_tim2_heap::remove(tim2* p) {
+    if (!contains(p))
+        return 0;
+    unsigned long i = p->hpos;
+    p->hpos = 0;
+    tim2* q = (tim2*)heap[n];
+    n -= 1;
+    if (q == p)
+        return p;
+    double t = q->t;
+    unsigned long long index = q->index;
+
+    // Percolate upwards.
+    while (i > 1) {
+        unsigned long k = i >> 1;   // k is the parent of i.
+        tim2* c = (tim2*)heap[k];
+        if (c->t < t || (c->t == t && c->index < index))
+            break;
+        heap[i] = c;
+        c->hpos = i;
+        i = k;
+        }
+
+    // Percolate downwards. (Does nothing if the element moved upwards.)
+    unsigned long j;
+    while ((j = i << 1) <= n) {
+        tim2* c0 = (tim2*)heap[j];
+        if (j < n) {
+            tim2* c1 = (tim2*)heap[j+1];
+            if (c1->t < c0->t
+                    || ((c1->t == c0->t) && c1->index < c0->index)) {
+                c0 = c1;
+                j += 1;
+                }
+            }
+        if (t < c0->t || (t == c0->t && index < c0->index))
+            break;
+        heap[i] = c0;
+        c0->hpos = i;
+        i = j;
+        }
+    heap[i] = q;
+    q->hpos = i;
+    return p;
+    } // End of function min_tim2_heap::remove.
+
+/*------------------------------------------------------------------------------
+The arity is rounded down to a power of 2, in the range from 2 to 16. Larger
+arities just waste time comparing children.
+------------------------------------------------------------------------------*/
+//----------------------------------//
+//  min_tim_dheap::min_tim_dheap    //
+//----------------------------------//
+min_tim_dheap::min_tim_dheap(unsigned int arity) {
+    dlog = 1;
+    while (dlog < 4 && (2u << dlog) <= arity)
+        dlog += 1;
+    d = 1 << dlog;
+    heap = new tim_entry[heap_block_size];
+    size = heap_block_size;
+    n = 0;
+    next_index = 0;
+    } // End of function min_tim_dheap::min_tim_dheap.
+
+/*------------------------------------------------------------------------------
+min_tim_dheap::reserve() makes the heap array big enough for "m" elements.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//  min_tim_dheap::reserve  //
+//--------------------------//
+void min_tim_dheap::reserve(unsigned int m) {
+    if (m <= size)
+        return;
+    tim_entry* p = new tim_entry[m];
+    for (unsigned int i = 0; i < n; ++i)
+        p[i] = heap[i];
+    delete[] heap;
+    heap = p;
+    size = m;
+    } // End of function min_tim_dheap::reserve.
+
+/*------------------------------------------------------------------------------
+min_tim_dheap::insert() inserts a pointer to a "tim" or derived structure into
+the heap. Since the new entry has the latest sequence number, a parent with the
+same time is less than the new entry. So only the times need to be compared.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   min_tim_dheap::insert  //
+//--------------------------//
+void min_tim_dheap::insert(tim* p) {
+    if (!p)
+        return;
+    if (n >= size)
+        resize();
+    double t = p->t;
+    unsigned int j = n;
+    n += 1;
+    while (j > 0) {
+        unsigned int i = (j - 1) >> dlog;   // i is the parent of j.
+        if (heap[i].t <= t)
+            break;
+        heap[j] = heap[i];
+        j = i;
+        }
+    heap[j].t = t;
+    heap[j].index = next_index;
+    heap[j].p = p;
+    next_index += 1;
+    } // End of function min_tim_dheap::insert.
+
+/*------------------------------------------------------------------------------
+min_tim_dheap::heapify() restores the heap condition for all elements, assuming
+that elements 0 to m - 1 already satisfy it. (See min_tim_heap::heapify().)
+------------------------------------------------------------------------------*/
+//--------------------------//
+//  min_tim_dheap::heapify  //
+//--------------------------//
+void min_tim_dheap::heapify(unsigned int m) {
+    if (m >= n || n < 2)
+        return;
+    for (unsigned int k = ((n - 2) >> dlog) + 1; k-- > 0; ) {
+        tim_entry e = heap[k];
+        unsigned int i = k;
+        unsigned int j;
+        while ((j = (i << dlog) + 1) < n) {
+            unsigned int jend = (j + d < n) ? j + d : n;
+            unsigned int c = j;
+            for (++j; j < jend; ++j)
+                if (heap[j].t < heap[c].t
+                    || (heap[j].t == heap[c].t
+                        && heap[j].index < heap[c].index))
+                    c = j;
+            if (e.t < heap[c].t
+                || (e.t == heap[c].t && e.index < heap[c].index))
+                break;
+            heap[i] = heap[c];
+            i = c;
+            }
+        heap[i] = e;
+        }
+    } // End of function min_tim_dheap::heapify.
+
+/*------------------------------------------------------------------------------
+min_tim_dheap::insert_many() inserts the "k" pointers in the array "pp" into the
+heap, in the same way as min_tim_heap::insert_many(). The sequence numbers are
+allocated in the order of the array.
+------------------------------------------------------------------------------*/
+//------------------------------//
+//  min_tim_dheap::insert_many  //
+//------------------------------//
+void min_tim_dheap::insert_many(tim** pp, unsigned int k) {
+    if (!pp || k == 0)
+        return;
+    if (n + k > size)
+        reserve((n + k > 2 * size) ? n + k : 2 * size);
+    if (k < n) {
+        for (unsigned int i = 0; i < k; ++i)
+            insert(pp[i]);
+        return;
+        }
+    unsigned int m = n;
+    for (unsigned int i = 0; i < k; ++i) {
+        if (!pp[i])
+            continue;
+        heap[n].t = pp[i]->t;
+        heap[n].index = next_index;
+        heap[n].p = pp[i];
+        next_index += 1;
+        n += 1;
+        }
+    heapify(m);
+    } // End of function min_tim_dheap::insert_many.
+
+/*------------------------------------------------------------------------------
+min_tim_dheap::popfirst() removes a pointer in the heap with the least value
+of the member "t". The pointer is returned to the caller.
+Equal times are resolved by the sequence numbers, as explained for
+min_tim2_heap::popfirst().
+------------------------------------------------------------------------------*/
+//------------------------------//
+//   min_tim_dheap::popfirst    //
+//------------------------------//
+tim* min_tim_dheap::popfirst() {
+    if (n < 1)
+        return 0;
+    tim* p = heap[0].p;
+    n -= 1;
+    if (n == 0)
+        return p;
+
+    // Percolate the end-of-heap entry into the heap from the top.
+    tim_entry e = heap[n];
+    unsigned int i = 0;
+    unsigned int j;
+    while ((j = (i << dlog) + 1) < n) { // j to j+d-1 are children of i.
+        unsigned int jend = (j + d < n) ? j + d : n;
+        unsigned int m = j;         // m is the least child.
+        for (++j; j < jend; ++j)
+            if (heap[j].t < heap[m].t
+                || (heap[j].t == heap[m].t
+                    && heap[j].index < heap[m].index))
+                m = j;
+        if (e.t < heap[m].t
+            || (e.t == heap[m].t && e.index < heap[m].index))
+            break;
+        heap[i] = heap[m];
+        i = m;
+        }
+    heap[i] = e;
+    return p;
+    } // End of function min_tim_dheap::popfirst.
+
+/*------------------------------------------------------------------------------
+min_tim_dheap::remove() removes an arbitrary element from the heap. The element
+is found by a linear search of the array, which is fast because the array is
+contiguous. The hole is filled with the end-of-heap entry, which is percolated
+up or down as required. The pointer is returned if it was found. Otherwise the
+null pointer is returned.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   min_tim_dheap::remove  //
+//--------------------------//
+tim* min_tim_dheap::remove(tim* p) {
+    if (!p)
+        return 0;
+    unsigned int i;
+    for (i = 0; i < n; ++i)
+        if (heap[i].p == p)
+            break;
+    if (i >= n)
+        return 0;
+    n -= 1;
+    if (i == n)
+        return p;
+    tim_entry e = heap[n];
+
+    // Percolate upwards.
+    while (i > 0) {
+        unsigned int k = (i - 1) >> dlog;   // k is the parent of i.
+        if (heap[k].t < e.t
+            || (heap[k].t == e.t && heap[k].index < e.index))
+            break;
+        heap[i] = heap[k];
+        i = k;
+        }
+
+    // Percolate downwards.
+    unsigned int j;
+    while ((j = (i << dlog) + 1) < n) {
+        unsigned int jend = (j + d < n) ? j + d : n;
+        unsigned int m = j;
+        for (++j; j < jend; ++j)
+            if (heap[j].t < heap[m].t
+                || (heap[j].t == heap[m].t
+                    && heap[j].index < heap[m].index))
+                m = j;
+        if (e.t < heap[m].t
+            || (e.t == heap[m].t && e.index < heap[m].index))
+            break;
+        heap[i] = heap[m];
+        i = m;
+        }
+    heap[i] = e;
+    return p;
+    } // End of function min_tim_dheap::remove.
+
+/*------------------------------------------------------------------------------
+The arity is rounded down to a power of 2, in the range from 2 to 16, as for
+min_tim_dheap.
+------------------------------------------------------------------------------*/
+//----------------------------------//
+//  min_ord_dheap::min_ord_dheap    //
+//----------------------------------//
+min_ord_dheap::min_ord_dheap(unsigned int arity) {
+    dlog = 1;
+    while (dlog < 4 && (2u << dlog) <= arity)
+        dlog += 1;
+    d = 1 << dlog;
+    heap = new ord_entry[heap_block_size];
+    size = heap_block_size;
+    n = 0;
+    } // End of function min_ord_dheap::min_ord_dheap.
+
+//--------------------------//
+//  min_ord_dheap::reserve  //
+//--------------------------//
+void min_ord_dheap::reserve(unsigned int m) {
+    if (m <= size)
+        return;
+    ord_entry* p = new ord_entry[m];
+    for (unsigned int i = 0; i < n; ++i)
+        p[i] = heap[i];
+    delete[] heap;
+    heap = p;
+    size = m;
+    } // End of function min_ord_dheap::reserve.
+
+/*------------------------------------------------------------------------------
+min_ord_dheap::insert() inserts a pointer to a "tim" or derived structure into
+the heap, with the given key and sequence number. Unlike in
+min_tim_dheap::insert(), the keys must be compared with the keys of equal-time
+parents, because the new entry is not necessarily the greatest of them.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   min_ord_dheap::insert  //
+//--------------------------//
+void min_ord_dheap::insert(tim* p, unsigned long long key,
+        unsigned long long seq) {
+    if (!p)
+        return;
+    if (n >= size)
+        resize();
+    ord_entry e;
+    e.t = p->t;
+    e.key = key;
+    e.seq = seq;
+    e.p = p;
+    unsigned int j = n;
+    n += 1;
+    while (j > 0) {
+        unsigned int i = (j - 1) >> dlog;   // i is the parent of j.
+        if (!e.less(heap[i]))
+            break;
+        heap[j] = heap[i];
+        j = i;
+        }
+    heap[j] = e;
+    } // End of function min_ord_dheap::insert.
+
+/*------------------------------------------------------------------------------
+min_ord_dheap::sift_down() puts the entry "e" into the hole at position i, and
+percolates it downwards until it is not greater than its least child.
+------------------------------------------------------------------------------*/
+//------------------------------//
+//   min_ord_dheap::sift_down   //
+//------------------------------//
+void min_ord_dheap::sift_down(unsigned int i, const ord_entry& e) {
+    unsigned int j;
+    while ((j = (i << dlog) + 1) < n) { // j to j+d-1 are children of i.
+        unsigned int jend = (j + d < n) ? j + d : n;
+        unsigned int m = j;         // m is the least child.
+        for (++j; j < jend; ++j)
+            if (heap[j].less(heap[m]))
+                m = j;
+        if (!heap[m].less(e))
+            break;
+        heap[i] = heap[m];
+        i = m;
+        }
+    heap[i] = e;
+    } // End of function min_ord_dheap::sift_down.
+
+/*------------------------------------------------------------------------------
+min_ord_dheap::heapify() restores the heap condition for all elements, assuming
+that elements 0 to m - 1 already satisfy it. (See min_tim_heap::heapify().)
+------------------------------------------------------------------------------*/
+//--------------------------//
+//  min_ord_dheap::heapify  //
+//--------------------------//
+void min_ord_dheap::heapify(unsigned int m) {
+    if (m >= n || n < 2)
+        return;
+    for (unsigned int k = ((n - 2) >> dlog) + 1; k-- > 0; ) {
+        ord_entry e = heap[k];
+        sift_down(k, e);
+        }
+    } // End of function min_ord_dheap::heapify.
+
+/*------------------------------------------------------------------------------
+min_ord_dheap::insert_many() inserts the "k" entries in the array "pe" into the
+heap, in the same way as min_tim_heap::insert_many(). The caller fills in the
+time, key, sequence number and pointer of each entry. Entries with a null
+pointer are ignored.
+------------------------------------------------------------------------------*/
+//------------------------------//
+//  min_ord_dheap::insert_many  //
+//------------------------------//
+void min_ord_dheap::insert_many(const ord_entry* pe, unsigned int k) {
+    if (!pe || k == 0)
+        return;
+    if (n + k > size)
+        reserve((n + k > 2 * size) ? n + k : 2 * size);
+    if (k < n) {
+        for (unsigned int i = 0; i < k; ++i)
+            insert(pe[i].p, pe[i].key, pe[i].seq);
+        return;
+        }
+    unsigned int m = n;
+    for (unsigned int i = 0; i < k; ++i)
+        if (pe[i].p)
+            heap[n++] = pe[i];
+    heapify(m);
+    } // End of function min_ord_dheap::insert_many.
+
+//------------------------------//
+//   min_ord_dheap::popfirst    //
+//------------------------------//
+tim* min_ord_dheap::popfirst() {
+    if (n < 1)
+        return 0;
+    tim* p = heap[0].p;
+    n -= 1;
+    if (n > 0)
+        sift_down(0, heap[n]);
+    return p;
+    } // End of function min_ord_dheap::popfirst.
+
+/*------------------------------------------------------------------------------
+min_ord_dheap::remove() removes an arbitrary element from the heap, in the same
+way as min_tim_dheap::remove().
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   min_ord_dheap::remove  //
+//--------------------------//
+tim* min_ord_dheap::remove(tim* p) {
+    if (!p)
+        return 0;
+    unsigned int i;
+    for (i = 0; i < n; ++i)
+        if (heap[i].p == p)
+            break;
+    if (i >= n)
+        return 0;
+    n -= 1;
+    if (i == n)
+        return p;
+    ord_entry e = heap[n];
+
+    // Percolate upwards.
+    while (i > 0) {
+        unsigned int k = (i - 1) >> dlog;   // k is the parent of i.
+        if (!e.less(heap[k]))
+            break;
+        heap[i] = heap[k];
+        i = k;
+        }
+
+    // Percolate downwards. (Does nothing if the entry moved upwards.)
+    sift_down(i, e);
+    return p;
+    } // End of function min_ord_dheap::remove.
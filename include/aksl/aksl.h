@@ -15,10 +15,12 @@ attr_type::
 object::
 objectlist::
 event::
+event_rec::
 event_heap::
 event_heap_traversal::
 globvar::
 globvarlist::
+subscriber_array::
 systm::
 systmlist::
 package::
@@ -43,6 +45,9 @@ object_friend::
 #ifndef AKSL_HEAP_H
 #include "aksl/heap.h"
 #endif
+#ifndef AKSL_FELQ_H
+#include "aksl/felq.h"
+#endif
 #ifndef AKSL_BMEM_H
 #include "aksl/bmem.h"
 #endif
@@ -55,6 +60,12 @@ object_friend::
 #ifndef AKSL_OPTIONS_H
 #include "aksl/options.h"
 #endif
+#ifndef AKSL_HASHFN_H
+#include "aksl/hashfn.h"
+#endif
+#ifndef AKSL_ARENA_H
+#include "aksl/arena.h"
+#endif
 
 // System header files.
 #ifndef AKSL_X_IOSTREAM_H
@@ -66,8 +77,15 @@ object_friend::
 struct event;
 struct event_heap;
 struct systm;
+struct psim;
+struct dsim;
+struct rtsim;
 struct package;
 struct model;
+struct ckpt_writer;
+struct ckpt_reader;
+struct event_trace;
+struct sim_profile;
 
 /*------------------------------------------------------------------------------
 This class is intended for communicating attribute types from system
@@ -103,13 +121,27 @@ friend struct model;
 friend struct systm;
 friend struct event;
 friend struct object_friend;
+friend struct psim;
+friend struct dsim;
+friend struct rtsim;
+friend struct event_heap;
+friend struct ckpt_writer;
+friend struct ckpt_reader;
+friend struct sim_profile;
+friend struct objectlist;
 private:
     int index;                      // Index of the object in its package.
+    unsigned int oid;               // Id of the object in its system.
+    object* prv;                    // The previous object in its objectlist.
+    unsigned int bgroup;            // Group in an event batch. (event_heap.)
+    unsigned long long nsent;       // Number of events sent. (event::seq.)
+    long aindex;                    // Index in its arena, or -1. (arena.h.)
+    bool_enum subscriber;           // True if it has called subscribe().
     mtype *mloc2glob;               // Local/global message type conversions.
     mtype *mglob2loc;               // Local/global message type conversions.
 
     // Functions provided here for use by the "system".
-    int sim(object* orig, mtype m, value* arg) {
+    int sim(object* orig, mtype m, const payload& arg) {
         return recv_message(orig, mglob2loc[m], arg); }
     value* get_glob_attr(mtype m) { return get_attr(mglob2loc[m]); }
     value* get_glob_attr(mtype m, const value& arg)
@@ -128,6 +160,7 @@ protected:
     inline event* send_message_abs(double, object*, mtype, datum*);
     inline event* send_message_abs(double, object*, mtype, double);
     inline event* send_message_abs(double, object*, mtype, long);
+    inline event* send_message_abs(double, object*, mtype, const payload&);
     inline event* send_message(double d, object* o, mtype t, value* v)
         { return send_message_abs(sysclock() + d, o, t, v); }
     inline event* send_message(double d, object* o, mtype t)
@@ -138,6 +171,8 @@ protected:
         { return send_message_abs(sysclock() + d, o, t, x); }
     inline event* send_message(double d, object* o, mtype t, long x)
         { return send_message_abs(sysclock() + d, o, t, x); }
+    inline event* send_message(double d, object* o, mtype t, const payload& x)
+        { return send_message_abs(sysclock() + d, o, t, x); }
 
     // [Functions which send messages on behalf of other objects.]
     inline event* send_message_abs(object*, double, object*, mtype, value*);
@@ -145,6 +180,8 @@ protected:
     inline event* send_message_abs(object*, double, object*, mtype, datum*);
     inline event* send_message_abs(object*, double, object*, mtype, double);
     inline event* send_message_abs(object*, double, object*, mtype, long);
+    inline event* send_message_abs(object*, double, object*, mtype,
+        const payload&);
     inline event* send_message(object* p, double d, object* o,mtype t,value* v)
         { return send_message_abs(p, sysclock() + d, o, t, v); }
     inline event* send_message(object* p, double d, object* o, mtype t)
@@ -155,9 +192,20 @@ protected:
         { return send_message_abs(p, sysclock() + d, o, t, x); }
     inline event* send_message(object* p, double d, object* o, mtype t, long x)
         { return send_message_abs(p, sysclock() + d, o, t, x); }
+    inline event* send_message(object* p, double d, object* o, mtype t,
+            const payload& x)
+        { return send_message_abs(p, sysclock() + d, o, t, x); }
 
+    // cancel_message() takes the event out of the FEL and deletes it (see
+    // systm::cancel_message()). cancel_message_no_check() only marks the event
+    // as cancelled, leaving a "tombstone" in the FEL which is discarded when
+    // its time comes. This takes constant time with every FEL, whereas the
+    // ladder queue and d-ary heap must search for an event to remove it. The
+    // event must not have been delivered yet, and in Time Warp it must not be
+    // used at all, because it cannot be undone (see psim.h).
     inline void cancel_message_no_check(event*);    // Fast no-check version.
     inline void cancel_message(event*);             // Safer version.
+    int subscribe(mtype);           // Receive broadcasts of this type.
     inline object* newobject(c_string&, c_string&);
     inline double sysclock();
     inline int setglob(const c_string&, value* = 0);
@@ -178,8 +226,30 @@ protected:
     virtual int init() { return 0; }
     virtual int recv_message(object* /*caller*/, mtype /*msg*/, value* /*arg*/)
         { return 0; }
+    // The kernel calls this version, which receives the argument by value.
+    // By default, it calls the "value*" version with arg_value(arg).
+    virtual int recv_message(object* caller, mtype msg, payload arg)
+        { return recv_message(caller, msg, arg_value(arg)); }
+    inline value* arg_value(const payload&);    // The argument as a value.
     virtual int term() { return 0; }
     virtual void del() {}
+
+    // Handler-functions for optimistic parallel simulation. (See psim.h.)
+    // save_state() returns a new copy of the state of the object.
+    // restore_state() restores a saved state and then discards it.
+    virtual void* save_state() { return 0; }
+    virtual void restore_state(void* /*state*/) {}
+    virtual void discard_state(void* /*state*/) {}
+
+    // Handler-functions for checkpoints. (See ckpt.h.)
+    // write_state() writes the dynamic state of the object, and read_state()
+    // reads it back in the same order. write_datum() and read_datum() do the
+    // same for a datum argument of an event for which the object is the
+    // destination.
+    virtual int write_state(ckpt_writer&) { return 0; }
+    virtual int read_state(ckpt_reader&) { return 0; }
+    virtual int write_datum(ckpt_writer&, datum*) { return eNOT_SERIALISABLE; }
+    virtual datum* read_datum(ckpt_reader&) { return 0; }
 public:
     // Variable functions provided here for general use.
     c_string name;           // Read-only. Set at construction time.
@@ -215,16 +285,32 @@ public:
     // Function to be provided in derived classes for general use.
     virtual const char* type() { return "object"; } // Class name of object.
 
+    // The id of the object in its system. (See systm::object_by_id().)
+    unsigned int id() const { return oid; }
+
+    // Allocation in the heap or in an arena. (See arena.h.)
+    long arena_index() const { return aindex; }
+    static void* operator new(size_t);
+    static void* operator new(size_t, obj_arena*);
+    static void operator delete(void*);
+    static void operator delete(void*, obj_arena*);
+
     object();
     ~object() { del(); }
     }; // End of struct object.
 
+/*------------------------------------------------------------------------------
+An objectlist keeps a pointer to the previous object in each object, so that
+remove() takes constant time.
+------------------------------------------------------------------------------*/
 //----------------------//
 //      objectlist::    //
 //----------------------//
 struct objectlist: private s2list {
 friend struct systm;
 friend struct model;
+friend struct psim;
+friend struct dsim;
 private:
     model* mdl;
 public:
@@ -235,11 +321,32 @@ public:
 private:
     // These functions are made private because objectlists are always
     // "owned" by their system and/or model.
-    void append(object* p) { s2list::append(p); }
-    void prepend(object* p) { s2list::prepend(p); }
-    object* popfirst() { return (object*)s2list::popfirst(); }
-    object* poplast() { return (object*)s2list::poplast(); }
-    object* remove(object* p) { return (object*)s2list::remove(p); }
+    void append(object* p) { p->prv = last(); s2list::append(p); }
+    void prepend(object* p) {
+        object* q = first();
+        s2list::prepend(p);
+        p->prv = 0;
+        if (q)
+            q->prv = p;
+        }
+    object* popfirst() {
+        object* p = (object*)s2list::popfirst();
+        if (first())
+            first()->prv = 0;
+        return p;
+        }
+    object* poplast() { return remove(last()); }
+    object* remove(object* p) {     // The object must be in this list.
+        if (!p)
+            return 0;
+        object* q = p->next();
+        if (!s2list::removeafter(p->prv, p))
+            return 0;
+        if (q)
+            q->prv = p->prv;
+        p->prv = 0;
+        return p;
+        }
     void delfirst() { delete popfirst(); }
     void dellast() { delete poplast(); }
     void delremove(object* p) { delete remove(p); }
@@ -285,6 +392,18 @@ Each of these three classes must invoke the methods of the other in a cyclical
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 The "index" member will be used for determining the dequeuing order of
 events which have the same execution time.
+The members "prio", "depth" and "seq" are set when the event is sent, for the
+ordered FEL (felORDERED). "prio" is the priority of the message type in the
+model (see model::set_priority()). "depth" is 0 for an event which is sent for
+a later time than the current time. Otherwise it is one more than the depth of
+the event which is being simulated. "seq" is the number of events which the
+origin object had sent before this one. Together with the time and the index
+of the origin object in its system, they give a total order of the events which
+does not depend on the order in which they were inserted into the FEL.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+The argument of an event is a "payload" (see value.h), so that a long, double,
+object* or datum* argument is stored in the event itself. A "value" is only
+created for an object whose recv_message() takes a "value*" argument.
 ------------------------------------------------------------------------------*/
 //----------------------//
 //        event::       //
@@ -301,26 +420,55 @@ friend struct event_heap;
 friend struct event_heap_traversal;
 #endif
 friend struct systm;
+friend struct psim;
+friend struct dsim;
+friend struct rtsim;
+friend struct event_trace;
+friend struct sim_profile;
 private:
     object* orig;       // Source of the event. (Only null if cancelled.)
     object* dest;       // Destination of the event. (Null for broadcast.)
     mtype   mty;        // (Global) type of event.
-    value*  arg;        // The event argument(s).
+    short prio;         // Priority of the message type. (Lower is first.)
+    unsigned short depth;   // Generation of a zero-delay event.
+    payload arg;        // The event argument(s).
+    unsigned long long seq;     // Sequence number of the event at its origin.
 
     void cancel() { orig = 0; }
+    bool_enum refers_to(const object* po) const {  // For systm::remove().
+        return (bool_enum)(orig == po || dest == po
+                           || (arg.type() == pOBJECT && (object*)arg == po));
+        }
+    unsigned long long order_key() const {  // For felORDERED.
+        return ((unsigned long long)depth << 48)
+               | ((unsigned long long)((unsigned short)prio ^ 0x8000u) << 32)
+               | (orig ? orig->oid : 0);
+        }
+    void copy_order(const event* pe)
+        { prio = pe->prio; depth = pe->depth; seq = pe->seq; }
+    void get_order(ord_entry& e) const
+        { e.t = t; e.key = order_key(); e.seq = seq; e.p = (tim*)this; }
 public:
     double time() const { return t; }
     object* origin() const { return orig; }
+    int priority() const { return prio; }
+    unsigned long long sequence() const { return seq; }
     void print(ostream&, systm* = 0) const;
 
     // simulate() returns 0 if okay, or the erroneous object if not okay.
     object* simulate();
-    void setarg(datum* d) { delete arg; arg = new value(d); }
-    void setarg(double r) { delete arg; arg = new value(r); }
-    void setarg(long r) { delete arg; arg = new value(r); }
+    const payload& argument() const { return arg; }
+    void setarg(datum* d) { arg = d; }
+    void setarg(double r) { arg = r; }
+    void setarg(long r) { arg = r; }
+    void setarg(const payload& x) { arg = x; }
 
     // Memory management things.
+#if AKSL_BMEM_SAFE
+    static bmem_safe bmem0;
+#else
     static bmem bmem0;
+#endif
     void* operator new(size_t) { return bmem0.newchunk(); }
     void operator delete(void* p) { bmem0.freechunk(p); }
     static unsigned long n_objects() { return bmem0.length(); }
@@ -330,42 +478,198 @@ public:
         orig = oo;
         dest = dd;
         mty = mm;
-        arg = 0;
+        prio = 0;
+        depth = 0;
+        seq = 0;
         }
     ~event() {}
     }; // End of struct event.
 
+// The id of no object, for the destination of a broadcast event_rec.
+const unsigned int no_object_id = 0xffffffffu;
+
+/*------------------------------------------------------------------------------
+An event_rec is an event in which the objects are given by their ids in the
+system (see object::id()) instead of by pointers. So it can be sent to another
+process or stored in a file. The argument must be a long, a double or an
+object, which is also given by its id. The ordering fields are kept, so that
+the event has the same place in the ordered FEL as the original.
+systm::pack_event() converts an event to an event_rec, and unpack_event() and
+insert_event() convert it back.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      event_rec::     //
+//----------------------//
+struct event_rec {
+    double t;                       // Time of the event.
+    unsigned int orig;              // Id of the origin object.
+    unsigned int dest;              // Id of the destination, or no_object_id.
+    int mty;                        // Global message type.
+    short prio;                     // As in event.
+    unsigned short depth;           // As in event.
+    unsigned long long seq;         // As in event.
+    int ptype;                      // Ptype: pNONE, pINTEGER, pREAL or pOBJECT.
+    unsigned int argid;             // Id of the argument, if it is an object.
+    long long arg;                  // Integer or bits of a real argument.
+    }; // End of struct event_rec.
+
+/*------------------------------------------------------------------------------
+The future event list may be implemented as a binary heap (the default), a
+d-ary heap, a calendar queue or a ladder queue. See heap.h and felq.h. The heaps
+have the most predictable performance. The d-ary heap is more cache-friendly
+than the binary heap. The queues have amortised constant time insertion and
+extraction, which is better for very large event lists.
+All four implementations dequeue equal-time events in the order of insertion if
+AKSL_SYSTM_FEL_STRICT_ORDER is set.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+The ordered FEL (felORDERED) is a d-ary heap (min_ord_dheap) which dequeues
+equal-time events in order of increasing depth, then by priority, then by the
+index of the origin object in its system, and then by the sequence number of the
+event at its origin. (See event.) This order does not depend on the order of
+insertion, so a simulation gives the same results for any partition of the
+model (see psim.h), and when it is restored from a checkpoint. The depth comes
+first so that an event sent with zero delay is never dequeued before an event
+which was already in the FEL. Then the order is the same whether the events are
+dispatched one by one or in batches. The keys are copied into the heap entries,
+so that comparisons do not dereference the events.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+After defer() is called, inserted events are just appended to a pending array,
+until flush() is called. Then they are all inserted with insert_many(), which
+builds a heap in linear time. This is used by systm::simulate() while the
+objects are being initialised, which is when most of the events of a big model
+are created. The pending events are flushed automatically if they are needed.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+The function pop_batch() extracts all of the events which have the same time
+as the first event into the "batch" array, in dequeueing order. Then they may
+be dequeued one by one with pop_batched(), which is much cheaper than
+popfirst(). The undispatched events of the batch are regarded as the first
+events of the FEL. So first(), popfirst(), length() and remove() all take
+account of them, and pop_batch() just returns the rest of an unfinished
+batch. If set_grouping() is called, the batch is also stably sorted
+by destination object, with the destinations in order of first appearance.
+So all of the events for the same object are dispatched together.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+purge() deletes all of the events which refer to an object, for
+systm::remove(). (See event::refers_to().)
+------------------------------------------------------------------------------*/
+enum fel_t {
+    felHEAP,            // Binary heap.
+    felCALENDAR,        // Calendar queue.
+    felLADDER,          // Ladder queue.
+    felDARY,            // D-ary heap.
+    felORDERED          // D-ary heap with deterministic tie-breaking.
+    };
+
 //----------------------//
 //      event_heap::    //
 //----------------------//
+struct event_heap {
+friend struct event_heap_traversal;
+private:
+    fel_t felq;             // The implementation of the event list.
 #if AKSL_SYSTM_FEL_STRICT_ORDER
-struct event_heap: private min_tim2_heap {
+    min_tim2_heap heap;     // Used if felq == felHEAP.
 #else
-struct event_heap: private min_tim_heap {
+    min_tim_heap heap;      // Used if felq == felHEAP.
 #endif
-friend struct event_heap_traversal;
+    cal_queue* calq;        // Used if felq == felCALENDAR.
+    ladder_queue* ladq;     // Used if felq == felLADDER.
+    min_tim_dheap* dheap;   // Used if felq == felDARY.
+    min_ord_dheap* oheap;   // Used if felq == felORDERED.
+    event** pending;        // Events deferred by defer().
+    unsigned int npending;  // Number of pending events.
+    unsigned int pending_size;  // Size of the array "pending".
+    bool_enum deferring;    // True if insertions are being deferred.
+    event** batch;          // Equal-time events extracted by pop_batch().
+    unsigned int ibatch;    // The next event of the batch.
+    unsigned int nbatch;    // Number of events in the batch.
+    unsigned int batch_size;    // Size of the arrays "batch" and "gtmp".
+    bool_enum grouping;     // True if batches are grouped by destination.
+    event** gtmp;           // Temporary array for grouping.
+    unsigned int* gcount;   // Number of events in each group.
+
+    void defer_insert(event*);
+    void batch_append(event* p) {
+        if (nbatch >= batch_size)
+            resize_batch();
+        batch[nbatch++] = p;
+        }
+    void resize_batch();
+    void group_batch();
 public:
     // The routine members:
-#if AKSL_SYSTM_FEL_STRICT_ORDER
-    const event* first() const { return (const event*)min_tim2_heap::first(); }
-    const event* last() const { return (const event*)min_tim2_heap::last(); }
-    using min_tim2_heap::empty;
-    using min_tim2_heap::length;
-#else
-    const event* first() const { return (const event*)min_tim_heap::first(); }
-    const event* last() const { return (const event*)min_tim_heap::last(); }
-    using min_tim_heap::empty;
-    using min_tim_heap::length;
-#endif
+    fel_t fel_type() const { return felq; }
+    void set_fel_type(fel_t, unsigned int arity = dheap_default_arity);
+    unsigned int length() const {
+        unsigned int n = npending + nbatch - ibatch;
+        switch (felq) {
+        case felCALENDAR:   return n + calq->length();
+        case felLADDER:     return n + ladq->length();
+        case felDARY:       return n + dheap->length();
+        case felORDERED:    return n + oheap->length();
+        default:            return n + heap.length();
+            }
+        }
+    int empty() const { return length() == 0; }
+    const event* first() {  // Not const, because the FEL may be re-organised.
+        if (ibatch < nbatch)
+            return batch[ibatch];
+        if (npending > 0)
+            flush();
+        switch (felq) {
+        case felCALENDAR:   return (const event*)calq->first();
+        case felLADDER:     return (const event*)ladq->first();
+        case felDARY:       return (const event*)dheap->first();
+        case felORDERED:    return (const event*)oheap->first();
+        default:            return (const event*)heap.first();
+            }
+        }
 
-    // The cast in the next line should not be necessary!
+    // The casts in the next lines should not be necessary!
+    void reserve(unsigned int);
+    void defer() { deferring = true; }
+    void flush();
+    void insert(event* p) {
+        if (deferring) {
+            defer_insert(p);
+            return;
+            }
 #if AKSL_SYSTM_FEL_STRICT_ORDER
-    void insert(event* p) { min_tim2_heap::insert((tim2*)p); }
-    event* popfirst() { return (event*)min_tim2_heap::popfirst(); }
+        if (felq == felHEAP)
+            heap.insert((tim2*)p);
 #else
-    void insert(event* p) { min_tim_heap::insert((tim*)p); }
-    event* popfirst() { return (event*)min_tim_heap::popfirst(); }
+        if (felq == felHEAP)
+            heap.insert((tim*)p);
 #endif
+        else if (felq == felDARY)
+            dheap->insert((tim*)p);
+        else if (felq == felORDERED)
+            oheap->insert((tim*)p, p->order_key(), p->seq);
+        else if (felq == felCALENDAR)
+            calq->insert((tim*)p);
+        else
+            ladq->insert((tim*)p);
+        }
+    void insert_many(event**, unsigned int);
+    event* remove(event*, object*);
+    unsigned int purge(const object*);
+    event* popfirst() {
+        if (ibatch < nbatch)
+            return batch[ibatch++];
+        if (npending > 0)
+            flush();
+        switch (felq) {
+        case felCALENDAR:   return (event*)calq->popfirst();
+        case felLADDER:     return (event*)ladq->popfirst();
+        case felDARY:       return (event*)dheap->popfirst();
+        case felORDERED:    return (event*)oheap->popfirst();
+        default:            return (event*)heap.popfirst();
+            }
+        }
+    unsigned int pop_batch();
+    event* pop_batched() { return (ibatch < nbatch) ? batch[ibatch++] : 0; }
+    void set_grouping(bool_enum g = true) { grouping = g; }
+    bool_enum get_grouping() const { return grouping; }
     void delfirst() { delete popfirst(); }
     void del_events() {
         event* pe;
@@ -375,45 +679,97 @@ public:
     void print(ostream&, systm* = 0);
     void clear() { del_events(); }
 
-    event_heap() {}
-    ~event_heap() {}
+//    event_heap& operator=(const event_heap& x) {}
+//    event_heap(const event_heap& x) {};
+    event_heap() {
+        felq = felHEAP;
+        calq = 0;
+        ladq = 0;
+        dheap = 0;
+        oheap = 0;
+        pending = 0;
+        npending = 0;
+        pending_size = 0;
+        deferring = false;
+        batch = 0;
+        ibatch = 0;
+        nbatch = 0;
+        batch_size = 0;
+        grouping = false;
+        gtmp = 0;
+        gcount = 0;
+        }
+    ~event_heap() {
+        delete calq;
+        delete ladq;
+        delete dheap;
+        delete oheap;
+        delete[] pending;
+        delete[] batch;
+        delete[] gtmp;
+        delete[] gcount;
+        }
     }; // End of struct event_heap.
 
+/*------------------------------------------------------------------------------
+The traversal order is the internal order of the FEL implementation, which is
+not the dequeueing order.
+------------------------------------------------------------------------------*/
 //--------------------------//
 //  event_heap_traversal::  //
 //--------------------------//
+struct event_heap_traversal {
+private:
+    event_heap* eh;             // Pointer to the event list.
 #if AKSL_SYSTM_FEL_STRICT_ORDER
-struct event_heap_traversal: private tim2_heap_traversal {
-public:
-    event* next() { return (event*)tim2_heap_traversal::next(); }
-    using tim2_heap_traversal::init;
-
-//    event_heap_traversal& operator=(const event_heap_traversal& x) {}
-//    event_heap_traversal(const event_heap_traversal& x) {};
-    event_heap_traversal(event_heap& h): tim2_heap_traversal(h) {}
-    ~event_heap_traversal() {}
-
+    tim2_heap_traversal ht;
 #else
-struct event_heap_traversal: private heap_traversal {
+    heap_traversal ht;
+#endif
+    cal_queue_traversal ct;
+    ladder_queue_traversal lt;
+    dheap_traversal dt;
+    ord_dheap_traversal ot;
+    unsigned int pi;            // Position in pending events.
+    unsigned int bi;            // Position in batched events.
 public:
-    event* next() { return (event*)heap_traversal::next(); }
-    using heap_traversal::init;
+    event* next() {
+        if (bi < eh->nbatch)
+            return eh->batch[bi++];
+        if (pi < eh->npending)
+            return eh->pending[pi++];
+        switch (eh->felq) {
+        case felCALENDAR:   return (event*)ct.next();
+        case felLADDER:     return (event*)lt.next();
+        case felDARY:       return (event*)dt.next();
+        case felORDERED:    return (event*)ot.next();
+        default:            return (event*)ht.next();
+            }
+        }
+    void init() {
+        bi = eh->ibatch; pi = 0;
+        ht.init(); ct.init(); lt.init(); dt.init(); ot.init(); }
 
 //    event_heap_traversal& operator=(const event_heap_traversal& x) {}
 //    event_heap_traversal(const event_heap_traversal& x) {};
-    event_heap_traversal(event_heap& h): heap_traversal(h) {}
+    event_heap_traversal(event_heap& h):
+        ht(h.heap), ct(h.calq), lt(h.ladq), dt(h.dheap), ot(h.oheap)
+        { eh = &h; pi = 0; bi = h.ibatch; }
     ~event_heap_traversal() {}
-#endif
     }; // End of struct event_heap_traversal.
 
 /*------------------------------------------------------------------------------
-The global variables should really be in some sort of hash table.
+The global variables are kept in a list, in order of creation, and are also
+indexed by name in a hash table, so that set() and get() take constant time.
+The index refers to the name strings of the globvars. So the name of a globvar
+must not be changed while it is in the list.
 ------------------------------------------------------------------------------*/
 //----------------------//
 //       globvar::      //
 //----------------------//
 struct globvar: public slink {
 friend struct globvarlist;
+friend struct systm;
 private:
     c_string name;      // Name of the global variable.
     value* val;         // Value of the global variable.
@@ -428,21 +784,40 @@ public:
 //     globvarlist::    //
 //----------------------//
 struct globvarlist: private s2list {
+private:
+    hashtab_str index;              // Index of the globvars by name.
 public:
     // The routine members.
     using s2list::empty;
     using s2list::length;
     globvar* first() const { return (globvar*)s2list::first(); }
     globvar* last() const { return (globvar*)s2list::last(); }
-    void append(globvar* p) { s2list::append(p); }
-    void prepend(globvar* p) { s2list::prepend(p); }
-    globvar* popfirst() { return (globvar*)s2list::popfirst(); }
-    globvar* poplast() { return (globvar*)s2list::poplast(); }
+    void append(globvar* p)
+        { s2list::append(p); index.insert(p, p->name.read()); }
+    void prepend(globvar* p)
+        { s2list::prepend(p); index.insert(p, p->name.read()); }
+    globvar* popfirst() {
+        globvar* p = (globvar*)s2list::popfirst();
+        if (p)
+            index.del(p->name.read());
+        return p;
+        }
+    globvar* poplast() {
+        globvar* p = (globvar*)s2list::poplast();
+        if (p)
+            index.del(p->name.read());
+        return p;
+        }
     void delfirst() { delete popfirst(); }
     void dellast() { delete poplast(); }
-    using s2list::insertafter;
+    void insertafter(globvar* p1, globvar* p2) {  // Insert p2 after p1.
+        s2list::insertafter(p1, p2);
+        if (p2)
+            index.insert(p2, p2->name.read());
+        }
     void clear() { for (globvar* p = first(); p; )
-        { globvar* q = p->next(); delete p; p = q; } clearptrs(); }
+        { globvar* q = p->next(); delete p; p = q; }
+        clearptrs(); index.clear(); }
 
     int set(const c_string&, value* = 0);
     int set(const c_string&, const c_string&);
@@ -452,16 +827,83 @@ public:
     ~globvarlist() { clear(); }
     }; // End of struct globvarlist.
 
+/*------------------------------------------------------------------------------
+A subscriber_array is a growable array of the objects which receive broadcast
+events of one message type.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//    subscriber_array::    //
+//--------------------------//
+struct subscriber_array {
+    object** v;                 // Array of objects.
+    unsigned int n;             // Number of objects.
+    unsigned int size;          // Size of the array.
+
+    void append(object* p) { if (n >= size) resize(); v[n++] = p; }
+    void remove(object*);           // Keeps the order of the others.
+    void resize();
+    void clear() { n = 0; }
+
+//    subscriber_array& operator=(const subscriber_array& x) {}
+//    subscriber_array(const subscriber_array& x) {};
+    subscriber_array() { v = 0; n = 0; size = 0; }
+    ~subscriber_array() { delete[] v; }
+    }; // End of struct subscriber_array.
+
+/*------------------------------------------------------------------------------
+By default, a broadcast event is delivered to every object in the system except
+the sender. An object may call subscribe() in its init() function to declare
+each (local) message type which it accepts in broadcast events. After that, it
+receives only the broadcast events of these types. Each system keeps an array of
+the subscribers of each global message type, so that the cost of a broadcast
+depends on the number of subscribers, not on the number of objects.
+A broadcast is delivered first to the subscribers of its type, in the order in
+which they subscribed, and then to the objects which have not subscribed to
+any types, in the order of the object list. The subscriptions are cleared at the
+start of each simulation, before the objects are initialised.
+------------------------------------------------------------------------------*/
 //----------------------//
 //        systm::       //
 //----------------------//
 struct systm: public slink {
+friend struct object;
+friend struct psim;
+friend struct dsim;
+friend struct rtsim;
 private:
     model* mdl;             // The model in which the system is defined.
     globvarlist globvars;   // The global variables.
     event_heap events;      // The event heap.
     double clck;            // The system clock (in seconds).
     short trace;            // The trace level of the system.
+    unsigned long fel_hint; // Expected maximum number of events in the FEL.
+    unsigned long tombstones_avoided;   // Cancelled events removed from FEL.
+    psim* par;              // Parallel driver, if this is a partition.
+    systm* parent;          // The partitioned system, if this is a partition.
+    int lp;                 // The partition number, if this is a partition.
+    dsim* dist;             // Distributed driver, if any. (See dsim.h.)
+    subscriber_array* subs; // subs[m] = subscribers to global message type m.
+    unsigned int nsubs;     // Size of the array "subs".
+    unsigned long nsubscribers;     // Number of objects which subscribed.
+    subscriber_array others;        // Objects which did not subscribe.
+    bool_enum others_ok;    // False if "others" must be rebuilt.
+    event_trace* etrace;    // Binary event trace, if any. (See trace.h.)
+    sim_profile* prof;      // Profile, if profiling is on. (See prof.h.)
+    unsigned int next_oid;  // The id of the next object added.
+    object** objtab;        // objtab[i] = object with id i, or 0 if removed.
+    unsigned int objtab_size;       // Size of the array "objtab".
+    unsigned short depth;   // The depth of the current event. (See event.)
+    bool_enum in_bcast;     // True while a broadcast is being delivered.
+    value* bcast_value;     // The argument of the broadcast as a value, or 0.
+
+    void clear_subscriptions();
+    object* broadcast_all(object*, mtype, const payload&);
+
+    void par_enqueue(event*);
+    void par_cancelled(event*);
+    void dist_enqueue(event*);
+    inline void enqueue(event*);
+    globvarlist& gvars() { return parent ? parent->globvars : globvars; }
 public:
     c_string name;          // The name of the system.
     objectlist objects;     // The objects in the system.
@@ -470,18 +912,51 @@ public:
 
     double sysclock() { return clck; }
     unsigned long event_count() { return events.length(); }
+    fel_t fel_type() const { return events.fel_type(); }
+    void set_fel(fel_t f, unsigned int arity = dheap_default_arity)
+        { events.set_fel_type(f, arity); }
+    void set_fel_size_hint(unsigned long n) { fel_hint = n; }
+    void set_batch_grouping(bool_enum g = true) { events.set_grouping(g); }
+    unsigned long n_tombstones_avoided() const { return tombstones_avoided; }
     int add(object*);
+    int remove(object*);            // Take an object out. (Not deleted.)
+    object* object_by_id(unsigned int i) const {
+        if (parent)
+            return parent->object_by_id(i);
+        return (i < next_oid) ? objtab[i] : 0;
+        }
+    unsigned int n_object_ids() const
+        { return parent ? parent->next_oid : next_oid; }
+    int pack_event(const event*, event_rec&) const;
+    event* unpack_event(const event_rec&) const;
+    int insert_event(const event_rec&);
+    int subscribe(object*, mtype);  // The message type is global.
     void set_trace_level(short t) { trace = t; }
 
     int simulate(double = 1, double = 0);
-    object* broadcast(object*, mtype, value* = 0);
+    int initialise(double = 0);     // The parts of simulate().
+    int advance(double);
+    void terminate();
+    int resume(double = 1);         // Continue a simulation.
+    int checkpoint(const char*);    // Save the state. (See ckpt.h.)
+    int restore(const char*);       // Restore a saved state.
+    int open_event_trace(const char*, unsigned long = 65536,
+        bool_enum = false);         // Binary event trace. (See trace.h.)
+    int close_event_trace();
+    void sync_event_trace();
+    int set_profiling(bool_enum = true);    // Profile. (See prof.h.)
+    const sim_profile* profile() const { return prof; }
+    void print_profile(ostream& = cout) const;
+    object* broadcast(object*, mtype, const payload&);
+    object* broadcast(object* po, mtype m, value* pv = 0)
+        { return broadcast(po, m, payload(pv)); }
     int dump(FILE* = stdout) { return 0; }
     const char* sgetglob(const c_string& n);
     int setglob(const c_string& n, value* v = 0)
-        { return globvars.set(n, v); }
+        { return gvars().set(n, v); }
     int setglob(const c_string& n, const c_string& v)
-        { return globvars.set(n, v); }
-    const value* getglob(const c_string& n) { return globvars.get(n); }
+        { return gvars().set(n, v); }
+    const value* getglob(const c_string& n) { return gvars().get(n); }
     void cancel_message(event*, object*);  // Intended for use by objects.
     inline bool_enum print_message(int index, ostream&);
     inline mtype globkey(c_string&);
@@ -492,13 +967,38 @@ public:
     event* newevent_abs(double, object*, object*, mtype, datum*);
     event* newevent_abs(double, object*, object*, mtype, double);
     event* newevent_abs(double, object*, object*, mtype, long);
+    event* newevent_abs(double, object*, object*, mtype, const payload&);
 
     systm(model& m): objects(m) {
         mdl = &m;
         clck = 0;
         trace = 0;
+        fel_hint = 0;
+        tombstones_avoided = 0;
+        par = 0;
+        parent = 0;
+        lp = 0;
+        dist = 0;
+        subs = 0;
+        nsubs = 0;
+        nsubscribers = 0;
+        others_ok = false;
+        etrace = 0;
+        prof = 0;
+        next_oid = 0;
+        objtab = 0;
+        objtab_size = 0;
+        depth = 0;
+        in_bcast = false;
+        bcast_value = 0;
+        }
+    // Should the object list be deleted here?
+    ~systm() {
+        close_event_trace();
+        set_profiling(false);
+        delete[] subs;
+        delete[] objtab;
         }
-    ~systm() {} // Should the object list be deleted here?
     }; // End of struct systm.
 
 //----------------------//
@@ -538,12 +1038,23 @@ friend struct model;
 private:
     mtype *mloc2glob;               // Local/global message conversion table.
     mtype *mglob2loc;               // Global/local message conversion table.
+    mtype nlocal;                   // Size of mloc2glob.
     model* mdl;                     // The model using the package.
+    obj_arena** arenas;             // Arenas of the classes, or 0. (arena.h.)
+    int narenas;                    // Size of the array "arenas".
+    hashtab_str keyindex;           // Index of cs_mesgkeys. (After loading.)
+
+    void index_keys();
 public:
     // Provided here for general use.
     package* next() { return (package*)slink::next(); }
     inline object* newobject(systm&, c_string&, c_string&);
     inline const char* message_string(mtype); // String name for local integer.
+    long mesgkey(const c_string&);  // Local message key of a message name.
+    int set_arena(int, long = arena_deft_slab); // Use an arena for a class.
+    obj_arena* arena(int i) const
+        { return (i >= 0 && i < narenas) ? arenas[i] : 0; }
+    mtype n_local_mtypes() const { return nlocal; }   // 0 until loaded.
 
     // Unsafe message type conversion functions.
     // Could get bus error if "t" is out of range or the array is null.
@@ -563,14 +1074,24 @@ public:
     package() {
         mloc2glob = 0;
         mglob2loc = 0;
+        nlocal = 0;
         mdl = 0;
+        arenas = 0;
+        narenas = 0;
         new_object = 0;
         construct = 0;
         init = 0;
         term = 0;
         del = 0;
         }
-    ~package() { delete[] mloc2glob; delete[] mglob2loc; }
+    ~package() {
+        for (int i = 0; i < narenas; ++i)
+            if (arenas[i])
+                arenas[i]->discard();
+        delete[] arenas;
+        delete[] mloc2glob;
+        delete[] mglob2loc;
+        }
     }; // End of struct package.
 
 //----------------------//
@@ -605,6 +1126,8 @@ public:
 struct model {
 friend struct systm;
 friend struct package;
+friend struct psim;
+friend struct sim_profile;
 private:
     systmlist systems;          // The systems using this model.
     strnglist pkgsneeded;       // The packages required for the simulation.
@@ -612,10 +1135,16 @@ private:
     packagelist linkedpackages; // List of packages linked but not loaded.
     packagelist packages;       // List of loaded packages.
     objectlist reps;            // Representatives of each class of object.
+    hashtab_str repindex;       // Index of "reps" by type name.
 
     // The global message name table.
     const char **mtypenames;
     c_stringlist cs_mtypenames;     // The list of message types in the model.
+    hashtab_str mtypeindex;         // Index of cs_mtypenames.
+
+    // Priorities of global message types, for felORDERED. (Default 0.)
+    short* mprio;
+    unsigned int nmprio;            // Size of the array "mprio".
 public:
     // To be called by applications programs.
     systm* newsystem(c_string);     // Create a system.
@@ -630,19 +1159,27 @@ public:
     int load2(package* (**)());     // Load packages via a function table.
     int load(const c_string&);      // Load by name. (Must be pre-linked.)
     strnglist* missingpackages();   // Packages that need to be linked.
+    systm* firstsystem() const { return systems.first(); }
 
     // For general use, and via system interfaces.
     object* newobject(systm&, c_string&, c_string&);
+    obj_arena* arena(const c_string&);  // Arena of a class, or 0.
     bool_enum print_message(int index, ostream& = cout);
-    mtype globkey(c_string& cs) { return (mtype)cs_mtypenames.index(cs); }
+    mtype globkey(c_string& cs) { void* p = 0;
+        return mtypeindex.find(p, cs.read()) ? mtype(long(p)) : mtype(-1); }
+    int set_priority(const c_string&, int);     // Lower is dequeued first.
+    int priority(mtype m) const
+        { return ((unsigned int)m < nmprio) ? mprio[m] : 0; }
 
     void print(ostream& = cout);
 
     model(): reps(*this) {
         pkgnotfound = false;
         mtypenames = 0;
+        mprio = 0;
+        nmprio = 0;
         }
-    ~model() {}
+    ~model() { delete[] mprio; }
     }; // End of struct model.
 
 /*------------------------------------------------------------------------------
@@ -671,6 +1208,9 @@ public:
         { return p->send_message(t, d, m, r); }
     event* send_message(object* p, double t, object* d, mtype m, long i)
         { return p->send_message(t, d, m, i); }
+    event* send_message(object* p, double t, object* d, mtype m,
+            const payload& x)
+        { return p->send_message(t, d, m, x); }
 
 //    object_friend& operator=(const object_friend& x) {}
 //    object_friend(const object_friend& x) {};
@@ -699,6 +1239,9 @@ inline event* object::send_message_abs(double time, object* dest, mtype message,
 inline event* object::send_message_abs(double time, object* dest,
         mtype message, long t) {
     return sys->newevent_abs(time, this, dest, mloc2glob[message], t); }
+inline event* object::send_message_abs(double time, object* dest,
+        mtype message, const payload& x) {
+    return sys->newevent_abs(time, this, dest, mloc2glob[message], x); }
 
 /*------------------------------------------------------------------------------
 These functions send messages on behalf of another object, but using the
@@ -719,6 +1262,9 @@ inline event* object::send_message_abs(object* p, double time, object* dest,
 inline event* object::send_message_abs(object* p, double time, object* dest,
         mtype message, long t) {
     return sys->newevent_abs(time, p, dest, mloc2glob[message], t); }
+inline event* object::send_message_abs(object* p, double time, object* dest,
+        mtype message, const payload& x) {
+    return sys->newevent_abs(time, p, dest, mloc2glob[message], x); }
 
 inline void object::cancel_message_no_check(event* p) // Unsafe version.
     { if (p && p->origin() == this) p->cancel(); }
@@ -728,6 +1274,27 @@ inline object* object::newobject(c_string& type, c_string& newname) {
     return (pkg && sys) ? pkg->newobject(*sys, type, newname) : 0; }
 inline double object::sysclock() {
     return sys->sysclock(); }
+
+/*------------------------------------------------------------------------------
+object::arg_value() returns the argument of an event as a value, for the
+default recv_message(), which passes it to the "value*" version. If the payload
+holds a value, that value is returned, and it belongs to the recipient, as for
+any value sent with send_message(). Otherwise a new value is made. For a
+point-to-point event it belongs to the recipient. For a broadcast, it is made
+only once, when the first recipient which needs it receives the event. It is
+then shared by all of the recipients, and it is deleted by the system after the
+broadcast, so a recipient must copy it if it needs it later.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  object::arg_value   //
+//----------------------//
+inline value* object::arg_value(const payload& x) {
+    if (!sys || !sys->in_bcast || x.type() == pVALUE)
+        return x.new_value();
+    if (!sys->bcast_value)
+        sys->bcast_value = x.new_value();
+    return sys->bcast_value;
+    } // End of function object::arg_value.
 inline int object::setglob(const c_string& a, value* b) {
     return sys->setglob(a, b); }
 inline int object::setglob(const c_string& a, const c_string& b) {
@@ -741,11 +1308,11 @@ inline const char* object::sgetglob(const c_string& s) {
 inline const char* object::sgetglob(const char* s) {
     c_string cs(s); return sys->sgetglob(s); }
 inline int object::set_attr(const c_string& attr, value& newvalue) {
-    return set_attr((mtype)pkg->cs_mesgkeys.key(attr), newvalue); }
+    return set_attr((mtype)pkg->mesgkey(attr), newvalue); }
 inline value* object::get_attr(const c_string& attr) {
-    return get_attr((mtype)pkg->cs_mesgkeys.key(attr)); }
+    return get_attr((mtype)pkg->mesgkey(attr)); }
 inline value* object::get_attr(const c_string& attr, const value& arg) {
-    return get_attr((mtype)pkg->cs_mesgkeys.key(attr), arg); }
+    return get_attr((mtype)pkg->mesgkey(attr), arg); }
 inline const char* object::message_string(mtype m) {
     return pkg ? pkg->message_string(m) : 0; }
 
@@ -754,8 +1321,8 @@ Function event::simulate() returns 0 if okay, or the erroneous object
 if not okay. If the "dest" pointer is null, then a copy of the message
 is sent to all objects in the system which contains "orig".
 Order of delivery is essentially unpredictable.
-Special NOTE: If any object tampers with "arg", then all later
-recipients of the argument are affected!!!!!
+Special NOTE: If the argument is a "value" and any object tampers with it,
+then all later recipients of the argument are affected!!!!!
 ------------------------------------------------------------------------------*/
 //----------------------//
 //        event::       //
@@ -773,6 +1340,24 @@ inline bool_enum systm::print_message(int index, ostream& os)
 inline mtype systm::globkey(c_string& cs)
     { return mdl ? mdl->globkey(cs) : -1; }
 
+/*------------------------------------------------------------------------------
+systm::enqueue() stamps a new event with its priority, depth and sequence
+number at its origin, which must not be null, and then inserts it into the FEL,
+or passes it to the parallel or distributed driver. The depth saturates at its
+maximum.
+------------------------------------------------------------------------------*/
+inline void systm::enqueue(event* pe) {
+    pe->prio = (short)mdl->priority(pe->mty);
+    pe->depth = (pe->t > clck) ? 0 : (depth < 0xffff) ? depth + 1 : depth;
+    pe->seq = pe->orig->nsent++;
+    if (par)
+        par_enqueue(pe);
+    else if (dist)
+        dist_enqueue(pe);
+    else
+        events.insert(pe);
+    }
+
 //----------------------//
 //       package::      //
 //----------------------//
@@ -131,6 +131,14 @@ linux                                   1
 #define TEMPLATES_OK
 #endif
 
+// Storage class for variables which are private to each thread.
+// (Empty if the compiler does not support thread-local storage.)
+#ifdef __GNUC__
+#define AKSL_TLS __thread
+#else
+#define AKSL_TLS
+#endif
+
 // Determine if for-loop declaration scope is restricted to the for-loop block:
 // #if !defined(__GNUC__) && !defined(SOLARIS_COMP_VERSION4)
 #if !defined(__GNUC__)
@@ -0,0 +1,150 @@
+// src/aksl/arena.h   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+#ifndef AKSL_ARENA_H
+#define AKSL_ARENA_H
+/*------------------------------------------------------------------------------
+Classes in this file:
+
+arena_slot::
+obj_arena::
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Object arenas.
+
+Simulation objects are normally made one at a time with "operator new" by the
+new_object() function of their package, so that the objects of a large system
+are scattered over the heap. An obj_arena holds the objects of one class in
+contiguous slabs of memory instead, so that a pass over the objects of a class
+touches consecutive memory.
+
+A package asks for an arena for one of its classes with package::set_arena().
+After that, model::newobject() makes the objects of that class in the arena,
+without any change to the new_object() function of the package. A package may
+also allocate objects in an arena explicitly with "new(arena) myclass(...)".
+The arenas are found by package::arena() or model::arena().
+
+Each object of an arena has an index, which is its slot in the arena. The
+indices of the objects of an arena are 0, 1, 2, ... in the order of creation,
+and the slot of a deleted object is re-used by the next new object. So the
+objects of a class may be visited by index, as follows, as well as through the
+object list of their system.
+    for (long i = 0; i < pa->length(); ++i)
+        if ((po = pa->at(i)) != 0)
+            ...
+object::arena_index() returns the index of an object, or -1 if it is not in an
+arena.
+
+Every object is preceded in memory by an arena_slot header, whether it is in an
+arena or not, so that "delete" can give the memory back to the right place.
+Operator delete is given only the address of an object which has already been
+destroyed, so the header is the only way of finding its arena in constant
+time. (Otherwise every delete would have to search the slabs of all arenas.)
+The header is 16 bytes on 64-bit machines, and the base class "object" alone
+is 112 bytes, so a heap object grows by less than 15%.
+The first object made in an arena fixes the size of its slots. A larger object
+is made on the heap instead.
+
+While bmem_threaded is set, the arena is locked in the same way as a bmem. An
+arena is not deleted while it holds any objects. If its package is deleted
+first, it is deleted when its last object is deleted.
+------------------------------------------------------------------------------*/
+
+// AKSL header files:
+#ifndef AKSL_BMEM_H
+#include "aksl/bmem.h"
+#endif
+#ifndef AKSL_BOOLE_H
+#include "aksl/boole.h"
+#endif
+#ifndef AKSL_AKSLDEFS_H
+#include "aksl/aksldefs.h"
+#endif
+
+// System header files:
+#ifndef AKSL_X_STDDEF_H
+#define AKSL_X_STDDEF_H
+#include <stddef.h>
+#endif
+
+// Forward class references.
+struct object;
+struct obj_arena;
+struct arena_slot;
+
+// The default number of objects in a slab of an arena.
+const long arena_deft_slab = 256;
+
+// The arena for the next object made by object::operator new(size_t), if any.
+// Set by model::newobject() and cleared by the next object allocation.
+extern AKSL_TLS obj_arena* arena_next;
+
+// The arena slot of the object under construction. (Used by object::object.)
+extern AKSL_TLS arena_slot* arena_pending;
+
+/*------------------------------------------------------------------------------
+The header of every object. Its size is 16 bytes on 64-bit machines, which
+keeps the alignment of "operator new".
+------------------------------------------------------------------------------*/
+//----------------------//
+//      arena_slot::    //
+//----------------------//
+struct arena_slot {
+    obj_arena* arena;               // The arena of the slot, or 0 for the heap.
+    long index;                     // Index in the arena, or -1.
+    }; // End of struct arena_slot.
+
+//----------------------//
+//      obj_arena::     //
+//----------------------//
+struct obj_arena {
+friend struct object;
+friend struct package;
+private:
+    char** slabs;                   // The slabs of slots.
+    long nslabs;                    // Number of slabs.
+    long slabs_size;                // Size of the array "slabs".
+    object** objs;                  // The object in each slot, or 0 if free.
+    long nper;                      // Number of slots in a slab.
+    long objsize;                   // Size of the objects. 0 until the first.
+    long slotsize;                  // Size of a slot, including the header.
+    long n;                         // Number of slots which have been used.
+    long nlive;                     // Number of objects in the arena.
+    arena_slot* free;               // Free list of slots of deleted objects.
+    bool_enum orphan;               // True if the package has been deleted.
+    volatile int lock;              // Spin lock, used if bmem_threaded is set.
+
+    void newslab();
+    void* alloc(size_t);            // Memory for an object, or 0.
+    void release(arena_slot*);
+    void bind(arena_slot* ps, object* po) { objs[ps->index] = po; }
+    void discard();                 // For the package destructor.
+public:
+    long length() const { return n; }       // Indices are 0 to length() - 1.
+    object* at(long i) const { return (i >= 0 && i < n) ? objs[i] : 0; }
+    long n_live() const { return nlive; }
+    long object_size() const { return objsize; }
+    unsigned long size() const { return nslabs * nper * slotsize; }
+
+//    obj_arena& operator=(const obj_arena& x) {}
+//    obj_arena(const obj_arena& x) {};
+    obj_arena(long nslab = arena_deft_slab) {
+        slabs = 0;
+        nslabs = 0;
+        slabs_size = 0;
+        objs = 0;
+        nper = (nslab > 0) ? nslab : arena_deft_slab;
+        objsize = 0;
+        slotsize = 0;
+        n = 0;
+        nlive = 0;
+        free = 0;
+        orphan = false;
+        lock = 0;
+        }
+    ~obj_arena();
+    }; // End of struct obj_arena.
+
+#endif /* AKSL_ARENA_H */
@@ -10,6 +10,7 @@ modified Artistic Licence, as specified in the accompanying LICENCE file.
 /*------------------------------------------------------------------------------
 Classes defined in this file:
 
+bmem_mag::
 bmem::
 bmem_ptr::
 bmem_safe::
@@ -23,11 +24,6 @@ using namespace std;
 #include <iostream>
 #endif
 
-// BMEM_TRACE should normally be set to 0.
-// Set this to 1 when compiling AKSL to activate bmem allocation tracing.
-// This is intended for diagnosis of unusual memory allocation errors.
-#define BMEM_TRACE 0
-
 // GNU g++/solaris/pc seems particularly prone to the alignment problem.
 // But should check on which environments have the problem exactly.
 // Warning: It is assumed here that sizeof(char*) == 4.
@@ -43,15 +39,70 @@ using namespace std;
 // The default number of chunks in a block:
 const long deftnchunks = 64;
 
+// The default maximum number of bytes in a block. (See bmem::set_growth().)
+const long bmem_deft_max_block = 1L << 20;
+
+// The size of a huge page, for msHUGEPAGE.
+const long bmem_huge_page = 2L << 20;
+
 enum memsrc_t {
     msNEW,
-    msMALLOC
+    msMALLOC,
+    msMMAP,             // Anonymous mmap(), rounded up to whole pages.
+    msHUGEPAGE          // mmap() of huge pages, or else transparent ones.
+    };
+
+// How bmem_safe gives the blocks which it reclaims back to the system.
+enum bmem_release_t {
+    brFREE,             // Free the block with delete[], free() or munmap().
+    brMADVISE           // Keep the block, but release its pages with madvise().
     };
 
+// Non-zero while more than one thread may be using bmems. (See psim.h.)
+extern volatile int bmem_threaded;
+
+// Number of chunks moved at once between a thread and the depot of a bmem.
+const long bmem_batch = 32;
+
+// Number of batches which the depot of a bmem can hold.
+const int bmem_depot_size = 32;
+
+// Maximum number of bmems with thread caches at once. Any further bmems use a
+// lock, and are not in the registry.
+const int bmem_max_slots = 1024;
+
+// Gives the cached chunks of the calling thread back to their bmems.
+extern void bmem_thread_flush();
+
+// The registry of bmems. (See bmem::.)
+struct bmem;
+extern int bmem_count();                    // Number of places in registry.
+extern bmem* bmem_registered(int i);        // The bmem in place i, or 0.
+extern bmem* bmem_find(const char* owner);  // First bmem of an owner, or 0.
+extern void bmem_dump(ostream& = cout);     // Print all bmems in registry.
+
+/*------------------------------------------------------------------------------
+A bmem_mag is the cache of free chunks of one bmem in one thread. It holds two
+lists of chunks: "cur", from which chunks are allocated and to which they are
+freed, and "prev", which is either empty or a full batch of bmem_batch chunks.
+So a thread may allocate or free up to bmem_batch chunks without touching the
+bmem, and it moves chunks to or from the depot only one batch at a time.
+------------------------------------------------------------------------------*/
+//----------------------//
+//       bmem_mag::     //
+//----------------------//
+struct bmem_mag {
+    char* cur;          // The current list of free chunks.
+    long ncur;          // Number of chunks in "cur". (At most bmem_batch.)
+    char* prev;         // A full batch, or 0.
+    unsigned int gen;   // Generation of the bmem in the slot, or 0.
+    }; // End of struct bmem_mag.
+
 /*------------------------------------------------------------------------------
 This class manages a very simple singly-linked memory allocation list.
 The class never gives memory back to "new" (or ultimately "malloc"),
-and all allocation is of fixed length blocks.
+and all allocation is of fixed length blocks. (The exception is the derived
+class bmem_safe, which can release blocks whose chunks are all free.)
 The advantages of this way of doing things are:
 1.  Less bugs.  [Surprisingly many malloc libraries have bugs.]
 2.  More speed. [This is because fixed-length allocation is very fast.]
@@ -59,8 +110,57 @@ The advantages of this way of doing things are:
 The pointer "free" points to the first free memory chunk at the head
 of the list of free chunks. No record is kept of allocated chunks as such.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-The memsrc member determines whether malloc or operator new should be used for
-allocating memory.
+The memsrc member determines whether operator new, malloc() or mmap() should be
+used for allocating memory. With msMMAP, each block is an anonymous mapping,
+rounded up to a whole number of pages. With msHUGEPAGE, each block is rounded
+up to a whole number of huge pages (bmem_huge_page bytes), and it is mapped
+with MAP_HUGETLB if possible, and otherwise it is aligned to a huge page and
+marked with MADV_HUGEPAGE, so that transparent huge pages may be used. So
+there are fewer TLB misses. (If mmap() is not available, operator new is
+used.) The memory source may be changed with set_memsrc() until the first
+block has been allocated, which is not until the first chunk is allocated.
+If the memory source fails, an error is printed and newchunk() returns 0.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+The first block has "n" chunks, as given to the constructor. Each further block
+has twice as many chunks as the one before, until the block would be larger
+than bmem_deft_max_block bytes, or the maximum set by set_growth(). So the
+number of blocks is logarithmic in the number of chunks.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+prefill(n) allocates one block so that the bmem has at least n chunks in all,
+and it touches every page of the block. This may be called before a
+simulation, so that the expected working set is faulted in before the timing
+starts.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+While the global flag "bmem_threaded" is set, newchunk() and freechunk() use a
+cache of free chunks in each thread (a bmem_mag), so that events and values may
+be allocated and freed by several threads at once without any locks in the
+common case. When the cache of a thread is empty or full, a batch of
+bmem_batch chunks is taken from or given to the depot of the bmem. The depot
+is an array of pointers to batches, which is updated with compare-and-swap
+only, so it is lock-free. Only when the depot is empty or full is the spin
+lock of the bmem taken, to carve a batch from the free list, or from a new
+block, or to put a batch back on the free list. The single-threaded cost is
+one predictable branch, and in the single-threaded case the free list is
+refilled from the depot before a new block is allocated. (The atomic
+operations use the GNU __sync built-in functions.)
+
+A thread which has used bmems while bmem_threaded was set must call
+bmem_thread_flush() before it exits, and the main thread must call it before
+clearing bmem_threaded. Otherwise, the chunks cached by the thread are lost.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+The number of chunks in use, and its highest value, are counted as chunks are
+allocated and freed, so that length() and high_water() take constant time.
+While bmem_threaded is set, the counts are updated atomically only when chunks
+move between a thread cache and the bmem, and the chunks in the caches of
+threads are counted as in use. (The high-water mark is then approximate.)
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Each bmem is put in a process-wide registry when it is constructed, with the
+name of its owner, which is the class name for bmem_define(). The registry may
+be printed with bmem_dump(), or polled with bmem_count(), bmem_registered()
+and bmem_find(), for example to watch the memory use of a long simulation.
+The place of a deleted bmem is re-used by the next bmem which is constructed.
+Each place has a generation number, so that the chunks which a thread cached
+for the deleted bmem are not given to the new one.
 ------------------------------------------------------------------------------*/
 //----------------------//
 //        bmem::        //
@@ -71,62 +171,104 @@ private:
     char* free;         // The start of the free list.
     long usersize;      // Size of the user part of each chunk (in bytes).
     long chunksize;     // Size of the whole chunk, including "next" pointer.
-    long nchunks;       // Number of chunks.
-    long blocksize;     // Hope that "long" has sufficient bits!
+    long nchunks;       // Number of chunks in the next block.
+    long maxchunks;     // Maximum number of chunks in a block.
     long nblocks;       // The number of blocks.
+    long totchunks;     // Number of chunks in all blocks.
+    long totbytes;      // Number of bytes in all blocks.
+    long nused;         // Number of chunks in use.
+    long nhigh;         // Highest number of chunks in use.
+    const char* own;    // Name of the owner of the bmem, or 0.
+
+    memsrc_t memsrc;    // The memory source: new, malloc() or mmap().
+    volatile int lock;  // Spin lock, used only if bmem_threaded is set.
+    int slot;           // Index of the thread caches, or -1 if none.
+    unsigned int gen;   // Generation of the slot.
+    char* volatile depot[bmem_depot_size];  // Batches of free chunks, or 0.
+    volatile long ndepot;                   // Number of batches in the depot.
 
-    memsrc_t memsrc;    // The memory source: "operator new" or malloc().
     void getnewblock(); // Link in a new block.
+    char* newblock(long&, int = 0);     // Allocate and link a block.
+    long blockbytes(long) const;                // Bytes in a block.
+    char* allocblock(long);
+    void freeblock(char*, long);
+    void linkblock(char*, long);    // Put the chunks of a block on free list.
+    void refill();      // Refill the free list from the depot or a new block.
+    void* newchunk_locked();
+    void freechunk_locked(void*);
+    void* newchunk_threaded();
+    void freechunk_threaded(void*);
+    bmem_mag* mag();    // The cache of the calling thread.
+    void depot_push(char*);
+    char* depot_pop();
+    char* take_batch(long&);
+    void put_list(char*);
+    void flush_mag(bmem_mag*);
+    void count_used(long);      // Add to nused atomically.
+    friend void bmem_thread_flush();
 public:
-#if BMEM_TRACE
-    char* owner;        // Name of class which owns this bmem object.
-#endif
     void* newchunk() {
-        if (!free)
-            getnewblock();
+        if (bmem_threaded)
+            return newchunk_threaded();
+        if (!free) {
+            refill();
+            if (!free)
+                return 0;       // Out of memory.
+            }
         register char* p = free;
         free = *(char**)p;
-#if BMEM_TRACE
-        if (owner) {
-            cerr << "\n[bmem::newchunk(" << owner
-                 << "): " << (void*)p << "]\n";
-            }
-#endif
+        if (++nused > nhigh)
+            nhigh = nused;
         return p + BMEM_ALIGN;
         }
     void freechunk(void* p) {
-        p = (char*)p - BMEM_ALIGN;
-#if BMEM_TRACE
-        if (owner) {
-            cerr << "\n[bmem::freechunk(" << owner
-                 << "): " << (void*)p << "]\n";
+        if (bmem_threaded) {
+            freechunk_threaded(p);
+            return;
             }
-#endif
+        p = (char*)p - BMEM_ALIGN;
         *(char**)p = free;
         free = (char*)p;
+        nused -= 1;
         }
     void print();               // Print number and list of free chunks.
-    unsigned long size() { return nblocks * blocksize; }
-    unsigned long length();     // Number of chunks in use.
+    void print_stats(ostream& = cout) const;    // Print one line of counts.
+    unsigned long size() { return totbytes; }
+    unsigned long length() const { return nused; }  // Chunks in use.
+    unsigned long high_water() const { return nhigh; }
+    void reset_high_water() { nhigh = nused; }
+    unsigned long n_chunks() const { return totchunks; }
+    unsigned long n_blocks() const { return nblocks; }
+    unsigned long chunk_size() const { return usersize; }
+    const char* owner() const { return own; }
+    void set_owner(const char* s) { own = s; }  // The string is not copied.
+
+    int set_memsrc(memsrc_t);   // Returns -1 if blocks have been allocated.
+    void set_growth(long);      // Maximum bytes in a block. (No growth if 0.)
+    void prefill(long n);       // Pre-fault at least n chunks in all.
 
     // Constructor called with size of memory lump required, and nchunks.
     // If you want the malloc() version, just tack msMALLOC on the end.
+    // (Or msMMAP or msHUGEPAGE.)
     // The four options for the constructor are as follows.
     // bmem(s);
     // bmem(s, n);
     // bmem(s, ms);
     // bmem(s, n, ms);
+    // The name of the owner may be given after the memory source.
 private:
-    void ctor(long s, long n, memsrc_t ms = msNEW);
+    void ctor(long s, long n, memsrc_t ms = msNEW, const char* o = 0);
 public:
-    bmem(long s, long n, memsrc_t ms = msNEW) { ctor(s, n, ms); }
+    bmem(long s, long n, memsrc_t ms = msNEW, const char* o = 0)
+        { ctor(s, n, ms, o); }
     bmem(long s, memsrc_t ms) { ctor(s, deftnchunks, ms); }
     bmem(long s) { ctor(s, deftnchunks); }
-    ~bmem() {}  // Assume that the user may try to clean up AFTER bmem.
+    ~bmem();    // Assume that the user may try to clean up AFTER bmem.
     }; // End of struct bmem.
 
 /*------------------------------------------------------------------------------
-A linked pointer to a bmem block.
+A linked pointer to a bmem block. The field "count" is used by
+bmem_safe::reclaim() to count the free chunks in the block.
 ------------------------------------------------------------------------------*/
 //----------------------//
 //       bmem_ptr::     //
@@ -134,32 +276,81 @@ A linked pointer to a bmem block.
 struct bmem_ptr {
     bmem_ptr*   next;           // Pointer to next bmem_ptr structure.
     char*       block;          // Pointer to bmem block of chunks.
+    long        nchunks;        // Number of chunks in the block.
+    long        count;          // Work space.
 
 //    bmem_ptr& operator=(const bmem_ptr& x) {}
 //    bmem_ptr(const bmem_ptr& x) {}
-    bmem_ptr(char* pc = 0) { next = 0; block = pc; }
+    bmem_ptr(char* pc = 0, long n = 0)
+        { next = 0; block = pc; nchunks = n; count = 0; }
     ~bmem_ptr() {}
     }; // End of struct bmem_ptr.
 
 /*------------------------------------------------------------------------------
-This is supposed to be a safe form of the "bmem" class.
-I don't think this class is ready to use yet, and I don't know what it's
-supposed to do either. So probably you should not use it.
+bmem_safe is a form of bmem which keeps a list of its blocks, so that it can
+give memory back to the system after a burst of allocations. It also checks
+that each chunk which is freed has been allocated.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+reclaim() finds the blocks all of whose chunks are free, removes their chunks
+from the free list, and releases them, but it keeps at least "keep" free
+chunks. With brFREE, a released block is given back with delete[], free() or
+munmap(), according to the memory source.
+With brMADVISE, the pages inside the block are given back with madvise(), and
+the block is kept on a list of idle blocks, which getnewblock() uses before it
+allocates a new block. reclaim() sorts the blocks by address, and looks up
+each free chunk, so it takes time of order f log(b) for f free chunks and b
+blocks. It returns the number of blocks which were released.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+After set_watermark(hi, keep), reclaim(keep) is called by freechunk() when the
+number of free chunks exceeds "hi". The next call is not until a further
+(hi - keep) chunks have been freed, or a new block has been allocated, so
+that the cost of reclaim() is spread over the frees. The only cost of this on
+the fast path is a counter of free chunks and one comparison.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+A class uses a bmem_safe instead of a bmem by declaring its static member to
+be a bmem_safe, and defining it with bmem_safe_define(). For efficient
+reclamation, the blocks should be large enough to hold many pages (see
+bmem::bmem()). While bmem_threaded is set, bmem_safe does not use the thread
+caches of bmem, but only the spin lock.
+The event and cp_pkt classes use bmem_safe if AKSL_BMEM_SAFE is set (see
+options.h). A class must not be switched to bmem_safe if it reads its objects
+after they are deleted, unless its blocks are released with brMADVISE, which
+keeps them mapped.
 ------------------------------------------------------------------------------*/
 //----------------------//
 //      bmem_safe::     //
 //----------------------//
 struct bmem_safe : public bmem {
 private:
-    bmem_ptr*   blocks;
+    bmem_ptr*   blocks;         // The blocks which are in use.
+    bmem_ptr*   idle;           // The blocks released with madvise().
+    long        nfree;          // Number of chunks in the free list.
+    long        nidle;          // Number of idle blocks.
+    long        hiwater;        // Free chunks which trigger reclaim(), or 0.
+    long        keep;           // Free chunks kept by reclaim().
+    long        trigger;        // Free chunks which trigger the next reclaim().
+    bmem_release_t release;     // How blocks are released.
+    unsigned long nreleased;    // Number of blocks released.
 
     void getnewblock(); // Link in a new block.
+    long reclaim_locked(long);
+    void release_block(bmem_ptr*);
+    void* newchunk_threaded();
+    void freechunk_unlocked(void*);
 public:
     void* newchunk() {
-        if (!free)
+        if (bmem_threaded)
+            return newchunk_threaded();
+        if (!free) {
             getnewblock();  // This is the bmem_safe version of getnewblock.
+            if (!free)
+                return 0;   // Out of memory.
+            }
         register char* p = free;
         free = *(char**)p;
+        nfree -= 1;
+        if (++nused > nhigh)
+            nhigh = nused;
 
         // Set the chunk's link to a strange value to indicate allocation.
         *(char**)p = (char*)1;
@@ -167,18 +358,30 @@ public:
         }
     void freechunk(void* p);
 
+    long reclaim(long keep = 0);            // Returns the blocks released.
+    void set_watermark(long hi, long keep = 0);
+    void set_release(bmem_release_t r) { release = r; }
+    unsigned long n_idle() const { return nidle; }
+    unsigned long n_released() const { return nreleased; }
+    unsigned long n_free() const { return nfree; }
+    void prefill(long n);       // As for bmem::prefill().
+
 //    bmem_safe& operator=(const bmem_safe& x) {}
 //    bmem_safe(const bmem_safe& x) {}
-    bmem_safe(long s, long n = deftnchunks) : bmem(s, n)
-        { blocks = new bmem_ptr(free); }
+    bmem_safe(long s, long n = deftnchunks, memsrc_t ms = msNEW,
+              const char* o = 0, bmem_release_t r = brFREE);
     ~bmem_safe();
     }; // End of struct bmem_safe.
 
 // Trivial macro to help safely define bmem member B of class X.
-#define bmem_define(X, B)           bmem        X::B(sizeof(X))
-#define bmem_define_malloc(X, B)    bmem        X::B(sizeof(X), msMALLOC)
+// The bmem is registered with the class name as its owner.
+#define bmem_define(X, B) \
+    bmem X::B(sizeof(X), deftnchunks, msNEW, #X)
+#define bmem_define_malloc(X, B) \
+    bmem X::B(sizeof(X), deftnchunks, msMALLOC, #X)
 
 // Trivial macro to help safely define bmem_safe member B of class X.
-#define bmem_safe_define(X, B)      bmem_safe   X::B(sizeof(X))
+#define bmem_safe_define(X, B) \
+    bmem_safe X::B(sizeof(X), deftnchunks, msNEW, #X)
 
 #endif /* AKSL_BMEM_H */
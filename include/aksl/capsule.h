@@ -35,6 +35,9 @@ f32streamlist::
 #ifndef AKSL_NUMB_H
 #include "aksl/numb.h"
 #endif
+#ifndef AKSL_SZMEM_H
+#include "aksl/szmem.h"
+#endif
 
 // System header files:
 #ifndef AKSL_X_SYS_TYPES_H
@@ -98,10 +101,10 @@ struct frame8: public slink {
     uint8           opcode;         // 8-bit opcode. Type opcode_t.
     uint8           arg;            // 4 bit-argument.
     uint16          LI;             // 12-bit number of bytes in "payload".
-    char*           payload;        // Heap-allocated.
+    char*           payload;        // From szbuf_new.
 
     // The encoded version, complete with HCS and DCS, but no "sync":
-    char*           coded;          // Heap-allocated.
+    char*           coded;          // From szbuf_new.
     uint16          n_coded;        // Number of bytes in "coded".
 
     frame8* next() const { return (frame8*)slink::next(); }
@@ -121,7 +124,7 @@ public:
         coded = 0;
         n_coded = 0;
         }
-    ~frame8() { delete[] payload; delete[] coded; }
+    ~frame8() { szbuf_delete(payload); szbuf_delete(coded); }
     }; // End of struct frame8.
 
 //----------------------//
@@ -228,10 +231,10 @@ struct frame32: public slink {
     uint8           opcode;         // 8-bit opcode. Type opcode_t.
     uint8           arg;            // 2-bit argument.
     uint16          LI;             // 14-bit number of bytes in "payload".
-    char*           payload;        // Heap-allocated.
+    char*           payload;        // From szbuf_new.
 
     // The encoded version, complete with HCS and DCS, but no "sync":
-    char*           coded;          // Heap-allocated.
+    char*           coded;          // From szbuf_new.
     uint16          n_coded;        // Number of bytes in "coded".
 
     frame32* next() const { return (frame32*)slink::next(); }
@@ -251,7 +254,7 @@ public:
         coded = 0;
         n_coded = 0;
         }
-    ~frame32() { delete[] payload; delete[] coded; }
+    ~frame32() { szbuf_delete(payload); szbuf_delete(coded); }
     }; // End of struct frame32.
 
 //----------------------//
@@ -0,0 +1,201 @@
+// src/aksl/ckpt.h   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+#ifndef AKSL_CKPT_H
+#define AKSL_CKPT_H
+/*------------------------------------------------------------------------------
+Classes in this file:
+
+ckpt_ptrmap::
+ckpt_writer::
+ckpt_reader::
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Checkpoints of a running simulation.
+
+The function systm::checkpoint() writes the state of a system to a file, and
+systm::restore() reads it back. A checkpoint may be written between the parts
+of a simulation, as follows.
+
+    sys.initialise(0);              // Instead of sys.simulate(...).
+    sys.advance(warmup);
+    sys.checkpoint("warm.ckpt");
+    sys.resume(duration);
+
+Then the warmed-up state may be restored into a system which has the same model
+and the same objects, in the same order, for example by reading the same data
+file. The objects are initialised with attributes as usual, but init() is not
+called. Instead, restore() replaces their states.
+
+    sys.restore("warm.ckpt");
+    sys.resume(duration);
+
+A checkpoint contains the clock, the global variables, the events in the FEL
+(with their ordering keys), the send counters of the objects,
+the broadcast subscriptions, the state of the random number stream rndm_current
+(if it is set in both runs), and the state of each object. The states of the
+objects are written and read by the handler-functions object::write_state()
+and object::read_state(), which must write and read the same items in the same
+order. The state of the packages is not saved.
+
+Pointers to objects of the system and to events in the FEL are written as
+indices with put_object() and put_event(). So an object which holds a pointer
+to an event (e.g. a time-out which it may cancel) gets a pointer to the
+restored event. A pointer to any other event is restored as null.
+An event argument which is a datum is written and read by the handler-functions
+object::write_datum() and object::read_datum() of the destination object of
+the event, or of the origin object for a broadcast. The default functions
+return the error eNOT_SERIALISABLE.
+
+The file format is compact and binary. Integers are written as variable-length
+"varints" (7 bits per byte), and reals are written as 8 bytes in the native byte
+order, so a checkpoint can only be read on the same kind of machine. The file
+is memory-mapped by ckpt_reader, and the strings which it returns point into the
+mapped file. The checkpoint is written to a temporary file, which is renamed
+only when it is complete, so that a crash cannot leave a truncated checkpoint.
+------------------------------------------------------------------------------*/
+
+// AKSL header files:
+#ifndef AKSL_AKSL_H
+#include "aksl/aksl.h"
+#endif
+#ifndef AKSL_BOOLE_H
+#include "aksl/boole.h"
+#endif
+
+// System header files:
+#ifndef AKSL_X_STDIO_H
+#define AKSL_X_STDIO_H
+#include <stdio.h>
+#endif
+
+// Version of the checkpoint file format.
+const unsigned long ckpt_version = 2;
+
+/*------------------------------------------------------------------------------
+A ckpt_ptrmap maps pointers to indices. The pointers are added in index order,
+and then sort() must be called before find().
+------------------------------------------------------------------------------*/
+//----------------------//
+//     ckpt_ptrmap::    //
+//----------------------//
+struct ckpt_ptrmap {
+    struct entry {
+        const void* p;
+        long i;
+        };
+private:
+    entry* v;                   // Array of (pointer, index) pairs.
+    long n;                     // Number of pairs.
+    long size;                  // Size of the array.
+public:
+    void append(const void*);   // The index is the number of earlier pointers.
+    void sort();
+    long find(const void*) const;   // -1 if not found.
+    long length() const { return n; }
+    void clear() { n = 0; }
+
+//    ckpt_ptrmap& operator=(const ckpt_ptrmap& x) {}
+//    ckpt_ptrmap(const ckpt_ptrmap& x) {};
+    ckpt_ptrmap() { v = 0; n = 0; size = 0; }
+    ~ckpt_ptrmap() { delete[] v; }
+    }; // End of struct ckpt_ptrmap.
+
+/*------------------------------------------------------------------------------
+A ckpt_writer collects a checkpoint in memory. Then write() writes it to a file.
+If an error occurs, the error code is kept, and returned by error() and write().
+------------------------------------------------------------------------------*/
+//----------------------//
+//     ckpt_writer::    //
+//----------------------//
+struct ckpt_writer {
+friend struct systm;
+private:
+    unsigned char* buf;         // The bytes of the checkpoint.
+    unsigned long n;            // Number of bytes.
+    unsigned long size;         // Size of the array "buf".
+    int err;                    // The first error, or 0.
+    ckpt_ptrmap objs;           // Object indices.
+    ckpt_ptrmap evts;           // Event indices.
+
+    void reserve(unsigned long);
+    void put_payload(const payload&, object*);
+public:
+    void put_bytes(const void*, unsigned long);
+    void put_uint(unsigned long long);
+    void put_int(long long x)   // Zig-zag encoding of signed integers.
+        { put_uint(((unsigned long long)x << 1)
+                   ^ (unsigned long long)(x >> 63)); }
+    void put_real(double x) { put_bytes(&x, sizeof(x)); }
+    void put_string(const char*);   // The null pointer is permitted.
+    void put_object(object*);       // Must be in the system, or null.
+    void put_event(event*);         // Must be in the FEL, or null.
+    void put_value(value*, object* = 0);    // For datums, see above.
+    void fail(int e) { if (!err) err = e; }
+    int error() const { return err; }
+    int write(const char*);
+
+//    ckpt_writer& operator=(const ckpt_writer& x) {}
+//    ckpt_writer(const ckpt_writer& x) {};
+    ckpt_writer() { buf = 0; n = 0; size = 0; err = 0; }
+    ~ckpt_writer() { delete[] buf; }
+    }; // End of struct ckpt_writer.
+
+/*------------------------------------------------------------------------------
+A ckpt_reader reads a checkpoint file, which is memory-mapped if possible.
+If the file is too short or otherwise bad, the error code is kept, and the get
+functions return zeros.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     ckpt_reader::    //
+//----------------------//
+struct ckpt_reader {
+friend struct systm;
+private:
+    const unsigned char* base;  // The contents of the file.
+    const unsigned char* p;     // The next byte to be read.
+    const unsigned char* end;   // The end of the file.
+    unsigned long len;          // Length of the file.
+    bool_enum mapped;           // True if "base" is memory-mapped.
+    int err;                    // The first error, or 0.
+    object** objs;              // The objects of the system, by index.
+    long nobjs;
+    event** evts;               // The restored events, by index.
+    long nevts;
+
+    payload get_payload(object*);
+public:
+    int open(const char*);
+    void close();
+    void get_bytes(void*, unsigned long);
+    unsigned long long get_uint();
+    long long get_int() {
+        unsigned long long x = get_uint();
+        return (long long)(x >> 1) ^ -(long long)(x & 1);
+        }
+    double get_real() { double x = 0; get_bytes(&x, sizeof(x)); return x; }
+    const char* get_string();       // Points into the file. May be null.
+    object* get_object();
+    event* get_event();
+    value* get_value(object* = 0);  // A new value, owned by the caller.
+    void fail(int e) { if (!err) err = e; }
+    int error() const { return err; }
+
+//    ckpt_reader& operator=(const ckpt_reader& x) {}
+//    ckpt_reader(const ckpt_reader& x) {};
+    ckpt_reader() {
+        base = p = end = 0;
+        len = 0;
+        mapped = false;
+        err = 0;
+        objs = 0;
+        nobjs = 0;
+        evts = 0;
+        nevts = 0;
+        }
+    ~ckpt_reader() { close(); }
+    }; // End of struct ckpt_reader.
+
+#endif /* AKSL_CKPT_H */
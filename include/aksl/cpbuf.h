@@ -32,6 +32,9 @@ http://www.topology.org/tex/atnac/README.html
 #ifndef AKSL_BMEM_H
 #include "aksl/bmem.h"
 #endif
+#ifndef AKSL_SZMEM_H
+#include "aksl/szmem.h"
+#endif
 #ifndef AKSL_AKSLDEFS_H
 #include "aksl/aksldefs.h"
 #endif
@@ -149,7 +152,7 @@ true. If a virtual_pkt is registered at cp_pkt delete-time, it is deleted.
 //----------------------//
 struct cp_pkt: public slink {
 private:
-    char* buf0;                         // The packet contents.
+    char* buf0;                         // The packet contents. (szbuf_new.)
     int len;                            // The length of the packet.
     virtual_pkt* v_pkt;                 // On-demand packet creator.
 public:
@@ -173,7 +176,11 @@ public:
     // Block memory allocation to get around (non-existent) solaris malloc bug:
 #if USE_CP_PKT_BMEM
     // Memory management things.
+#if AKSL_BMEM_SAFE
+    static bmem_safe bmem0;
+#else
     static bmem bmem0;
+#endif
     void* operator new(size_t) { return bmem0.newchunk(); }
     void operator delete(void* p) { bmem0.freechunk(p); }
     static unsigned long n_objects() { return bmem0.length(); }
@@ -181,7 +188,7 @@ public:
 //    cp_pkt& operator=(const cp_pkt& x) {}
 //    cp_pkt(const cp_pkt& x) {};
     cp_pkt() { buf0 = 0; len = -1; v_pkt = 0; }
-    ~cp_pkt() { delete[] buf0; delete v_pkt; }
+    ~cp_pkt() { szbuf_delete(buf0); delete v_pkt; }
     }; // End of struct cp_pkt.
 
 //----------------------//
@@ -243,7 +250,11 @@ public:
     // Block memory allocation to get around (non-existent) solaris malloc bug.
 #if USE_CP_PKT_BMEM
     // Memory management things.
+#if AKSL_BMEM_SAFE
+    static bmem_safe bmem0;
+#else
     static bmem bmem0;
+#endif
     void* operator new(size_t) { return bmem0.newchunk(); }
     void operator delete(void* p0) { bmem0.freechunk(p0); }
     static unsigned long n_objects() { return bmem0.length(); }
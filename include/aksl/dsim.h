@@ -0,0 +1,292 @@
+// src/aksl/dsim.h   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+#ifndef AKSL_DSIM_H
+#define AKSL_DSIM_H
+/*------------------------------------------------------------------------------
+Classes in this file:
+
+dsim_buf::
+dsim_reader::
+dsim_peer::
+dsim::
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Distributed simulation of a single system by several processes.
+
+Each process ("rank") builds the same model and the same objects, in the same
+order, so that every object has the same id (see object::id()) in every rank.
+The objects are then divided among the ranks in the same way as the LPs of a
+parallel simulation (see psim.h). Objects which are not assigned explicitly
+with assign() are divided into contiguous blocks in the order of the object
+list. Each rank initialises and simulates only its own objects. The objects of
+the other ranks are taken out of the object list of the system while the
+simulation is running, so that they receive no broadcasts, but they stay in
+the id table of the system, so that events for them can be addressed.
+
+An event for an object of another rank is written to a TCP connection to that
+rank, and is inserted into the FEL of that rank when it arrives. The objects of
+the event are written as ids, and its argument is written with it. Integers,
+reals, objects, strings and lists of them may be sent, in "value" arguments as
+well as in plain arguments. A datum cannot be sent, and ends the simulation
+with the error eNOT_SERIALISABLE. All numbers are written in network byte
+order with the encoders of numb.h, so the ranks may run on different kinds of
+machines.
+
+The ranks are connected by a full mesh of TCP connections. Rank k listens on
+port "port + k" of its address, and connects to each lower rank, retrying until
+that rank is listening or the connection time-out expires. (The addresses of
+ranks on other hosts may be set with set_address().) The connections are driven
+by a selector, and the bytes to be sent are buffered, so that two ranks which
+send to each other at the same time cannot block each other.
+
+The ranks are synchronised conservatively in rounds, as for psim. In each round,
+every rank sends an "end of round" message to every other rank, after all of
+its events for that round. The message contains the time of the first event in
+its FEL and the least time of the events which it has sent to each rank since
+its previous "end of round" message. Since TCP delivers bytes in order, when a
+rank has received the "end of round" messages of all the other ranks, it has
+received all of their events, and all ranks know the time of the first event of
+every rank. Then rank j executes its events with times less than the minimum
+over all ranks i of the first event time of rank i plus the least total
+lookahead of a path from i to j. (For i = j, this is the shortest cycle from j
+back to itself through other ranks.) The lookaheads are declared with
+set_lookahead(), which every rank must call in the same way. A message which is
+sent to another rank with less delay than the lookahead terminates the
+simulation with eLOOKAHEAD_VIOLATION, and an event which arrives with a time
+earlier than the clock of its rank terminates it with eCAUSALITY_ERROR.
+All ranks take the same decision to stop, when the first event time of every
+rank is at or after the finish time, or when any rank reports an error.
+
+As with psim, events at or after the finish time are not executed, the
+cancellation of messages only works for messages to objects in the same rank,
+and global variables must not be set while the simulation is running. An event
+which is sent to another rank, and its argument if it is a "value", is deleted
+by the sending rank at the end of the round. Every rank must have at least one
+object. Each rank terminates only its own objects.
+
+Example, for rank k of n, all on one host:
+
+    dsim ds(*sys, k, n, 47000);
+    ds.set_lookahead(0.1);
+    int err = ds.simulate(duration);
+------------------------------------------------------------------------------*/
+
+// AKSL header files:
+#ifndef AKSL_AKSL_H
+#include "aksl/aksl.h"
+#endif
+#ifndef AKSL_PSIM_H
+#include "aksl/psim.h"
+#endif
+#ifndef AKSL_SELECTOR_H
+#include "aksl/selector.h"
+#endif
+#ifndef AKSL_NUMB_H
+#include "aksl/numb.h"
+#endif
+#ifndef AKSL_BOOLE_H
+#include "aksl/boole.h"
+#endif
+
+// The default TCP port of rank 0.
+const uint16 dsim_deft_port = 47000;
+
+// The default time allowed for the ranks to connect to each other, in seconds.
+const double dsim_deft_timeout = 10;
+
+// The output of a peer is written to its socket whenever it exceeds this size.
+const unsigned long dsim_flush_size = 65536;
+
+// Kinds of messages between ranks.
+enum dsim_msg_t {
+    dmHELLO = 1,        // Rank, number of ranks and number of object ids.
+    dmEVENT,            // An event.
+    dmEND               // End of round.
+    };
+
+/*------------------------------------------------------------------------------
+A dsim_buf is a queue of bytes. The put functions append numbers in network byte
+order. Bytes are taken from the front with consume().
+------------------------------------------------------------------------------*/
+//----------------------//
+//      dsim_buf::      //
+//----------------------//
+struct dsim_buf {
+    char* buf;                  // The bytes.
+    unsigned long head;         // Index of the first byte.
+    unsigned long n;            // Index after the last byte.
+    unsigned long size;         // Size of the array "buf".
+
+    unsigned long length() const { return n - head; }
+    const char* front() const { return buf + head; }
+    char* reserve(unsigned long);   // Space for more bytes at the end.
+    void consume(unsigned long k) { head += k; if (head >= n) head = n = 0; }
+    void put_u8(unsigned int x) { *reserve(1) = (char)x; n += 1; }
+    void put_u32(uint32 x) { u32encode(reserve(4), x); n += 4; }
+    void put_u64(unsigned long long);
+    void put_real(double);
+    void put_string(const char*);   // The null pointer is permitted.
+    int put_value(const value*);    // eNOT_SERIALISABLE for a datum.
+    int put_payload(const payload&);
+    void clear() { head = n = 0; }
+
+//    dsim_buf& operator=(const dsim_buf& x) {}
+//    dsim_buf(const dsim_buf& x) {};
+    dsim_buf() { buf = 0; head = 0; n = 0; size = 0; }
+    ~dsim_buf() { delete[] buf; }
+    }; // End of struct dsim_buf.
+
+/*------------------------------------------------------------------------------
+A dsim_reader reads the numbers of one message. If the message is too short or
+otherwise bad, the error ePROTOCOL_ERROR is kept, and the get functions return
+zeros.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     dsim_reader::    //
+//----------------------//
+struct dsim_reader {
+    const char* p;              // The next byte.
+    const char* end;            // The end of the message.
+    systm* sys;                 // For looking up objects by id.
+    int err;                    // The first error, or 0.
+
+    bool_enum check(unsigned long k) {
+        if ((unsigned long)(end - p) >= k)
+            return true;
+        err = ePROTOCOL_ERROR;
+        p = end;
+        return false;
+        }
+    unsigned int get_u8() { return check(1) ? (unsigned char)*p++ : 0; }
+    uint32 get_u32()
+        { if (!check(4)) return 0; p += 4; return u32decode(p - 4); }
+    unsigned long long get_u64();
+    double get_real();
+    char* get_string();             // A new string, or null.
+    object* get_object();           // Fails if the id is not in the system.
+    value* get_value();             // A new value, owned by the caller.
+    payload get_payload();
+
+//    dsim_reader& operator=(const dsim_reader& x) {}
+//    dsim_reader(const dsim_reader& x) {};
+    dsim_reader(const char* b, unsigned long k, systm* s)
+        { p = b; end = b + k; sys = s; err = 0; }
+    ~dsim_reader() {}
+    }; // End of struct dsim_reader.
+
+/*------------------------------------------------------------------------------
+A dsim_peer is the TCP connection to one other rank. Its handler() is called by
+the selector of the dsim when bytes arrive or when bytes can be sent. It
+returns -1, which makes selector::get_event() return, when the dsim has
+received everything for which it is waiting, or when an error occurs. A rank
+which has sent its last "end of round" message may close its connections
+before the other ranks have read all of theirs. So the end of the stream is
+an error only if the other rank has not yet sent its message for this round.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      dsim_peer::     //
+//----------------------//
+struct dsim_peer: public select_handler {
+    struct dsim* ds;            // The distributed simulation.
+    int rank;                   // The rank at the other end.
+    int sock;                   // The socket, or -1.
+    dsim_buf in;                // Bytes received but not yet processed.
+    dsim_buf out;               // Bytes to be sent.
+    bool_enum wwait;            // True if waiting for a writable socket.
+    bool_enum eof;              // True if the other rank has closed.
+    unsigned long ends;         // Number of dmEND messages received.
+
+    int handler();
+    int flush();                // Sends what it can without blocking.
+
+//    dsim_peer& operator=(const dsim_peer& x) {}
+//    dsim_peer(const dsim_peer& x) {};
+    dsim_peer(struct dsim* d, int r, int s)
+        { ds = d; rank = r; sock = s; wwait = false; eof = false; ends = 0; }
+    ~dsim_peer();
+    }; // End of struct dsim_peer.
+
+//----------------------//
+//        dsim::        //
+//----------------------//
+struct dsim {
+friend struct systm;
+friend struct dsim_peer;
+private:
+    systm* sys;                 // The distributed system.
+    int rank;                   // The rank of this process.
+    int nranks;                 // Number of ranks.
+    uint32* addrs;              // IP address of each rank.
+    uint16* ports;              // TCP port of each rank.
+    selector sel;
+    dsim_peer** peers;          // peers[i] = connection to rank i, or 0.
+    bool_enum connected;        // True if the mesh is open.
+    int* owner;                 // owner[id] = rank of each object id.
+    unsigned int nowner;        // Size of the array "owner".
+    objectlist* away;           // Objects of other ranks. (During simulation.)
+    double* la;                 // la[i*nranks + j] = lookahead from i to j.
+    double* lac;                // lac[i*nranks + j] = shortest path i to j.
+    double* tsent;              // Least time of the events sent to each rank.
+    psim_mailbox sent;          // Events sent in this round, for deletion.
+    double finish;              // Finish time of the simulation.
+    bool_enum running;          // False during initialisation.
+    int lerr;                   // Error status of this rank.
+    int cerr;                   // Communication error, or 0.
+    unsigned long round;        // Number of the current round.
+
+    // The "end of round" messages of rounds with parity p = round % 2,
+    // including this rank's own. (A peer may be one round ahead.)
+    double* etnext;             // etnext[p*nranks + i] = first event time.
+    int* estatus;               // estatus[p*nranks + i] = error status.
+    double* etsent;             // etsent[(p*nranks + i)*nranks + j] = tsent.
+    int nend[2];                // Number of messages received for parity p.
+
+    psim_link* links;           // Declared links.
+    int nlinks;
+    int links_size;
+    psim_assignment* assignments;   // Explicit assignments of objects to ranks.
+    int nassignments;
+    int assignments_size;
+    double default_la;          // Lookahead for all pairs of ranks. 0 if none.
+    unsigned long nrounds;      // Number of rounds in the last simulation.
+    unsigned long nsent;        // Events sent to other ranks.
+    unsigned long nrecv;        // Events received from other ranks.
+
+    void post(event*);
+    void send(int, event*);
+    void fail(int e) { if (cerr == 0) cerr = e; }
+    bool_enum done() const;
+    int receive(dsim_peer*);
+    int recv_event(dsim_reader&);
+    int recv_end(int, dsim_reader&);
+    void send_end();
+    int open_peer(int, int);
+    void partition();
+    void unpartition();
+public:
+    int n_ranks() const { return nranks; }
+    int my_rank() const { return rank; }
+    unsigned long n_rounds() const { return nrounds; }
+    unsigned long n_sent() const { return nsent; }
+    unsigned long n_received() const { return nrecv; }
+    bool_enum is_local(object*) const;
+    int assign(object*, int);
+    int set_lookahead(object*, object*, double);
+    int set_lookahead(double);
+    int set_address(int, uint32, uint16);
+    int connect(double = dsim_deft_timeout);
+    void close();
+
+    int simulate(double = 1, double = 0);
+
+//    dsim& operator=(const dsim& x) {}
+//    dsim(const dsim& x) {};
+    dsim(systm&, int, int, uint16 = dsim_deft_port,
+        uint32 = INADDR_LOOPBACK);
+    ~dsim();
+    }; // End of struct dsim.
+
+#endif /* AKSL_DSIM_H */
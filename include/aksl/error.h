@@ -40,6 +40,9 @@ enum aksl_error_t {
     eBAD_SYSTEM_CHARACTER,
     eBAD_VALUE,
     eBIND_FAILED,
+    eCAUSALITY_ERROR,
+    eCHECKPOINT_ERROR,
+    eCHECKPOINT_MISMATCH,
     eCOMMAND_NAME_ERROR,
     eCONNECT_FAILED,
     eEND_OF_FILE,
@@ -60,6 +63,7 @@ enum aksl_error_t {
     eINIT_FAILED,
     eLIST_ERROR,
     eLISTEN_FAILED,
+    eLOOKAHEAD_VIOLATION,
     eMESSAGE_KEY_CLASH,
     eMISSING_BRACKET,
     eMISSING_EQUALS,
@@ -69,11 +73,13 @@ enum aksl_error_t {
     eOPEN_FAILED,
     ePACKAGE_NAME_ERROR,
     ePACKAGE_NOT_FOUND,
+    ePROTOCOL_ERROR,
     eNAME_RESOLUTION_ERROR,
     eNEGATIVE_DURATION,
     eNEGATIVE_KEY,
     eNEW_OBJECT_NAME_CLASH,
     eNOT_FOUND,
+    eNOT_SERIALISABLE,
     eNO_OBJECT_FUNCTION,
     eNO_OBJECTS,
     eNO_EVENTS,
@@ -85,7 +91,9 @@ enum aksl_error_t {
     eNULL_FILE_NAME,
     eSIMULATION_INTERRUPTED,
     eSOCKET_FAILED,
+    eTHREAD_FAILED,
     eUNRECOGNISED_COMMAND,
+    eWRITE_FAILED,
 
     eERRORMAX                       // eERRORMAX must be negative!!!
     }; // End of enum aksl_error_t.
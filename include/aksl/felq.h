@@ -0,0 +1,274 @@
+// src/aksl/felq.h   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+#ifndef AKSL_FELQ_H
+#define AKSL_FELQ_H
+/*------------------------------------------------------------------------------
+Classes in this file:
+
+tim_bucket::
+cal_queue::
+cal_queue_traversal::
+ladder_rung::
+ladder_queue::
+ladder_queue_traversal::
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+The classes in this file are alternatives to the min_tim_heap class in heap.h
+for implementing future event lists. They store pointers to "tim" structures,
+and they have the same insert/popfirst interface as min_tim_heap. The aim is to
+get (amortised) constant time insertion and extraction for the very large event
+lists of network simulations, where the heap costs O(log n) per operation.
+
+Both of the queues here are stable. That is, "tim"s with the same value of "t"
+are dequeued in the same order that they were enqueued. So they may be used
+when AKSL_SYSTM_FEL_STRICT_ORDER is set, without needing the "index" field of
+"tim2".
+------------------------------------------------------------------------------*/
+
+#ifndef AKSL_HEAP_H
+#include "aksl/heap.h"
+#endif
+#ifndef AKSL_AKSLDEFS_H
+#include "aksl/aksldefs.h"
+#endif
+#ifndef AKSL_BOOLE_H
+#include "aksl/boole.h"
+#endif
+
+// System header files:
+#ifndef AKSL_X_MATH_H
+#define AKSL_X_MATH_H
+#include <math.h>
+#endif
+
+// Constants for the calendar queue:
+static const unsigned int calq_min_buckets = 16;    // Must be a power of 2.
+static const unsigned int calq_n_sample = 25;       // Events sampled for width.
+
+// Constants for the ladder queue:
+static const unsigned int ladq_max_rungs = 8;       // Maximum number of rungs.
+static const unsigned int ladq_threshold = 50;      // Max bucket size to sort.
+
+/*------------------------------------------------------------------------------
+A tim_bucket is a variable-length array of pointers to "tim"s.
+If the bucket is kept sorted by calling only insert(), then popfirst() returns
+the element with the least "t", and equal-time elements are returned in
+insertion order. The function append() puts an element at the end without any
+sorting. The array is consumed from the front by advancing "head", so that
+popfirst() is constant time.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     tim_bucket::     //
+//----------------------//
+struct tim_bucket {
+friend struct cal_queue;
+friend struct ladder_queue;
+private:
+    tim** v;            // Array of pointers to "tim"s.
+    unsigned int head;  // Index of the first occupant.
+    unsigned int n;     // One more than the index of the last occupant.
+    unsigned int size;  // The size of the array "v".
+
+    void resize();
+public:
+    unsigned int length() const { return n - head; }
+    int empty() const { return n == head; }
+    tim* first() const { return (n > head) ? v[head] : 0; }
+    tim* element(unsigned int i) const // No check!
+        { return v[head + i]; }
+
+    void append(tim* p) { if (n >= size) resize(); v[n++] = p; }
+    void insert(tim*);  // Insert in non-decreasing order of "t".
+    tim* popfirst() {
+        if (n <= head)
+            return 0;
+        tim* p = v[head++];
+        if (head == n)
+            head = n = 0;
+        return p;
+        }
+    tim* remove(tim*);  // Remove an arbitrary element. (Linear time.)
+    void sort();        // Stable sort into non-decreasing order of "t".
+    void swap(tim_bucket&);
+    void clear() { head = n = 0; }
+
+//    tim_bucket& operator=(const tim_bucket& x) {}
+//    tim_bucket(const tim_bucket& x) {};
+    tim_bucket() { v = 0; head = 0; n = 0; size = 0; }
+    ~tim_bucket() { delete[] v; }
+    }; // End of struct tim_bucket.
+
+/*------------------------------------------------------------------------------
+cal_queue:: implements the calendar queue in
+    R. Brown, "Calendar queues: a fast O(1) priority queue implementation for
+    the simulation event set problem", Comm. ACM 31(10), 1988, Pp. 1220-1227.
+The "t" axis is divided into "days" of length "width". Day number d is kept in
+bucket (d mod nbuckets), so that each bucket holds the events of the same day of
+all "years". Each bucket is kept sorted.
+
+The number of buckets is doubled when the queue holds more than twice as many
+events as buckets, and halved when it holds less than half as many. On each
+resize, the day width is re-estimated from the separation of a sample of the
+earliest events.
+
+The functions first() and popfirst() both advance the day cursor to the day of
+the first event. So first() is not a "const" function.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      cal_queue::     //
+//----------------------//
+struct cal_queue {
+friend struct cal_queue_traversal;
+private:
+    tim_bucket* buckets;        // Array of buckets.
+    unsigned int nbuckets;      // Number of buckets. Always a power of 2.
+    unsigned int n;             // Number of occupants of the queue.
+    double width;               // The width of each day.
+    double day;                 // The day number of the cursor.
+    unsigned int cur;           // The bucket of the cursor.
+    bool_enum resize_enabled;   // False while resizing.
+
+    double dayof(double t) const { return floor(t / width); }
+    unsigned int bucketof(double d) const
+        { return (unsigned int)(long long)d & (nbuckets - 1); }
+    unsigned int find_first();          // Returns bucket of first element.
+    double new_width();
+    void resize(unsigned int);
+public:
+    unsigned int length() const { return n; }
+    int empty() const { return n == 0; }
+    unsigned int n_buckets() const { return nbuckets; }
+    double day_width() const { return width; }
+    const tim* first() { return (n > 0) ? buckets[find_first()].first() : 0; }
+
+    void insert(tim*);
+    tim* popfirst();
+    tim* remove(tim*);  // Remove an arbitrary element.
+    void clear();
+
+//    cal_queue& operator=(const cal_queue& x) {}
+//    cal_queue(const cal_queue& x) {};
+    cal_queue();
+    ~cal_queue() { delete[] buckets; }
+    }; // End of struct cal_queue.
+
+//--------------------------//
+//  cal_queue_traversal::   //
+//--------------------------//
+struct cal_queue_traversal {
+private:
+    cal_queue* cq;              // Pointer to a calendar queue.
+    unsigned int b;             // Bucket number.
+    unsigned int i;             // Position in bucket.
+public:
+    tim* next();
+    void init() { b = 0; i = 0; }   // Useful for restarting.
+
+//    cal_queue_traversal& operator=(const cal_queue_traversal& x) {}
+//    cal_queue_traversal(const cal_queue_traversal& x) {};
+    cal_queue_traversal(cal_queue* q) { cq = q; b = 0; i = 0; }
+    ~cal_queue_traversal() {}
+    }; // End of struct cal_queue_traversal.
+
+/*------------------------------------------------------------------------------
+A ladder_rung is one rung of a ladder queue. Bucket k of the rung holds the
+(unsorted) events with "t" in [start + k*width, start + (k+1)*width).
+The buckets before "cur" have already been passed down the ladder.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     ladder_rung::    //
+//----------------------//
+struct ladder_rung {
+    tim_bucket* buckets;        // Array of buckets.
+    unsigned int nbuckets;      // Number of buckets in use.
+    unsigned int size;          // Size of the array "buckets".
+    unsigned int cur;           // The first bucket not yet passed down.
+    unsigned int n;             // Number of events in the rung.
+    double start;               // The start time of bucket 0.
+    double width;               // The width of each bucket.
+
+    double cur_start() const { return start + cur * width; }
+    void init(double s, double w, unsigned int nb);
+
+//    ladder_rung& operator=(const ladder_rung& x) {}
+//    ladder_rung(const ladder_rung& x) {};
+    ladder_rung() {
+        buckets = 0; nbuckets = 0; size = 0; cur = 0; n = 0;
+        start = 0; width = 0;
+        }
+    ~ladder_rung() { delete[] buckets; }
+    }; // End of struct ladder_rung.
+
+/*------------------------------------------------------------------------------
+ladder_queue:: implements the ladder queue in
+    W.T. Tang, R.S.M. Goh, I.L.-J. Thng, "Ladder queue: an O(1) priority queue
+    structure for large-scale discrete event simulation", ACM Trans. Modeling
+    and Computer Simulation 15(3), 2005, Pp. 175-204.
+New events at or after "top_start" are appended to the unsorted "top" list.
+Earlier events go into the first rung whose current bucket can take them, or
+else into the sorted "bottom" list. When "bottom" is empty, the first non-empty
+bucket of the lowest rung is either sorted into "bottom", or if it has more
+than ladq_threshold events, it is spread out over a new rung of finer buckets.
+When the ladder is empty, "top" is spread out over a new first rung.
+Since the sorting of each event is deferred until it is near the front of the
+queue, the amortised cost of the hold operation is constant.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    ladder_queue::    //
+//----------------------//
+struct ladder_queue {
+friend struct ladder_queue_traversal;
+private:
+    tim_bucket top;             // Unsorted events at or after top_start.
+    double top_start;           // Start time of "top".
+    double top_min;             // Minimum time of events in "top".
+    double top_max;             // Maximum time of events in "top".
+    ladder_rung rungs[ladq_max_rungs];
+    unsigned int nrungs;        // Number of rungs in use.
+    tim_bucket bottom;          // Sorted events before the lowest rung.
+    unsigned int n;             // Number of occupants of the queue.
+
+    void spread(ladder_rung&, tim_bucket&, double, double);
+    void top_to_ladder();
+    void bottom_to_ladder();
+    void refill_bottom();
+public:
+    unsigned int length() const { return n; }
+    int empty() const { return n == 0; }
+    unsigned int n_rungs() const { return nrungs; }
+    const tim* first();
+
+    void insert(tim*);
+    tim* popfirst();
+    tim* remove(tim*);  // Remove an arbitrary element.
+    void clear();
+
+//    ladder_queue& operator=(const ladder_queue& x) {}
+//    ladder_queue(const ladder_queue& x) {};
+    ladder_queue();
+    ~ladder_queue() {}
+    }; // End of struct ladder_queue.
+
+//------------------------------//
+//    ladder_queue_traversal::  //
+//------------------------------//
+struct ladder_queue_traversal {
+private:
+    ladder_queue* lq;           // Pointer to a ladder queue.
+    unsigned int r;             // Rung number, or section of ladder.
+    unsigned int b;             // Bucket number.
+    unsigned int i;             // Position in bucket.
+public:
+    tim* next();
+    void init() { r = 0; b = 0; i = 0; }    // Useful for restarting.
+
+//    ladder_queue_traversal& operator=(const ladder_queue_traversal& x) {}
+//    ladder_queue_traversal(const ladder_queue_traversal& x) {};
+    ladder_queue_traversal(ladder_queue* q) { lq = q; r = 0; b = 0; i = 0; }
+    ~ladder_queue_traversal() {}
+    }; // End of struct ladder_queue_traversal.
+
+#endif /* AKSL_FELQ_H */
@@ -12,6 +12,8 @@ Classes in this file:
 hashtab_32_8::
 hashtab_32_16::
 hashtab_str_8::
+hashtab_str_pair::
+hashtab_str::
 ------------------------------------------------------------------------------*/
 
 #ifndef AKSL_COD_H
@@ -173,4 +175,44 @@ public:
     ~hashtab_str_8() {}
     }; // End of struct hashtab_str_8.
 
+/*------------------------------------------------------------------------------
+This table stores and retrieves void* pointers according to string keys, using
+open addressing with linear probing in an array whose size is a power of 2. The
+array is doubled when it is more than half full. So insert() and find() take
+constant time on average, for any number of entries.
+The key strings are not copied. Each key must remain valid, and unchanged, for
+as long as it is in the table.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   hashtab_str_pair::  //
+//----------------------//
+struct hashtab_str_pair {
+    const void* data;                   // Data being stored.
+    const char* key;                    // Key to data. Null if slot is empty.
+    }; // End of struct hashtab_str_pair.
+
+//----------------------//
+//     hashtab_str::    //
+//----------------------//
+struct hashtab_str {
+private:
+    hashtab_str_pair* table;            // Array of (void*, key) pairs.
+    uint32 size;                        // Size of the array. 0 or a power of 2.
+    uint32 n;                           // Number of entries in the array.
+
+    static uint32 hash(const char*);
+    void resize();
+public:
+    void insert(const void* data, const char* key); // Over-writes old entry.
+    bool_enum find(void*& data, const char* key) const;
+    bool_enum del(const char* key);
+    void clear();
+    long n_entries() const { return n; }
+
+//    hashtab_str& operator=(const hashtab_str& x) {}
+//    hashtab_str(const hashtab_str& x) {};
+    hashtab_str() { table = 0; size = 0; n = 0; }
+    ~hashtab_str() { delete[] table; }
+    }; // End of struct hashtab_str.
+
 #endif /* AKSL_HASHFN_H */
@@ -16,6 +16,14 @@ heap_traversal::
 tim2::
 min_tim2_heap::
 tim2_heap_traversal::
+
+tim_entry::
+min_tim_dheap::
+dheap_traversal::
+
+ord_entry::
+min_ord_dheap::
+ord_dheap_traversal::
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 The classes in this file are intended for implementing future event lists. But
 they may be of use in general sorting, or to represent lists where an object
@@ -27,9 +35,12 @@ is linear in the size of the list.
 #include "aksl/aksldefs.h"
 #endif
 
-// The heap block size wil be made variable if there is a demand for it:
+// The initial size of a heap. Heaps grow geometrically from this size.
 static const unsigned int heap_block_size = 512;
 
+// The default number of children per node of min_tim_dheap:
+static const unsigned int dheap_default_arity = 4;
+
 /*------------------------------------------------------------------------------
 The struct "tim" is intended to be used for the derivation of event classes
 and such, so that pointers to events can be sent to the functions in the
@@ -74,6 +85,11 @@ to the same event. That is, an event may be a multiple member of the heap.
 It is important, though, that the element not be deleted while it is referred
 to in the heap. The multiple-membership possibility may or may not have a
 useful application.
+
+The heap array doubles in size when it is full. The function reserve() may be
+used to allocate a big enough array in advance. The function insert_many()
+inserts a whole array of elements. If there are at least as many new elements
+as old ones, the heap is rebuilt bottom-up, which takes linear time.
 ------------------------------------------------------------------------------*/
 //----------------------//
 //    min_tim_heap::    //
@@ -85,16 +101,19 @@ protected:
     unsigned int size;  // The size of the array "heap".
     unsigned int n;     // Number of occupants of the heap, starting at heap[1].
 
-    void resize();
+    void resize() { reserve(2 * size); }
+    void heapify(unsigned int);
 public:
     unsigned int length() const { return n; }
     int empty() const { return n == 0; }
     const tim* first() const { return (n > 0) ? heap[1] : 0; }
     const tim* last() const { return (n > 0) ? heap[n] : 0; } // Not a maximum!
 
+    void reserve(unsigned int);         // Make room for this many elements.
     void insert(tim*);
+    void insert_many(tim**, unsigned int);
     tim* popfirst();
-    tim* remove(tim*); // Define this some day to remove an arbitrary element.
+    tim* remove(tim*);  // Remove an arbitrary element. (Linear search.)
 
     min_tim_heap() {
         heap = new tim*[heap_block_size];
@@ -137,9 +156,10 @@ of dequeuing of events which have the same execution time.
 struct tim2 : public tim {
 friend class min_tim2_heap;
 private:
-    long index;     // This is intentionally signed. Should be >= 32 bits.
+    unsigned long long index;   // Insertion sequence number. (Never wraps.)
+    unsigned int hpos;  // Position in a min_tim2_heap, or 0 if not in it.
 public:
-    tim2() {}       // min_tim2_heap is responsible for initialising "index".
+    tim2() { hpos = 0; }    // min_tim2_heap is responsible for "index".
     ~tim2() {}
     }; // End of struct tim2.
 
@@ -150,6 +170,10 @@ that an array of tim2* is implemented the same as an array of tim*.
 The insert and pop functions for this class must be separately defined to the
 parent class because they involve sorting of elements of the heap, and this
 sorting depends on the "index" field.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+The heap also records the position of each element in its "hpos" field, so that
+remove() takes logarithmic time. Therefore a "tim2" must not be a multiple
+member of the same heap, or a member of more than one heap at the same time.
 ------------------------------------------------------------------------------*/
 //----------------------//
 //    min_tim2_heap::   //
@@ -157,16 +181,20 @@ sorting depends on the "index" field.
 struct min_tim2_heap : public min_tim_heap {
 friend struct tim2_heap_traversal;
 private:
-    long next_index;    // May be arbitrarily initialized at beginning of use.
+    unsigned long long next_index;  // The index for the next insertion.
 
-    void resize();
+    void heapify(unsigned int);
 public:
     const tim2* first() const { return (tim2*)min_tim_heap::first(); }
     const tim2* last() const { return (tim2*)min_tim_heap::last(); }
 
+    int contains(const tim2* p) const
+        { return p && p->hpos >= 1 && p->hpos <= n && heap[p->hpos] == p; }
+
     void insert(tim2*);
+    void insert_many(tim2**, unsigned int);
     tim2* popfirst();
-    tim2* remove(tim2*); // Define this some day to remove an arbitrary element.
+    tim2* remove(tim2*);    // Remove an arbitrary element. (Logarithmic.)
     void reset_index() { next_index = 0; } // Not as useful as you might think.
 
     min_tim2_heap() { next_index = 0; }
@@ -190,4 +218,171 @@ public:
     ~tim2_heap_traversal() {}
     }; // End of struct tim2_heap_traversal.
 
+/*------------------------------------------------------------------------------
+A tim_entry is an element of a min_tim_dheap. The time "t" is copied from the
+"tim" when it is inserted, so that the heap can be sorted without dereferencing
+the pointer. Therefore the "t" member of a "tim" must not be modified while it
+is in a min_tim_dheap.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      tim_entry::     //
+//----------------------//
+struct tim_entry {
+    double t;           // Copy of p->t.
+    unsigned long long index;   // Insertion sequence number, for FIFO order.
+    tim* p;             // The "tim" itself.
+    }; // End of struct tim_entry.
+
+/*------------------------------------------------------------------------------
+min_tim_dheap:: is a d-ary heap of tim_entry structures, stored in a single
+contiguous array, with heap[0] as the root. The children of node i are the
+nodes d*i + 1 to d*i + d. The arity d is a power of 2, so that shifts can be
+used instead of multiplication and division.
+
+The binary heap min_tim_heap dereferences a pointer to a "tim" for every
+comparison, which usually means one cache miss per level of the heap. Here, the
+time and the sequence number are stored in the array, and the d children of
+each node are adjacent. So popfirst() visits about log(n)/log(d) cache-line
+groups instead of log(n) random chunks of memory. Arities of 4 and 8 are
+usually the best choices.
+
+Equal-time elements are dequeued in the order of insertion, using a sequence
+number in the same way as min_tim2_heap, but without needing a "tim2".
+------------------------------------------------------------------------------*/
+//----------------------//
+//    min_tim_dheap::   //
+//----------------------//
+struct min_tim_dheap {
+friend struct dheap_traversal;
+protected:
+    tim_entry* heap;    // Array of entries. The root is heap[0].
+    unsigned int size;  // The size of the array "heap".
+    unsigned int n;     // Number of occupants of the heap.
+    unsigned int d;     // The arity of the heap.
+    unsigned int dlog;  // The base 2 logarithm of d.
+    unsigned long long next_index;  // Sequence number of the next insertion.
+
+    void resize() { reserve(2 * size); }
+    void heapify(unsigned int);
+public:
+    unsigned int length() const { return n; }
+    int empty() const { return n == 0; }
+    unsigned int arity() const { return d; }
+    const tim* first() const { return (n > 0) ? heap[0].p : 0; }
+    const tim* last() const { return (n > 0) ? heap[n-1].p : 0; } // Not max!
+
+    void reserve(unsigned int);         // Make room for this many elements.
+    void insert(tim*);
+    void insert_many(tim**, unsigned int);
+    tim* popfirst();
+    tim* remove(tim*);  // Remove an arbitrary element. (Linear search.)
+
+//    min_tim_dheap& operator=(const min_tim_dheap& x) {}
+//    min_tim_dheap(const min_tim_dheap& x) {};
+    min_tim_dheap(unsigned int arity = dheap_default_arity);
+    ~min_tim_dheap() { delete[] heap; }
+    }; // End of struct min_tim_dheap.
+
+//----------------------//
+//   dheap_traversal::  //
+//----------------------//
+struct dheap_traversal {
+private:
+    min_tim_dheap* hp;          // Pointer to a heap. May be null.
+    unsigned int i;             // Position in heap.
+public:
+    tim* next() { return (hp && i < hp->n) ? hp->heap[i++].p : 0; }
+    void init() { i = 0; }      // Useful for restarting.
+
+//    dheap_traversal& operator=(const dheap_traversal& x) {}
+//    dheap_traversal(const dheap_traversal& x) {};
+    dheap_traversal(min_tim_dheap& h) { hp = &h; i = 0; }
+    dheap_traversal(min_tim_dheap* h) { hp = h; i = 0; }
+    ~dheap_traversal() {}
+    }; // End of struct dheap_traversal.
+
+/*------------------------------------------------------------------------------
+An ord_entry is an element of a min_ord_dheap. The entries are ordered by the
+time "t", then by the "key", and then by the sequence number "seq". All three
+are copied into the entry when it is inserted, so that the heap can be sorted
+without dereferencing the pointer.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      ord_entry::     //
+//----------------------//
+struct ord_entry {
+    double t;                   // Copy of p->t.
+    unsigned long long key;     // Secondary sort key.
+    unsigned long long seq;     // Tertiary sort key.
+    tim* p;                     // The "tim" itself.
+
+    int less(const ord_entry& e) const {
+        return t < e.t || (t == e.t
+                           && (key < e.key || (key == e.key && seq < e.seq)));
+        }
+    }; // End of struct ord_entry.
+
+/*------------------------------------------------------------------------------
+min_ord_dheap:: is a d-ary heap of ord_entry structures, which is organised in
+the same way as min_tim_dheap. The difference is that equal-time elements are
+not dequeued in the order of insertion, but in the order of the keys which are
+given to insert(). If the keys of all elements are distinct, the dequeueing
+order is a total order which does not depend on the order of insertion. This
+is intended for simulations which must give the same results when the events
+are created in a different order, e.g. by a different partition of the model.
+Elements with the same time, key and sequence number are dequeued in an
+arbitrary order.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    min_ord_dheap::   //
+//----------------------//
+struct min_ord_dheap {
+friend struct ord_dheap_traversal;
+protected:
+    ord_entry* heap;    // Array of entries. The root is heap[0].
+    unsigned int size;  // The size of the array "heap".
+    unsigned int n;     // Number of occupants of the heap.
+    unsigned int d;     // The arity of the heap.
+    unsigned int dlog;  // The base 2 logarithm of d.
+
+    void resize() { reserve(2 * size); }
+    void heapify(unsigned int);
+    void sift_down(unsigned int, const ord_entry&);
+public:
+    unsigned int length() const { return n; }
+    int empty() const { return n == 0; }
+    unsigned int arity() const { return d; }
+    const tim* first() const { return (n > 0) ? heap[0].p : 0; }
+    const tim* last() const { return (n > 0) ? heap[n-1].p : 0; } // Not max!
+
+    void reserve(unsigned int);         // Make room for this many elements.
+    void insert(tim*, unsigned long long key, unsigned long long seq);
+    void insert_many(const ord_entry*, unsigned int);
+    tim* popfirst();
+    tim* remove(tim*);  // Remove an arbitrary element. (Linear search.)
+
+//    min_ord_dheap& operator=(const min_ord_dheap& x) {}
+//    min_ord_dheap(const min_ord_dheap& x) {};
+    min_ord_dheap(unsigned int arity = dheap_default_arity);
+    ~min_ord_dheap() { delete[] heap; }
+    }; // End of struct min_ord_dheap.
+
+//--------------------------//
+//  ord_dheap_traversal::   //
+//--------------------------//
+struct ord_dheap_traversal {
+private:
+    min_ord_dheap* hp;          // Pointer to a heap. May be null.
+    unsigned int i;             // Position in heap.
+public:
+    tim* next() { return (hp && i < hp->n) ? hp->heap[i++].p : 0; }
+    void init() { i = 0; }      // Useful for restarting.
+
+//    ord_dheap_traversal& operator=(const ord_dheap_traversal& x) {}
+//    ord_dheap_traversal(const ord_dheap_traversal& x) {};
+    ord_dheap_traversal(min_ord_dheap& h) { hp = &h; i = 0; }
+    ord_dheap_traversal(min_ord_dheap* h) { hp = h; i = 0; }
+    ~ord_dheap_traversal() {}
+    }; // End of struct ord_dheap_traversal.
+
 #endif /* AKSL_HEAP_H */
@@ -22,6 +22,9 @@ nbytes::
 #ifndef AKSL_CONFIG_H
 #include "aksl/config.h"
 #endif
+#ifndef AKSL_SZMEM_H
+#include "aksl/szmem.h"
+#endif
 
 // System header files:
 #ifdef WIN32
@@ -69,7 +72,7 @@ public:
     int n_bytes() const { return n; }
     int length() { return pc ? n : 0; }
     bool_enum empty() const { return bool_enum(!pc); }
-    void clear() { delete[] pc; pc = 0; n = 0; }
+    void clear() { szbuf_delete(pc); pc = 0; n = 0; }
     void copy_from(const char* pc1, int n1);    // Reads n1 bytes from buffer.
     void swallow(char*& pc1, int n1);           // Swallows n1-byte heap mem.
     int copy_to(char* buf, int bufsize);        // Returns n bytes copied.
@@ -95,7 +98,7 @@ public:
     nbytes& operator=(const nbytes& x);
     nbytes(const nbytes& x);
     nbytes() { pc = 0; n = 0; }
-    ~nbytes() { delete[] pc; }
+    ~nbytes() { szbuf_delete(pc); }
     }; // End of struct nbytes.
 
 // Exported buffer for use by classes derived from "nbytes".
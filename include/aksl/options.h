@@ -23,4 +23,40 @@ Turn this feature off if you don't need it.
 #define AKSL_SYSTM_FEL_STRICT_ORDER     1
 #endif
 
+/*---------------------------------------------------------------------------
+This option makes the selector timer heap a d-ary heap (min_tim_dheap) instead
+of a binary heap (min_tim_heap). The d-ary heap makes fewer cache misses, and
+it dequeues equal-time timers in FIFO order. It is off by default because
+there are usually very few timers.
+---------------------------------------------------------------------------*/
+#ifndef AKSL_SELECTOR_TIMER_DHEAP
+#define AKSL_SELECTOR_TIMER_DHEAP       0
+#endif
+
+/*---------------------------------------------------------------------------
+This option makes the variable-length buffers of cp_pkt, nbytes, c_string,
+frame8 and frame32 come from the size-class allocator (see szmem.h) instead of
+operator new[]. It is off by default because arrays which are handed over to
+these classes (e.g. by c_string::eat() and nbytes::swallow()) must then be
+copied.
+---------------------------------------------------------------------------*/
+#ifndef AKSL_SIZE_CLASS_BUFFERS
+#define AKSL_SIZE_CLASS_BUFFERS         0
+#endif
+
+/*---------------------------------------------------------------------------
+This option makes the memory of events, cp_pkts and udp_cp_pkts come from a
+bmem_safe instead of a bmem (see bmem.h), so that it can be given back to the
+system after a burst, by calling reclaim() or set_watermark() for the bmem0
+member of the class. It is off by default because bmem_safe has no thread
+caches, so psim is slower, and because event_heap::remove() and
+object::cancel_message_no_check() read events which may have been deleted.
+For this reason, the event blocks are released with brMADVISE, which keeps
+them mapped. (Where madvise() is not available, reclaim() must not be called
+for events.)
+---------------------------------------------------------------------------*/
+#ifndef AKSL_BMEM_SAFE
+#define AKSL_BMEM_SAFE                  0
+#endif
+
 #endif /* AKSL_OPTIONS_H */
@@ -10,7 +10,12 @@ modified Artistic Licence, as specified in the accompanying LICENCE file.
 #ifndef AKSL_AKSL_H
 #include "aksl/aksl.h"
 #endif
+#ifndef AKSL_ORAL_H
+#include "aksl/oral.h"
+#endif
 
 extern int readdatafile(model&, c_string&, int = 0);
+extern int parsedatafile(oraldata&, c_string&, int = 0);
+extern int makedata(model&, oraldata&, int = 0);
 
 #endif /* AKSL_ORALAKSL_H */
@@ -0,0 +1,205 @@
+// src/aksl/prof.h   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+#ifndef AKSL_PROF_H
+#define AKSL_PROF_H
+/*------------------------------------------------------------------------------
+Classes in this file:
+
+prof_row::
+prof_sample::
+sim_profile::
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Simulation profiles.
+
+A profile of a system is started by systm::set_profiling(). While it is on,
+systm::advance() counts the events which it simulates, and measures the time
+spent in the recv_message() handlers, for each destination object class, each
+global message type and each package. A broadcast event is counted for the
+class "BROADCAST", and for the package of its origin object.
+The profile also records the maximum length of the FEL, a sample of the FEL
+length at regular intervals of events, and the high-water mark of the number
+of events in existence, which is kept by event::bmem0 for the whole process.
+(See bmem::high_water().)
+
+The profile is printed as a table by systm::terminate(), and may be printed at
+any time by systm::print_profile(). A running model may also read the profile
+through systm::profile() and the access functions of sim_profile. If a handler
+stops or restarts profiling, the profile of its own event is deleted when the
+handler returns, without recording the event. (See sim_profile::discard().)
+
+Handler times are measured with the processor's time-stamp counter where it is
+available (x86 with GNU C++), and otherwise with clock_gettime(). The counts
+are converted to seconds by comparing them with the elapsed real time since
+the profile was started. The cost of profiling is two reads of the counter and
+a few table updates per event. When profiling is off, the cost is the test of a
+pointer per event.
+------------------------------------------------------------------------------*/
+
+// AKSL header files:
+#ifndef AKSL_AKSL_H
+#include "aksl/aksl.h"
+#endif
+#ifndef AKSL_AKSLTIME_H
+#include "aksl/aksltime.h"
+#endif
+
+// System header files:
+#ifndef AKSL_X_IOSTREAM_H
+#define AKSL_X_IOSTREAM_H
+#include <iostream>
+#endif
+#if !(defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__)))
+#ifndef AKSL_X_TIME_H
+#define AKSL_X_TIME_H
+#include <time.h>
+#endif
+#endif
+
+// The default number of events between samples of the FEL length.
+const unsigned long prof_sample_period = 1024;
+
+// The maximum number of samples of the FEL length. When this is reached, every
+// second sample is discarded, and the sampling period is doubled.
+const long prof_max_samples = 1024;
+
+//----------------------//
+//      prof_ticks      //
+//----------------------//
+inline unsigned long long prof_ticks() {
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    unsigned int lo, hi;
+    __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+    return ((unsigned long long)hi << 32) | lo;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+    } // End of function prof_ticks.
+
+/*------------------------------------------------------------------------------
+A prof_row holds the statistics for one class, message type or package.
+------------------------------------------------------------------------------*/
+//----------------------//
+//       prof_row::     //
+//----------------------//
+struct prof_row {
+    const char* name;           // Not owned by the row.
+    const char* pkgname;        // Package of a class. Not owned by the row.
+    unsigned long long events;  // Number of events simulated.
+    unsigned long long ticks;   // Time spent in the handlers.
+
+    void clear() { events = 0; ticks = 0; }
+
+//    prof_row& operator=(const prof_row& x) {}
+//    prof_row(const prof_row& x) {};
+    prof_row() { name = 0; pkgname = 0; events = 0; ticks = 0; }
+    ~prof_row() {}
+    }; // End of struct prof_row.
+
+//----------------------//
+//     prof_sample::    //
+//----------------------//
+struct prof_sample {
+    double t;                   // Simulation time of the sample.
+    unsigned long fel;          // Length of the FEL.
+    }; // End of struct prof_sample.
+
+//----------------------//
+//     sim_profile::    //
+//----------------------//
+struct sim_profile {
+private:
+    model* mdl;
+    prof_row* cls;              // Classes, in the order of model::reps.
+    long ncls;                  // The last row is for broadcasts.
+    prof_row* mty;              // Global message types.
+    long nmty;
+    prof_row* pkgs;             // Packages, in the order of model::packages.
+    package** pkgptrs;
+    long* pkgbase;              // Row in "cls" of class 0 of each package.
+    long npkgs;
+    long lastpkg;               // The package of the previous event.
+
+    prof_sample* samples;       // Samples of the FEL length.
+    long nsamples;
+    unsigned long period;       // Number of events between samples.
+    unsigned long countdown;    // Number of events until the next sample.
+    unsigned long fel_max;      // Maximum FEL length.
+
+    unsigned long long events;  // Total number of events.
+    unsigned long long ticks;   // Total handler time.
+    unsigned long long tick0;   // The counter when the profile was started.
+    timeval wall0;              // The real time when the profile was started.
+    bool_enum busy;             // True while simulate() runs a handler.
+    bool_enum discarded;        // True if discard() was called while busy.
+
+    long find_pkg(package*);
+    void record(event*, unsigned long long, double, unsigned long);
+public:
+    int start(model*);
+    void reset();
+    object* simulate(event* pe, double clk, unsigned long fel) {
+        unsigned long long t0 = prof_ticks();
+        busy = true;
+        object* err = pe->simulate();
+        busy = false;
+        if (discarded) {
+            delete this;
+            return err;
+            }
+        record(pe, prof_ticks() - t0, clk, fel);
+        return err;
+        }
+    void discard();
+
+    // Access functions.
+    double seconds_per_tick() const;
+    unsigned long long n_events() const { return events; }
+    double handler_seconds() const { return ticks * seconds_per_tick(); }
+    long n_classes() const { return ncls; }
+    const prof_row& class_row(long i) const { return cls[i]; }
+    long n_mtypes() const { return nmty; }
+    const prof_row& mtype_row(long i) const { return mty[i]; }
+    long n_packages() const { return npkgs; }
+    const prof_row& package_row(long i) const { return pkgs[i]; }
+    long n_samples() const { return nsamples; }
+    const prof_sample& sample(long i) const { return samples[i]; }
+    unsigned long fel_high_water() const { return fel_max; }
+    unsigned long event_high_water() const
+        { return event::bmem0.high_water(); }
+    void print(ostream& = cout, const char* = 0) const;
+
+//    sim_profile& operator=(const sim_profile& x) {}
+//    sim_profile(const sim_profile& x) {};
+    sim_profile() {
+        mdl = 0;
+        cls = 0;
+        ncls = 0;
+        mty = 0;
+        nmty = 0;
+        pkgs = 0;
+        pkgptrs = 0;
+        pkgbase = 0;
+        npkgs = 0;
+        lastpkg = 0;
+        samples = 0;
+        nsamples = 0;
+        period = prof_sample_period;
+        countdown = 0;
+        fel_max = 0;
+        events = 0;
+        ticks = 0;
+        tick0 = 0;
+        timeval_set_zero(wall0);
+        busy = false;
+        discarded = false;
+        }
+    ~sim_profile();
+    }; // End of struct sim_profile.
+
+#endif /* AKSL_PROF_H */
@@ -0,0 +1,328 @@
+// src/aksl/psim.h   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+#ifndef AKSL_PSIM_H
+#define AKSL_PSIM_H
+/*------------------------------------------------------------------------------
+Classes in this file:
+
+pbarrier::
+psim_mailbox::
+psim_link::
+psim_assignment::
+psim_undo::
+psim_record::
+psim_log::
+psim::
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Conservative parallel simulation of a single system.
+
+The objects of a system are partitioned among a number of "logical processes"
+(LPs). Each LP is a private systm, with its own FEL and clock, and it is run by
+its own thread. While the simulation is running, the "sys" member of each object
+points to the systm of its LP. So the object code (recv_message() etc.) does not
+need to be changed. After the simulation, the objects are returned to the
+original system.
+
+The LPs are synchronised with a YAWNS-style window. In each round, every LP
+publishes the time of its first event. Then LP j executes all of its events
+with times less than the minimum over all LPs i of the first event time of LP i
+plus the least total lookahead of a path of links from i to j. For i = j, this
+is the shortest cycle of links from j back to itself, because an event of LP j
+may cause another LP to send a message back to j. Messages from one LP to
+another are appended to a mailbox which is owned by the sending LP, and are
+moved into the FEL of the receiving LP at the start of the next round. Since
+each mailbox has only one writer and the rounds are separated by barriers, no
+locks are required for the mailboxes.
+
+The lookahead of a link is the minimum delay of messages sent across that link.
+Links are declared between objects with set_lookahead(object*, object*, double).
+The lookahead between two LPs is the minimum lookahead of the declared links
+between their objects. A default lookahead for all pairs of LPs may be set with
+set_lookahead(double). A message which is sent to another LP with less delay
+than the lookahead, or with no declared link, terminates the simulation with the
+error eLOOKAHEAD_VIOLATION. A broadcast message is delivered to every LP, so it
+needs a link to every LP. All lookaheads must be positive. If an LP receives
+an event which is earlier than its clock, the simulation is terminated with the
+error eCAUSALITY_ERROR.
+
+Unlike systm::simulate(), events at or after the finish time are not executed.
+Cancellation of messages only works for messages within the same LP. The copies
+of a broadcast message share the same argument, which must not be modified.
+Objects which are explicitly assigned to LPs may be in a different order in the
+object list of the system after the simulation.
+Global variables are shared by all LPs, and must not be set while the
+simulation is running.
+The allocation of events and values is made thread-safe by setting the global
+flag bmem_threaded while the simulation is running. (See bmem.h.)
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+After set_optimistic() is called, the LPs are run with the Time Warp algorithm
+instead, and no lookaheads are needed. In each round, each LP executes up to
+"batch" events speculatively, without waiting for the other LPs. Before each
+event is executed, the states of the receiving objects are saved with the
+handler-function object::save_state(). Each event which is sent, and each event
+which is cancelled, is recorded in an undo log.
+
+When an LP receives an event which is earlier than the last event it executed
+(a "straggler"), it rolls back all of the later events. That is, it restores the
+saved states of the objects with object::restore_state(), it retracts the events
+which were sent by the rolled-back events, and it puts the rolled-back events
+back into its FEL. Events sent to other LPs are retracted by sending them
+"anti-messages", which may in turn cause rollbacks in the other LPs. The
+anti-message for an event is just a pointer to the event itself. With the
+ordered FEL (felORDERED), an event at the same time as the last executed event
+is also a straggler if it precedes that event in the order of the FEL.
+
+At the start of each round, the global virtual time (GVT) is the least time of
+the unprocessed events of all LPs and of the events which have anti-messages in
+transit. No event before the GVT can be rolled back, so these events and their
+saved states are deleted ("fossil collection"). Events at the GVT are also
+committed if no anti-message in transit is for an event at the GVT. With the
+ordered FEL, only the events at the GVT which precede the first unprocessed
+event at the GVT of every LP are committed.
+The events are returned to event::bmem0. The simulation ends when the GVT
+reaches the finish time. An error returned by an object ends the simulation
+only when the GVT reaches the time of the erroneous event, because the error may
+be rolled back.
+
+The speculative execution of events may be restricted to events before the GVT
+plus "window". This can reduce the number of rollbacks.
+
+For optimistic simulation, each object which has a state must provide the three
+state-saving handler-functions. All effects of recv_message() other than
+changing the state of the object, sending events and cancelling events (for
+example, printing, or calling a global random number generator) cannot be
+undone. The function object::cancel_message_no_check() cannot be undone, and so
+it must not be used.
+------------------------------------------------------------------------------*/
+
+// AKSL header files:
+#ifndef AKSL_AKSL_H
+#include "aksl/aksl.h"
+#endif
+#ifndef AKSL_BOOLE_H
+#include "aksl/boole.h"
+#endif
+
+/*------------------------------------------------------------------------------
+A pbarrier is a sense-reversing spinning barrier for a fixed number of threads.
+Each thread must keep its own "sense" variable, initialised to 0.
+A thread which has waited a long time yields the CPU, in case there are more
+threads than CPUs.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      pbarrier::      //
+//----------------------//
+struct pbarrier {
+private:
+    volatile int count;         // Number of threads which have arrived.
+    volatile int sense;         // Flips when all threads have arrived.
+    int nthreads;               // Number of threads.
+public:
+    void wait(int& local_sense);
+
+//    pbarrier& operator=(const pbarrier& x) {}
+//    pbarrier(const pbarrier& x) {};
+    pbarrier(int n = 1) { count = 0; sense = 0; nthreads = n; }
+    ~pbarrier() {}
+    }; // End of struct pbarrier.
+
+/*------------------------------------------------------------------------------
+A psim_mailbox is a growable array of events from one LP to another.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    psim_mailbox::    //
+//----------------------//
+struct psim_mailbox {
+    event** v;                  // Array of events.
+    unsigned int n;             // Number of events.
+    unsigned int size;          // Size of the array.
+
+    void append(event* p) { if (n >= size) resize(); v[n++] = p; }
+    void resize();
+    void clear() { n = 0; }
+
+//    psim_mailbox& operator=(const psim_mailbox& x) {}
+//    psim_mailbox(const psim_mailbox& x) {};
+    psim_mailbox() { v = 0; n = 0; size = 0; }
+    ~psim_mailbox() { delete[] v; }
+    }; // End of struct psim_mailbox.
+
+//----------------------//
+//      psim_link::     //
+//----------------------//
+struct psim_link {
+    object* from;               // Sending object.
+    object* to;                 // Receiving object.
+    double lookahead;           // Minimum delay of messages from "from" to "to".
+    }; // End of struct psim_link.
+
+//--------------------------//
+//    psim_assignment::     //
+//--------------------------//
+struct psim_assignment {
+    object* po;                 // An object.
+    int lp;                     // The LP to which it is assigned.
+    }; // End of struct psim_assignment.
+
+// Default number of events executed by each LP per round of Time Warp.
+static const unsigned int psim_default_batch = 1024;
+
+// Kinds of entries in the undo log of an LP.
+enum psim_undo_t {
+    undoSTATE,          // Restore the state of an object.
+    undoSENT,           // Retract an event sent by an executed event.
+    undoCANCEL          // Re-insert an event cancelled by an executed event.
+    };
+
+//----------------------//
+//      psim_undo::     //
+//----------------------//
+struct psim_undo {
+    psim_undo_t kind;
+    int lp;                     // The destination LP of an undoSENT event.
+    event* pe;                  // The event for undoSENT and undoCANCEL.
+    object* po;                 // The object for undoSTATE.
+    void* state;                // The saved state for undoSTATE.
+    }; // End of struct psim_undo.
+
+//----------------------//
+//     psim_record::    //
+//----------------------//
+struct psim_record {
+    event* pe;                  // An executed event.
+    unsigned int undo0;         // The first undo entry of the event.
+    }; // End of struct psim_record.
+
+/*------------------------------------------------------------------------------
+A psim_log is the list of executed events of an LP which are later than the
+GVT, and the undo entries of these events. The undo entries of record i are
+entries rec[i].undo0 to rec[i+1].undo0 - 1.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      psim_log::      //
+//----------------------//
+struct psim_log {
+    psim_record* rec;           // Array of records of executed events.
+    unsigned int nrec;          // Number of records.
+    unsigned int rec_size;      // Size of the array "rec".
+    psim_undo* undo;            // Array of undo entries.
+    unsigned int nundo;         // Number of undo entries.
+    unsigned int undo_size;     // Size of the array "undo".
+    double tcommit;             // The time of the last committed event.
+
+    void add_record(event* p) {
+        if (nrec >= rec_size)
+            resize_rec();
+        rec[nrec].pe = p;
+        rec[nrec].undo0 = nundo;
+        nrec += 1;
+        }
+    void add_undo(psim_undo_t k, int lp, event* p, object* po, void* s) {
+        if (nundo >= undo_size)
+            resize_undo();
+        psim_undo& u = undo[nundo++];
+        u.kind = k;
+        u.lp = lp;
+        u.pe = p;
+        u.po = po;
+        u.state = s;
+        }
+    void resize_rec();
+    void resize_undo();
+
+//    psim_log& operator=(const psim_log& x) {}
+//    psim_log(const psim_log& x) {};
+    psim_log() {
+        rec = 0; nrec = 0; rec_size = 0;
+        undo = 0; nundo = 0; undo_size = 0;
+        tcommit = 0;
+        }
+    ~psim_log() { delete[] rec; delete[] undo; }
+    }; // End of struct psim_log.
+
+//----------------------//
+//        psim::        //
+//----------------------//
+struct psim {
+friend struct systm;
+private:
+    systm* sys;                 // The partitioned system.
+    int nlp;                    // Number of logical processes.
+    systm** lps;                // The systems of the LPs. (During simulation.)
+    double* la;                 // la[i*nlp + j] = lookahead from LP i to j.
+    double* lac;                // lac[i*nlp + j] = shortest path from i to j.
+    psim_mailbox* mbox;         // mbox[i*nlp + j] = mailbox from LP i to j.
+    double* tnext;              // First event time of each LP in each round.
+    unsigned long long* knext;  // Key of the first event. (felORDERED.)
+    unsigned long long* snext;  // Sequence number of the first event.
+    bool_enum ordered;          // True if the FEL type is felORDERED.
+    int* status;                // Error status of each LP in each round.
+    int* lperr;                 // Current error status of each LP.
+    unsigned long* lpposted;    // Events received from other LPs by each LP.
+    double finish;              // Finish time of the simulation.
+    bool_enum running;          // False during initialisation.
+    pbarrier* barrier;
+
+    psim_link* links;           // Declared links.
+    int nlinks;
+    int links_size;
+    psim_assignment* assignments;   // Explicit assignments of objects to LPs.
+    int nassignments;
+    int assignments_size;
+    double default_la;          // Lookahead for all pairs of LPs. 0 if none.
+    unsigned long nrounds;      // Number of rounds in the last simulation.
+    unsigned long nposted;      // Messages between LPs in the last simulation.
+
+    // Time Warp:
+    bool_enum optimistic;       // True if Time Warp is to be used.
+    double window;              // Speculation limit beyond GVT. 0 if none.
+    unsigned int batch;         // Maximum events per LP per round.
+    psim_log* logs;             // The undo log of each LP.
+    psim_mailbox* anti;         // anti[(r%2)*nlp*nlp + i*nlp + j] in round r.
+    double* errtime;            // Time of the erroneous event of each LP.
+    double* terr;               // Published errtime of each LP in each round.
+    object** errobj;            // The object which returned the error.
+    double* tanti;              // Least time of anti-messages sent in round.
+    double* panti;              // Published tanti of each LP in each round.
+    unsigned long* lprolled;    // Number of events rolled back by each LP.
+    unsigned long nrolled;      // Events rolled back in the last simulation.
+
+    void post(systm*, event*);
+    void cancelled(systm*, event*);
+    void partition();
+    void unpartition();
+    object* execute(int, event*);
+    int run_lp(int);
+    int run_lp_optimistic(int);
+    void rollback(int, unsigned int, int);
+    void rollback_after(int, const event*, int);
+    void annihilate(int, event*, int);
+    bool_enum precedes(const event*, const event*) const;
+    bool_enum committed(const event*, double, bool_enum,
+        const ord_entry*) const;
+    void fossil_collect(int, double, bool_enum, const ord_entry* = 0);
+    static void* thread_main(void*);
+public:
+    int n_lps() const { return nlp; }
+    unsigned long n_rounds() const { return nrounds; }
+    unsigned long n_posted() const { return nposted; }
+    unsigned long n_rolled_back() const { return nrolled; }
+    int assign(object*, int);
+    int set_lookahead(object*, object*, double);
+    int set_lookahead(double);
+    int set_optimistic(double = 0, unsigned int = psim_default_batch);
+    void set_conservative() { optimistic = false; }
+
+    int simulate(double = 1, double = 0);
+
+//    psim& operator=(const psim& x) {}
+//    psim(const psim& x) {};
+    psim(systm&, int);
+    ~psim();
+    }; // End of struct psim.
+
+#endif /* AKSL_PSIM_H */
@@ -0,0 +1,110 @@
+// src/aksl/replic.h   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+#ifndef AKSL_REPLIC_H
+#define AKSL_REPLIC_H
+/*------------------------------------------------------------------------------
+Classes in this file:
+
+replicator::
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Independent replications of a simulation, run in parallel by a pool of threads.
+
+A replicator parses an ORAL data file once, with read(). Then run() creates a
+new "model" for each replication, with makedata(), and simulates each of its
+systems. Each replication has its own random number stream, which is the
+stream of rndm_stream(seed, rep) for replication number "rep". (See rndm.h.)
+So the results of each replication do not depend on the number of threads.
+
+The packages of each model are linked by the call-back function "setup", which
+is called with a new model for each replication. It should link a fresh copy of
+each package which is named in the data file, for example with model::link1().
+The objects of different replications must not share any data, except for data
+which is not modified while the simulations are running.
+
+The results of the replications are recorded as "statistics", which must be
+declared with add_stat() before run() is called. A statistic is set for the
+current replication either by an object, with the function replicator::set()
+(typically in its term() handler), or by the call-back function "collect",
+which is called after each simulation with the model and an array of all of the
+statistics of the replication. Then the mean of each statistic over all
+successful replications may be printed with a confidence interval, which is
+based on the Student t-distribution.
+
+If "warm_start" is set to the name of a checkpoint file, the first system of
+each replication is restored from this file and then resumed for the duration,
+instead of being simulated from the start. So a warm-up period may be simulated
+once only. Then each replication continues with its own random number stream.
+(See ckpt.h.)
+
+Every object of a model is deleted in the same thread which created it. While
+run() is running with more than one thread, the global flag bmem_threaded is
+set. (See bmem.h.)
+------------------------------------------------------------------------------*/
+
+// AKSL header files:
+#ifndef AKSL_AKSL_H
+#include "aksl/aksl.h"
+#endif
+#ifndef AKSL_ORAL_H
+#include "aksl/oral.h"
+#endif
+#ifndef AKSL_BOOLE_H
+#include "aksl/boole.h"
+#endif
+
+//----------------------//
+//     replicator::     //
+//----------------------//
+struct replicator {
+private:
+    oraldata od;                // The parse tree of the data file.
+    bool_enum parsed;           // True if a data file has been read.
+    const char** names;         // The names of the statistics.
+    int nstats;                 // The number of statistics.
+    int names_size;             // The size of the array "names".
+    double* x;                  // x[rep*nstats + i] = statistic i of rep.
+    int* status;                // The return value of each replication.
+    long nreps;                 // Number of replications in the last run.
+    volatile long nextrep;      // The next replication to be started.
+    double duration;            // Duration of each simulation.
+    unsigned long long seed;    // The seed of the random number streams.
+
+    int replicate(long);
+    static void* thread_main(void*);
+public:
+    int (*setup)(model&, void*);                    // Links the packages.
+    void (*collect)(model&, long, double*, void*);  // Records statistics.
+    void* arg;                  // Argument for "setup" and "collect".
+    const char* warm_start;     // Checkpoint file for the first system.
+
+    int read(c_string&, int = 0);
+    int add_stat(const char*);
+    static void set(int, double);   // Set a statistic of the current rep.
+
+    int run(long, int = 1, double = 1, unsigned long long = 1);
+
+    int n_stats() const { return nstats; }
+    long n_reps() const { return nreps; }
+    int rep_status(long r) const    // No check!
+        { return status[r]; }
+    double rep_value(long r, int i) const  // No check!
+        { return x[r*nstats + i]; }
+    long n(int) const;              // Number of successful replications.
+    double mean(int) const;
+    double stddev(int) const;
+    double halfwidth(int, double = 0.95) const;
+    void print(ostream& = cout, double = 0.95) const;
+
+//    replicator& operator=(const replicator& x) {}
+//    replicator(const replicator& x) {};
+    replicator();
+    ~replicator();
+    }; // End of struct replicator.
+
+extern double t_quantile(double, long);
+
+#endif /* AKSL_REPLIC_H */
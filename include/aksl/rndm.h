@@ -6,6 +6,17 @@ modified Artistic Licence, as specified in the accompanying LICENCE file.
 -----------------------------------------------------------------------------*/
 #ifndef AKSL_RNDM_H
 #define AKSL_RNDM_H
+/*------------------------------------------------------------------------------
+Classes in this file:
+
+rndm_stream::
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+The functions random0n(), randomnn() and random01() use the C library function
+random(), unless the calling thread has selected a private random number stream
+by setting the thread-local pointer rndm_current. This permits several
+independent simulations to run in the same process, each with its own
+reproducible sequence of random numbers. (See replic.h.)
+------------------------------------------------------------------------------*/
 
 // AKSL header files:
 #ifndef AKSL_AKSLDEFS_H
@@ -34,16 +45,67 @@ modified Artistic Licence, as specified in the accompanying LICENCE file.
 const double randivisorR = 2147483648.0;    // 2**31.
 const long randivisorN = 2147483647;        // 2**31 - 1.
 
+/*------------------------------------------------------------------------------
+rndm_stream:: is the PCG32 generator of
+    M.E. O'Neill, "PCG: a family of simple fast space-efficient statistically
+    good algorithms for random number generation", HMC-CS-2014-0905, 2014.
+Streams with the same seed and different sequence numbers are independent.
+The function next() returns integers in the same range as random().
+------------------------------------------------------------------------------*/
+//----------------------//
+//     rndm_stream::    //
+//----------------------//
+struct rndm_stream {
+private:
+    unsigned long long state;
+    unsigned long long inc;     // Always odd.
+public:
+    unsigned int next32() {
+        unsigned long long old = state;
+        state = old * 6364136223846793005ULL + inc;
+        unsigned int x = (unsigned int)(((old >> 18) ^ old) >> 27);
+        unsigned int rot = (unsigned int)(old >> 59);
+        return (x >> rot) | (x << ((32 - rot) & 31));
+        }
+    long next() { return (long)(next32() >> 1); }
+    void seed(unsigned long long s, unsigned long long seq) {
+        state = 0;
+        inc = (seq << 1) | 1;
+        next32();
+        state += s;
+        next32();
+        }
+
+    // The complete state of the stream, for checkpoints. (See ckpt.h.)
+    void get_state(unsigned long long& s, unsigned long long& i) const
+        { s = state; i = inc; }
+    void set_state(unsigned long long s, unsigned long long i)
+        { state = s; inc = i | 1; }
+
+//    rndm_stream& operator=(const rndm_stream& x) {}
+//    rndm_stream(const rndm_stream& x) {};
+    rndm_stream(unsigned long long s = 1, unsigned long long seq = 0)
+        { seed(s, seq); }
+    ~rndm_stream() {}
+    }; // End of struct rndm_stream.
+
+// The random number stream of the current thread. Null for random().
+extern AKSL_TLS rndm_stream* rndm_current;
+
+inline long rndm_random()
+    { return rndm_current ? rndm_current->next() : random(); }
+
 /*------------------------------------------------------------------------------
 random0n(n) returns a random integer in the range 0 <= x < n.
 ------------------------------------------------------------------------------*/
-inline long random0n(long n) { return random()/(1 + randivisorN/n); }
+inline long random0n(long n) { return rndm_random()/(1 + randivisorN/n); }
 
 /*------------------------------------------------------------------------------
 randomnn(n) returns a random integer in the range -n <= x < n.
 ------------------------------------------------------------------------------*/
 #ifdef SOLARIS
-inline long randomnn(long n) { return mrand48()/(1 + randivisorN/n); }
+inline long randomnn(long n) {
+    return rndm_current ? random0n(2*n) - n : mrand48()/(1 + randivisorN/n); }
 #else
 inline long randomnn(long n) { return random0n(2*n) - n; }
 #endif
@@ -51,7 +113,7 @@ inline long randomnn(long n) { return random0n(2*n) - n; }
 /*------------------------------------------------------------------------------
 random01() returns a random real number in the range 0 < x <= 1.
 ------------------------------------------------------------------------------*/
-inline double random01() { return (random() + 1)/randivisorR; }
+inline double random01() { return (rndm_random() + 1)/randivisorR; }
 
 // Exports:
 extern void srandom01();
@@ -0,0 +1,133 @@
+// src/aksl/rtsim.h   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+#ifndef AKSL_RTSIM_H
+#define AKSL_RTSIM_H
+/*------------------------------------------------------------------------------
+Classes in this file:
+
+rtsim::
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Real-time simulation of a system, paced by the wall clock.
+
+An rtsim runs the FEL of a system inside the event loop of a selector, so that
+a simulation can be driven by, and can drive, real sockets and devices. The
+rtsim is a select_handler, which keeps one timer in the selector for the wall
+time of the first event in the FEL. When the timer goes off, the handler
+executes the events which are due, and sets the timer again. All other
+handlers of the selector (sockets, stdin, other timers) are called from the
+same loop, in selector::get_event(), between the simulation events.
+
+Simulated time t is mapped to the wall time
+    wall0 + (t - start) * scale,
+where wall0 is the wall time at which simulate() was called, and "scale" is
+the number of wall seconds per simulated second. So a scale of 0.5 runs the
+simulation twice as fast as real time.
+
+The handler of a socket may inject an event into the system with inject(),
+which sends it at the current simulated time, that is, the simulated time
+which corresponds to the wall time now. The clock of the system is moved
+forward to this time first (but not past the first event in the FEL), so
+objects which are called by the handler may also send messages with
+object::send_message() in the usual way. If the injected event is earlier than
+the timer, the timer is set again.
+
+An event is executed no earlier than its wall time. Its lateness is the wall
+time at which the handler was called minus the wall time of the event. The
+number of events, the mean and maximum lateness, and the number of events
+which are later than the jitter bound, are kept, and printed by print_stats().
+If set_slip() is called, then whenever an event is later than the jitter
+bound, wall0 is moved forward by its lateness, so that the simulation falls
+behind the wall clock, instead of executing a burst of late events to catch
+up. So the jitter of the following events is bounded by the jitter bound,
+unless the machine is overloaded.
+
+Events at or after the finish time are not executed. The simulation ends when
+the wall time of the finish time is reached, or when an object or the handler
+of a socket calls stop(), or when an object returns an error. The simulation
+does not end when the FEL is empty, because events may still be injected.
+Example:
+
+    selector sel;
+    rtsim rt(*sys, sel, 1.0);
+    my_socket_handler h(&rt);       // Calls rt.inject() when data arrives.
+    sel.set_fd_mask(fd, sREAD, &h);
+    int err = rt.simulate(60);
+------------------------------------------------------------------------------*/
+
+// AKSL header files:
+#ifndef AKSL_AKSL_H
+#include "aksl/aksl.h"
+#endif
+#ifndef AKSL_SELECTOR_H
+#include "aksl/selector.h"
+#endif
+#ifndef AKSL_BOOLE_H
+#include "aksl/boole.h"
+#endif
+
+// The default jitter bound, in wall seconds.
+const double rtsim_deft_jitter = 0.001;
+
+//----------------------//
+//        rtsim::       //
+//----------------------//
+struct rtsim: public select_handler {
+private:
+    systm* sys;                 // The simulated system.
+    selector* sel;              // The event loop.
+    double scale;               // Wall seconds per simulated second.
+    double jitter;              // Events later than this are counted as late.
+    bool_enum slip;             // True if late events move wall0 forward.
+    double start;               // Start time of the simulation.
+    double finish;              // Finish time of the simulation.
+    double wall0;               // Wall time of the start time.
+    const void* tmr;            // The timer in the selector, or 0.
+    double tmr_at;              // The wall time of the timer.
+    bool_enum running;          // True during simulate().
+    int err;                    // Error which ends the simulation, or 0.
+
+    // Statistics.
+    unsigned long nevents;      // Events executed.
+    unsigned long nlate;        // Events later than the jitter bound.
+    unsigned long ninjected;    // Events injected.
+    unsigned long nslips;       // Number of times wall0 was moved.
+    double late_sum;            // Sum of the lateness of the events.
+    double late_max;            // Maximum lateness of the events.
+
+    double wall(double t) const { return wall0 + (t - start) * scale; }
+    void arm();
+    int handler();
+public:
+    // The simulated time which corresponds to the wall time now.
+    double now() const;
+    void sync();                // Move the system clock forward to now().
+    event* inject(object*, object*, mtype, const payload& = payload());
+    event* inject(object* o, object* d, mtype m, value* pv)
+        { return inject(o, d, m, payload(pv)); }
+    void stop(int = 0);         // End the simulation, with an error if < 0.
+    void set_scale(double s) { if (s > 0 && !running) scale = s; }
+    void set_jitter(double j) { if (j >= 0) jitter = j; }
+    void set_slip(bool_enum b = true) { slip = b; }
+
+    unsigned long n_events() const { return nevents; }
+    unsigned long n_late() const { return nlate; }
+    unsigned long n_injected() const { return ninjected; }
+    unsigned long n_slips() const { return nslips; }
+    double mean_lateness() const
+        { return (nevents > 0) ? late_sum / nevents : 0; }
+    double max_lateness() const { return late_max; }
+    void print_stats(ostream& = cout) const;
+
+    int simulate(double = 1, double = 0);
+
+//    rtsim& operator=(const rtsim& x) {}
+//    rtsim(const rtsim& x) {};
+    rtsim(systm&, selector&, double = 1, double = rtsim_deft_jitter);
+    ~rtsim();
+    }; // End of struct rtsim.
+
+#endif /* AKSL_RTSIM_H */
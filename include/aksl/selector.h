@@ -48,6 +48,9 @@ the Unix system clock (e.g. gettimeofday), not directly on a hardware clock.
 #ifndef AKSL_HEAP_H
 #include "aksl/heap.h"
 #endif
+#ifndef AKSL_OPTIONS_H
+#include "aksl/options.h"
+#endif
 #ifndef AKSL_CHARBUF_H
 #include "aksl/charbuf.h"
 #endif
@@ -663,28 +666,36 @@ public:
     timer(double tt) {
         t = tt;
         t_handler = 0;
-#if BMEM_TRACE
-        bmem0.owner = "timer";
-#endif
         }
     ~timer() {}
     }; // End of struct timer.
 
+// The base of the timer heap is chosen in options.h.
+#if AKSL_SELECTOR_TIMER_DHEAP
+typedef min_tim_dheap timer_heap_base;
+typedef dheap_traversal timer_heap_base_traversal;
+#else
+typedef min_tim_heap timer_heap_base;
+typedef heap_traversal timer_heap_base_traversal;
+#endif
+
 //----------------------//
 //      timer_heap::    //
 //----------------------//
-struct timer_heap: private min_tim_heap {
+struct timer_heap: private timer_heap_base {
 friend struct timer_heap_traversal;
 public:
     // The routine members:
-    const timer* first() const { return (const timer*)min_tim_heap::first(); }
-    const timer* last() const { return (const timer*)min_tim_heap::last(); }
-    using min_tim_heap::empty;
-    using min_tim_heap::length;
+    const timer* first() const
+        { return (const timer*)timer_heap_base::first(); }
+    const timer* last() const
+        { return (const timer*)timer_heap_base::last(); }
+    using timer_heap_base::empty;
+    using timer_heap_base::length;
 
     // The cast in the next line should not be necessary!
-    void insert(timer* p) { min_tim_heap::insert((tim*)p); }
-    timer* popfirst() { return (timer*)min_tim_heap::popfirst(); }
+    void insert(timer* p) { timer_heap_base::insert((tim*)p); }
+    timer* popfirst() { return (timer*)timer_heap_base::popfirst(); }
     void delfirst() { delete popfirst(); }
     void del_timers() {
         timer* pt;
@@ -700,15 +711,15 @@ public:
 //--------------------------//
 //  timer_heap_traversal::  //
 //--------------------------//
-struct timer_heap_traversal: private heap_traversal {
+struct timer_heap_traversal: private timer_heap_base_traversal {
 
 public:
-    timer* next() { return (timer*)heap_traversal::next(); }
-    using heap_traversal::init;
+    timer* next() { return (timer*)timer_heap_base_traversal::next(); }
+    using timer_heap_base_traversal::init;
 
 //    timer_heap_traversal& operator=(const timer_heap_traversal& x) {}
 //    timer_heap_traversal(const timer_heap_traversal& x) {};
-    timer_heap_traversal(timer_heap& h): heap_traversal(h) {}
+    timer_heap_traversal(timer_heap& h): timer_heap_base_traversal(h) {}
     ~timer_heap_traversal() {}
     }; // End of struct timer_heap_traversal.
 
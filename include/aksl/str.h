@@ -38,6 +38,9 @@ using namespace std;
 #ifndef AKSL_NEWSTR_H
 #include "aksl/newstr.h"
 #endif
+#ifndef AKSL_SZMEM_H
+#include "aksl/szmem.h"
+#endif
 #ifndef AKSL_BOOLE_H
 #include "aksl/boole.h"
 #endif
@@ -69,16 +72,17 @@ the number of links currently to the string. ("rep" means "representation".)
 struct c_string_rep {
 friend struct c_string;
 private:
-    char* s;                        // The actual string.
+    char* s;                        // The actual string. (szbuf_new.)
     long nlink;                     // The number of links to this string.
 
     // Read-only functions:
     c_string_rep* copy() { return new c_string_rep(s); }
     void cpy(const char* s2) {      // Analogous to ::strcpy().
-        delete[] s;
-        s = ::new_strcpy(s2);
+        szbuf_delete(s);
+        s = szbuf_strcpy(s2);
         }
-    void eat(char* s2) { delete[] s; s = s2; }
+    void eat(char* s2)
+        { szbuf_delete(s); s = szbuf_adopt(s2, s2 ? strlen(s2) + 1 : 0); }
     char* new_strcpy() const { return ::new_strcpy(s); }
     char* new_strcpy(const char* s2) const { return ::new_strcpy(s, s2); }
     char* new_strcpy_nz() const { return ::new_strcpy_nz(s); }
@@ -115,7 +119,7 @@ private:
                 return 0;
         }
     // Write functions:
-    void clear() { delete[] s; s = 0; }
+    void clear() { szbuf_delete(s); s = 0; }
     void cat(const char* pc);
 #if HAVE_SNPRINTF
     void cat(long x);
@@ -128,10 +132,10 @@ private:
     void subst(char c1, char c2);
 
     // Non-standard constructors:
-    c_string_rep(const char* s2) { s = ::new_strcpy(s2); nlink = 1; }
+    c_string_rep(const char* s2) { s = szbuf_strcpy(s2); nlink = 1; }
 
     c_string_rep() { s = 0; nlink = 1; }    // Assume immediate linkage!
-    ~c_string_rep() { delete[] s; }
+    ~c_string_rep() { szbuf_delete(s); }
     }; // End of struct c_string_rep.
 
 /*------------------------------------------------------------------------------
@@ -0,0 +1,175 @@
+// src/aksl/szmem.h   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+#ifndef AKSL_SZMEM_H
+#define AKSL_SZMEM_H
+/*------------------------------------------------------------------------------
+Classes defined in this file:
+
+szmem::
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Inline functions in this file:
+
+szmem_buffers
+szbuf_new
+szbuf_delete
+szbuf_strcpy
+szbuf_adopt
+------------------------------------------------------------------------------*/
+
+// AKSL header files:
+#ifndef AKSL_BMEM_H
+#include "aksl/bmem.h"
+#endif
+#ifndef AKSL_OPTIONS_H
+#include "aksl/options.h"
+#endif
+
+// System header files:
+#ifndef AKSL_X_STRING_H
+#define AKSL_X_STRING_H
+#include <string.h>
+#endif
+
+// The smallest and largest size classes, in bytes.
+const long szmem_min_size = 16;
+const long szmem_max_size = 65536;
+
+// Number of size classes. (Two per power of 2 from 16 to 65536.)
+const int szmem_nclasses = 25;
+
+// Approximate number of bytes in each block of a size class.
+const long szmem_block_bytes = 65536;
+
+/*------------------------------------------------------------------------------
+An szmem allocates variable-length arrays from a set of bmems, one for each of
+the size classes 16, 24, 32, 48, 64, 96, ..., 49152, 65536 bytes. So the
+classes go up in steps of about the square root of 2, and at most a third of
+each chunk is wasted. The class of each chunk is kept in the BMEM_ALIGN bytes
+just before the array, so that free() does not need the size. Arrays larger
+than szmem_max_size come from operator new[] or malloc().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+The bmem of a class is created when the class is first used, with a first
+block of about szmem_block_bytes, but not less than 4 chunks. Like bmem, an
+szmem never gives memory back. Since the bmems use the thread caches while
+bmem_threaded is set, so does an szmem. The statistics are then updated
+atomically.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+For each class, and for the large arrays (class szmem_nclasses), the number
+of allocations and frees, the number of arrays in use, and the highest number
+in use, are kept. These are printed by print().
+------------------------------------------------------------------------------*/
+//----------------------//
+//        szmem::       //
+//----------------------//
+struct szmem {
+private:
+    bmem* volatile pools[szmem_nclasses];   // The bmem of each class, or 0.
+    memsrc_t memsrc;                        // The memory source of the bmems.
+
+    // Statistics, indexed by class. The last entry is for large arrays.
+    volatile unsigned long nallocs[szmem_nclasses + 1];
+    volatile unsigned long nfrees[szmem_nclasses + 1];
+    volatile unsigned long nhigh[szmem_nclasses + 1];
+
+    bmem* newpool(int);
+    void count_alloc(int);
+    void count_free(int);
+public:
+    static int size_class(long);            // Class of an array, or -1.
+    static long class_size(int);            // Size of a class, or 0.
+
+    void* alloc(long n);                    // 0 if n <= 0 or no memory.
+    void free(void* p);                     // Array from alloc(), or 0.
+    static long capacity(const void* p);    // Usable size of an array.
+
+    unsigned long n_allocs(int i) const;
+    unsigned long n_frees(int i) const;
+    unsigned long n_in_use(int i) const;
+    unsigned long high_water(int i) const;
+    unsigned long n_chunks(int i) const;    // Chunks in the bmem.
+    unsigned long n_bytes(int i) const;     // Bytes in the bmem.
+    unsigned long n_large() const { return n_in_use(szmem_nclasses); }
+    void print(ostream& = cout) const;      // Print the statistics.
+
+//    szmem& operator=(const szmem& x) {}
+//    szmem(const szmem& x) {};
+    szmem(memsrc_t = msNEW);
+    ~szmem();
+    }; // End of struct szmem.
+
+// The szmem for the buffer classes. Created when first used.
+extern szmem* szmem_buffers0;
+extern szmem* szmem_buffers_init();
+
+//----------------------//
+//     szmem_buffers    //
+//----------------------//
+inline szmem* szmem_buffers() {
+    szmem* p = szmem_buffers0;
+    return p ? p : szmem_buffers_init();
+    } // End of function szmem_buffers.
+
+/*------------------------------------------------------------------------------
+The buffer classes (cp_pkt, nbytes, c_string_rep, frame8, frame32) allocate
+and free their arrays with szbuf_new() and szbuf_delete(), which use the szmem
+szmem_buffers() if AKSL_SIZE_CLASS_BUFFERS is set (see options.h), and
+otherwise operator new[] and delete[]. szbuf_strcpy() is the szbuf version of
+new_strcpy(). szbuf_adopt() turns an array from new[] into an szbuf array, by
+copying it if necessary.
+------------------------------------------------------------------------------*/
+//----------------------//
+//       szbuf_new      //
+//----------------------//
+inline char* szbuf_new(long n) {
+#if AKSL_SIZE_CLASS_BUFFERS
+    return (char*)szmem_buffers()->alloc(n);
+#else
+    return new char[n];
+#endif
+    } // End of function szbuf_new.
+
+//----------------------//
+//     szbuf_delete     //
+//----------------------//
+inline void szbuf_delete(char* p) {
+#if AKSL_SIZE_CLASS_BUFFERS
+    szmem_buffers()->free(p);
+#else
+    delete[] p;
+#endif
+    } // End of function szbuf_delete.
+
+//----------------------//
+//     szbuf_strcpy     //
+//----------------------//
+inline char* szbuf_strcpy(const char* s2) {
+    if (!s2)
+        return 0;
+    long n = strlen(s2) + 1;
+    char* s = szbuf_new(n);
+    memcpy(s, s2, n);
+    return s;
+    } // End of function szbuf_strcpy.
+
+//----------------------//
+//      szbuf_adopt     //
+//----------------------//
+inline char* szbuf_adopt(char* p, long n) {
+#if AKSL_SIZE_CLASS_BUFFERS
+    if (!p)
+        return 0;
+    char* q = szbuf_new(n);
+    memcpy(q, p, n);
+    delete[] p;
+    return q;
+#else
+    (void)n;                    // The length is not needed here.
+    return p;
+#endif
+    } // End of function szbuf_adopt.
+
+#endif /* AKSL_SZMEM_H */
@@ -0,0 +1,181 @@
+// src/aksl/trace.h   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+#ifndef AKSL_TRACE_H
+#define AKSL_TRACE_H
+/*------------------------------------------------------------------------------
+Classes in this file:
+
+trace_header::
+trace_record::
+event_trace::
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Binary event traces.
+
+The text trace of systm::simulate() (set_trace_level()) prints every event with
+event::print(), which is far too slow for long simulations. A binary event trace
+records each simulated event as a fixed-size trace_record instead, which costs
+only a few stores per event. The trace is opened for a system with
+systm::open_event_trace(), and is closed by systm::close_event_trace() or when
+the system is deleted. It may be brought up to date while it is open with
+systm::sync_event_trace(). It records the events simulated by
+systm::advance(), and thus by simulate() and resume(), at all trace levels.
+
+There are two kinds of trace file.
+-   In a "ring" trace, the file is memory-mapped and holds the last n records.
+    This is for keeping the events before a crash or an error, at any speed.
+    The record count in the mapped header is updated by each record(), and the
+    name tables are written when the trace is opened, so that the file can be
+    decoded even if the program dies without closing it.
+-   Otherwise, the records are collected in a buffer of n records, which is
+    written to the file whenever it is full. So the file holds all records.
+    The record count in the header is updated by sync() and close(), and the
+    name tables are written when the trace is closed.
+
+Objects are identified in the records by their ids in the system (see
+systm::add()), which are never re-used. The trace keeps a copy of the name and
+type of each object of the system when the trace is opened, and of each object
+added later, so that objects which have been removed are still named. The
+program tools/tracedump prints a trace file in the format of event::print().
+In a ring file, the objects added since the last sync() are printed as ids.
+
+The file format is native-endian, so a trace file can only be read on the same
+kind of machine. It is as follows.
+    trace_header                        (64 bytes)
+    trace_record[]                      (Ring: "capacity" slots.)
+    name tables                         (At the offset "tables".)
+The name tables consist of the number of message types, followed by their
+names, and then the number of objects, followed by the id, name and type of
+each object. Numbers are 4 bytes. Each string is preceded by its length.
+In a ring, if "count" is greater than "capacity", the oldest record is in slot
+count % capacity.
+------------------------------------------------------------------------------*/
+
+// AKSL header files:
+#ifndef AKSL_AKSL_H
+#include "aksl/aksl.h"
+#endif
+#ifndef AKSL_BOOLE_H
+#include "aksl/boole.h"
+#endif
+
+// System header files:
+#ifndef AKSL_X_STDIO_H
+#define AKSL_X_STDIO_H
+#include <stdio.h>
+#endif
+
+// The first bytes of a trace file.
+#define TRACE_MAGIC "AKSLTRC2"
+
+// A native-order integer, for checking the byte order of the file.
+const unsigned int trace_byte_order = 0x01020304;
+
+//----------------------//
+//     trace_header::   //
+//----------------------//
+struct trace_header {
+    char magic[8];                  // TRACE_MAGIC, without the null.
+    unsigned int byte_order;        // trace_byte_order.
+    unsigned int record_size;       // sizeof(trace_record).
+    unsigned long long capacity;    // Number of slots of a ring. 0 if none.
+    unsigned long long count;       // Number of records written.
+    unsigned long long tables;      // Offset of the name tables. 0 if none.
+    char reserved[24];
+    }; // End of struct trace_header.
+
+//----------------------//
+//     trace_record::   //
+//----------------------//
+struct trace_record {
+    double t;                       // Time of the event.
+    unsigned int orig;              // Id of the origin object.
+    unsigned int dest;              // Id of the destination, or no_object_id.
+    int mty;                        // Global message type.
+    int ptype;                      // Type of the argument. (Ptype.)
+    long long arg;                  // As payload::word(), but id of object.
+    }; // End of struct trace_record.
+
+//----------------------//
+//     event_trace::    //
+//----------------------//
+struct event_trace {
+private:
+    char* path;                     // Name of the trace file.
+    trace_record* rec;              // The ring or buffer of records.
+    unsigned long n;                // Number of records of "rec".
+    unsigned long pos;              // The next slot of "rec".
+    unsigned long long count;       // Number of records written.
+    bool_enum ring;                 // True if "rec" is a memory-mapped ring.
+    void* map;                      // The mapped file, for a ring.
+    unsigned long maplen;           // Length of the mapping.
+    FILE* fp;                       // The file, if not a ring.
+    int err;                        // The first error, or 0.
+
+    // The name tables.
+    char** mnames;                  // Names of the message types.
+    long nmnames;                   // Number of message types.
+    char** onames;                  // Names of the objects, indexed by id.
+    char** otypes;                  // Types of the objects, indexed by id.
+    unsigned int nobjs;             // Size of onames and otypes.
+    bool_enum stale;                // True if the ring tables are stale.
+
+    void wrap();
+    void put_tables(FILE*);
+    void write_ring_tables();
+    void clear_names();
+public:
+    int open(const char*, unsigned long = 65536, bool_enum = false);
+    void set_mtypes(const char** names, long nm);
+    void add_object(const object*);
+    void record(const event* pe) {
+        trace_record& r = rec[pos];
+        r.t = pe->time();
+        r.orig = pe->orig->id();
+        r.dest = pe->dest ? pe->dest->id() : no_object_id;
+        r.mty = pe->mty;
+        r.ptype = pe->arg.type();
+        if (r.ptype == pOBJECT) {
+            object* po = pe->arg;
+            r.arg = po ? po->id() : no_object_id;
+            }
+        else
+            r.arg = pe->arg.word();
+        count += 1;
+        if (ring)
+            ((trace_header*)map)->count = count;
+        if (++pos >= n)
+            wrap();
+        }
+    void sync();                    // Bring the file up to date.
+    int close();
+    unsigned long long length() const { return count; }
+    int error() const { return err; }
+
+//    event_trace& operator=(const event_trace& x) {}
+//    event_trace(const event_trace& x) {};
+    event_trace() {
+        path = 0;
+        rec = 0;
+        n = 0;
+        pos = 0;
+        count = 0;
+        ring = false;
+        map = 0;
+        maplen = 0;
+        fp = 0;
+        err = 0;
+        mnames = 0;
+        nmnames = 0;
+        onames = 0;
+        otypes = 0;
+        nobjs = 0;
+        stale = false;
+        }
+    ~event_trace();
+    }; // End of struct event_trace.
+
+#endif /* AKSL_TRACE_H */
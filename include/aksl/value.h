@@ -10,6 +10,7 @@ modified Artistic Licence, as specified in the accompanying LICENCE file.
 Classes defined in this file:
 
 value::
+payload::
 valuelist::
 tagvalue::
 tagvaluelist::
@@ -172,6 +173,91 @@ public:
     ~value() {}
     }; // End of struct value.
 
+// Types of "payloads":
+enum Ptype {
+    pNONE,                          // No argument.
+    pINTEGER,                       // Integer.
+    pREAL,                          // Real number.
+    pOBJECT,                        // Pointer to object.
+    pDATUM,                         // Datum.
+    pVALUE                          // Pointer to a heap-allocated value.
+    };
+
+/*------------------------------------------------------------------------------
+A "payload" is the argument of an event. It holds a small argument directly, so
+that sending a message with a long, double, object* or datum* argument does not
+allocate a "value". Any other argument is held as a pointer to a "value".
+The conversion operators have the same results as those of "value".
+The function new_value() returns the argument as a value. If the payload holds
+a value pointer, this pointer is returned. Otherwise a new value is created,
+which belongs to the caller.
+------------------------------------------------------------------------------*/
+//----------------------//
+//       payload::      //
+//----------------------//
+struct payload {
+private:
+    Ptype ty;
+    union {
+        long            i;
+        double          r;
+        object*         p;
+        datum*          d;
+        value*          v;
+        };
+public:
+    Ptype type() const { return ty; }
+    bool_enum Integer() const { return (bool_enum)(ty == pINTEGER); }
+    bool_enum Real() const { return (bool_enum)(ty == pREAL); }
+    bool_enum Object() const { return (bool_enum)(ty == pOBJECT); }
+    bool_enum Datum() const { return (bool_enum)(ty == pDATUM); }
+    bool_enum Value() const { return (bool_enum)(ty == pVALUE); }
+    bool_enum Null() const { return (bool_enum)(ty == pNONE); }
+
+    void clear() { ty = pNONE; }
+    long word() const { return i; }     // The raw argument, for tracing.
+    value* new_value() const;
+    value* value_ptr() const { return (ty == pVALUE) ? v : 0; }
+
+    operator long() const {
+        return (ty == pINTEGER) ? i : (ty == pREAL) ? (long)r :
+            (ty == pVALUE) ? (long)*v : 0; }
+    operator double() const {
+        return (ty == pREAL) ? r : (ty == pINTEGER) ? (double)i :
+            (ty == pVALUE) ? (double)*v : 0; }
+    operator object*() const {
+        return (ty == pOBJECT) ? p : (ty == pVALUE) ? (object*)*v : 0; }
+    operator datum*() const {
+        return (ty == pDATUM) ? d : (ty == pVALUE) ? (datum*)*v : 0; }
+
+    payload& operator=(long ii) { ty = pINTEGER; i = ii; return *this; }
+    payload& operator=(double rr) { ty = pREAL; r = rr; return *this; }
+    payload& operator=(object* pp) { ty = pOBJECT; p = pp; return *this; }
+    payload& operator=(datum* dd) { ty = pDATUM; d = dd; return *this; }
+    payload& operator=(value* pv)
+        { ty = pv ? pVALUE : pNONE; v = pv; return *this; }
+
+    payload(long ii) { ty = pINTEGER; i = ii; }
+    payload(double rr) { ty = pREAL; r = rr; }
+    payload(object* pp) { ty = pOBJECT; p = pp; }
+    payload(datum* dd) { ty = pDATUM; d = dd; }
+    payload(value* pv) { ty = pv ? pVALUE : pNONE; v = pv; }
+    payload() { ty = pNONE; v = 0; }
+    ~payload() {}
+    }; // End of struct payload.
+
+inline value* payload::new_value() const {
+    switch (ty) {
+    case pINTEGER:  return new value(i);
+    case pREAL:     return new value(r);
+    case pOBJECT:   return new value(p);
+    case pDATUM:    return new value(d);
+    case pVALUE:    return v;
+    case pNONE:
+    default:        return 0;
+        }
+    } // End of function payload::new_value.
+
 //----------------------//
 //      valuelist::     //
 //----------------------//
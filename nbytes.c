@@ -44,7 +44,7 @@ int nbytes::nbytes_bufsize  = nbytes_bufsize0;
 nbytes::nbytes(const nbytes& x) {
     if (x.pc) {
         n = x.n;
-        pc = new char[n];
+        pc = szbuf_new(n);
         memcpy(pc, x.pc, n);
         }
     else {
@@ -57,10 +57,10 @@ nbytes::nbytes(const nbytes& x) {
 //   nbytes::operator=  //
 //----------------------//
 nbytes& nbytes::operator=(const nbytes& x) {
-    delete[] pc;
+    szbuf_delete(pc);
     if (x.pc) {
         n = x.n;
-        pc = new char[n];
+        pc = szbuf_new(n);
         memcpy(pc, x.pc, n);
         }
     else {
@@ -78,7 +78,7 @@ void nbytes::copy_from(const char* pc1, int n1) {
     if (!pc1 || n1 <= 0)
         return;
     n = n1;
-    pc = new char[n1];
+    pc = szbuf_new(n1);
     memcpy(pc, pc1, n);
     } // End of function nbytes::copy_from.
 
@@ -86,6 +86,7 @@ void nbytes::copy_from(const char* pc1, int n1) {
 This function assumes that "pc1" points to a heap-allocated char array of length
 n1 bytes. The "pc1" pointer is deleted to try to prevent the user from deleting
 the memory, because that responsibility is taken over by the "nbytes" class.
+If AKSL_SIZE_CLASS_BUFFERS is set, the array is copied and deleted.
 ------------------------------------------------------------------------------*/
 //----------------------//
 //    nbytes::swallow   //
@@ -95,7 +96,7 @@ void nbytes::swallow(char*& pc1, int n1) {
     if (!pc1 || n1 <= 0)
         return;
     n = n1;
-    pc = pc1;
+    pc = szbuf_adopt(pc1, n1);
 
     // Zero the char-pointer so that the user won't be able to delete it!
     pc1 = 0;
@@ -155,8 +156,8 @@ int nbytes::read(int fd, int bufsize, bool_enum append) {
     if (!append) {
         // Copy the new bytes to the (pc, n) pair:
         if (rval > 0) {
-            delete[] pc;
-            pc = new char[rval];
+            szbuf_delete(pc);
+            pc = szbuf_new(rval);
             memcpy(pc, buf, rval);
             n = rval;
             }
@@ -166,10 +167,10 @@ int nbytes::read(int fd, int bufsize, bool_enum append) {
     else {
         // Append the new bytes to the (pc, n) pair:
         if (rval > 0) {
-            char* pc2 = new char[n + rval];
+            char* pc2 = szbuf_new(n + rval);
             memcpy(pc2, pc, n);
             memcpy(pc2 + n, buf, rval);
-            delete[] pc;
+            szbuf_delete(pc);
             pc = pc2;
             n += rval;
             }
@@ -12,9 +12,14 @@ acolonlist2value
 attrlist2value
 makeobjects
 setattributes
+parsedatafile
+makedata
 readdatafile
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 The principal export from this compilation unit is function "readdatafile".
+It is equivalent to "parsedatafile" followed by "makedata". These two functions
+may be called separately, so that a file may be parsed once and then used to
+create the objects of several models. (See replic.h.)
 
 Function "readdatafile" creates objects with the relations and attributes
 indicated in the input file (in the ORAL data language), using the functions
@@ -216,13 +221,17 @@ objects. A pointer to each created "object" is set in the corresponding
 parse-tree "item", in preparation for the attribute-setting phase. This way of
 doing things makes it possible for objects to reference both forwards and
 backwards in system description files.
+The names are copied, so that the objects do not share reference-counted strings
+with the parse tree.
 ------------------------------------------------------------------------------*/
 //----------------------//
 //     makeobjects      //
 //----------------------//
 static int makeobjects(itemblock& ol, model& mdl, systm& sys) {
     Forall(item, pi, ol.items) {
-        object* po = mdl.newobject(sys, pi->classname, pi->name);
+        c_string classname((const char*)pi->classname);
+        c_string name((const char*)pi->name);
+        object* po = mdl.newobject(sys, classname, name);
         if (!po) {
             cout << "Failed to create object " << pi->name
                  << " of type " << pi->classname << DOTNL;
@@ -264,19 +273,20 @@ static int setattributes(itemblock& ol, systm* sys) {
         Forall(attr, pa, ol.globvars) {
             if (!pa->name || !pa->a)
                 continue;
+            c_string name((const char*)pa->name);   // Not shared with "ol".
             value* pv = new value;
             switch(pa->a->type) {
             case avINTEGER:
                 *pv = pa->a->i;
-                sys->setglob(pa->name, pv);
+                sys->setglob(name, pv);
                 break;
             case avREAL:
                 *pv = pa->a->r;
-                sys->setglob(pa->name, pv);
+                sys->setglob(name, pv);
                 break;
             case avSTRING: // Note that users must make their own string copies!
                 *pv = pa->a->s_refname.new_strcpy();
-                sys->setglob(pa->name, pv);
+                sys->setglob(name, pv);
                 break;
             case avREF: {
                 item* po = pa->a->itm;
@@ -285,25 +295,22 @@ static int setattributes(itemblock& ol, systm* sys) {
                     break;
                     }
                 *pv = (object*)po->obj;
-                sys->setglob(pa->name, pv);
+                sys->setglob(name, pv);
                 }
                 break;
             case avLIST:
                 // Overloaded assignment for this is rejected by the compiler.
                 avaluelist2value(*pv, pa->a->l, sys);
-                sys->setglob(pa->name, pv);
-                pa->a->l = 0; // Dodgy!
+                sys->setglob(name, pv);
                 break;
             case avBLOCK:
                 attrlist2value(*pv, pa->a->blk, sys);
-                sys->setglob(pa->name, pv);
-                pa->a->blk = 0; // Dodgy!
+                sys->setglob(name, pv);
                 break;
             case avCOLONLIST:
                 // Overloaded assignment for this is rejected by the compiler.
                 acolonlist2value(*pv, pa->a->cl, sys);
-                sys->setglob(pa->name, pv);
-                pa->a->cl = 0; // Dodgy!
+                sys->setglob(name, pv);
                 break;
             case avNULL:
             default:
@@ -383,30 +390,15 @@ static int setattributes(itemblock& ol, systm* sys) {
     } // End of function setattributes.
 
 /*------------------------------------------------------------------------------
-This function reads the contents of a file with the name "filename" into the
-"model" structure "mdl". The file is first parsed, and then structures of class
-"object" are created to represent the system described in the file.
-- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-First, a parse-tree object of class "oraldata" is created to hold the results of
-parsing the file.
-Then the file is parsed with the function oraldata::readfile.
-Then the simulation packages requested in the input file are loaded into the
-system model "mdl" to provide the "object"s to simulate the system described.
-Then for each system (typically on system only) in the input file:
--   create "object" structures according to the file's descriptions
--   set the indicated attribute lists for each each object created.
+parsedatafile() parses the file with the name "filename" into the parse-tree
+object "od" of class "oraldata".
 If all goes well, 0 is returned. Otherwise a negative integer is returned,
 indicating the category of failure.
-The second to last step invokes function "makeobjects", which is defined in this
-file.
-The last step (attribute setting) is performed by calling function
-"setattributes" which is also defined in this file.
 ------------------------------------------------------------------------------*/
 //----------------------//
-//     readdatafile     //
+//     parsedatafile    //
 //----------------------//
-int readdatafile(model& mdl, c_string& filename, int trace) {
-    oraldata od;
+int parsedatafile(oraldata& od, c_string& filename, int trace) {
     oralsystem* os;
     int err;
 
@@ -433,11 +425,38 @@ int readdatafile(model& mdl, c_string& filename, int trace) {
             cout << DOTNL;
             }
         }
+    return 0;
+    } // End of function parsedatafile.
+
+/*------------------------------------------------------------------------------
+makedata() creates the objects described by the parse tree "od" in the "model"
+structure "mdl".
+First, the simulation packages requested in the parse tree are loaded into the
+system model "mdl" to provide the "object"s to simulate the system described.
+Then for each system (typically on system only) in the parse tree:
+-   create "object" structures according to the file's descriptions
+-   set the indicated attribute lists for each each object created.
+If all goes well, 0 is returned. Otherwise a negative integer is returned,
+indicating the category of failure.
+The second to last step invokes function "makeobjects", which is defined in this
+file.
+The last step (attribute setting) is performed by calling function
+"setattributes" which is also defined in this file.
+The parse tree is not modified, except for the object pointers in its items.
+So makedata() may be called for any number of models, but not concurrently.
+------------------------------------------------------------------------------*/
+//----------------------//
+//       makedata       //
+//----------------------//
+int makedata(model& mdl, oraldata& od, int trace) {
+    oralsystem* os;
+    int err;
 
     // Load all of the referenced simulation packages.
     Forall(strng, sp, od.packagenames) {
         if (notnullstr(sp->s)) {
-            if ((err = mdl.load(sp->s)) < 0) {
+            c_string name((const char*)sp->s);
+            if ((err = mdl.load(name)) < 0) {
                 cout << "Error while loading module \"" << sp->s << "\".\n";
                 return err;
                 }
@@ -455,7 +474,7 @@ int readdatafile(model& mdl, c_string& filename, int trace) {
             }
 
         // Find or create system with requested name.
-        systm* sys = mdl.getsystem(os->name);
+        systm* sys = mdl.getsystem(c_string((const char*)os->name));
         if (!sys) {
             cout << "Error while getting a system called \"";
             cout << os->name << "\".\n";
@@ -479,4 +498,28 @@ int readdatafile(model& mdl, c_string& filename, int trace) {
         }
 
     return 0;
+    } // End of function makedata.
+
+/*------------------------------------------------------------------------------
+This function reads the contents of a file with the name "filename" into the
+"model" structure "mdl". The file is first parsed, and then structures of class
+"object" are created to represent the system described in the file.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+First, a parse-tree object of class "oraldata" is created to hold the results of
+parsing the file.
+Then the file is parsed with the function parsedatafile.
+Then the objects are created with the function makedata.
+If all goes well, 0 is returned. Otherwise a negative integer is returned,
+indicating the category of failure.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     readdatafile     //
+//----------------------//
+int readdatafile(model& mdl, c_string& filename, int trace) {
+    oraldata od;
+    int err;
+
+    if ((err = parsedatafile(od, filename, trace)) < 0)
+        return err;
+    return makedata(mdl, od, trace);
     } // End of function readdatafile.
@@ -0,0 +1,351 @@
+// src/aksl/prof.c   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+/*------------------------------------------------------------------------------
+Functions in this file:
+
+prof_cmp
+prof_print_rows
+sim_profile::
+    start
+    reset
+    find_pkg
+    record
+    seconds_per_tick
+    print
+    ~sim_profile
+    discard
+systm::
+    set_profiling
+    print_profile
+------------------------------------------------------------------------------*/
+
+#include "aksl/prof.h"
+#ifndef AKSL_ERROR_H
+#include "aksl/error.h"
+#endif
+
+// System header files.
+#ifndef AKSL_X_STDIO_H
+#define AKSL_X_STDIO_H
+#include <stdio.h>
+#endif
+#ifndef AKSL_X_STDLIB_H
+#define AKSL_X_STDLIB_H
+#include <stdlib.h>
+#endif
+
+/*------------------------------------------------------------------------------
+prof_cmp() orders rows by decreasing handler time, for qsort().
+------------------------------------------------------------------------------*/
+//----------------------//
+//       prof_cmp       //
+//----------------------//
+static int prof_cmp(const void* a, const void* b) {
+    const prof_row* x = *(const prof_row* const*)a;
+    const prof_row* y = *(const prof_row* const*)b;
+    if (x->ticks != y->ticks)
+        return (x->ticks > y->ticks) ? -1 : 1;
+    return (x->events > y->events) ? -1 : (x->events < y->events) ? 1 : 0;
+    } // End of function prof_cmp.
+
+/*------------------------------------------------------------------------------
+prof_print_rows() prints the rows which have events, in order of decreasing
+handler time.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    prof_print_rows   //
+//----------------------//
+static void prof_print_rows(ostream& os, const char* heading,
+        const prof_row* rows, long n, bool_enum show_pkg,
+        unsigned long long total, double spt) {
+    const prof_row** v = new const prof_row*[n + 1];
+    long k = 0;
+    for (long i = 0; i < n; ++i)
+        if (rows[i].events > 0)
+            v[k++] = &rows[i];
+    qsort(v, k, sizeof(*v), prof_cmp);
+
+    char buf[200];
+    sprintf(buf, "%-20s %-12s %12s %6s %10s %9s\n", heading,
+        show_pkg ? "Package" : "", "Events", "%", "Seconds", "ns/event");
+    os << buf;
+    for (long i = 0; i < k; ++i) {
+        const prof_row& r = *v[i];
+        double sec = r.ticks * spt;
+        sprintf(buf, "%-20.20s %-12.12s %12llu %6.2f %10.4f %9.1f\n",
+            r.name ? r.name : "?",
+            (show_pkg && r.pkgname) ? r.pkgname : "",
+            r.events, total ? 100.0 * r.events / total : 0.0, sec,
+            1e9 * sec / r.events);
+        os << buf;
+        }
+    delete[] v;
+    } // End of function prof_print_rows.
+
+/*------------------------------------------------------------------------------
+sim_profile::start() makes the tables for the classes, message types and
+packages of the model, and starts the clock. The profile covers only the
+packages which are loaded when it is started.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  sim_profile::start  //
+//----------------------//
+int sim_profile::start(model* m) {
+    if (!m)
+        return eNULL_ARGUMENT;
+    mdl = m;
+
+    // The packages.
+    npkgs = m->packages.length();
+    pkgs = new prof_row[npkgs + 1];
+    pkgptrs = new package*[npkgs + 1];
+    pkgbase = new long[npkgs + 1];
+    long i = 0;
+    package* pp = 0;
+    forall(pp, m->packages) {
+        pkgs[i].name = pp->name.read();
+        pkgptrs[i] = pp;
+        pkgbase[i] = -1;
+        i += 1;
+        }
+
+    // The classes, in the order of the representative objects. The classes
+    // of a package have consecutive indices from 0.
+    ncls = m->reps.length() + 1;
+    cls = new prof_row[ncls];
+    i = 0;
+    for (object* po = m->reps.first(); po; po = po->next()) {
+        cls[i].name = po->type();
+        cls[i].pkgname = po->pkg ? po->pkg->name.read() : 0;
+        long p = find_pkg(po->pkg);
+        if (p >= 0 && po->index == 0)
+            pkgbase[p] = i;
+        i += 1;
+        }
+    cls[i].name = "BROADCAST";
+
+    // The message types.
+    nmty = m->cs_mtypenames.length();
+    mty = new prof_row[nmty + 1];
+    for (i = 0; i < nmty; ++i)
+        mty[i].name = m->mtypenames ? m->mtypenames[i] : 0;
+
+    reset();
+    return 0;
+    } // End of function sim_profile::start.
+
+/*------------------------------------------------------------------------------
+sim_profile::reset() clears the statistics and restarts the clock.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  sim_profile::reset  //
+//----------------------//
+void sim_profile::reset() {
+    long i = 0;
+    for (i = 0; i < ncls; ++i)
+        cls[i].clear();
+    for (i = 0; i < nmty; ++i)
+        mty[i].clear();
+    for (i = 0; i < npkgs; ++i)
+        pkgs[i].clear();
+    if (!samples)
+        samples = new prof_sample[prof_max_samples];
+    nsamples = 0;
+    period = prof_sample_period;
+    countdown = 1;
+    fel_max = 0;
+    events = 0;
+    ticks = 0;
+    gettime(wall0);
+    tick0 = prof_ticks();
+    } // End of function sim_profile::reset.
+
+/*------------------------------------------------------------------------------
+sim_profile::find_pkg() returns the row of a package, or -1.
+------------------------------------------------------------------------------*/
+//----------------------//
+// sim_profile::find_pkg//
+//----------------------//
+long sim_profile::find_pkg(package* pp) {
+    if (lastpkg < npkgs && pkgptrs[lastpkg] == pp)
+        return lastpkg;
+    for (long i = 0; i < npkgs; ++i)
+        if (pkgptrs[i] == pp) {
+            lastpkg = i;
+            return i;
+            }
+    return -1;
+    } // End of function sim_profile::find_pkg.
+
+/*------------------------------------------------------------------------------
+sim_profile::record() adds an event to the statistics. The FEL length "fel" is
+its length when the event was dequeued.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  sim_profile::record //
+//----------------------//
+void sim_profile::record(event* pe, unsigned long long dt, double clk,
+        unsigned long fel) {
+    events += 1;
+    ticks += dt;
+
+    // The destination class and the package.
+    object* po = pe->dest ? pe->dest : pe->orig;
+    long p = po ? find_pkg(po->pkg) : -1;
+    if (p >= 0) {
+        pkgs[p].events += 1;
+        pkgs[p].ticks += dt;
+        }
+    long c = -1;
+    if (!pe->dest)
+        c = ncls - 1;
+    else if (p >= 0 && pkgbase[p] >= 0)
+        c = pkgbase[p] + po->index;
+    if (c >= 0 && c < ncls) {
+        cls[c].events += 1;
+        cls[c].ticks += dt;
+        }
+
+    // The message type.
+    if (pe->mty >= 0 && pe->mty < nmty) {
+        mty[pe->mty].events += 1;
+        mty[pe->mty].ticks += dt;
+        }
+
+    // The FEL length.
+    if (fel > fel_max)
+        fel_max = fel;
+    if (--countdown == 0) {
+        if (nsamples >= prof_max_samples) {
+            for (long i = 0; 2 * i < nsamples; ++i)
+                samples[i] = samples[2 * i];
+            nsamples = (nsamples + 1) / 2;
+            period *= 2;
+            }
+        samples[nsamples].t = clk;
+        samples[nsamples].fel = fel;
+        nsamples += 1;
+        countdown = period;
+        }
+    } // End of function sim_profile::record.
+
+/*------------------------------------------------------------------------------
+sim_profile::seconds_per_tick() estimates the length of a tick by comparing the
+counter with the real time which has elapsed since the profile was started.
+------------------------------------------------------------------------------*/
+//------------------------------//
+// sim_profile::seconds_per_tick//
+//------------------------------//
+double sim_profile::seconds_per_tick() const {
+    timeval w0 = wall0;
+    timeval w1;
+    gettime(w1);
+    double dw = timeval_diff(w1, w0);
+    unsigned long long dt = prof_ticks() - tick0;
+    if (dw <= 0 || dt == 0)
+        return 1e-9;
+    return dw / dt;
+    } // End of function sim_profile::seconds_per_tick.
+
+/*------------------------------------------------------------------------------
+sim_profile::print() prints the profile as tables. At most 16 of the samples of
+the FEL length are printed.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  sim_profile::print  //
+//----------------------//
+void sim_profile::print(ostream& os, const char* sysname) const {
+    double spt = seconds_per_tick();
+    timeval w0 = wall0;
+    timeval w1;
+    gettime(w1);
+    char buf[200];
+
+    os << "Profile of system \"" << (sysname ? sysname : "") << "\":\n";
+    sprintf(buf, "    Events simulated:   %llu\n", events);
+    os << buf;
+    sprintf(buf, "    Handler time:       %.4f s of %.4f s elapsed\n",
+        ticks * spt, timeval_diff(w1, w0));
+    os << buf;
+    sprintf(buf, "    Maximum FEL length: %lu\n", fel_max);
+    os << buf;
+    sprintf(buf, "    Events allocated:   %lu (high-water mark)\n",
+        event_high_water());
+    os << buf << NL;
+
+    prof_print_rows(os, "Class", cls, ncls, true, events, spt);
+    os << NL;
+    prof_print_rows(os, "Message type", mty, nmty, false, events, spt);
+    os << NL;
+    prof_print_rows(os, "Package", pkgs, npkgs, false, events, spt);
+    if (nsamples > 0) {
+        os << "\nFEL length (sampled every " << period << " events):\n";
+        long step = (nsamples + 15) / 16;
+        for (long i = 0; i < nsamples; i += step) {
+            sprintf(buf, "    t = %-14g %lu\n", samples[i].t, samples[i].fel);
+            os << buf;
+            }
+        }
+    os << flush;
+    } // End of function sim_profile::print.
+
+//------------------------------//
+//   sim_profile::~sim_profile  //
+//------------------------------//
+sim_profile::~sim_profile() {
+    delete[] cls;
+    delete[] mty;
+    delete[] pkgs;
+    delete[] pkgptrs;
+    delete[] pkgbase;
+    delete[] samples;
+    } // End of function sim_profile::~sim_profile.
+
+/*------------------------------------------------------------------------------
+sim_profile::discard() deletes the profile. If it is called by a handler within
+simulate(), the deletion is deferred until the handler returns.
+------------------------------------------------------------------------------*/
+//------------------------------//
+//     sim_profile::discard     //
+//------------------------------//
+void sim_profile::discard() {
+    if (busy)
+        discarded = true;
+    else
+        delete this;
+    } // End of function sim_profile::discard.
+
+/*------------------------------------------------------------------------------
+systm::set_profiling() starts a new profile of the system, or stops profiling
+and discards the profile. (See prof.h.)
+------------------------------------------------------------------------------*/
+//------------------------------//
+//     systm::set_profiling     //
+//------------------------------//
+int systm::set_profiling(bool_enum on) {
+    if (prof)
+        prof->discard();
+    prof = 0;
+    if (!on)
+        return 0;
+    sim_profile* pp = new sim_profile;
+    int err = pp->start(mdl);
+    if (err < 0) {
+        delete pp;
+        return err;
+        }
+    prof = pp;
+    return 0;
+    } // End of function systm::set_profiling.
+
+//------------------------------//
+//     systm::print_profile     //
+//------------------------------//
+void systm::print_profile(ostream& os) const {
+    if (prof)
+        prof->print(os, name.read());
+    } // End of function systm::print_profile.
@@ -0,0 +1,1091 @@
+// src/aksl/psim.c   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+/*------------------------------------------------------------------------------
+Functions in this file:
+
+pbarrier::
+    wait
+psim_mailbox::
+    resize
+psim_log::
+    resize_rec
+    resize_undo
+psim::
+    psim
+    ~psim
+    assign
+    set_lookahead
+    set_lookahead
+    set_optimistic
+    post
+    cancelled
+    partition
+    unpartition
+    execute
+    run_lp
+    rollback
+    rollback_after
+    annihilate
+    precedes
+    committed
+    fossil_collect
+    run_lp_optimistic
+    thread_main
+    simulate
+systm::
+    par_enqueue
+    par_cancelled
+------------------------------------------------------------------------------*/
+
+#include "aksl/psim.h"
+#ifndef AKSL_ERROR_H
+#include "aksl/error.h"
+#endif
+#ifndef AKSL_BMEM_H
+#include "aksl/bmem.h"
+#endif
+
+// System header files.
+#ifndef AKSL_X_PTHREAD_H
+#define AKSL_X_PTHREAD_H
+#include <pthread.h>
+#endif
+#ifndef AKSL_X_SCHED_H
+#define AKSL_X_SCHED_H
+#include <sched.h>
+#endif
+#ifndef AKSL_X_MATH_H
+#define AKSL_X_MATH_H
+#include <math.h>
+#endif
+#ifndef AKSL_X_STDLIB_H
+#define AKSL_X_STDLIB_H
+#include <stdlib.h>
+#endif
+
+// Number of spins in pbarrier::wait() before yielding the CPU.
+static const long pbarrier_spins = 1000;
+
+// The argument of psim::thread_main().
+struct psim_thread {
+    psim* ps;
+    int lp;
+    volatile int* go;   // 0 = wait, 1 = run, -1 = abandon.
+    };
+
+/*------------------------------------------------------------------------------
+The last thread to arrive resets the count and then flips the shared sense.
+The other threads wait until the shared sense equals their own new sense.
+The __sync built-in functions are full memory barriers, so all writes made
+before the barrier are visible to all threads after the barrier.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    pbarrier::wait    //
+//----------------------//
+void pbarrier::wait(int& local_sense) {
+    local_sense = !local_sense;
+    if (__sync_add_and_fetch(&count, 1) == nthreads) {
+        count = 0;
+        __sync_synchronize();
+        sense = local_sense;
+        }
+    else {
+        long spins = 0;
+        while (sense != local_sense) {
+            if (++spins >= pbarrier_spins) {
+                sched_yield();
+                spins = 0;
+                }
+            }
+        }
+    __sync_synchronize();
+    } // End of function pbarrier::wait.
+
+//--------------------------//
+//  psim_mailbox::resize    //
+//--------------------------//
+void psim_mailbox::resize() {
+    unsigned int newsize = (size > 0) ? 2 * size : 64;
+    event** v2 = new event*[newsize];
+    for (unsigned int i = 0; i < n; ++i)
+        v2[i] = v[i];
+    delete[] v;
+    v = v2;
+    size = newsize;
+    } // End of function psim_mailbox::resize.
+
+//--------------------------//
+//   psim_log::resize_rec   //
+//--------------------------//
+void psim_log::resize_rec() {
+    unsigned int newsize = (rec_size > 0) ? 2 * rec_size : 256;
+    psim_record* v2 = new psim_record[newsize];
+    for (unsigned int i = 0; i < nrec; ++i)
+        v2[i] = rec[i];
+    delete[] rec;
+    rec = v2;
+    rec_size = newsize;
+    } // End of function psim_log::resize_rec.
+
+//--------------------------//
+//   psim_log::resize_undo  //
+//--------------------------//
+void psim_log::resize_undo() {
+    unsigned int newsize = (undo_size > 0) ? 2 * undo_size : 512;
+    psim_undo* v2 = new psim_undo[newsize];
+    for (unsigned int i = 0; i < nundo; ++i)
+        v2[i] = undo[i];
+    delete[] undo;
+    undo = v2;
+    undo_size = newsize;
+    } // End of function psim_log::resize_undo.
+
+/*------------------------------------------------------------------------------
+The number of LPs is fixed when the psim is constructed. The objects of the
+system are not partitioned until simulate() is called.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      psim::psim      //
+//----------------------//
+psim::psim(systm& s, int n) {
+    sys = &s;
+    nlp = (n >= 1) ? n : 1;
+    lps = 0;
+    la = new double[nlp * nlp];
+    lac = new double[nlp * nlp];
+    mbox = new psim_mailbox[nlp * nlp];
+    tnext = new double[nlp];
+    knext = new unsigned long long[nlp];
+    snext = new unsigned long long[nlp];
+    ordered = false;
+    status = new int[nlp];
+    lperr = new int[nlp];
+    lpposted = new unsigned long[nlp];
+    finish = 0;
+    running = false;
+    barrier = new pbarrier(nlp);
+
+    links = 0;
+    nlinks = 0;
+    links_size = 0;
+    assignments = 0;
+    nassignments = 0;
+    assignments_size = 0;
+    default_la = 0;
+    nrounds = 0;
+    nposted = 0;
+
+    optimistic = false;
+    window = 0;
+    batch = psim_default_batch;
+    logs = new psim_log[nlp];
+    anti = new psim_mailbox[2 * nlp * nlp];
+    errtime = new double[nlp];
+    terr = new double[nlp];
+    errobj = new object*[nlp];
+    tanti = new double[nlp];
+    panti = new double[nlp];
+    lprolled = new unsigned long[nlp];
+    nrolled = 0;
+    } // End of function psim::psim.
+
+//----------------------//
+//      psim::~psim     //
+//----------------------//
+psim::~psim() {
+    delete[] la;
+    delete[] lac;
+    delete[] mbox;
+    delete[] tnext;
+    delete[] knext;
+    delete[] snext;
+    delete[] status;
+    delete[] lperr;
+    delete[] lpposted;
+    delete barrier;
+    delete[] links;
+    delete[] assignments;
+    delete[] logs;
+    delete[] anti;
+    delete[] errtime;
+    delete[] terr;
+    delete[] errobj;
+    delete[] tanti;
+    delete[] panti;
+    delete[] lprolled;
+    } // End of function psim::~psim.
+
+/*------------------------------------------------------------------------------
+psim::assign() assigns an object to a given LP. Objects which are not assigned
+are divided among the LPs in contiguous blocks, in the order of the object list.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     psim::assign     //
+//----------------------//
+int psim::assign(object* po, int k) {
+    if (!po)
+        return eNULL_ARGUMENT;
+    if (k < 0 || k >= nlp)
+        return eBAD_ARGUMENT;
+    if (nassignments >= assignments_size) {
+        int newsize = (assignments_size > 0) ? 2 * assignments_size : 64;
+        psim_assignment* pa = new psim_assignment[newsize];
+        for (int i = 0; i < nassignments; ++i)
+            pa[i] = assignments[i];
+        delete[] assignments;
+        assignments = pa;
+        assignments_size = newsize;
+        }
+    assignments[nassignments].po = po;
+    assignments[nassignments].lp = k;
+    nassignments += 1;
+    return 0;
+    } // End of function psim::assign.
+
+/*------------------------------------------------------------------------------
+psim::set_lookahead() declares that all messages from "from" to "to" have a
+delay of at least "d", which must be positive.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   psim::set_lookahead    //
+//--------------------------//
+int psim::set_lookahead(object* from, object* to, double d) {
+    if (!from || !to)
+        return eNULL_ARGUMENT;
+    if (!(d > 0))
+        return eBAD_ARGUMENT;
+    if (nlinks >= links_size) {
+        int newsize = (links_size > 0) ? 2 * links_size : 64;
+        psim_link* pl = new psim_link[newsize];
+        for (int i = 0; i < nlinks; ++i)
+            pl[i] = links[i];
+        delete[] links;
+        links = pl;
+        links_size = newsize;
+        }
+    links[nlinks].from = from;
+    links[nlinks].to = to;
+    links[nlinks].lookahead = d;
+    nlinks += 1;
+    return 0;
+    } // End of function psim::set_lookahead.
+
+/*------------------------------------------------------------------------------
+This version of psim::set_lookahead() declares that all messages between
+objects in different LPs have a delay of at least "d", which must be positive.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   psim::set_lookahead    //
+//--------------------------//
+int psim::set_lookahead(double d) {
+    if (!(d > 0))
+        return eBAD_ARGUMENT;
+    default_la = d;
+    return 0;
+    } // End of function psim::set_lookahead.
+
+/*------------------------------------------------------------------------------
+psim::set_optimistic() selects Time Warp execution. Speculative execution is
+limited to events before the GVT plus "w", unless "w" is zero. Each LP executes
+at most "b" events between rounds of message exchange and fossil collection.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   psim::set_optimistic   //
+//--------------------------//
+int psim::set_optimistic(double w, unsigned int b) {
+    if (w < 0 || b == 0)
+        return eBAD_ARGUMENT;
+    optimistic = true;
+    window = w;
+    batch = b;
+    return 0;
+    } // End of function psim::set_optimistic.
+
+/*------------------------------------------------------------------------------
+psim::post() is called by systm::newevent_abs() (via par_enqueue()) for each
+new event of an LP. Events for objects in the same LP are inserted in the FEL of
+the LP. Events for other LPs are checked against the lookahead and appended to
+the mailbox of the sending LP. A broadcast event is inserted locally, and a
+copy of it (with the same argument) is sent to every other LP.
+In optimistic mode, there is no lookahead check, and each event is recorded in
+the undo log of the sending LP, so that it can be retracted.
+During initialisation, all events are inserted directly into the FELs, because
+the objects are initialised by a single thread.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      psim::post      //
+//----------------------//
+void psim::post(systm* from, event* pe) {
+    int i = from->lp;
+    int j = i;
+    if (pe->dest && pe->dest->sys && pe->dest->sys->par == this)
+        j = pe->dest->sys->lp;
+
+    if (!running) {
+        lps[j]->events.insert(pe);
+        if (!pe->dest)
+            for (int k = 0; k < nlp; ++k) {
+                if (k == i)
+                    continue;
+                event* pc = new event(pe->t, pe->orig, 0, pe->mty);
+                pc->arg = pe->arg;
+                pc->copy_order(pe);
+                lps[k]->events.insert(pc);
+                }
+        return;
+        }
+    if (pe->dest) {
+        if (optimistic)
+            logs[i].add_undo(undoSENT, j, pe, 0, 0);
+        if (j == i) {
+            from->events.insert(pe);
+            return;
+            }
+        if (!optimistic && pe->t < from->clck + la[i*nlp + j]) {
+            if (lperr[i] == 0)
+                cout << "Warning: lookahead violation by "
+                     << pe->orig->name << DOTNL;
+            lperr[i] = eLOOKAHEAD_VIOLATION;
+            }
+        mbox[i*nlp + j].append(pe);
+        return;
+        }
+
+    // Broadcast event.
+    from->events.insert(pe);
+    if (optimistic)
+        logs[i].add_undo(undoSENT, i, pe, 0, 0);
+    for (int k = 0; k < nlp; ++k) {
+        if (k == i)
+            continue;
+        if (!optimistic && pe->t < from->clck + la[i*nlp + k]) {
+            if (lperr[i] == 0)
+                cout << "Warning: lookahead violation by broadcast from "
+                     << pe->orig->name << DOTNL;
+            lperr[i] = eLOOKAHEAD_VIOLATION;
+            }
+        event* pc = new event(pe->t, pe->orig, 0, pe->mty);
+        pc->arg = pe->arg;
+        pc->copy_order(pe);
+        mbox[i*nlp + k].append(pc);
+        if (optimistic)
+            logs[i].add_undo(undoSENT, k, pc, 0, 0);
+        }
+    } // End of function psim::post.
+
+/*------------------------------------------------------------------------------
+psim::cancelled() is called by systm::cancel_message() (via par_cancelled())
+for an event which has been removed from the FEL of an LP. In optimistic mode,
+the event is kept in the undo log, so that it can be re-inserted.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    psim::cancelled   //
+//----------------------//
+void psim::cancelled(systm* from, event* pe) {
+    if (running && optimistic)
+        logs[from->lp].add_undo(undoCANCEL, from->lp, pe, 0, 0);
+    else
+        delete pe;
+    } // End of function psim::cancelled.
+
+//--------------------------//
+//    psim_assignment_cmp   //
+//--------------------------//
+static int psim_assignment_cmp(const void* a, const void* b) {
+    object* pa = ((const psim_assignment*)a)->po;
+    object* pb = ((const psim_assignment*)b)->po;
+    return (pa < pb) ? -1 : (pa > pb) ? 1 : 0;
+    } // End of function psim_assignment_cmp.
+
+/*------------------------------------------------------------------------------
+psim::partition() creates a systm for each LP, moves the objects of the system
+into the LPs, and computes the lookahead matrix of the LPs. The closure "lac"
+of the matrix is computed with the Floyd-Warshall algorithm. Its diagonal is
+the shortest cycle through each LP.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    psim::partition   //
+//----------------------//
+void psim::partition() {
+    lps = new systm*[nlp];
+    for (int k = 0; k < nlp; ++k) {
+        systm* s = new systm(*sys->mdl);
+        s->name = sys->name;
+        s->par = this;
+        s->parent = sys;
+        s->lp = k;
+        s->clck = sys->clck;
+        s->set_fel(sys->fel_type());
+        if (sys->fel_hint > 0)
+            s->events.reserve(sys->fel_hint / nlp + 1);
+        lps[k] = s;
+        }
+
+    // Sort the explicit assignments so that they can be looked up.
+    if (nassignments > 1)
+        qsort(assignments, nassignments, sizeof(psim_assignment),
+              psim_assignment_cmp);
+
+    // Move the objects into the LPs.
+    long nobj = sys->objects.length();
+    long idx = 0;
+    object* po = 0;
+    while ((po = sys->objects.popfirst()) != 0) {
+        int k = int((idx * nlp) / nobj);
+        psim_assignment key;
+        key.po = po;
+        psim_assignment* pa = (nassignments > 0) ?
+            (psim_assignment*)bsearch(&key, assignments, nassignments,
+                sizeof(psim_assignment), psim_assignment_cmp) : 0;
+        if (pa)
+            k = pa->lp;
+        lps[k]->objects.append(po);
+        po->sys = lps[k];
+        idx += 1;
+        }
+    for (int k = 0; k < nlp; ++k)
+        lps[k]->clear_subscriptions();
+
+    // Compute the lookahead matrix.
+    for (int i = 0; i < nlp; ++i)
+        for (int j = 0; j < nlp; ++j)
+            la[i*nlp + j] = (i != j && default_la > 0) ? default_la : HUGE_VAL;
+    for (int l = 0; l < nlinks; ++l) {
+        object* pf = links[l].from;
+        object* pt = links[l].to;
+        if (!pf->sys || pf->sys->par != this
+            || !pt->sys || pt->sys->par != this)
+            continue;
+        int i = pf->sys->lp;
+        int j = pt->sys->lp;
+        if (i != j && links[l].lookahead < la[i*nlp + j])
+            la[i*nlp + j] = links[l].lookahead;
+        }
+    for (int i = 0; i < nlp * nlp; ++i)
+        lac[i] = la[i];
+    for (int m = 0; m < nlp; ++m)
+        for (int i = 0; i < nlp; ++i)
+            for (int j = 0; j < nlp; ++j)
+                if (lac[i*nlp + m] + lac[m*nlp + j] < lac[i*nlp + j])
+                    lac[i*nlp + j] = lac[i*nlp + m] + lac[m*nlp + j];
+    } // End of function psim::partition.
+
+/*------------------------------------------------------------------------------
+psim::unpartition() deletes any remaining events, moves the objects back into
+the system and deletes the LPs. Objects which were explicitly assigned to LPs
+may be returned in a different order.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   psim::unpartition  //
+//----------------------//
+void psim::unpartition() {
+    // The anti-messages point to events which are deleted below.
+    for (int i = 0; i < 2 * nlp * nlp; ++i)
+        anti[i].clear();
+    for (int i = 0; i < nlp * nlp; ++i) {
+        for (unsigned int m = 0; m < mbox[i].n; ++m)
+            delete mbox[i].v[m];
+        mbox[i].clear();
+        }
+    for (int k = 0; k < nlp; ++k) {
+        systm* s = lps[k];
+        fossil_collect(k, HUGE_VAL, true);
+        s->events.clear();
+        object* po = 0;
+        while ((po = s->objects.popfirst()) != 0) {
+            sys->objects.append(po);
+            po->sys = sys;
+            }
+        delete s;
+        }
+    delete[] lps;
+    lps = 0;
+    } // End of function psim::unpartition.
+
+/*------------------------------------------------------------------------------
+psim::execute() delivers an event to its destination in LP k, or to all objects
+in LP k except the origin if it is a broadcast event. It returns the object
+which reported an error, if any, as for event::simulate().
+------------------------------------------------------------------------------*/
+//----------------------//
+//     psim::execute    //
+//----------------------//
+object* psim::execute(int k, event* evt) {
+    if (evt->dest)
+        return (evt->dest->sim(evt->orig, evt->mty, evt->arg) < 0) ?
+            evt->dest : 0;
+    return lps[k]->broadcast(evt->orig, evt->mty, evt->arg);
+    } // End of function psim::execute.
+
+/*------------------------------------------------------------------------------
+psim::run_lp() is the main loop of LP number k. Each round has two phases,
+separated by barriers.
+(1) The events in the mailboxes for this LP are moved into its FEL, and the time
+    of its first event is published.
+(2) Every event with time less than the bound of this LP is executed. The bound
+    is the least time at which any LP, including this one, could cause a
+    message to be sent to this LP, along any path of links.
+All LPs see the same published times, so they all stop in the same round.
+An event which is earlier than the clock of the LP is an error, because it
+shows that the lookaheads were not respected.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     psim::run_lp     //
+//----------------------//
+int psim::run_lp(int k) {
+    if (optimistic)
+        return run_lp_optimistic(k);
+    systm* s = lps[k];
+    int sense = 0;
+
+    for (;;) {
+        for (int i = 0; i < nlp; ++i) {
+            psim_mailbox& mb = mbox[i*nlp + k];
+            if (mb.n > 0) {
+                lpposted[k] += mb.n;
+                s->events.insert_many(mb.v, mb.n);
+                mb.clear();
+                }
+            }
+        const event* pf = s->events.first();
+        tnext[k] = pf ? pf->time() : HUGE_VAL;
+        status[k] = lperr[k];
+        barrier->wait(sense);
+
+        // All LPs take the same decision here.
+        double tmin = HUGE_VAL;
+        int err = 0;
+        for (int i = 0; i < nlp; ++i) {
+            if (tnext[i] < tmin)
+                tmin = tnext[i];
+            if (status[i] != 0 && err == 0)
+                err = status[i];
+            }
+        if (err != 0 || tmin >= finish)
+            break;
+        if (k == 0)
+            nrounds += 1;
+
+        double bound = finish;
+        for (int i = 0; i < nlp; ++i)
+            if (tnext[i] + lac[i*nlp + k] < bound)
+                bound = tnext[i] + lac[i*nlp + k];
+
+        while (lperr[k] == 0) {
+            pf = s->events.first();
+            if (!pf || pf->time() >= bound)
+                break;
+            event* evt = s->events.popfirst();
+            if (evt->t < s->clck) {
+                cout << "Causality error: event at time " << evt->t
+                     << " received after time " << s->clck << DOTNL;
+                lperr[k] = eCAUSALITY_ERROR;
+                delete evt;
+                break;
+                }
+            if (evt->orig) {
+                s->clck = evt->t;
+                s->depth = evt->depth;
+                object* perr = execute(k, evt);
+                if (perr) {
+                    cout << "Termination condition received from the "
+                         << perr->type();
+                    cout << " called " << perr->name << DOTNL;
+                    lperr[k] = (perr->error < 0) ? perr->error : eEVENT_ERROR;
+                    }
+                }
+            delete evt;
+            }
+        barrier->wait(sense);
+        }
+    return lperr[k];
+    } // End of function psim::run_lp.
+
+/*------------------------------------------------------------------------------
+psim::rollback() undoes the executed events of LP k from record p onwards, in
+reverse order. The saved object states are restored, the events sent by the
+undone events are retracted, and the events cancelled by them are re-inserted.
+The send counter of the origin of each retracted event is set back to the
+sequence number of the event, so that the re-executed events are sent with the
+same sequence numbers as before. (See event.)
+Events sent to other LPs are retracted by appending anti-messages to the anti
+mailboxes of round parity r, and the least time of these events is noted for
+the GVT. The undone events are re-inserted into the FEL.
+If the LP has an error, the erroneous event is the last record, so the error is
+undone too.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    psim::rollback    //
+//----------------------//
+void psim::rollback(int k, unsigned int p, int r) {
+    psim_log& lg = logs[k];
+    if (p >= lg.nrec)
+        return;
+    systm* s = lps[k];
+    psim_mailbox* outbox = anti + r * nlp * nlp + k * nlp;
+    lprolled[k] += lg.nrec - p;
+    while (lg.nrec > p) {
+        psim_record& rc = lg.rec[lg.nrec - 1];
+        while (lg.nundo > rc.undo0) {
+            psim_undo& u = lg.undo[--lg.nundo];
+            switch (u.kind) {
+            case undoSTATE:
+                if (u.state)
+                    u.po->restore_state(u.state);
+                break;
+            case undoSENT:
+                if (u.pe->orig)
+                    u.pe->orig->nsent = u.pe->seq;
+                if (u.lp != k) {
+                    outbox[u.lp].append(u.pe);
+                    if (u.pe->t < tanti[k])
+                        tanti[k] = u.pe->t;
+                    }
+                else if (s->events.remove(u.pe, u.pe->orig))
+                    delete u.pe;
+                break;
+            case undoCANCEL:
+                s->events.insert(u.pe);
+                break;
+                }
+            }
+        s->events.insert(rc.pe);
+        lg.nrec -= 1;
+        }
+    s->clck = (lg.nrec > 0) ? lg.rec[lg.nrec - 1].pe->t : lg.tcommit;
+    lperr[k] = 0;
+    errtime[k] = HUGE_VAL;
+    } // End of function psim::rollback.
+
+/*------------------------------------------------------------------------------
+psim::rollback_after() undoes the executed events of LP k which do not precede
+the straggler pe. (See precedes().)
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   psim::rollback_after   //
+//--------------------------//
+void psim::rollback_after(int k, const event* pe, int r) {
+    psim_log& lg = logs[k];
+    unsigned int p = lg.nrec;
+    while (p > 0 && !precedes(lg.rec[p - 1].pe, pe))
+        --p;
+    rollback(k, p, r);
+    } // End of function psim::rollback_after.
+
+/*------------------------------------------------------------------------------
+psim::annihilate() handles an anti-message for event pe in LP k. If the event
+has not been executed, it is just removed from the FEL. Otherwise, the LP is
+rolled back to just before the event, and then it is removed.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   psim::annihilate   //
+//----------------------//
+void psim::annihilate(int k, event* pe, int r) {
+    systm* s = lps[k];
+    if (s->events.remove(pe, pe->orig)) {
+        delete pe;
+        return;
+        }
+    psim_log& lg = logs[k];
+    for (unsigned int p = lg.nrec; p > 0; --p)
+        if (lg.rec[p - 1].pe == pe) {
+            rollback(k, p - 1, r);
+            if (s->events.remove(pe, pe->orig))
+                delete pe;
+            return;
+            }
+    } // End of function psim::annihilate.
+
+/*------------------------------------------------------------------------------
+psim::precedes() returns true if an executed event "pe" does not need to be
+rolled back for the straggler "ps". An event at the same time as the straggler
+is only rolled back if the FEL is ordered and the straggler precedes it.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    psim::precedes    //
+//----------------------//
+bool_enum psim::precedes(const event* pe, const event* ps) const {
+    if (pe->t != ps->t)
+        return bool_enum(pe->t < ps->t);
+    if (!ordered)
+        return true;
+    ord_entry a, b;
+    pe->get_order(a);
+    ps->get_order(b);
+    return bool_enum(a.less(b));
+    } // End of function psim::precedes.
+
+/*------------------------------------------------------------------------------
+psim::committed() returns true if the executed event "pe" may be committed for
+the GVT "gvt". This is true if it is before the GVT, or if it is at the GVT and
+"incl" is true. For the ordered FEL, "nb" is the least unprocessed event at the
+GVT of all LPs, and an event at the GVT must also precede it.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    psim::committed   //
+//----------------------//
+bool_enum psim::committed(const event* pe, double gvt, bool_enum incl,
+        const ord_entry* nb) const {
+    if (pe->t != gvt)
+        return bool_enum(pe->t < gvt);
+    if (!incl)
+        return false;
+    if (!nb)
+        return true;
+    ord_entry a;
+    pe->get_order(a);
+    return bool_enum(a.less(*nb));
+    } // End of function psim::committed.
+
+/*------------------------------------------------------------------------------
+psim::fossil_collect() commits the executed events of LP k before time gvt, or
+at or before time gvt if "incl" is true. (See committed().) Their saved states
+and cancelled events are discarded, and the events are deleted. The remaining
+records are moved to the front of the log.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   psim::fossil_collect   //
+//--------------------------//
+void psim::fossil_collect(int k, double gvt, bool_enum incl,
+        const ord_entry* nb) {
+    psim_log& lg = logs[k];
+    unsigned int c = 0;
+    while (c < lg.nrec && committed(lg.rec[c].pe, gvt, incl, nb))
+        ++c;
+    if (c == 0)
+        return;
+    unsigned int u0 = (c < lg.nrec) ? lg.rec[c].undo0 : lg.nundo;
+    for (unsigned int u = 0; u < u0; ++u) {
+        psim_undo& pu = lg.undo[u];
+        if (pu.kind == undoSTATE && pu.state)
+            pu.po->discard_state(pu.state);
+        else if (pu.kind == undoCANCEL)
+            delete pu.pe;
+        }
+    lg.tcommit = lg.rec[c - 1].pe->t;
+    for (unsigned int i = 0; i < c; ++i)
+        delete lg.rec[i].pe;
+    for (unsigned int i = c; i < lg.nrec; ++i) {
+        lg.rec[i - c].pe = lg.rec[i].pe;
+        lg.rec[i - c].undo0 = lg.rec[i].undo0 - u0;
+        }
+    lg.nrec -= c;
+    for (unsigned int u = u0; u < lg.nundo; ++u)
+        lg.undo[u - u0] = lg.undo[u];
+    lg.nundo -= u0;
+    } // End of function psim::fossil_collect.
+
+/*------------------------------------------------------------------------------
+psim::run_lp_optimistic() is the main loop of LP number k for Time Warp. Each
+round has two phases, separated by barriers.
+(1) The anti-messages of the previous round are handled. Then the events in the
+    mailboxes for this LP are moved into its FEL, after rolling back the LP if
+    any of them are stragglers. The time of the first event of the LP is
+    published. (Anti-messages sent in this phase are handled in the next round,
+    because the other LPs are reading the mailboxes of the previous round.)
+(2) The GVT is computed, and fossil collection is done. Then up to "batch"
+    events before the finish time (and the GVT plus "window") are executed.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//  psim::run_lp_optimistic //
+//--------------------------//
+int psim::run_lp_optimistic(int k) {
+    systm* s = lps[k];
+    psim_log& lg = logs[k];
+    int sense = 0;
+    int r = 0;      // Parity of the round number.
+
+    for (;;) {
+        tanti[k] = HUGE_VAL;
+        for (int i = 0; i < nlp; ++i) {
+            psim_mailbox& ab = anti[(1 - r) * nlp * nlp + i*nlp + k];
+            for (unsigned int m = 0; m < ab.n; ++m)
+                annihilate(k, ab.v[m], r);
+            ab.clear();
+            }
+        const event* pmin = 0;      // The least straggler.
+        for (int i = 0; i < nlp; ++i) {
+            psim_mailbox& mb = mbox[i*nlp + k];
+            for (unsigned int m = 0; m < mb.n; ++m)
+                if (!pmin || !precedes(pmin, mb.v[m]))
+                    pmin = mb.v[m];
+            }
+        if (pmin && lg.nrec > 0 && !precedes(lg.rec[lg.nrec - 1].pe, pmin))
+            rollback_after(k, pmin, r);
+        for (int i = 0; i < nlp; ++i) {
+            psim_mailbox& mb = mbox[i*nlp + k];
+            if (mb.n > 0) {
+                lpposted[k] += mb.n;
+                s->events.insert_many(mb.v, mb.n);
+                mb.clear();
+                }
+            }
+        const event* pf = s->events.first();
+        tnext[k] = pf ? pf->time() : HUGE_VAL;
+        if (ordered && pf) {
+            knext[k] = pf->order_key();
+            snext[k] = pf->seq;
+            }
+        if (lperr[k] != 0 && errtime[k] <= tnext[k]) {
+            tnext[k] = errtime[k];
+            knext[k] = 0;
+            snext[k] = 0;
+            }
+        status[k] = lperr[k];
+        terr[k] = errtime[k];
+        panti[k] = tanti[k];
+        barrier->wait(sense);
+
+        // All LPs take the same decision here.
+        double gvt = HUGE_VAL;
+        double ta = HUGE_VAL;
+        for (int i = 0; i < nlp; ++i) {
+            if (tnext[i] < gvt)
+                gvt = tnext[i];
+            if (panti[i] < ta)
+                ta = panti[i];
+            }
+        bool_enum incl = bool_enum(ta > gvt);
+        if (ta < gvt)
+            gvt = ta;
+        ord_entry nb;               // The least next event at the GVT.
+        nb.t = gvt;
+        nb.key = ~0ULL;
+        nb.seq = ~0ULL;
+        nb.p = 0;
+        for (int i = 0; ordered && i < nlp; ++i)
+            if (tnext[i] == gvt && (knext[i] < nb.key
+                                    || (knext[i] == nb.key
+                                        && snext[i] < nb.seq))) {
+                nb.key = knext[i];
+                nb.seq = snext[i];
+                }
+        int err = 0;
+        for (int i = 0; i < nlp; ++i)
+            if (status[i] != 0 && err == 0
+                && (terr[i] < gvt || (incl && terr[i] == gvt)))
+                err = status[i];
+        if (err != 0 || gvt >= finish) {
+            // Undo the events which are not committed, and commit the rest.
+            unsigned int p = lg.nrec;
+            while (p > 0 && !committed(lg.rec[p - 1].pe, gvt, incl,
+                                       ordered ? &nb : 0))
+                --p;
+            rollback(k, p, r);
+            fossil_collect(k, HUGE_VAL, true);
+            if (lperr[k] != 0) {
+                cout << "Termination condition received from the "
+                     << errobj[k]->type();
+                cout << " called " << errobj[k]->name << DOTNL;
+                }
+            break;
+            }
+        if (k == 0)
+            nrounds += 1;
+        fossil_collect(k, gvt, incl, ordered ? &nb : 0);
+
+        double bound = finish;
+        if (window > 0 && gvt + window < bound)
+            bound = gvt + window;
+        unsigned int n = 0;
+        while (lperr[k] == 0 && n < batch) {
+            pf = s->events.first();
+            if (!pf || pf->time() >= bound)
+                break;
+            event* evt = s->events.popfirst();
+            n += 1;
+            if (!evt->orig) {
+                delete evt;
+                continue;
+                }
+            lg.add_record(evt);
+            if (evt->dest)
+                lg.add_undo(undoSTATE, k, 0, evt->dest,
+                            evt->dest->save_state());
+            else {
+                object* po = 0;
+                forall(po, s->objects)
+                    if (po != evt->orig)
+                        lg.add_undo(undoSTATE, k, 0, po, po->save_state());
+                }
+            s->clck = evt->t;
+            s->depth = evt->depth;
+            object* perr = execute(k, evt);
+            if (perr) {
+                lperr[k] = (perr->error < 0) ? perr->error : eEVENT_ERROR;
+                errtime[k] = evt->t;
+                errobj[k] = perr;
+                }
+            }
+        barrier->wait(sense);
+        r = 1 - r;
+        }
+    return lperr[k];
+    } // End of function psim::run_lp_optimistic.
+
+//----------------------//
+//   psim::thread_main  //
+//----------------------//
+void* psim::thread_main(void* arg) {
+    psim_thread* pt = (psim_thread*)arg;
+    while (*pt->go == 0)
+        sched_yield();
+    __sync_synchronize();
+    if (*pt->go > 0)
+        pt->ps->run_lp(pt->lp);
+    bmem_thread_flush();
+    return 0;
+    } // End of function psim::thread_main.
+
+/*------------------------------------------------------------------------------
+psim::simulate() is the parallel version of systm::simulate(). The packages and
+objects are initialised by the calling thread. Then each LP is run by its own
+thread, the calling thread running LP 0. Events at or after the finish time are
+not executed. On return, all objects are back in the system, and the clock of
+the system is the latest clock of the LPs.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    psim::simulate    //
+//----------------------//
+int psim::simulate(double duration, double start) {
+    int err = 0;
+
+    if (duration <= 0) {
+        cout << "Terminating simulation due to non-positive duration.\n";
+        return eNEGATIVE_DURATION;
+        }
+    if (sys->objects.empty()) {
+        cout << "Terminating simulation due to lack of objects.\n";
+        return eNO_OBJECTS;
+        }
+    sys->events.clear();
+    sys->clck = start;
+    finish = start + duration;
+    nrounds = 0;
+    nposted = 0;
+    nrolled = 0;
+    for (int k = 0; k < nlp; ++k) {
+        lperr[k] = 0;
+        lpposted[k] = lprolled[k] = 0;
+        errtime[k] = HUGE_VAL;
+        errobj[k] = 0;
+        logs[k].tcommit = start;
+        }
+    partition();
+
+    // Initialise all packages and objects, in the calling thread.
+    running = false;
+    for (int k = 0; k < nlp; ++k)
+        lps[k]->events.defer();
+    package* pp = 0;
+    forall(pp, sys->mdl->packages)
+        if (pp->init)
+            (*pp->init)(pp);
+    for (int k = 0; k < nlp && err >= 0; ++k) {
+        object* po = 0;
+        forall(po, lps[k]->objects)
+            if ((err = po->init()) < 0)
+                break;
+        }
+    for (int k = 0; k < nlp; ++k)
+        lps[k]->events.flush();
+    if (err < 0) {
+        unpartition();
+        return err;
+        }
+
+    // Run the LPs.
+    ordered = bool_enum(sys->fel_type() == felORDERED);
+    running = true;
+    bmem_threaded = 1;
+    psim_thread* pts = new psim_thread[nlp];
+    pthread_t* tids = new pthread_t[nlp];
+    volatile int go = 0;
+    int nstarted = 1;
+    for (int k = 1; k < nlp; ++k) {
+        pts[k].ps = this;
+        pts[k].lp = k;
+        pts[k].go = &go;
+        if (pthread_create(&tids[k], 0, thread_main, &pts[k]) != 0)
+            break;
+        nstarted += 1;
+        }
+    __sync_synchronize();
+    if (nstarted < nlp) {
+        cout << "Terminating simulation due to thread creation failure.\n";
+        go = -1;
+        err = eTHREAD_FAILED;
+        }
+    else {
+        go = 1;
+        run_lp(0);
+        }
+    for (int k = 1; k < nstarted; ++k)
+        pthread_join(tids[k], 0);
+    bmem_thread_flush();
+    bmem_threaded = 0;
+    running = false;
+    delete[] pts;
+    delete[] tids;
+
+    // Find the first error, the final clock and the number of posted events.
+    double tmin = HUGE_VAL;
+    for (int k = 0; k < nlp; ++k) {
+        if (lperr[k] < 0 && err >= 0)
+            err = lperr[k];
+        if (lps[k]->clck > sys->clck)
+            sys->clck = lps[k]->clck;
+        if (tnext[k] < tmin)
+            tmin = tnext[k];
+        }
+    for (int k = 0; k < nlp; ++k) {
+        nposted += lpposted[k];
+        nrolled += lprolled[k];
+        }
+    unpartition();
+    if (err < 0)
+        return err;
+    if (tmin == HUGE_VAL) {
+        cout << "Simulation ending with exhaustion of events.\n";
+        return eNO_EVENTS;
+        }
+
+    // Terminate all objects and packages.
+    object* po = 0;
+    forall(po, sys->objects)
+        po->term();
+    forall(pp, sys->mdl->packages)
+        if (pp->term)
+            (*pp->term)(pp);
+
+    // Delete all objects and packages.
+    forall(po, sys->objects)
+        po->del();
+    forall(pp, sys->mdl->packages)
+        if (pp->del)
+            (*pp->del)(pp);
+
+    return 0;
+    } // End of function psim::simulate.
+
+/*------------------------------------------------------------------------------
+systm::par_enqueue() is called instead of event_heap::insert() for the systm of
+an LP of a parallel simulation.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  systm::par_enqueue  //
+//----------------------//
+void systm::par_enqueue(event* pe) {
+    par->post(this, pe);
+    } // End of function systm::par_enqueue.
+
+//--------------------------//
+//   systm::par_cancelled   //
+//--------------------------//
+void systm::par_cancelled(event* pe) {
+    par->cancelled(this, pe);
+    } // End of function systm::par_cancelled.
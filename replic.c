@@ -0,0 +1,417 @@
+// src/aksl/replic.c   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+/*------------------------------------------------------------------------------
+Functions in this file:
+
+normal_quantile
+t_quantile
+replicator::
+    replicator
+    ~replicator
+    read
+    add_stat
+    set
+    replicate
+    thread_main
+    run
+    n
+    mean
+    stddev
+    halfwidth
+    print
+------------------------------------------------------------------------------*/
+
+#include "aksl/replic.h"
+#ifndef AKSL_ORALAKSL_H
+#include "aksl/oralaksl.h"
+#endif
+#ifndef AKSL_RNDM_H
+#include "aksl/rndm.h"
+#endif
+#ifndef AKSL_BMEM_H
+#include "aksl/bmem.h"
+#endif
+#ifndef AKSL_ERROR_H
+#include "aksl/error.h"
+#endif
+#ifndef AKSL_NEWSTR_H
+#include "aksl/newstr.h"
+#endif
+
+// System header files.
+#ifndef AKSL_X_PTHREAD_H
+#define AKSL_X_PTHREAD_H
+#include <pthread.h>
+#endif
+#ifndef AKSL_X_MATH_H
+#define AKSL_X_MATH_H
+#include <math.h>
+#endif
+
+// Serialises the calls to makedata(), which writes to the parse tree.
+static pthread_mutex_t replic_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// The statistics of the replication which is running in the current thread.
+static AKSL_TLS double* replic_row = 0;
+static AKSL_TLS int replic_nstats = 0;
+
+/*------------------------------------------------------------------------------
+normal_quantile() returns the quantile of the standard normal distribution for
+the probability p, with 0 < p < 1. The relative error is less than 1.2e-9.
+This is the rational approximation of P.J. Acklam (2003).
+------------------------------------------------------------------------------*/
+//----------------------//
+//    normal_quantile   //
+//----------------------//
+static double normal_quantile(double p) {
+    static const double a[6] = {
+        -3.969683028665376e+01,  2.209460984245205e+02,
+        -2.759285104469687e+02,  1.383577518672690e+02,
+        -3.066479806614716e+01,  2.506628277459239e+00 };
+    static const double b[5] = {
+        -5.447609879822406e+01,  1.615858368580409e+02,
+        -1.556989798598866e+02,  6.680131188771972e+01,
+        -1.328068155288572e+01 };
+    static const double c[6] = {
+        -7.784894002430293e-03, -3.223964580411365e-01,
+        -2.400758277161838e+00, -2.549732539343734e+00,
+         4.374664141464968e+00,  2.938163982698783e+00 };
+    static const double d[4] = {
+         7.784695709041462e-03,  3.224671290700398e-01,
+         2.445134137142996e+00,  3.754408661907416e+00 };
+    static const double plow = 0.02425;
+
+    if (p <= 0 || p >= 1)
+        return 0;
+    if (p < plow) {
+        double q = sqrt(-2 * log(p));
+        return (((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5])
+             / ((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1);
+        }
+    if (p > 1 - plow) {
+        double q = sqrt(-2 * log(1 - p));
+        return -(((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5])
+             / ((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1);
+        }
+    double q = p - 0.5;
+    double r = q * q;
+    return (((((a[0]*r + a[1])*r + a[2])*r + a[3])*r + a[4])*r + a[5])*q
+         / (((((b[0]*r + b[1])*r + b[2])*r + b[3])*r + b[4])*r + 1);
+    } // End of function normal_quantile.
+
+/*------------------------------------------------------------------------------
+t_quantile() returns the quantile of the Student t-distribution with "df"
+degrees of freedom for the probability p, with 0 < p < 1.
+The quantile is exact for 1 and 2 degrees of freedom. Otherwise it is the
+expansion of the normal quantile in Abramowitz and Stegun, formula 26.7.5,
+which is within 0.5% of the true value for 3 or more degrees of freedom in the
+range 0.0005 <= p <= 0.9995.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      t_quantile      //
+//----------------------//
+double t_quantile(double p, long df) {
+    if (df <= 0 || p <= 0 || p >= 1)
+        return 0;
+    if (df == 1)
+        return tan(M_PI * (p - 0.5));
+    if (df == 2)
+        return (2*p - 1) / sqrt(2 * p * (1 - p));
+
+    double z = normal_quantile(p);
+    double z2 = z * z;
+    double n = df;
+    double g1 = z * (z2 + 1) / 4;
+    double g2 = z * ((5*z2 + 16)*z2 + 3) / 96;
+    double g3 = z * (((3*z2 + 19)*z2 + 17)*z2 - 15) / 384;
+    double g4 = z * ((((79*z2 + 776)*z2 + 1482)*z2 - 1920)*z2 - 945) / 92160;
+    return z + (g1 + (g2 + (g3 + g4/n)/n)/n)/n;
+    } // End of function t_quantile.
+
+//--------------------------//
+// replicator::replicator   //
+//--------------------------//
+replicator::replicator() {
+    parsed = false;
+    names = 0;
+    nstats = 0;
+    names_size = 0;
+    x = 0;
+    status = 0;
+    nreps = 0;
+    nextrep = 0;
+    duration = 1;
+    seed = 1;
+    setup = 0;
+    collect = 0;
+    arg = 0;
+    warm_start = 0;
+    } // End of function replicator::replicator.
+
+//--------------------------//
+// replicator::~replicator  //
+//--------------------------//
+replicator::~replicator() {
+    for (int i = 0; i < nstats; ++i)
+        delete[] (char*)names[i];
+    delete[] names;
+    delete[] x;
+    delete[] status;
+    } // End of function replicator::~replicator.
+
+/*------------------------------------------------------------------------------
+replicator::read() parses the given ORAL data file. (See oralaksl.h.)
+------------------------------------------------------------------------------*/
+//----------------------//
+//   replicator::read   //
+//----------------------//
+int replicator::read(c_string& filename, int trace) {
+    od.oslist.clear();
+    od.packagenames.clear();
+    parsed = false;
+    int err = parsedatafile(od, filename, trace);
+    if (err < 0)
+        return err;
+    parsed = true;
+    return 0;
+    } // End of function replicator::read.
+
+/*------------------------------------------------------------------------------
+replicator::add_stat() declares a statistic with the given name, and returns
+its index.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//   replicator::add_stat   //
+//--------------------------//
+int replicator::add_stat(const char* name) {
+    if (nstats >= names_size) {
+        int new_size = names_size ? 2 * names_size : 8;
+        const char** new_names = new const char*[new_size];
+        for (int i = 0; i < nstats; ++i)
+            new_names[i] = names[i];
+        delete[] names;
+        names = new_names;
+        names_size = new_size;
+        }
+    names[nstats] = new_strcpy(name ? name : "");
+    return nstats++;
+    } // End of function replicator::add_stat.
+
+/*------------------------------------------------------------------------------
+replicator::set() sets statistic "i" of the replication which is running in the
+calling thread. It does nothing if no replication is running in the thread.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    replicator::set   //
+//----------------------//
+void replicator::set(int i, double v) {
+    if (replic_row && i >= 0 && i < replic_nstats)
+        replic_row[i] = v;
+    } // End of function replicator::set.
+
+/*------------------------------------------------------------------------------
+replicator::replicate() runs replication number "rep" in the calling thread.
+The return value is 0 if all went well, and a negative error code otherwise.
+The exhaustion of events is not regarded as an error.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//  replicator::replicate   //
+//--------------------------//
+int replicator::replicate(long rep) {
+    rndm_stream rs(seed, (unsigned long long)rep);
+    rndm_stream* old_stream = rndm_current;
+    rndm_current = &rs;
+    double* row = x + rep * nstats;
+    replic_row = row;
+    replic_nstats = nstats;
+
+    model* mdl = new model;
+    int err = setup ? (*setup)(*mdl, arg) : 0;
+    if (err >= 0) {
+        pthread_mutex_lock(&replic_mutex);
+        err = makedata(*mdl, od);
+        pthread_mutex_unlock(&replic_mutex);
+        }
+    for (systm* ps = mdl->firstsystem(); ps && err >= 0; ps = ps->next()) {
+        if (warm_start && ps == mdl->firstsystem()) {
+            // The stream of the checkpoint is replaced by that of the rep.
+            err = ps->restore(warm_start);
+            rs.seed(seed, (unsigned long long)rep);
+            if (err >= 0)
+                err = ps->resume(duration);
+            }
+        else
+            err = ps->simulate(duration);
+        if (err == eNO_EVENTS)
+            err = 0;
+        }
+    if (err >= 0 && collect)
+        (*collect)(*mdl, rep, row, arg);
+    delete mdl;
+
+    replic_row = 0;
+    replic_nstats = 0;
+    rndm_current = old_stream;
+    return (err < 0) ? err : 0;
+    } // End of function replicator::replicate.
+
+/*------------------------------------------------------------------------------
+Each thread takes the next replication number until there are none left.
+------------------------------------------------------------------------------*/
+//--------------------------//
+// replicator::thread_main  //
+//--------------------------//
+void* replicator::thread_main(void* p) {
+    replicator* pr = (replicator*)p;
+    for (;;) {
+        long rep = __sync_fetch_and_add(&pr->nextrep, 1);
+        if (rep >= pr->nreps)
+            break;
+        pr->status[rep] = pr->replicate(rep);
+        }
+    bmem_thread_flush();
+    return 0;
+    } // End of function replicator::thread_main.
+
+/*------------------------------------------------------------------------------
+replicator::run() runs "n" replications of duration "dur" with "nthreads"
+threads, using the random number streams with the seed "s".
+The calling thread is one of the threads. If some of the other threads cannot
+be created, the replications are run by fewer threads.
+The return value is the number of replications which failed, or a negative
+error code if the run could not be started.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    replicator::run   //
+//----------------------//
+int replicator::run(long n, int nthreads, double dur, unsigned long long s) {
+    if (!parsed)
+        return eNO_VALUE;
+    if (n < 0)
+        return eBAD_ARGUMENT;
+    if (dur < 0)
+        return eNEGATIVE_DURATION;
+
+    delete[] x;
+    delete[] status;
+    nreps = n;
+    x = new double[n * nstats + 1];
+    status = new int[n + 1];
+    for (long k = 0; k < n * nstats; ++k)
+        x[k] = 0;
+    for (long r = 0; r < n; ++r)
+        status[r] = 0;
+    nextrep = 0;
+    duration = dur;
+    seed = s;
+
+    if (nthreads > n)
+        nthreads = (int)n;
+    if (nthreads <= 1) {
+        thread_main(this);
+        }
+    else {
+        bmem_threaded = 1;
+        pthread_t* tids = new pthread_t[nthreads];
+        int nstarted = 1;
+        for (int k = 1; k < nthreads; ++k) {
+            if (pthread_create(&tids[nstarted], 0, thread_main, this) != 0)
+                break;
+            nstarted += 1;
+            }
+        thread_main(this);
+        for (int k = 1; k < nstarted; ++k)
+            pthread_join(tids[k], 0);
+        delete[] tids;
+        bmem_threaded = 0;
+        }
+
+    int nfailed = 0;
+    for (long r = 0; r < n; ++r)
+        if (status[r] < 0)
+            nfailed += 1;
+    return nfailed;
+    } // End of function replicator::run.
+
+/*------------------------------------------------------------------------------
+replicator::n() returns the number of successful replications. All statistics
+have the same number of observations.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     replicator::n    //
+//----------------------//
+long replicator::n(int) const {
+    long m = 0;
+    for (long r = 0; r < nreps; ++r)
+        if (status[r] >= 0)
+            m += 1;
+    return m;
+    } // End of function replicator::n.
+
+//----------------------//
+//   replicator::mean   //
+//----------------------//
+double replicator::mean(int i) const {
+    if (i < 0 || i >= nstats)
+        return 0;
+    double sum = 0;
+    long m = 0;
+    for (long r = 0; r < nreps; ++r)
+        if (status[r] >= 0) {
+            sum += x[r*nstats + i];
+            m += 1;
+            }
+    return (m > 0) ? sum / m : 0;
+    } // End of function replicator::mean.
+
+/*------------------------------------------------------------------------------
+replicator::stddev() returns the sample standard deviation of statistic "i".
+------------------------------------------------------------------------------*/
+//----------------------//
+//  replicator::stddev  //
+//----------------------//
+double replicator::stddev(int i) const {
+    if (i < 0 || i >= nstats)
+        return 0;
+    double mu = mean(i);
+    double sum = 0;
+    long m = 0;
+    for (long r = 0; r < nreps; ++r)
+        if (status[r] >= 0) {
+            double d = x[r*nstats + i] - mu;
+            sum += d * d;
+            m += 1;
+            }
+    return (m > 1) ? sqrt(sum / (m - 1)) : 0;
+    } // End of function replicator::stddev.
+
+/*------------------------------------------------------------------------------
+replicator::halfwidth() returns the half-width of the two-sided confidence
+interval for the mean of statistic "i", with confidence level "conf".
+------------------------------------------------------------------------------*/
+//--------------------------//
+//  replicator::halfwidth   //
+//--------------------------//
+double replicator::halfwidth(int i, double conf) const {
+    long m = n(i);
+    if (m < 2 || conf <= 0 || conf >= 1)
+        return 0;
+    return t_quantile(0.5 + conf / 2, m - 1) * stddev(i) / sqrt(double(m));
+    } // End of function replicator::halfwidth.
+
+//----------------------//
+//   replicator::print  //
+//----------------------//
+void replicator::print(ostream& os, double conf) const {
+    long m = n(0);
+    os << "Replications: " << m << " of " << nreps << " successful.\n";
+    for (int i = 0; i < nstats; ++i) {
+        os << names[i] << ": " << mean(i) << " +/- " << halfwidth(i, conf)
+           << " (" << 100 * conf << "% confidence, s.d. " << stddev(i)
+           << ")\n";
+        }
+    } // End of function replicator::print.
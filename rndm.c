@@ -21,6 +21,8 @@ srandom01
 
 static int seeded = 0;
 
+AKSL_TLS rndm_stream* rndm_current = 0;
+
 /*------------------------------------------------------------------------------
 srandom01() seeds the random number function random01(). If the random number
 has already been seeded, then it is not seeded again.
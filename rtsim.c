@@ -0,0 +1,293 @@
+// src/aksl/rtsim.c   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+/*------------------------------------------------------------------------------
+Functions in this file:
+
+rtsim_now
+rtsim::
+    rtsim
+    ~rtsim
+    now
+    sync
+    inject
+    stop
+    arm
+    handler
+    print_stats
+    simulate
+------------------------------------------------------------------------------*/
+
+// AKSL header files:
+#include "aksl/rtsim.h"
+#ifndef AKSL_ERROR_H
+#include "aksl/error.h"
+#endif
+#ifndef AKSL_AKSLTIME_H
+#include "aksl/aksltime.h"
+#endif
+#ifndef AKSL_TRACE_H
+#include "aksl/trace.h"
+#endif
+#ifndef AKSL_PROF_H
+#include "aksl/prof.h"
+#endif
+
+//----------------------//
+//       rtsim_now      //
+//----------------------//
+static double rtsim_now() {
+    timeval tv;
+    gettime(tv);
+    return timeval_get(tv);
+    } // End of function rtsim_now.
+
+//----------------------//
+//     rtsim::rtsim     //
+//----------------------//
+rtsim::rtsim(systm& s, selector& sl, double sc, double j) {
+    sys = &s;
+    sel = &sl;
+    set_selector(sl);
+    scale = (sc > 0) ? sc : 1;
+    jitter = (j >= 0) ? j : rtsim_deft_jitter;
+    slip = false;
+    start = 0;
+    finish = 0;
+    wall0 = 0;
+    tmr = 0;
+    tmr_at = 0;
+    running = false;
+    err = 0;
+    nevents = 0;
+    nlate = 0;
+    ninjected = 0;
+    nslips = 0;
+    late_sum = 0;
+    late_max = 0;
+    } // End of function rtsim::rtsim.
+
+//----------------------//
+//    rtsim::~rtsim     //
+//----------------------//
+rtsim::~rtsim() {
+    if (tmr)
+        sel->cancel_timer(tmr);
+    } // End of function rtsim::~rtsim.
+
+/*------------------------------------------------------------------------------
+rtsim::now() returns the simulated time which corresponds to the wall time now.
+It is not greater than the finish time.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      rtsim::now      //
+//----------------------//
+double rtsim::now() const {
+    if (!running)
+        return sys->sysclock();
+    double t = start + (rtsim_now() - wall0) / scale;
+    return (t < finish) ? t : finish;
+    } // End of function rtsim::now.
+
+/*------------------------------------------------------------------------------
+rtsim::sync() moves the clock of the system forward to now(), but not past the
+first event in the FEL, which may not have been executed yet.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      rtsim::sync     //
+//----------------------//
+void rtsim::sync() {
+    if (!running)
+        return;
+    double t = now();
+    const event* pf = sys->events.first();
+    if (pf && pf->time() < t)
+        t = pf->time();
+    if (t > sys->clck) {
+        sys->clck = t;
+        sys->depth = 0;
+        }
+    } // End of function rtsim::sync.
+
+/*------------------------------------------------------------------------------
+rtsim::inject() sends an event from "orig" to "dest" at the current simulated
+time. It is intended to be called by the handlers of the selector. The timer is
+set again if the event is earlier than the timer.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     rtsim::inject    //
+//----------------------//
+event* rtsim::inject(object* orig, object* dest, mtype m, const payload& x) {
+    sync();
+    event* pe = sys->newevent_abs(sys->clck, orig, dest, m, x);
+    if (!pe)
+        return 0;
+    ninjected += 1;
+    if (running)
+        arm();
+    return pe;
+    } // End of function rtsim::inject.
+
+/*------------------------------------------------------------------------------
+rtsim::stop() ends the simulation with the given error, or normally if it is
+not negative. The timer is set for now, so that the selector returns soon,
+even if stop() is called by the handler of a socket.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      rtsim::stop     //
+//----------------------//
+void rtsim::stop(int e) {
+    if (err == 0)
+        err = (e < 0) ? e : 1;
+    if (!running)
+        return;
+    if (tmr)
+        sel->cancel_timer(tmr);
+    tmr_at = rtsim_now();
+    tmr = sel->set_timer(tmr_at, this);
+    } // End of function rtsim::stop.
+
+/*------------------------------------------------------------------------------
+rtsim::arm() sets the timer for the wall time of the first event in the FEL, or
+of the finish time if that is earlier. If the timer is already set for that
+time, it is left alone.
+------------------------------------------------------------------------------*/
+//----------------------//
+//      rtsim::arm      //
+//----------------------//
+void rtsim::arm() {
+    double t = finish;
+    const event* pf = sys->events.first();
+    if (pf && pf->time() < t)
+        t = pf->time();
+    double w = wall(t);
+    if (tmr) {
+        if (tmr_at == w)
+            return;
+        sel->cancel_timer(tmr);
+        }
+    tmr = sel->set_timer(w, this);
+    tmr_at = w;
+    } // End of function rtsim::arm.
+
+/*------------------------------------------------------------------------------
+rtsim::handler() is called by the selector when the timer goes off. It executes
+the events which are due, and sets the timer again. It returns -1, so that
+selector::get_event() returns, when the simulation has ended.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    rtsim::handler    //
+//----------------------//
+int rtsim::handler() {
+    tmr = 0;                    // The selector deletes the timer.
+    if (err != 0)
+        return -1;
+    double w = rtsim_now();
+    double tnow = start + (w - wall0) / scale;
+    while (err == 0) {
+        const event* pf = sys->events.first();
+        if (!pf || pf->time() > tnow || pf->time() >= finish)
+            break;
+        event* evt = sys->events.popfirst();
+        if (evt->origin()) {    // Ignore cancelled events.
+            double late = w - wall(evt->time());
+            if (late < 0)
+                late = 0;
+            nevents += 1;
+            late_sum += late;
+            if (late > late_max)
+                late_max = late;
+            if (late > jitter) {
+                nlate += 1;
+                if (slip) {
+                    wall0 += late;
+                    tnow = start + (w - wall0) / scale;
+                    nslips += 1;
+                    }
+                }
+            sys->clck = evt->time();
+            sys->depth = evt->depth;
+            if (sys->etrace)
+                sys->etrace->record(evt);
+            object* perr = sys->prof
+                ? sys->prof->simulate(evt, sys->clck, sys->events.length())
+                : evt->simulate();
+            if (perr) {
+                cout << "Termination condition received from the "
+                     << perr->type();
+                cout << " called " << perr->name << DOTNL;
+                err = (perr->error < 0) ? perr->error : eEVENT_ERROR;
+                }
+            }
+        delete evt;
+        }
+    if (err == 0 && tnow >= finish)
+        err = 1;
+    if (err != 0)
+        return -1;
+    arm();
+    return 0;
+    } // End of function rtsim::handler.
+
+//----------------------//
+//  rtsim::print_stats  //
+//----------------------//
+void rtsim::print_stats(ostream& os) const {
+    os << "Real-time events: " << nevents
+       << ", injected: " << ninjected
+       << ", late: " << nlate
+       << ", slips: " << nslips << NL;
+    os << "Lateness (s): mean " << mean_lateness()
+       << ", max " << late_max
+       << ", jitter bound " << jitter << NL;
+    } // End of function rtsim::print_stats.
+
+/*------------------------------------------------------------------------------
+rtsim::simulate() is the real-time version of systm::simulate(). The system is
+initialised, and then selector::get_event() is called until the simulation
+ends. Then the objects and packages are terminated, unless there was an error.
+The statistics are those of this simulation.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    rtsim::simulate   //
+//----------------------//
+int rtsim::simulate(double duration, double start0) {
+    if (duration <= 0) {
+        cout << "Terminating simulation due to non-positive duration.\n";
+        return eNEGATIVE_DURATION;
+        }
+    nevents = 0;
+    nlate = 0;
+    ninjected = 0;
+    nslips = 0;
+    late_sum = 0;
+    late_max = 0;
+    err = 0;
+    int ret = sys->initialise(start0);
+    if (ret < 0)
+        return ret;
+    start = start0;
+    finish = start0 + duration;
+    wall0 = rtsim_now();
+    running = true;
+    arm();
+    while (err == 0) {
+        sel->get_event();
+        if (sel->select_return < 0 && err == 0)
+            err = eSOCKET_FAILED;
+        }
+    running = false;
+    if (tmr) {
+        sel->cancel_timer(tmr);
+        tmr = 0;
+        }
+    if (err < 0)
+        return err;
+    if (sys->clck < finish)
+        sys->clck = finish;
+    sys->terminate();
+    return 0;
+    } // End of function rtsim::simulate.
@@ -90,14 +90,14 @@ void c_string_rep::lower() {
 void c_string_rep::cat(const char* pc) {
     if (pc && *pc) { // Should always be true.
         if (s) {
-            char* x = new char[strlen(s) + strlen(pc) + 1];
+            char* x = szbuf_new(strlen(s) + strlen(pc) + 1);
             strcpy(x, s);
             strcat(x, pc);
-            delete[] s;
+            szbuf_delete(s);
             s = x;
             }
         else {
-            s = new char[strlen(pc) + 1];
+            s = szbuf_new(strlen(pc) + 1);
             strcpy(s, pc);
             }
         }
@@ -123,14 +123,14 @@ void c_string_rep::cat(long x) {
         return;
 
     if (s) {
-        char* s2 = new char[strlen(s) + strlen(buf) + 1];
+        char* s2 = szbuf_new(strlen(s) + strlen(buf) + 1);
         strcpy(s2, s);
         strcat(s2, buf);
-        delete[] s;
+        szbuf_delete(s);
         s = s2;
         }
     else {
-        s = new char[strlen(buf) + 1];
+        s = szbuf_new(strlen(buf) + 1);
         strcpy(s, buf);
         }
     } // End of function c_string_rep::cat.
@@ -156,14 +156,14 @@ void c_string_rep::cat(unsigned long x) {
         return;
 
     if (s) {
-        char* s2 = new char[strlen(s) + strlen(buf) + 1];
+        char* s2 = szbuf_new(strlen(s) + strlen(buf) + 1);
         strcpy(s2, s);
         strcat(s2, buf);
-        delete[] s;
+        szbuf_delete(s);
         s = s2;
         }
     else {
-        s = new char[strlen(buf) + 1];
+        s = szbuf_new(strlen(buf) + 1);
         strcpy(s, buf);
         }
     } // End of function c_string_rep::cat.
@@ -176,14 +176,14 @@ void c_string_rep::cat(const c_string_rep* p) {
     // Forget the check for null p. Only c_string can call the function.
     if (p->s && *p->s) { // Should always be true.
         if (s) {
-            char* x = new char[strlen(s) + strlen(p->s) + 1];
+            char* x = szbuf_new(strlen(s) + strlen(p->s) + 1);
             strcpy(x, s);
             strcat(x, p->s);
-            delete[] s;
+            szbuf_delete(s);
             s = x;
             }
         else {
-            s = new char[strlen(p->s) + 1];
+            s = szbuf_new(strlen(p->s) + 1);
             strcpy(s, p->s);
             }
         }
@@ -0,0 +1,312 @@
+// src/aksl/szmem.c   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+/*------------------------------------------------------------------------------
+Functions in this file:
+
+szmem::
+    szmem
+    ~szmem
+    size_class
+    class_size
+    newpool
+    count_alloc
+    count_free
+    alloc
+    free
+    capacity
+    n_allocs
+    n_frees
+    n_in_use
+    high_water
+    n_chunks
+    n_bytes
+    print
+szmem_buffers_init
+------------------------------------------------------------------------------*/
+
+// AKSL header files:
+#include "aksl/szmem.h"
+#ifndef AKSL_AKSLDEFS_H
+#include "aksl/aksldefs.h"
+#endif
+
+// System header files:
+#ifndef AKSL_X_STDLIB_H
+#define AKSL_X_STDLIB_H
+#include <stdlib.h>
+#endif
+
+// The class which marks a large array.
+static const long szmem_large = szmem_nclasses;
+
+szmem* szmem_buffers0 = 0;
+
+//----------------------//
+//     szmem::szmem     //
+//----------------------//
+szmem::szmem(memsrc_t ms) {
+    memsrc = ms;
+    for (int i = 0; i < szmem_nclasses; ++i)
+        pools[i] = 0;
+    for (int i = 0; i <= szmem_nclasses; ++i) {
+        nallocs[i] = 0;
+        nfrees[i] = 0;
+        nhigh[i] = 0;
+        }
+    } // End of function szmem::szmem.
+
+/*------------------------------------------------------------------------------
+The bmems are not deleted, because arrays may still be in use.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    szmem::~szmem     //
+//----------------------//
+szmem::~szmem() {
+    } // End of function szmem::~szmem.
+
+/*------------------------------------------------------------------------------
+szmem::size_class() returns the smallest class which can hold n bytes, or -1
+if n is larger than szmem_max_size. If 2^k < n <= 2^(k+1), then the class is
+either 3 * 2^(k-1) or 2^(k+1).
+------------------------------------------------------------------------------*/
+//----------------------//
+//   szmem::size_class  //
+//----------------------//
+int szmem::size_class(long n) {
+    if (n <= szmem_min_size)
+        return 0;
+    if (n > szmem_max_size)
+        return -1;
+    unsigned long m = n - 1;
+#ifdef __GNUC__
+    int k = 8 * sizeof(unsigned long) - 1 - __builtin_clzl(m);
+#else
+    int k = 0;
+    while (m >> (k + 1))
+        k += 1;
+#endif
+    if (n <= (3L << (k - 1)))
+        return 2 * (k - 4) + 1;
+    return 2 * (k - 3);
+    } // End of function szmem::size_class.
+
+//----------------------//
+//   szmem::class_size  //
+//----------------------//
+long szmem::class_size(int i) {
+    if (i < 0 || i >= szmem_nclasses)
+        return 0;
+    return (i & 1) ? (24L << (i >> 1)) : (16L << (i >> 1));
+    } // End of function szmem::class_size.
+
+/*------------------------------------------------------------------------------
+szmem::newpool() creates the bmem of class i. If two threads do this at once,
+the bmem of the loser is deleted. (It has not allocated any blocks yet.)
+------------------------------------------------------------------------------*/
+//----------------------//
+//    szmem::newpool    //
+//----------------------//
+bmem* szmem::newpool(int i) {
+    long s = class_size(i);
+    long n = szmem_block_bytes / (s + 2 * BMEM_ALIGN);
+    if (n < 4)
+        n = 4;
+    bmem* pb = new bmem(s + BMEM_ALIGN, n, memsrc, "szmem");
+    if (!bmem_threaded) {
+        pools[i] = pb;
+        return pb;
+        }
+    if (__sync_bool_compare_and_swap(&pools[i], (bmem*)0, pb))
+        return pb;
+    delete pb;
+    return pools[i];
+    } // End of function szmem::newpool.
+
+//----------------------//
+//  szmem::count_alloc  //
+//----------------------//
+void szmem::count_alloc(int i) {
+    unsigned long a, f;
+    if (bmem_threaded) {
+        a = __sync_add_and_fetch(&nallocs[i], 1);
+        f = nfrees[i];
+        }
+    else {
+        a = ++nallocs[i];
+        f = nfrees[i];
+        }
+    if (a - f > nhigh[i])
+        nhigh[i] = a - f;
+    } // End of function szmem::count_alloc.
+
+//----------------------//
+//   szmem::count_free  //
+//----------------------//
+void szmem::count_free(int i) {
+    if (bmem_threaded)
+        __sync_fetch_and_add(&nfrees[i], 1);
+    else
+        nfrees[i] += 1;
+    } // End of function szmem::count_free.
+
+/*------------------------------------------------------------------------------
+szmem::alloc() returns an array of at least n bytes, aligned to BMEM_ALIGN, or
+0 if the memory source fails.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     szmem::alloc     //
+//----------------------//
+void* szmem::alloc(long n) {
+    if (n <= 0)
+        return 0;
+    int i = size_class(n);
+    char* p = 0;
+    if (i < 0) {
+        i = szmem_large;
+        if (memsrc == msMALLOC)
+            p = (char*)malloc(n + BMEM_ALIGN);
+        else
+            p = new char[n + BMEM_ALIGN];
+        }
+    else {
+        bmem* pb = pools[i];
+        if (!pb)
+            pb = newpool(i);
+        p = (char*)pb->newchunk();
+        }
+    if (!p)
+        return 0;
+    *(long*)p = i;
+    count_alloc(i);
+    return p + BMEM_ALIGN;
+    } // End of function szmem::alloc.
+
+//----------------------//
+//      szmem::free     //
+//----------------------//
+void szmem::free(void* p0) {
+    if (!p0)
+        return;
+    char* p = (char*)p0 - BMEM_ALIGN;
+    int i = (int)*(long*)p;
+    count_free(i);
+    if (i == szmem_large) {
+        if (memsrc == msMALLOC)
+            ::free(p);
+        else
+            delete[] p;
+        return;
+        }
+    pools[i]->freechunk(p);
+    } // End of function szmem::free.
+
+/*------------------------------------------------------------------------------
+szmem::capacity() returns the number of bytes which may be used in an array
+from alloc(). For a large array this is not known, and 0 is returned.
+------------------------------------------------------------------------------*/
+//----------------------//
+//    szmem::capacity   //
+//----------------------//
+long szmem::capacity(const void* p) {
+    if (!p)
+        return 0;
+    return class_size((int)*(const long*)((const char*)p - BMEM_ALIGN));
+    } // End of function szmem::capacity.
+
+//----------------------//
+//    szmem::n_allocs   //
+//----------------------//
+unsigned long szmem::n_allocs(int i) const {
+    return (i >= 0 && i <= szmem_nclasses) ? nallocs[i] : 0;
+    } // End of function szmem::n_allocs.
+
+//----------------------//
+//    szmem::n_frees    //
+//----------------------//
+unsigned long szmem::n_frees(int i) const {
+    return (i >= 0 && i <= szmem_nclasses) ? nfrees[i] : 0;
+    } // End of function szmem::n_frees.
+
+//----------------------//
+//    szmem::n_in_use   //
+//----------------------//
+unsigned long szmem::n_in_use(int i) const {
+    return (i >= 0 && i <= szmem_nclasses) ? nallocs[i] - nfrees[i] : 0;
+    } // End of function szmem::n_in_use.
+
+//----------------------//
+//   szmem::high_water  //
+//----------------------//
+unsigned long szmem::high_water(int i) const {
+    return (i >= 0 && i <= szmem_nclasses) ? nhigh[i] : 0;
+    } // End of function szmem::high_water.
+
+//----------------------//
+//    szmem::n_chunks   //
+//----------------------//
+unsigned long szmem::n_chunks(int i) const {
+    if (i < 0 || i >= szmem_nclasses || !pools[i])
+        return 0;
+    return pools[i]->n_chunks();
+    } // End of function szmem::n_chunks.
+
+//----------------------//
+//    szmem::n_bytes    //
+//----------------------//
+unsigned long szmem::n_bytes(int i) const {
+    if (i < 0 || i >= szmem_nclasses || !pools[i])
+        return 0;
+    return pools[i]->size();
+    } // End of function szmem::n_bytes.
+
+/*------------------------------------------------------------------------------
+szmem::print() prints one line for each class which has been used, and one
+for the large arrays.
+------------------------------------------------------------------------------*/
+//----------------------//
+//     szmem::print     //
+//----------------------//
+void szmem::print(ostream& os) const {
+    os << "  size      allocs       frees      in use  high water"
+          "      chunks\n";
+    for (int i = 0; i <= szmem_nclasses; ++i) {
+        if (nallocs[i] == 0)
+            continue;
+        os.width(6);
+        if (i < szmem_nclasses)
+            os << class_size(i);
+        else
+            os << "large";
+        os << " ";
+        os.width(11);
+        os << n_allocs(i) << " ";
+        os.width(11);
+        os << n_frees(i) << " ";
+        os.width(11);
+        os << n_in_use(i) << " ";
+        os.width(11);
+        os << high_water(i) << " ";
+        os.width(11);
+        os << n_chunks(i) << NL;
+        }
+    } // End of function szmem::print.
+
+/*------------------------------------------------------------------------------
+szmem_buffers_init() creates the szmem for the buffer classes. It is not
+constructed statically, because c_strings may be constructed and destroyed
+by static constructors and destructors in any order.
+------------------------------------------------------------------------------*/
+//--------------------------//
+//    szmem_buffers_init    //
+//--------------------------//
+szmem* szmem_buffers_init() {
+    szmem* p = new szmem;
+    if (__sync_bool_compare_and_swap(&szmem_buffers0, (szmem*)0, p))
+        return p;
+    delete p;
+    return szmem_buffers0;
+    } // End of function szmem_buffers_init.
@@ -0,0 +1,203 @@
+// src/aksl/tools/tracedump.c   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+/*------------------------------------------------------------------------------
+Functions in this file:
+
+get_str
+obj_cmp
+obj_name
+print_record
+main
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Print a binary event trace file in the format of event::print(). (See trace.h.)
+
+Usage: tracedump [-a] file
+With the option -a, the argument of each event is also printed.
+If a buffered trace was not closed, the file has no name tables. Then the
+objects are printed as ids and the message types as numbers. The same is true
+of objects which were added to a ring trace after it was last synchronised.
+The number of records of such a buffered file is found from its size, since
+the count in the header is only as recent as the last sync().
+------------------------------------------------------------------------------*/
+
+#include "aksl/trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct obj_entry {
+    unsigned int id;
+    char* name;
+    char* type;
+    };
+
+static char** mnames = 0;           // Names of the message types.
+static unsigned int n_mnames = 0;
+static obj_entry* objs = 0;         // The objects, in order of id.
+static unsigned int n_objs = 0;
+
+/*------------------------------------------------------------------------------
+get_str() reads a string written by trace_put_str() into a new array.
+------------------------------------------------------------------------------*/
+//----------------------//
+//        get_str       //
+//----------------------//
+static char* get_str(FILE* fp) {
+    unsigned int k = 0;
+    if (fread(&k, sizeof(k), 1, fp) != 1 || k > (1U << 24))
+        return 0;
+    char* s = new char[k + 1];
+    if (k > 0 && fread(s, 1, k, fp) != k) {
+        delete[] s;
+        return 0;
+        }
+    s[k] = 0;
+    return s;
+    } // End of function get_str.
+
+//----------------------//
+//        obj_cmp       //
+//----------------------//
+static int obj_cmp(const void* a, const void* b) {
+    unsigned int x = ((const obj_entry*)a)->id;
+    unsigned int y = ((const obj_entry*)b)->id;
+    return (x < y) ? -1 : (x > y) ? 1 : 0;
+    } // End of function obj_cmp.
+
+/*------------------------------------------------------------------------------
+obj_name() returns the name of the object with the given id, or "#" and the
+id if the object is not in the table.
+------------------------------------------------------------------------------*/
+//----------------------//
+//       obj_name       //
+//----------------------//
+static const char* obj_name(unsigned int id, char* buf) {
+    obj_entry key;
+    key.id = id;
+    obj_entry* p = (obj_entry*)bsearch(&key, objs, n_objs, sizeof(obj_entry),
+                                       obj_cmp);
+    if (p)
+        return p->name ? p->name : "";
+    sprintf(buf, "#%u", id);
+    return buf;
+    } // End of function obj_name.
+
+//----------------------//
+//     print_record     //
+//----------------------//
+static void print_record(const trace_record& r, bool_enum print_arg) {
+    char b1[32], b2[32];
+    printf("t = %g,\n    ", r.t);
+    if (r.mty >= 0 && (unsigned int)r.mty < n_mnames)
+        printf("\"%s\", ", mnames[r.mty]);
+    else if (n_mnames > 0)
+        printf("\"Illegal message\", ");
+    else
+        printf("\"%d\", ", r.mty);
+    printf("%s -> %s.\n", obj_name(r.orig, b1),
+        (r.dest != no_object_id) ? obj_name(r.dest, b2) : "BROADCAST");
+    if (!print_arg)
+        return;
+    switch (r.ptype) {
+    case pINTEGER:
+        printf("    arg = %lld\n", r.arg);
+        break;
+    case pREAL: {
+        double x;
+        memcpy(&x, &r.arg, sizeof(x));
+        printf("    arg = %g\n", x);
+        }
+        break;
+    case pOBJECT:
+        if ((unsigned int)r.arg == no_object_id)
+            printf("    arg = object 0\n");
+        else
+            printf("    arg = object %s\n",
+                obj_name((unsigned int)r.arg, b1));
+        break;
+    case pDATUM:
+        printf("    arg = datum 0x%llx\n", (unsigned long long)r.arg);
+        break;
+    case pVALUE:
+        printf("    arg = value 0x%llx\n", (unsigned long long)r.arg);
+        break;
+    default:
+        break;
+        }
+    } // End of function print_record.
+
+//----------------------//
+//         main         //
+//----------------------//
+int main(int argc, char** argv) {
+    bool_enum print_arg = false;
+    int i = 1;
+    if (i < argc && strcmp(argv[i], "-a") == 0) {
+        print_arg = true;
+        ++i;
+        }
+    if (i != argc - 1) {
+        fprintf(stderr, "Usage: tracedump [-a] file\n");
+        return 1;
+        }
+    FILE* fp = fopen(argv[i], "rb");
+    if (!fp) {
+        fprintf(stderr, "tracedump: cannot open %s\n", argv[i]);
+        return 1;
+        }
+    trace_header h;
+    if (fread(&h, sizeof(h), 1, fp) != 1
+        || memcmp(h.magic, TRACE_MAGIC, sizeof(h.magic)) != 0
+        || h.byte_order != trace_byte_order
+        || h.record_size != sizeof(trace_record)) {
+        fprintf(stderr, "tracedump: %s is not a trace file\n", argv[i]);
+        return 1;
+        }
+
+    // Read the name tables.
+    if (h.tables > 0 && fseek(fp, (long)h.tables, SEEK_SET) == 0
+        && fread(&n_mnames, sizeof(n_mnames), 1, fp) == 1) {
+        mnames = new char*[n_mnames + 1];
+        for (unsigned int j = 0; j < n_mnames; ++j)
+            mnames[j] = get_str(fp);
+        if (fread(&n_objs, sizeof(n_objs), 1, fp) != 1)
+            n_objs = 0;
+        objs = new obj_entry[n_objs + 1];
+        for (unsigned int j = 0; j < n_objs; ++j) {
+            if (fread(&objs[j].id, sizeof(objs[j].id), 1, fp) != 1)
+                objs[j].id = no_object_id;
+            objs[j].name = get_str(fp);
+            objs[j].type = get_str(fp);
+            }
+        qsort(objs, n_objs, sizeof(obj_entry), obj_cmp);
+        }
+
+    // Print the records, oldest first.
+    unsigned long long n = h.count;
+    if (h.capacity == 0 && h.tables == 0 && fseek(fp, 0, SEEK_END) == 0) {
+        long len = ftell(fp);
+        if (len > (long)sizeof(h))
+            n = (len - sizeof(h)) / sizeof(trace_record);
+        }
+    unsigned long long first = 0;
+    if (h.capacity > 0 && n > h.capacity) {
+        first = n % h.capacity;
+        n = h.capacity;
+        }
+    trace_record r;
+    for (unsigned long long k = 0; k < n; ++k) {
+        unsigned long long slot = h.capacity > 0 ? (first + k) % h.capacity : k;
+        if (k == 0 || slot == 0)
+            fseek(fp, (long)(sizeof(h) + slot * sizeof(r)), SEEK_SET);
+        if (fread(&r, sizeof(r), 1, fp) != 1)
+            break;
+        print_record(r, print_arg);
+        }
+    fclose(fp);
+    return 0;
+    } // End of function main.
@@ -0,0 +1,426 @@
+// src/aksl/trace.c   2026-10-17   Alan U. Kennington.
+/*-----------------------------------------------------------------------------
+Copyright (C) 1989-2018, Alan U. Kennington.
+You may distribute this software under the terms of Alan U. Kennington's
+modified Artistic Licence, as specified in the accompanying LICENCE file.
+-----------------------------------------------------------------------------*/
+/*------------------------------------------------------------------------------
+Functions in this file:
+
+trace_put_str
+event_trace::
+    open
+    set_mtypes
+    add_object
+    put_tables
+    write_ring_tables
+    clear_names
+    wrap
+    sync
+    close
+    ~event_trace
+systm::
+    open_event_trace
+    close_event_trace
+    sync_event_trace
+------------------------------------------------------------------------------*/
+
+#include "aksl/trace.h"
+#ifndef AKSL_ERROR_H
+#include "aksl/error.h"
+#endif
+#ifndef AKSL_NEWSTR_H
+#include "aksl/newstr.h"
+#endif
+
+// System header files.
+#ifndef AKSL_X_STRING_H
+#define AKSL_X_STRING_H
+#include <string.h>
+#endif
+#ifndef AKSL_X_STDDEF_H
+#define AKSL_X_STDDEF_H
+#include <stddef.h>
+#endif
+#ifndef WIN32
+#ifndef AKSL_X_SYS_MMAN_H
+#define AKSL_X_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#ifndef AKSL_X_FCNTL_H
+#define AKSL_X_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifndef AKSL_X_UNISTD_H
+#define AKSL_X_UNISTD_H
+#include <unistd.h>
+#endif
+#endif
+
+//----------------------//
+//     trace_put_str    //
+//----------------------//
+static void trace_put_str(FILE* fp, const char* s) {
+    unsigned int k = s ? strlen(s) : 0;
+    fwrite(&k, sizeof(k), 1, fp);
+    if (k > 0)
+        fwrite(s, 1, k, fp);
+    } // End of function trace_put_str.
+
+/*------------------------------------------------------------------------------
+event_trace::open() creates the trace file. The number of records "nrec" is the
+size of the ring, or of the buffer. If the ring cannot be memory-mapped, the
+error eOPEN_FAILED is returned. The (empty) name tables of a ring are written
+at once, just after the ring.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   event_trace::open  //
+//----------------------//
+int event_trace::open(const char* filename, unsigned long nrec, bool_enum r) {
+    if (path)
+        return eBAD_ARGUMENT;
+    if (!filename || !*filename)
+        return eNULL_FILE_NAME;
+    if (nrec == 0)
+        nrec = 1;
+    trace_header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, TRACE_MAGIC, sizeof(h.magic));
+    h.byte_order = trace_byte_order;
+    h.record_size = sizeof(trace_record);
+    if (r) {
+#ifndef WIN32
+        h.capacity = nrec;
+        maplen = sizeof(trace_header) + nrec * sizeof(trace_record);
+        h.tables = maplen;
+        int fd = ::open(filename, O_RDWR | O_CREAT | O_TRUNC, 0666);
+        if (fd < 0)
+            return eFILE_OPEN_FAILED;
+        if (ftruncate(fd, maplen) != 0) {
+            ::close(fd);
+            return eOPEN_FAILED;
+            }
+        map = mmap(0, maplen, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) {
+            map = 0;
+            return eOPEN_FAILED;
+            }
+        memcpy(map, &h, sizeof(h));
+        rec = (trace_record*)((char*)map + sizeof(trace_header));
+#else
+        return eOPEN_FAILED;
+#endif
+        }
+    else {
+        fp = fopen(filename, "w+b");
+        if (!fp)
+            return eFILE_OPEN_FAILED;
+        fwrite(&h, sizeof(h), 1, fp);
+        rec = new trace_record[nrec];
+        }
+    path = new_strcpy(filename);
+    ring = r;
+    n = nrec;
+    pos = 0;
+    count = 0;
+    err = 0;
+    if (ring)
+        write_ring_tables();
+    return 0;
+    } // End of function event_trace::open.
+
+/*------------------------------------------------------------------------------
+event_trace::set_mtypes() copies the names of the global message types, since
+the array of a model is replaced when a package is loaded.
+------------------------------------------------------------------------------*/
+//------------------------------//
+//    event_trace::set_mtypes   //
+//------------------------------//
+void event_trace::set_mtypes(const char** names, long nm) {
+    for (long i = 0; i < nmnames; ++i)
+        delete[] mnames[i];
+    delete[] mnames;
+    mnames = 0;
+    nmnames = (names && nm > 0) ? nm : 0;
+    if (nmnames > 0) {
+        mnames = new char*[nmnames];
+        for (long i = 0; i < nmnames; ++i)
+            mnames[i] = new_strcpy(names[i] ? names[i] : "");
+        }
+    stale = ring;
+    } // End of function event_trace::set_mtypes.
+
+/*------------------------------------------------------------------------------
+event_trace::add_object() copies the name and type of an object into the table
+of objects, at the index of its id.
+------------------------------------------------------------------------------*/
+//------------------------------//
+//    event_trace::add_object   //
+//------------------------------//
+void event_trace::add_object(const object* po) {
+    unsigned int id = po->id();
+    if (id == no_object_id)
+        return;
+    if (id >= nobjs) {
+        unsigned int newsize = (nobjs > 0) ? 2 * nobjs : 64;
+        while (newsize <= id)
+            newsize *= 2;
+        char** pn = new char*[newsize];
+        char** pt = new char*[newsize];
+        unsigned int i = 0;
+        for ( ; i < nobjs; ++i) {
+            pn[i] = onames[i];
+            pt[i] = otypes[i];
+            }
+        for ( ; i < newsize; ++i) {
+            pn[i] = 0;
+            pt[i] = 0;
+            }
+        delete[] onames;
+        delete[] otypes;
+        onames = pn;
+        otypes = pt;
+        nobjs = newsize;
+        }
+    const char* s = po->name.read();
+    delete[] onames[id];
+    onames[id] = new_strcpy(s ? s : "");
+    s = ((object*)po)->type();
+    delete[] otypes[id];
+    otypes[id] = new_strcpy(s ? s : "");
+    stale = ring;
+    } // End of function event_trace::add_object.
+
+/*------------------------------------------------------------------------------
+event_trace::put_tables() writes the name tables at the current position of the
+file.
+------------------------------------------------------------------------------*/
+//------------------------------//
+//    event_trace::put_tables   //
+//------------------------------//
+void event_trace::put_tables(FILE* f) {
+    unsigned int k = (unsigned int)nmnames;
+    fwrite(&k, sizeof(k), 1, f);
+    for (unsigned int i = 0; i < k; ++i)
+        trace_put_str(f, mnames[i]);
+    k = 0;
+    for (unsigned int i = 0; i < nobjs; ++i)
+        if (onames[i])
+            k += 1;
+    fwrite(&k, sizeof(k), 1, f);
+    for (unsigned int i = 0; i < nobjs; ++i) {
+        if (!onames[i])
+            continue;
+        fwrite(&i, sizeof(i), 1, f);
+        trace_put_str(f, onames[i]);
+        trace_put_str(f, otypes[i]);
+        }
+    } // End of function event_trace::put_tables.
+
+/*------------------------------------------------------------------------------
+event_trace::write_ring_tables() writes the name tables of a ring just after the
+ring. They are only appended to, so the new tables are never shorter.
+------------------------------------------------------------------------------*/
+//----------------------------------//
+//  event_trace::write_ring_tables  //
+//----------------------------------//
+void event_trace::write_ring_tables() {
+    stale = false;
+    FILE* f = fopen(path, "r+b");
+    if (!f) {
+        if (!err)
+            err = eFILE_OPEN_FAILED;
+        return;
+        }
+    fseek(f, (long)maplen, SEEK_SET);
+    put_tables(f);
+    if (ferror(f) && !err)
+        err = eWRITE_FAILED;
+    fclose(f);
+    } // End of function event_trace::write_ring_tables.
+
+//------------------------------//
+//   event_trace::clear_names   //
+//------------------------------//
+void event_trace::clear_names() {
+    for (unsigned int i = 0; i < nobjs; ++i) {
+        delete[] onames[i];
+        delete[] otypes[i];
+        }
+    delete[] onames;
+    delete[] otypes;
+    onames = 0;
+    otypes = 0;
+    nobjs = 0;
+    for (long i = 0; i < nmnames; ++i)
+        delete[] mnames[i];
+    delete[] mnames;
+    mnames = 0;
+    nmnames = 0;
+    stale = false;
+    } // End of function event_trace::clear_names.
+
+/*------------------------------------------------------------------------------
+event_trace::wrap() is called when the last slot of the ring or buffer has been
+written. A full buffer is written to the file.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   event_trace::wrap  //
+//----------------------//
+void event_trace::wrap() {
+    if (!ring && fp && pos > 0) {
+        if (fwrite(rec, sizeof(trace_record), pos, fp) != pos && !err)
+            err = eWRITE_FAILED;
+        }
+    pos = 0;
+    } // End of function event_trace::wrap.
+
+/*------------------------------------------------------------------------------
+event_trace::sync() writes the buffered records to the file, and the record
+count to its header, or the name tables of a ring if objects have been added.
+Until then, a buffered file may lack recent records, and a ring file may lack
+the names of recent objects.
+------------------------------------------------------------------------------*/
+//----------------------//
+//   event_trace::sync  //
+//----------------------//
+void event_trace::sync() {
+    if (ring) {
+        if (map && stale)
+            write_ring_tables();
+        return;
+        }
+    if (fp) {
+        wrap();
+        fseek(fp, (long)offsetof(trace_header, count), SEEK_SET);
+        fwrite(&count, sizeof(count), 1, fp);
+        fseek(fp, 0, SEEK_END);
+        if (ferror(fp) && !err)
+            err = eWRITE_FAILED;
+        fflush(fp);
+        }
+    } // End of function event_trace::sync.
+
+/*------------------------------------------------------------------------------
+event_trace::close() writes the outstanding records and the name tables to the
+file, and then closes it.
+------------------------------------------------------------------------------*/
+//----------------------//
+//  event_trace::close  //
+//----------------------//
+int event_trace::close() {
+    if (!path)
+        return 0;
+    unsigned long long tables = 0;
+    if (ring) {
+#ifndef WIN32
+        if (map) {
+            ((trace_header*)map)->count = count;
+            munmap(map, maplen);
+            map = 0;
+            }
+#endif
+        rec = 0;
+        tables = maplen;
+        fp = fopen(path, "r+b");
+        if (fp)
+            fseek(fp, (long)tables, SEEK_SET);
+        }
+    else if (fp) {
+        wrap();
+        tables = sizeof(trace_header) + count * sizeof(trace_record);
+        }
+    if (fp) {
+        put_tables(fp);
+
+        // Complete the header.
+        fseek(fp, (long)offsetof(trace_header, count), SEEK_SET);
+        fwrite(&count, sizeof(count), 1, fp);
+        fwrite(&tables, sizeof(tables), 1, fp);
+        if (ferror(fp) && !err)
+            err = eWRITE_FAILED;
+        fclose(fp);
+        fp = 0;
+        }
+    else if (!err)
+        err = eFILE_OPEN_FAILED;
+    if (!ring)
+        delete[] rec;
+    rec = 0;
+    delete[] path;
+    path = 0;
+    clear_names();
+    return err;
+    } // End of function event_trace::close.
+
+/*------------------------------------------------------------------------------
+If the trace has not been closed, the records are kept. The names are kept only
+in a ring file.
+------------------------------------------------------------------------------*/
+//------------------------------//
+//  event_trace::~event_trace   //
+//------------------------------//
+event_trace::~event_trace() {
+    sync();
+#ifndef WIN32
+    if (map)
+        munmap(map, maplen);
+#endif
+    if (fp)
+        fclose(fp);
+    if (!ring)
+        delete[] rec;
+    delete[] path;
+    clear_names();
+    } // End of function event_trace::~event_trace.
+
+/*------------------------------------------------------------------------------
+systm::open_event_trace() starts a binary trace of the events of the system,
+with a ring or buffer of "nrec" records. The message types of the model and the
+objects of the system are put in the name tables at once. (See trace.h.)
+------------------------------------------------------------------------------*/
+//------------------------------//
+//    systm::open_event_trace   //
+//------------------------------//
+int systm::open_event_trace(const char* path, unsigned long nrec,
+        bool_enum ring) {
+    close_event_trace();
+    event_trace* pt = new event_trace;
+    int err = pt->open(path, nrec, ring);
+    if (err < 0) {
+        delete pt;
+        return err;
+        }
+    long nm = (mdl && mdl->mtypenames) ? mdl->cs_mtypenames.length() : 0;
+    pt->set_mtypes(mdl ? mdl->mtypenames : 0, nm);
+    for (object* po = objects.first(); po; po = po->next())
+        pt->add_object(po);
+    pt->sync();
+    etrace = pt;
+    return 0;
+    } // End of function systm::open_event_trace.
+
+//------------------------------//
+//   systm::close_event_trace   //
+//------------------------------//
+int systm::close_event_trace() {
+    if (!etrace)
+        return 0;
+    int err = etrace->close();
+    delete etrace;
+    etrace = 0;
+    return err;
+    } // End of function systm::close_event_trace.
+
+/*------------------------------------------------------------------------------
+systm::sync_event_trace() brings the trace file up to date, for example so that
+it can be read while the simulation is running. (See event_trace::sync().)
+------------------------------------------------------------------------------*/
+//------------------------------//
+//    systm::sync_event_trace   //
+//------------------------------//
+void systm::sync_event_trace() {
+    if (etrace)
+        etrace->sync();
+    } // End of function systm::sync_event_trace.